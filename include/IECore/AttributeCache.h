@@ -49,8 +49,9 @@ IE_CORE_FORWARDDECLARE( CompoundObject );
 /// A simple means of creating and reading caches of data values which are associated with
 /// notional "Objects" and "Attributes". Will throw an exception derived from IECore::Exception if
 /// any errors are encountered.
-/// \threading It is not safe to use an instance of this class from multiple concurrent threads. See
-/// the InterpolatedCache class for a threadsafe means of reading the files with automatic
+/// \threading It is not safe to use an instance of this class from multiple concurrent threads, except
+/// that the read and query methods of an instance opened in IndexedIO::Read mode may be called concurrently.
+/// See the InterpolatedCache class for a threadsafe means of reading the files with automatic
 /// interpolation.
 /// \ingroup ioGroup
 class AttributeCache : public RefCounted
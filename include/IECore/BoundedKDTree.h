@@ -71,6 +71,7 @@ class BoundedKDTree
 		/// Builds the tree for the specified bounds - the iterator range
 		/// must remain valid and unchanged as long as the tree is in use.
 		/// This method can be called again to rebuild the tree at any time.
+		/// Large trees are built in parallel using TBB tasks.
 		/// \threading This can't be called while other threads are
 		/// making queries.
 		void init( BoundIterator first, BoundIterator last, int maxLeafSize=4 );
@@ -103,8 +104,11 @@ class BoundedKDTree
 		typedef typename Permutation::const_iterator PermutationConstIterator;
 
 		class AxisSort;
+		class BuildTask;
 
 		unsigned char majorAxis( PermutationConstIterator permFirst, PermutationConstIterator permLast );
+		NodeIndex numNodesRequired( NodeIndex nodeIndex, typename Permutation::difference_type numBounds ) const;
+		PermutationIterator makeBranch( NodeIndex nodeIndex, PermutationIterator permFirst, PermutationIterator permLast );
 		void build( NodeIndex nodeIndex, PermutationIterator permFirst, PermutationIterator permLast );
 		void bound( NodeIndex nodeIndex );
 
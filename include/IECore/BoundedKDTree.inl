@@ -35,6 +35,8 @@
 #include <algorithm>
 #include <cassert>
 
+#include "tbb/task.h"
+
 #include "IECore/VectorTraits.h"
 #include "IECore/VectorOps.h"
 #include "IECore/BoxOps.h"
@@ -60,6 +62,50 @@ class BoundedKDTree<BoundIterator>::AxisSort
 		const unsigned int m_axis;
 };
 
+/// Builds a subtree, splitting the work into child tasks while
+/// the subtree is large enough to make that worthwhile.
+template<class BoundIterator>
+class BoundedKDTree<BoundIterator>::BuildTask : public tbb::task
+{
+	public :
+
+		BuildTask( BoundedKDTree *tree, NodeIndex nodeIndex, PermutationIterator permFirst, PermutationIterator permLast )
+			:	m_tree( tree ), m_nodeIndex( nodeIndex ), m_permFirst( permFirst ), m_permLast( permLast )
+		{
+		}
+
+		virtual tbb::task *execute()
+		{
+			// below this size the overhead of spawning tasks outweighs the benefits
+			static const int parallelThreshold = 10000;
+
+			if( m_permLast - m_permFirst <= std::max( parallelThreshold, m_tree->m_maxLeafSize ) )
+			{
+				m_tree->build( m_nodeIndex, m_permFirst, m_permLast );
+				return 0;
+			}
+
+			PermutationIterator permMid = m_tree->makeBranch( m_nodeIndex, m_permFirst, m_permLast );
+
+			set_ref_count( 3 );
+
+			tbb::task_list children;
+			children.push_back( *new( allocate_child() ) BuildTask( m_tree, lowChildIndex( m_nodeIndex ), m_permFirst, permMid ) );
+			children.push_back( *new( allocate_child() ) BuildTask( m_tree, highChildIndex( m_nodeIndex ), permMid, m_permLast ) );
+
+			spawn_and_wait_for_all( children );
+			return 0;
+		}
+
+	private :
+
+		BoundedKDTree *m_tree;
+		NodeIndex m_nodeIndex;
+		PermutationIterator m_permFirst;
+		PermutationIterator m_permLast;
+
+};
+
 
 template<class BoundIterator>
 BoundedKDTree<BoundIterator>::Node::Node() : m_cutAxisAndLeaf(0)
@@ -201,34 +247,50 @@ void BoundedKDTree<BoundIterator>::bound( NodeIndex nodeIndex  )
 
 
 template<class BoundIterator>
-void BoundedKDTree<BoundIterator>::build( NodeIndex nodeIndex, PermutationIterator permFirst, PermutationIterator permLast )
+typename BoundedKDTree<BoundIterator>::NodeIndex BoundedKDTree<BoundIterator>::numNodesRequired( NodeIndex nodeIndex, typename Permutation::difference_type numBounds ) const
 {
-	// make room for the new node
-	if( nodeIndex>=m_nodes.size() )
+	if( numBounds > m_maxLeafSize )
 	{
-		m_nodes.resize( nodeIndex+1 );
+		// must match the split made in makeBranch()
+		typename Permutation::difference_type numLowBounds = numBounds / 2;
+		return std::max(
+			numNodesRequired( lowChildIndex( nodeIndex ), numLowBounds ),
+			numNodesRequired( highChildIndex( nodeIndex ), numBounds - numLowBounds )
+		);
 	}
+	return nodeIndex + 1;
+}
 
+template<class BoundIterator>
+typename BoundedKDTree<BoundIterator>::PermutationIterator BoundedKDTree<BoundIterator>::makeBranch( NodeIndex nodeIndex, PermutationIterator permFirst, PermutationIterator permLast )
+{
 	assert( nodeIndex < m_nodes.size() );
 
-	Node &node = m_nodes[nodeIndex];
+	unsigned int cutAxis = majorAxis( permFirst, permLast );
+	PermutationIterator permMid = permFirst  + (permLast - permFirst)/2;
+	std::nth_element( permFirst, permMid, permLast, AxisSort( cutAxis ) );
 
-	if( permLast - permFirst > m_maxLeafSize )
-	{
-		unsigned int cutAxis = majorAxis( permFirst, permLast );
-		PermutationIterator permMid = permFirst  + (permLast - permFirst)/2;
-		std::nth_element( permFirst, permMid, permLast, AxisSort( cutAxis ) );
+	// insert node
+	m_nodes[nodeIndex].makeBranch( cutAxis );
 
-		// insert node
-		node.makeBranch( cutAxis );
+	return permMid;
+}
+
+template<class BoundIterator>
+void BoundedKDTree<BoundIterator>::build( NodeIndex nodeIndex, PermutationIterator permFirst, PermutationIterator permLast )
+{
+	assert( nodeIndex < m_nodes.size() );
 
+	if( permLast - permFirst > m_maxLeafSize )
+	{
+		PermutationIterator permMid = makeBranch( nodeIndex, permFirst, permLast );
 		build( lowChildIndex( nodeIndex ), permFirst, permMid );
 		build( highChildIndex( nodeIndex ), permMid, permLast );
 	}
 	else
 	{
 		// leaf node
-		node.makeLeaf( permFirst, permLast );
+		m_nodes[nodeIndex].makeLeaf( permFirst, permLast );
 	}
 }
 
@@ -256,8 +318,14 @@ void BoundedKDTree<BoundIterator>::init( BoundIterator first, BoundIterator last
 		m_perm[i++] = it;
 	}
 
-	/// \todo Can we reserve() enough space for m_nodes before doing this?
-	build( rootIndex(), m_perm.begin(), m_perm.end() );
+	// the shape of the tree only depends on the number of bounds, so we can
+	// allocate all the nodes up front and then fill them in from parallel tasks.
+	m_nodes.clear();
+	m_nodes.resize( numNodesRequired( rootIndex(), m_perm.size() ) );
+
+	BuildTask *task = new( tbb::task::allocate_root() ) BuildTask( this, rootIndex(), m_perm.begin(), m_perm.end() );
+	tbb::task::spawn_root_and_wait( *task );
+
 	bound( rootIndex() );
 }
 
@@ -0,0 +1,116 @@
+//////////////////////////////////////////////////////////////////////////
+//
+//  Copyright (c) 2013, Image Engine Design Inc. All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are
+//  met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//
+//     * Neither the name of Image Engine Design nor the names of any
+//       other contributors to this software may be used to endorse or
+//       promote products derived from this software without specific prior
+//       written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+//  IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+//  THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+//  PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+//  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+//  EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+//  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+//  PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+//  LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+//  NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//////////////////////////////////////////////////////////////////////////
+
+#ifndef IECORE_BOUNDINGVOLUMEHIERARCHY_H
+#define IECORE_BOUNDINGVOLUMEHIERARCHY_H
+
+#include <vector>
+
+#include "boost/noncopyable.hpp"
+
+#include "OpenEXR/ImathBox.h"
+#include "OpenEXR/ImathVec.h"
+
+namespace IECore
+{
+
+/// A bounding volume hierarchy over a set of boxes, intended for fast ray casting. Unlike the
+/// BoundedKDTree, which splits at the median and has two children per node, the hierarchy is
+/// built using the surface area heuristic and each node has up to four children. The bounds of
+/// the children are stored together in the node, so that a ray is tested against all four with
+/// a single visit to the node.
+/// \ingroup mathGroup
+class BoundingVolumeHierarchy : public boost::noncopyable
+{
+	public :
+
+		/// Builds the hierarchy for the specified bounds. Primitives are identified in
+		/// queries by their index into the bounds vector, which doesn't need to be kept
+		/// after construction.
+		BoundingVolumeHierarchy( const std::vector<Imath::Box3f> &bounds, unsigned maxLeafSize = 4 );
+
+		/// Returns the bound of all the primitives.
+		const Imath::Box3f &bound() const;
+		/// Returns the number of nodes in the hierarchy.
+		size_t numNodes() const;
+
+		/// Visits the primitives whose bounds are hit by the ray closer than maxDistance, calling
+		/// intersector( primitiveIndex, maxDistance ) for each. Nearer children are visited first, and
+		/// the intersector may reduce maxDistance to cull the rest of the traversal, which makes finding
+		/// the closest intersection efficient. The direction must be normalised, so that distances along
+		/// the ray are consistent with the bounds.
+		/// \threading May be called by multiple concurrent threads.
+		template<typename Intersector>
+		void intersect( const Imath::V3f &origin, const Imath::V3f &direction, float &maxDistance, Intersector &intersector ) const;
+
+	private :
+
+		struct Node
+		{
+			// child bounds, stored by axis and then by child
+			float boundMin[3][4];
+			float boundMax[3][4];
+			// for a leaf child, the offset of its first primitive in
+			// m_primitives, and for a branch child the index of its node.
+			unsigned child[4];
+			// the number of primitives in a leaf child, 0 for a branch.
+			unsigned numPrimitives[4];
+			unsigned numChildren;
+		};
+
+		typedef std::vector<unsigned>::iterator PrimitiveIterator;
+
+		unsigned build( PrimitiveIterator first, PrimitiveIterator last );
+		PrimitiveIterator split( PrimitiveIterator first, PrimitiveIterator last ) const;
+		Imath::Box3f rangeBound( PrimitiveIterator first, PrimitiveIterator last ) const;
+
+		template<typename Intersector>
+		void intersectWalk( unsigned nodeIndex, const Imath::V3f &origin, const Imath::V3f &inverseDirection, float &maxDistance, Intersector &intersector ) const;
+
+		unsigned m_maxLeafSize;
+		std::vector<Node> m_nodes;
+		std::vector<unsigned> m_primitives;
+		Imath::Box3f m_bound;
+
+		// only used during construction
+		const std::vector<Imath::Box3f> *m_bounds;
+		std::vector<Imath::V3f> m_centroids;
+
+};
+
+} // namespace IECore
+
+#include "IECore/BoundingVolumeHierarchy.inl"
+
+#endif // IECORE_BOUNDINGVOLUMEHIERARCHY_H
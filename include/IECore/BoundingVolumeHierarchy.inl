@@ -0,0 +1,141 @@
+//////////////////////////////////////////////////////////////////////////
+//
+//  Copyright (c) 2013, Image Engine Design Inc. All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are
+//  met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//
+//     * Neither the name of Image Engine Design nor the names of any
+//       other contributors to this software may be used to endorse or
+//       promote products derived from this software without specific prior
+//       written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+//  IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+//  THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+//  PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+//  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+//  EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+//  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+//  PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+//  LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+//  NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//////////////////////////////////////////////////////////////////////////
+
+#ifndef IECORE_BOUNDINGVOLUMEHIERARCHY_INL
+#define IECORE_BOUNDINGVOLUMEHIERARCHY_INL
+
+#include <algorithm>
+
+#include "OpenEXR/ImathLimits.h"
+
+namespace IECore
+{
+
+inline const Imath::Box3f &BoundingVolumeHierarchy::bound() const
+{
+	return m_bound;
+}
+
+inline size_t BoundingVolumeHierarchy::numNodes() const
+{
+	return m_nodes.size();
+}
+
+template<typename Intersector>
+void BoundingVolumeHierarchy::intersect( const Imath::V3f &origin, const Imath::V3f &direction, float &maxDistance, Intersector &intersector ) const
+{
+	if( m_nodes.empty() )
+	{
+		return;
+	}
+
+	Imath::V3f inverseDirection;
+	for( int a = 0; a < 3; ++a )
+	{
+		inverseDirection[a] = direction[a] != 0.0f ? 1.0f / direction[a] : Imath::limits<float>::max();
+	}
+
+	intersectWalk( 0, origin, inverseDirection, maxDistance, intersector );
+}
+
+template<typename Intersector>
+void BoundingVolumeHierarchy::intersectWalk( unsigned nodeIndex, const Imath::V3f &origin, const Imath::V3f &inverseDirection, float &maxDistance, Intersector &intersector ) const
+{
+	const Node &node = m_nodes[nodeIndex];
+
+	// slab test against all four children at once.
+	float entry[4], exit[4];
+	for( int i = 0; i < 4; ++i )
+	{
+		entry[i] = 0.0f;
+		exit[i] = maxDistance;
+	}
+	for( int a = 0; a < 3; ++a )
+	{
+		for( int i = 0; i < 4; ++i )
+		{
+			const float t0 = ( node.boundMin[a][i] - origin[a] ) * inverseDirection[a];
+			const float t1 = ( node.boundMax[a][i] - origin[a] ) * inverseDirection[a];
+			entry[i] = std::max( entry[i], std::min( t0, t1 ) );
+			exit[i] = std::min( exit[i], std::max( t0, t1 ) );
+		}
+	}
+
+	// sort the hit children so the nearest are visited first
+	unsigned hits[4];
+	unsigned numHits = 0;
+	// allow for rounding error so that rays grazing flat bounds aren't missed
+	const float tolerance = 1.0f + 4.0f * Imath::limits<float>::epsilon();
+	for( unsigned i = 0; i < node.numChildren; ++i )
+	{
+		if( entry[i] <= exit[i] * tolerance )
+		{
+			unsigned j = numHits++;
+			while( j > 0 && entry[hits[j-1]] > entry[i] )
+			{
+				hits[j] = hits[j-1];
+				--j;
+			}
+			hits[j] = i;
+		}
+	}
+
+	for( unsigned h = 0; h < numHits; ++h )
+	{
+		const unsigned i = hits[h];
+		if( entry[i] > maxDistance )
+		{
+			// the intersector has found something closer
+			continue;
+		}
+
+		if( node.numPrimitives[i] )
+		{
+			const unsigned *primitive = &(m_primitives[node.child[i]]);
+			const unsigned *primitiveEnd = primitive + node.numPrimitives[i];
+			for( ; primitive != primitiveEnd; ++primitive )
+			{
+				intersector( *primitive, maxDistance );
+			}
+		}
+		else
+		{
+			intersectWalk( node.child[i], origin, inverseDirection, maxDistance, intersector );
+		}
+	}
+}
+
+} // namespace IECore
+
+#endif // IECORE_BOUNDINGVOLUMEHIERARCHY_INL
@@ -37,15 +37,19 @@
 
 #include "boost/function.hpp"
 
-#include "IECore/LRUCache.h"
+#include "tbb/atomic.h"
+
+#include "IECore/ShardedLRUCache.h"
 #include "IECore/ObjectPool.h"
 
 namespace IECore
 {
 
-/// LRUCache for generic computation that results on Object derived classes. It uses ObjectPool for the storage and retrieval of 
+/// ShardedLRUCache for generic computation that results on Object derived classes. It uses ObjectPool for the storage and retrieval of 
 /// the computation results, and internally it only holds a map of computationHash to objectHash. The get functions will return the resulting 
 /// Object, which should be copied prior to modification. The retrieve function will only query the cache and not force computation.
+/// The cache limit can either be expressed as a number of computations or as a memory budget in bytes, in which case each
+/// computation costs the Object::memoryUsage() of its result.
 template< typename T >
 class ComputationCache : public RefCounted
 {
@@ -57,12 +61,21 @@ class ComputationCache : public RefCounted
 
 		IE_CORE_DECLAREMEMBERPTR( ComputationCache )
 
+		/// Enum used to specify how each computation counts against the cache limit.
+		typedef enum {
+			/// Each computation costs 1, so the limit is a number of computations.
+			CountCost = 0,
+			/// Each computation costs the memoryUsage() of its result, so the limit is in bytes.
+			MemoryCost
+		} CostMode;
+
 		/// Constructs a cache for the given computation function and hash functions.
 		/// \param computeFn Functor that should know return the computation result from the templated parameters.
 		/// \param hashFn Functor that should compute a unique hash from the templated parameters identifying the computation result.
-		/// \param maxResults Limits the number of computation results this cache will hold.
+		/// \param maxResults Limits the number of computation results this cache will hold, or its memory usage in bytes when costMode is MemoryCost.
 		/// \param objectPool Allows overriding the ObjectPool instance to be used for holding the resulting computed objects.
-		ComputationCache( ComputeFn computeFn, HashFn hashFn, size_t maxResults = 10000, ObjectPoolPtr objectPool = ObjectPool::defaultObjectPool() );
+		/// \param costMode Defines how the maxResults limit is interpreted.
+		ComputationCache( ComputeFn computeFn, HashFn hashFn, size_t maxResults = 10000, ObjectPoolPtr objectPool = ObjectPool::defaultObjectPool(), CostMode costMode = CountCost );
 
 		virtual ~ComputationCache();
 
@@ -72,15 +85,29 @@ class ComputationCache : public RefCounted
 		/// Removes stored information about a specific computation result.
 		void erase( const T &args );
 
-		/// Returns the maximum number of stored computations in the cache.
+		/// Returns the maximum number of stored computations in the cache, or the
+		/// maximum memory usage in bytes when the cost mode is MemoryCost.
 		size_t getMaxComputations() const;
 
-		/// Defines the maximum number of stored computations allowed in the cache. May trigger deallocation.
+		/// Defines the maximum number of stored computations allowed in the cache, or the
+		/// maximum memory usage in bytes when the cost mode is MemoryCost. May trigger deallocation.
 		void setMaxComputations( size_t maxComputations );
 
-		/// Returns the number of stored computations
+		/// Returns the number of stored computations, or their memory usage in bytes
+		/// when the cost mode is MemoryCost.
 		size_t cachedComputations() const;
 
+		/// Returns the cost mode given at construction.
+		CostMode costMode() const;
+
+		/// Statistics about the usage of the cache. Hits are calls to get() that found
+		/// the result in both the cache and the ObjectPool, misses are all other calls
+		/// to get() and evictions count results discarded from the cache, either due to
+		/// the limit or to explicit calls to erase(). The statistics are reset by clear().
+		size_t hits() const;
+		size_t misses() const;
+		size_t evictions() const;
+
 		/// Enum used to specify behavior when retrieving computation results from the cache.
 		typedef enum {
 			ThrowIfMissing = 0,
@@ -106,10 +133,18 @@ class ComputationCache : public RefCounted
 		ComputeFn m_computeFn;
 		HashFn m_hashFn;
 
-		typedef IECore::LRUCache<MurmurHash, MurmurHash> Cache;
+		typedef IECore::ShardedLRUCache<MurmurHash, MurmurHash> Cache;
 		Cache m_cache;
 
 		ObjectPoolPtr m_objectPool;
+		CostMode m_costMode;
+
+		tbb::atomic<size_t> m_hits;
+		tbb::atomic<size_t> m_misses;
+		tbb::atomic<size_t> m_evictions;
+
+		size_t cost( const Object *obj ) const;
+		void removalCallback( const MurmurHash &computationHash, const MurmurHash &objectHash );
 
 		static MurmurHash cacheGetter( const MurmurHash &h, size_t &cost );
 };
@@ -35,15 +35,20 @@
 #ifndef IECORE_COMPUTATIONCACHE_INL
 #define IECORE_COMPUTATIONCACHE_INL
 
+#include "boost/bind.hpp"
+
 #include "IECore/MessageHandler.h"
 
 namespace IECore
 {
 
 template< typename T >
-ComputationCache<T>::ComputationCache( ComputeFn computeFn, HashFn hashFn, size_t maxResults, ObjectPoolPtr objectPool ) : 
-	m_computeFn(computeFn), m_hashFn(hashFn), m_cache( &ComputationCache<T>::cacheGetter, maxResults), m_objectPool(objectPool)
+ComputationCache<T>::ComputationCache( ComputeFn computeFn, HashFn hashFn, size_t maxResults, ObjectPoolPtr objectPool, CostMode costMode ) : 
+	m_computeFn(computeFn), m_hashFn(hashFn), m_cache( &ComputationCache<T>::cacheGetter, boost::bind( &ComputationCache<T>::removalCallback, this, _1, _2 ), maxResults), m_objectPool(objectPool), m_costMode(costMode)
 {
+	m_hits = 0;
+	m_misses = 0;
+	m_evictions = 0;
 }
 
 template< typename T >
@@ -55,6 +60,9 @@ template< typename T >
 void ComputationCache<T>::clear()
 {
 	m_cache.clear();
+	m_hits = 0;
+	m_misses = 0;
+	m_evictions = 0;
 }
 
 template< typename T >
@@ -82,6 +90,30 @@ size_t ComputationCache<T>::cachedComputations() const
 	return m_cache.currentCost();
 }
 
+template< typename T >
+typename ComputationCache<T>::CostMode ComputationCache<T>::costMode() const
+{
+	return m_costMode;
+}
+
+template< typename T >
+size_t ComputationCache<T>::hits() const
+{
+	return m_hits;
+}
+
+template< typename T >
+size_t ComputationCache<T>::misses() const
+{
+	return m_misses;
+}
+
+template< typename T >
+size_t ComputationCache<T>::evictions() const
+{
+	return m_evictions;
+}
+
 template< typename T >
 ConstObjectPtr ComputationCache<T>::get( const T &args, typename ComputationCache::MissingBehaviour missingBehaviour )
 {
@@ -91,6 +123,7 @@ ConstObjectPtr ComputationCache<T>::get( const T &args, typename ComputationCach
 
 	if ( objectHash == MurmurHash() )
 	{
+		m_misses++;
 		/// don't know the computation hash... check the missing behaviour
 		if ( missingBehaviour == ThrowIfMissing )
 		{
@@ -103,15 +136,20 @@ ConstObjectPtr ComputationCache<T>::get( const T &args, typename ComputationCach
 		obj = m_computeFn(args);
 		if ( obj )
 		{
-			m_cache.set( computationHash, obj->hash(), 1 );
+			m_cache.set( computationHash, obj->hash(), cost( obj.get() ) );
 			obj = m_objectPool->store( obj, ObjectPool::StoreReference );
 		}
 	}
 	else
 	{
 		obj = m_objectPool->retrieve(objectHash);
-		if ( !obj )
+		if ( obj )
+		{
+			m_hits++;
+		}
+		else
 		{
+			m_misses++;
 			/// the computation result was not in the object pool.... check the missing behavour
 			if ( missingBehaviour == ThrowIfMissing )
 			{
@@ -129,7 +167,7 @@ ConstObjectPtr ComputationCache<T>::get( const T &args, typename ComputationCach
 				if ( h != objectHash )
 				{
 					/// the computation returned a different object for some reason, so we have to update the hash
-					m_cache.set( computationHash, h, 1 );	
+					m_cache.set( computationHash, h, cost( obj.get() ) );
 					msg( Msg::Warning, "ComputationCache::get", "Inconsistent hash detected." );
 				}
 			}
@@ -145,7 +183,27 @@ void ComputationCache<T>::set( const T &args, const Object *obj, StoreMode store
 	if ( obj )
 	{
 		m_objectPool->store(obj, storeMode);
-		m_cache.set( computationHash, obj->hash(), 1 );
+		m_cache.set( computationHash, obj->hash(), cost( obj ) );
+	}
+}
+
+template< typename T >
+size_t ComputationCache<T>::cost( const Object *obj ) const
+{
+	if ( m_costMode == MemoryCost )
+	{
+		return obj->memoryUsage();
+	}
+	return 1;
+}
+
+template< typename T >
+void ComputationCache<T>::removalCallback( const MurmurHash &computationHash, const MurmurHash &objectHash )
+{
+	/// placeholders left by cacheGetter for unknown computations are not results
+	if ( objectHash != MurmurHash() )
+	{
+		m_evictions++;
 	}
 }
 
@@ -35,7 +35,7 @@
 #ifndef IECORE_CURVESPRIMITIVEEVALUATOR_H
 #define IECORE_CURVESPRIMITIVEEVALUATOR_H
 
-#include "tbb/mutex.h"
+#include "tbb/atomic.h"
 
 #include "IECore/PrimitiveEvaluator.h"
 #include "IECore/BoundedKDTree.h"
@@ -146,6 +146,18 @@ class CurvesPrimitiveEvaluator : public PrimitiveEvaluator
 		float curveLength( unsigned curveIndex, float vStart=0.0f, float vEnd=1.0f ) const;
 		//@}
 
+		//! @name Batch Query Functions
+		/// These perform many queries in parallel, returning the results as arrays
+		/// rather than allocating a Result for each query.
+		////////////////////////////////////////////////////////////////////////////////////////
+		//@{
+		/// Batch form of closestPoint(). Each output vector which is non-zero is resized to match
+		/// the number of points and filled with the position, curve index or v parameter of each
+		/// closest point. Returns false if there are no curves.
+		bool closestPoints( const std::vector<Imath::V3f> &points, std::vector<Imath::V3f> *positions,
+			std::vector<unsigned> *curveIndices = 0, std::vector<float> *vs = 0 ) const;
+		//@}
+
 		//! @name Topology access
 		/// These functions make it easier to index curve data manually in cases where the
 		/// queries above are not sufficient.
@@ -181,14 +193,11 @@ class CurvesPrimitiveEvaluator : public PrimitiveEvaluator
 		std::vector<int> m_varyingDataOffsets; // one value per curve
 		PrimitiveVariable m_p;
 		
-		void buildTree();
-		bool m_haveTree;
-		typedef tbb::mutex TreeMutex;
-		TreeMutex m_treeMutex;
-		Box3fTree m_tree;
-		std::vector<Imath::Box3f> m_treeBounds;
+		void buildTree() const;
 		struct Line;
-		std::vector<Line> m_treeLines;
+		struct Tree;
+		// built on demand and published atomically - see buildTree().
+		mutable tbb::atomic<Tree *> m_tree;
 		
 		void closestPointWalk( Box3fTree::NodeIndex nodeIndex, const Imath::V3f &p, unsigned &curveIndex, float &v, float &closestDistSquared ) const;
 		
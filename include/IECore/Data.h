@@ -48,6 +48,22 @@ class Data : public Object
 
 		IE_CORE_DECLAREABSTRACTOBJECT( Data, Object );
 
+		//! @name Copy-on-write statistics
+		/// TypedData copies share their underlying data until one of them is
+		/// modified with writable(), at which point the data is duplicated. These
+		/// functions track how much data is actually duplicated, so that the
+		/// effectiveness of copy-on-write can be measured.
+		////////////////////////////////////////////////////////////
+		//@{
+		/// Returns the approximate number of bytes which have been duplicated
+		/// by writable() on the calling thread since the process began. Comparing
+		/// the values before and after an operation gives the amount of data it
+		/// duplicated.
+		static size_t bytesDuplicated();
+		/// Called by the TypedData implementation to record a duplication.
+		static void recordBytesDuplicated( size_t bytes );
+		//@}
+
 	protected :
 
 		virtual ~Data();
@@ -72,10 +72,9 @@ class EXRImageReader : public ImageReader
 
 	private:
 
-		template<class T>
-		DataPtr readTypedChannel( const std::string &name, const Imath::Box2i &dataWindow, const Imf::Channel *channel );
-
 		virtual DataPtr readChannel( const std::string &name, const Imath::Box2i &dataWindow, bool raw );
+		/// Reads all the channels in a single pass, so that each scanline is only decompressed once.
+		virtual void readChannels( const std::vector<std::string> &names, const Imath::Box2i &dataWindow, bool raw, std::vector<DataPtr> &channels );
 
 		static const ReaderDescription<EXRImageReader> g_readerDescription;
 
@@ -41,6 +41,10 @@ namespace IECore
 {
 
 /// An implementation of StreamIndexedIO which operates within a single file on disk.
+/// When opened with IndexedIO::Read | IndexedIO::MemoryMapped the file is mapped into
+/// memory and data is copied straight from the mapped pages. This removes the system
+/// call per read, but the data is still copied - loaded objects don't alias the mapping,
+/// so loading costs an allocation and a memcpy as well as the page faults.
 /// \ingroup ioGroup
 class FileIndexedIO : public StreamIndexedIO
 {
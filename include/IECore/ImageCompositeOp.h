@@ -110,9 +110,9 @@ class ImageCompositeOp : public ImagePrimitiveOp
 
 	private :
 		struct ChannelConverter;
+		struct CompositeBody;
 
 		FloatVectorDataPtr getChannelData( ImagePrimitive * image, const std::string &channelName, bool mustExist = true );
-		float readChannelData( const ImagePrimitive * image, const FloatVectorData * data, const Imath::V2i &pixel );
 
 };
 
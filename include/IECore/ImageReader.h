@@ -130,7 +130,7 @@ class ImageReader : public Reader
 		/// isn't wholly inside the available dataWindow().
 		Imath::Box2i dataWindowToRead();
 
-		/// Implemented using displayWindow(), dataWindow(), channelNames() and readChannel().
+		/// Implemented using displayWindow(), dataWindow(), channelNames() and readChannels().
 		/// Derived classes should implement those methods rather than reimplement this function.
 		virtual ObjectPtr doOperation( const CompoundObject *operands );
 
@@ -140,6 +140,13 @@ class ImageReader : public Reader
 		/// invalid names or dataWindows which are not wholly within the dataWindow in the file.
 		virtual DataPtr readChannel( const std::string &name, const Imath::Box2i &dataWindow, bool raw ) = 0;
 
+		/// Reads the specified area from all the named channels, placing the results in the
+		/// corresponding elements of the channels vector. This is called by the doOperation()
+		/// method. The default implementation simply calls readChannel() for each name in turn,
+		/// but derived classes may reimplement it for formats which can decode several channels
+		/// in a single pass over the file. The same guarantees apply as for readChannel().
+		virtual void readChannels( const std::vector<std::string> &names, const Imath::Box2i &dataWindow, bool raw, std::vector<DataPtr> &channels );
+
 	private :
 
 		Box2iParameterPtr m_dataWindowParameter;
@@ -48,6 +48,8 @@
 namespace IECore
 {
 
+class MurmurHash;
+
 IE_CORE_FORWARDDECLARE( IndexedIO );
 
 /// Abstract interface to define operations on a random-access indexed input/output device. All methods throw an instance of IOException,
@@ -68,6 +70,20 @@ class IndexedIO : public RunTimeTyped
 
 			Shared    = 1L << 3,
 			Exclusive = 1L << 4,
+
+			/// May be combined with Read to request that implementations
+			/// which support it map the file into memory, rather than
+			/// reading it through a stream. Currently supported by FileIndexedIO.
+			/// Note that this is not zero-copy - data read from the file is still
+			/// copied out of the mapping into the memory of the Object loaded, but
+			/// without any system calls or locking.
+			MemoryMapped = 1L << 5,
+
+			/// May be combined with Write or Append to request that implementations
+			/// which support it compress large data entries. Currently supported by
+			/// StreamIndexedIO subclasses, and ignored when appending to files written
+			/// with an older format.
+			CompressedData = 1L << 6,
 		} ;
 
 		typedef unsigned OpenMode;
@@ -349,6 +365,28 @@ class IndexedIO : public RunTimeTyped
 		/// \param x The data to write
 		virtual void write(const IndexedIO::EntryID &name, const unsigned short &x) = 0;
 
+		/// \name Writing with a precomputed hash
+		/// These variants of the array write() methods accept a hash which uniquely
+		/// identifies the contents of the array, such as the hash of the Data object
+		/// the array came from. Implementations which share identical data between
+		/// entries may use it to find previous copies without examining the data
+		/// themselves. The default implementations ignore the hash and call the
+		/// equivalent write() method.
+		//@{
+		virtual void write(const IndexedIO::EntryID &name, const float *x, unsigned long arrayLength, const MurmurHash &hash);
+		virtual void write(const IndexedIO::EntryID &name, const double *x, unsigned long arrayLength, const MurmurHash &hash);
+		virtual void write(const IndexedIO::EntryID &name, const half *x, unsigned long arrayLength, const MurmurHash &hash);
+		virtual void write(const IndexedIO::EntryID &name, const int *x, unsigned long arrayLength, const MurmurHash &hash);
+		virtual void write(const IndexedIO::EntryID &name, const int64_t *x, unsigned long arrayLength, const MurmurHash &hash);
+		virtual void write(const IndexedIO::EntryID &name, const uint64_t *x, unsigned long arrayLength, const MurmurHash &hash);
+		virtual void write(const IndexedIO::EntryID &name, const unsigned int *x, unsigned long arrayLength, const MurmurHash &hash);
+		virtual void write(const IndexedIO::EntryID &name, const char *x, unsigned long arrayLength, const MurmurHash &hash);
+		virtual void write(const IndexedIO::EntryID &name, const unsigned char *x, unsigned long arrayLength, const MurmurHash &hash);
+		virtual void write(const IndexedIO::EntryID &name, const short *x, unsigned long arrayLength, const MurmurHash &hash);
+		virtual void write(const IndexedIO::EntryID &name, const unsigned short *x, unsigned long arrayLength, const MurmurHash &hash);
+		virtual void write(const IndexedIO::EntryID &name, const InternedString *x, unsigned long arrayLength, const MurmurHash &hash);
+		//@}
+
 		/// Read a float array from an existing file.
 		/// \param name The name of the file to be read
 		/// \param x The buffer to fill. If 0 is passed, then memory is allocated and should be freed by the caller.
@@ -49,7 +49,9 @@ IE_CORE_FORWARDDECLARE( FileSequence );
 /// \threading This class provides limited thread safety. The methods which specify the caches
 /// to be read are not safe to call while other threads are operating on the object. However, once
 /// the caches have been specified it is safe to call the read methods from multiple concurrent threads and
-/// with multiple different frame arguments. See the documentation of the individual methods for more details.
+/// with multiple different frame arguments. Reads from the same file don't block one another, so concurrent
+/// reads of different objects at the same frame run in parallel. See the documentation of the individual
+/// methods for more details.
 /// \todo It might be great to pass interpolation and oversamples calculator to each read method rather
 /// than have them store as state. This would allow different interpolation and oversampling per call and per thread.
 /// If we did this I think we should look at replacing the OversamplesCalculator class with some more sensible
@@ -74,11 +76,13 @@ class InterpolatedCache : public RefCounted
 
 		/// Constructor
 		/// pathTemplate must be a valid FileSequence filename specifier, e.g. "myCacheFile.####.cob"
+		/// maxMemory is specified in bytes - see setMaxMemory().
 		InterpolatedCache(
 			const std::string &pathTemplate = "",
 			Interpolation interpolation = None,
 			const OversamplesCalculator &o = OversamplesCalculator(),
-			size_t maxOpenFiles = 10
+			size_t maxOpenFiles = 10,
+			size_t maxMemory = 500 * 1024 * 1024
 		);
 		
 		~InterpolatedCache();
@@ -92,7 +96,8 @@ class InterpolatedCache : public RefCounted
 		/// methods of this class.
 		const std::string &getPathTemplate() const;
 
-		/// Sets the maximum number of caches this class will keep open at one time.
+		/// Sets the maximum number of caches this class will keep open at one time. Changing
+		/// this closes all the open caches.
 		/// \threading It is not safe to call this method while other threads are accessing
 		/// this object.
 		void setMaxOpenFiles( size_t maxOpenFiles );
@@ -101,6 +106,24 @@ class InterpolatedCache : public RefCounted
 		/// methods of this class.
 		size_t getMaxOpenFiles() const;
 
+		/// Sets the limit (in bytes) on the total size of the caches this class keeps open, in
+		/// addition to the limit on their number. Each open file is costed at its size on disk,
+		/// but at no less than getMaxMemory() / getMaxOpenFiles(), so that neither limit is exceeded.
+		/// The least recently used files are closed when the limit is reached, and a file larger than
+		/// the limit is opened again each time it is needed.
+		/// \threading It is not safe to call this method while other threads are accessing
+		/// this object.
+		void setMaxMemory( size_t maxMemory );
+		/// Returns the limit (in bytes) on the total size of open caches.
+		/// \threading It is safe to call this method while other threads are calling const
+		/// methods of this class.
+		size_t getMaxMemory() const;
+		/// Returns the total cost (in bytes) of the currently open caches, as described
+		/// for setMaxMemory().
+		/// \threading It is safe to call this method while other threads are calling const
+		/// methods of this class.
+		size_t memoryUsage() const;
+
 		/// Sets the interpolation method.
 		/// \threading It is not safe to call this method while other threads are accessing
 		/// this object.
@@ -186,6 +209,20 @@ class InterpolatedCache : public RefCounted
 		/// methods of this class.
 		bool contains( float frame, const ObjectHandle &obj, const AttributeHandle &attr ) const;
 
+		/// Starts opening the cache files needed for the numFrames frames following frame, spaced by
+		/// step, in a background task and returns immediately. This allows the files for the next
+		/// frames to be loaded while the current one is being processed. Errors are not reported by
+		/// prefetch() but by the first read which needs the file in question. Prefetched files are
+		/// subject to the memory limit in the same way as any other.
+		/// \threading It is safe to call this method while other threads are calling const
+		/// methods of this class. The methods which aren't safe to call concurrently wait for
+		/// any prefetches to complete before making their changes.
+		void prefetch( float frame, float step = 1.0f, int numFrames = 1 ) const;
+		/// Waits for all the files requested by prefetch() to be opened.
+		/// \threading It is safe to call this method while other threads are calling const
+		/// methods of this class.
+		void waitForPrefetches() const;
+
 	private :
 
 		IE_CORE_FORWARDDECLARE( Implementation );
@@ -68,15 +68,21 @@ class KDTree
 		/// Creates a tree for the fast searching of points.
 		/// Note that the tree does not own the passed points -
 		/// it is up to you to ensure that they remain valid and
-		/// unchanged as long as the KDTree is in use.
-		KDTree( PointIterator first, PointIterator last, int maxLeafSize=4 );
+		/// unchanged as long as the KDTree is in use. If contiguousLeaves
+		/// is true, the tree also stores a copy of the points in tree
+		/// order, so that queries visiting a leaf read its points from
+		/// consecutive memory rather than dereferencing an iterator per
+		/// point. This uses additional memory but speeds up queries on
+		/// large pointsets.
+		KDTree( PointIterator first, PointIterator last, int maxLeafSize=4, bool contiguousLeaves=false );
 
 		/// Builds the tree for the specified points - the iterator range
 		/// must remain valid and unchanged as long as the tree is in use.
 		/// This method can be called again to rebuild the tree at any time.
+		/// Large trees are built in parallel using TBB tasks.
 		/// \threading This can't be called while other threads are
 		/// making queries.
-		void init( PointIterator first, PointIterator last, int maxLeafSize=4  );
+		void init( PointIterator first, PointIterator last, int maxLeafSize=4, bool contiguousLeaves=false );
 
 		/// Returns an iterator to the nearest neighbour to the point p.
 		/// \threading May be called by multiple concurrent threads.
@@ -101,6 +107,29 @@ class KDTree
 		/// \threading May be called by multiple concurrent threads provided they are each using a different vector for the result.
 		unsigned int nearestNNeighbours( const Point &p, unsigned int numNeighbours, std::vector<Neighbour> &nearNeighbours ) const;
 
+		/// Batch form of nearestNeighbour(). Finds the nearest neighbour to each point in the random access range
+		/// [queryFirst, queryLast), placing the results in nearestNeighbours in the same order as the queries.
+		/// The queries are sorted spatially, so that successive searches visit the same parts of the tree, and are
+		/// then performed in parallel. This is much faster than calling nearestNeighbour() in a loop for large
+		/// numbers of queries, particularly for trees built with contiguousLeaves.
+		/// \threading May be called by multiple concurrent threads provided they are each using a different vector for the result.
+		template<typename QueryIterator>
+		void nearestNeighbour( QueryIterator queryFirst, QueryIterator queryLast, std::vector<PointIterator> &nearestNeighbours ) const;
+
+		/// Batch form of nearestNeighbours(). Sorts and parallelises the queries as for the batch form of nearestNeighbour(),
+		/// placing the neighbours of each query within radius r in the corresponding element of nearNeighbours.
+		/// \threading May be called by multiple concurrent threads provided they are each using a different vector for the result.
+		template<typename QueryIterator>
+		void nearestNeighbours( QueryIterator queryFirst, QueryIterator queryLast, BaseType r, std::vector<std::vector<PointIterator> > &nearNeighbours ) const;
+
+		/// Batch form of nearestNNeighbours(). Sorts and parallelises the queries as for the batch form of nearestNeighbour().
+		/// The same number of neighbours n is found for every query - this is the smaller of numNeighbours and the number
+		/// of points in the tree, and is returned. The neighbours of query i are placed in nearNeighbours[i*n] to
+		/// nearNeighbours[i*n+n-1], sorted with the closest first.
+		/// \threading May be called by multiple concurrent threads provided they are each using a different vector for the result.
+		template<typename QueryIterator>
+		unsigned int nearestNNeighbours( QueryIterator queryFirst, QueryIterator queryLast, unsigned int numNeighbours, std::vector<Neighbour> &nearNeighbours ) const;
+
 		/// Finds all the points contained by the specified bound, outputting them to the specified iterator.
 		/// \threading May be called by multiple concurrent threads.
 		template<typename Box, typename OutputIterator>
@@ -128,10 +157,27 @@ class KDTree
 		typedef typename Permutation::const_iterator PermutationConstIterator;
 
 		class AxisSort;
+		class BuildTask;
+		template<typename QueryIterator>
+		class NearestNeighbourBody;
+		template<typename QueryIterator>
+		class NearestNeighboursBody;
+		template<typename QueryIterator>
+		class NearestNNeighboursBody;
 
 		unsigned char majorAxis( PermutationConstIterator permFirst, PermutationConstIterator permLast );
+		NodeIndex numNodesRequired( NodeIndex nodeIndex, typename Permutation::difference_type numPoints ) const;
+		PermutationIterator makeBranch( NodeIndex nodeIndex, PermutationIterator permFirst, PermutationIterator permLast );
 		void build( NodeIndex nodeIndex, PermutationIterator permFirst, PermutationIterator permLast );
 
+		/// Returns the point referenced by an element of the permutation held by a leaf.
+		inline const Point &leafPoint( const PointIterator *perm ) const;
+
+		/// Fills order with the indices of the queries, sorted by the position within the
+		/// permutation of the leaf containing each query.
+		template<typename QueryIterator>
+		void sortQueries( QueryIterator queryFirst, QueryIterator queryLast, std::vector<size_t> &order ) const;
+
 		void nearestNeighbourWalk( NodeIndex nodeIndex, const Point &p, PointIterator &closestPoint, BaseType &distSquared ) const;
 
 		void nearestNeighboursWalk( NodeIndex nodeIndex, const Point &p, BaseType r2, std::vector<PointIterator> &nearNeighbours ) const;
@@ -145,6 +191,9 @@ class KDTree
 		NodeVector m_nodes;
 		int m_maxLeafSize;
 		PointIterator m_lastPoint;
+		/// Copies of the points in permutation order, used when
+		/// contiguousLeaves is passed to init().
+		std::vector<Point> m_leafPoints;
 
 };
 
@@ -33,6 +33,12 @@
 //////////////////////////////////////////////////////////////////////////
 
 #include <algorithm>
+
+#include "tbb/task.h"
+#include "tbb/parallel_for.h"
+#include "tbb/parallel_sort.h"
+#include "tbb/blocked_range.h"
+
 #include "OpenEXR/ImathLimits.h"
 #include "IECore/VectorOps.h"
 #include "IECore/BoxOps.h"
@@ -108,6 +114,50 @@ class KDTree<PointIterator>::AxisSort
 		const unsigned int m_axis;
 };
 
+/// Builds a subtree, splitting the work into child tasks while
+/// the subtree is large enough to make that worthwhile.
+template<class PointIterator>
+class KDTree<PointIterator>::BuildTask : public tbb::task
+{
+	public :
+
+		BuildTask( KDTree *tree, NodeIndex nodeIndex, PermutationIterator permFirst, PermutationIterator permLast )
+			:	m_tree( tree ), m_nodeIndex( nodeIndex ), m_permFirst( permFirst ), m_permLast( permLast )
+		{
+		}
+
+		virtual tbb::task *execute()
+		{
+			// below this size the overhead of spawning tasks outweighs the benefits
+			static const int parallelThreshold = 10000;
+
+			if( m_permLast - m_permFirst <= std::max( parallelThreshold, m_tree->m_maxLeafSize ) )
+			{
+				m_tree->build( m_nodeIndex, m_permFirst, m_permLast );
+				return 0;
+			}
+
+			PermutationIterator permMid = m_tree->makeBranch( m_nodeIndex, m_permFirst, m_permLast );
+
+			set_ref_count( 3 );
+
+			tbb::task_list children;
+			children.push_back( *new( allocate_child() ) BuildTask( m_tree, m_tree->lowChildIndex( m_nodeIndex ), m_permFirst, permMid ) );
+			children.push_back( *new( allocate_child() ) BuildTask( m_tree, m_tree->highChildIndex( m_nodeIndex ), permMid, m_permLast ) );
+
+			spawn_and_wait_for_all( children );
+			return 0;
+		}
+
+	private :
+
+		KDTree *m_tree;
+		NodeIndex m_nodeIndex;
+		PermutationIterator m_permFirst;
+		PermutationIterator m_permLast;
+
+};
+
 // initialisation
 
 template<class PointIterator>
@@ -116,13 +166,13 @@ KDTree<PointIterator>::KDTree()
 }
 
 template<class PointIterator>
-KDTree<PointIterator>::KDTree( PointIterator first, PointIterator last, int maxLeafSize )
+KDTree<PointIterator>::KDTree( PointIterator first, PointIterator last, int maxLeafSize, bool contiguousLeaves )
 {
-	init( first, last, maxLeafSize );
+	init( first, last, maxLeafSize, contiguousLeaves );
 }
 
 template<class PointIterator>
-void KDTree<PointIterator>::init( PointIterator first, PointIterator last, int maxLeafSize  )
+void KDTree<PointIterator>::init( PointIterator first, PointIterator last, int maxLeafSize, bool contiguousLeaves )
 {
 	m_maxLeafSize = maxLeafSize;
 	m_lastPoint = last;
@@ -133,8 +183,38 @@ void KDTree<PointIterator>::init( PointIterator first, PointIterator last, int m
 		m_perm[i++] = it;
 	}
 
-	/// \todo Can we reserve() enough space for m_nodes before doing this?
-	build( rootIndex(), m_perm.begin(), m_perm.end() );
+	// the shape of the tree only depends on the number of points, so we can
+	// allocate all the nodes up front and then fill them in from parallel tasks.
+	m_nodes.clear();
+	m_nodes.resize( numNodesRequired( rootIndex(), m_perm.size() ) );
+
+	BuildTask *task = new( tbb::task::allocate_root() ) BuildTask( this, rootIndex(), m_perm.begin(), m_perm.end() );
+	tbb::task::spawn_root_and_wait( *task );
+
+	m_leafPoints.clear();
+	if( contiguousLeaves )
+	{
+		m_leafPoints.reserve( m_perm.size() );
+		for( PermutationConstIterator it=m_perm.begin(); it!=m_perm.end(); it++ )
+		{
+			m_leafPoints.push_back( **it );
+		}
+	}
+}
+
+template<class PointIterator>
+typename KDTree<PointIterator>::NodeIndex KDTree<PointIterator>::numNodesRequired( NodeIndex nodeIndex, typename Permutation::difference_type numPoints ) const
+{
+	if( numPoints > m_maxLeafSize )
+	{
+		// must match the split made in makeBranch()
+		typename Permutation::difference_type numLowPoints = numPoints / 2;
+		return std::max(
+			numNodesRequired( lowChildIndex( nodeIndex ), numLowPoints ),
+			numNodesRequired( highChildIndex( nodeIndex ), numPoints - numLowPoints )
+		);
+	}
+	return nodeIndex + 1;
 }
 
 template<class PointIterator>
@@ -172,33 +252,93 @@ unsigned char KDTree<PointIterator>::majorAxis( PermutationConstIterator permFir
 }
 
 template<class PointIterator>
-void KDTree<PointIterator>::build( NodeIndex nodeIndex, PermutationIterator permFirst, PermutationIterator permLast )
+typename KDTree<PointIterator>::PermutationIterator KDTree<PointIterator>::makeBranch( NodeIndex nodeIndex, PermutationIterator permFirst, PermutationIterator permLast )
 {
-	// make room for the new node
-	if( nodeIndex>=m_nodes.size() )
-	{
-		m_nodes.resize( nodeIndex+1 );
-	}
+	assert( nodeIndex < m_nodes.size() );
+
+	unsigned int cutAxis = majorAxis( permFirst, permLast );
+	PermutationIterator permMid = permFirst  + (permLast - permFirst)/2;
+	std::nth_element( permFirst, permMid, permLast, AxisSort( cutAxis ) );
+	BaseType cutValue = (**permMid)[cutAxis];
+	// insert node
+	m_nodes[nodeIndex].makeBranch( cutAxis, cutValue );
+
+	return permMid;
+}
 
+template<class PointIterator>
+void KDTree<PointIterator>::build( NodeIndex nodeIndex, PermutationIterator permFirst, PermutationIterator permLast )
+{
 	if( permLast - permFirst > m_maxLeafSize )
 	{
-		unsigned int cutAxis = majorAxis( permFirst, permLast );
-		PermutationIterator permMid = permFirst  + (permLast - permFirst)/2;
-		std::nth_element( permFirst, permMid, permLast, AxisSort( cutAxis ) );
-		BaseType cutValue = (**permMid)[cutAxis];
-		// insert node
-		m_nodes[nodeIndex].makeBranch( cutAxis, cutValue );
-
+		PermutationIterator permMid = makeBranch( nodeIndex, permFirst, permLast );
 		build( lowChildIndex( nodeIndex ), permFirst, permMid );
 		build( highChildIndex( nodeIndex ), permMid, permLast );
 	}
 	else
 	{
 		// leaf node
+		assert( nodeIndex < m_nodes.size() );
 		m_nodes[nodeIndex].makeLeaf( permFirst, permLast );
 	}
 }
 
+template<class PointIterator>
+inline const typename KDTree<PointIterator>::Point &KDTree<PointIterator>::leafPoint( const PointIterator *perm ) const
+{
+	if( m_leafPoints.size() )
+	{
+		return m_leafPoints[perm - &(m_perm[0])];
+	}
+	return **perm;
+}
+
+template<class PointIterator>
+template<typename QueryIterator>
+void KDTree<PointIterator>::sortQueries( QueryIterator queryFirst, QueryIterator queryLast, std::vector<size_t> &order ) const
+{
+	const size_t numQueries = queryLast - queryFirst;
+	order.resize( numQueries );
+	if( m_perm.empty() )
+	{
+		for( size_t i = 0; i < numQueries; ++i )
+		{
+			order[i] = i;
+		}
+		return;
+	}
+
+	// key each query by the offset of the leaf it falls in, so that sorting
+	// on the key places queries in the same or neighbouring leaves together.
+	std::vector<std::pair<size_t, size_t> > keys( numQueries );
+	const PointIterator *permBegin = &(m_perm[0]);
+	for( size_t i = 0; i < numQueries; ++i )
+	{
+		const Point &p = *( queryFirst + i );
+		NodeIndex nodeIndex = rootIndex();
+		while( !m_nodes[nodeIndex].isLeaf() )
+		{
+			const Node &node = m_nodes[nodeIndex];
+			if( p[node.cutAxis()] - node.cutValue() > 0.0 )
+			{
+				nodeIndex = highChildIndex( nodeIndex );
+			}
+			else
+			{
+				nodeIndex = lowChildIndex( nodeIndex );
+			}
+		}
+		keys[i] = std::pair<size_t, size_t>( m_nodes[nodeIndex].permFirst() - permBegin, i );
+	}
+
+	tbb::parallel_sort( keys.begin(), keys.end() );
+
+	for( size_t i = 0; i < numQueries; ++i )
+	{
+		order[i] = keys[i].second;
+	}
+}
+
 // nearest neighbour searching
 
 template<class PointIterator>
@@ -250,6 +390,146 @@ unsigned int KDTree<PointIterator>::nearestNNeighbours( const Point &p, unsigned
 	return nearNeighbours.size();
 }
 
+// batch nearest neighbour searching
+
+template<class PointIterator>
+template<typename QueryIterator>
+class KDTree<PointIterator>::NearestNeighbourBody
+{
+	public :
+
+		NearestNeighbourBody( const KDTree *tree, QueryIterator queryFirst, const std::vector<size_t> &order, std::vector<PointIterator> &nearestNeighbours )
+			:	m_tree( tree ), m_queryFirst( queryFirst ), m_order( order ), m_nearestNeighbours( nearestNeighbours )
+		{
+		}
+
+		void operator()( const tbb::blocked_range<size_t> &range ) const
+		{
+			for( size_t i = range.begin(); i != range.end(); ++i )
+			{
+				const size_t q = m_order[i];
+				m_nearestNeighbours[q] = m_tree->nearestNeighbour( *( m_queryFirst + q ) );
+			}
+		}
+
+	private :
+
+		const KDTree *m_tree;
+		QueryIterator m_queryFirst;
+		const std::vector<size_t> &m_order;
+		std::vector<PointIterator> &m_nearestNeighbours;
+
+};
+
+template<class PointIterator>
+template<typename QueryIterator>
+class KDTree<PointIterator>::NearestNeighboursBody
+{
+	public :
+
+		NearestNeighboursBody( const KDTree *tree, QueryIterator queryFirst, BaseType r, const std::vector<size_t> &order, std::vector<std::vector<PointIterator> > &nearNeighbours )
+			:	m_tree( tree ), m_queryFirst( queryFirst ), m_r( r ), m_order( order ), m_nearNeighbours( nearNeighbours )
+		{
+		}
+
+		void operator()( const tbb::blocked_range<size_t> &range ) const
+		{
+			for( size_t i = range.begin(); i != range.end(); ++i )
+			{
+				const size_t q = m_order[i];
+				m_tree->nearestNeighbours( *( m_queryFirst + q ), m_r, m_nearNeighbours[q] );
+			}
+		}
+
+	private :
+
+		const KDTree *m_tree;
+		QueryIterator m_queryFirst;
+		BaseType m_r;
+		const std::vector<size_t> &m_order;
+		std::vector<std::vector<PointIterator> > &m_nearNeighbours;
+
+};
+
+template<class PointIterator>
+template<typename QueryIterator>
+class KDTree<PointIterator>::NearestNNeighboursBody
+{
+	public :
+
+		NearestNNeighboursBody( const KDTree *tree, QueryIterator queryFirst, unsigned int numNeighbours, const std::vector<size_t> &order, std::vector<Neighbour> &nearNeighbours )
+			:	m_tree( tree ), m_queryFirst( queryFirst ), m_numNeighbours( numNeighbours ), m_order( order ), m_nearNeighbours( nearNeighbours )
+		{
+		}
+
+		void operator()( const tbb::blocked_range<size_t> &range ) const
+		{
+			// reuse the same heap for every query in the range
+			std::vector<Neighbour> neighbours;
+			neighbours.reserve( m_numNeighbours );
+			for( size_t i = range.begin(); i != range.end(); ++i )
+			{
+				const size_t q = m_order[i];
+				m_tree->nearestNNeighbours( *( m_queryFirst + q ), m_numNeighbours, neighbours );
+				assert( neighbours.size() == m_numNeighbours );
+				std::copy( neighbours.begin(), neighbours.end(), m_nearNeighbours.begin() + q * m_numNeighbours );
+			}
+		}
+
+	private :
+
+		const KDTree *m_tree;
+		QueryIterator m_queryFirst;
+		unsigned int m_numNeighbours;
+		const std::vector<size_t> &m_order;
+		std::vector<Neighbour> &m_nearNeighbours;
+
+};
+
+template<class PointIterator>
+template<typename QueryIterator>
+void KDTree<PointIterator>::nearestNeighbour( QueryIterator queryFirst, QueryIterator queryLast, std::vector<PointIterator> &nearestNeighbours ) const
+{
+	std::vector<size_t> order;
+	sortQueries( queryFirst, queryLast, order );
+
+	nearestNeighbours.resize( order.size() );
+	NearestNeighbourBody<QueryIterator> body( this, queryFirst, order, nearestNeighbours );
+	tbb::parallel_for( tbb::blocked_range<size_t>( 0, order.size(), 64 ), body );
+}
+
+template<class PointIterator>
+template<typename QueryIterator>
+void KDTree<PointIterator>::nearestNeighbours( QueryIterator queryFirst, QueryIterator queryLast, BaseType r, std::vector<std::vector<PointIterator> > &nearNeighbours ) const
+{
+	std::vector<size_t> order;
+	sortQueries( queryFirst, queryLast, order );
+
+	nearNeighbours.resize( order.size() );
+	NearestNeighboursBody<QueryIterator> body( this, queryFirst, r, order, nearNeighbours );
+	tbb::parallel_for( tbb::blocked_range<size_t>( 0, order.size(), 64 ), body );
+}
+
+template<class PointIterator>
+template<typename QueryIterator>
+unsigned int KDTree<PointIterator>::nearestNNeighbours( QueryIterator queryFirst, QueryIterator queryLast, unsigned int numNeighbours, std::vector<Neighbour> &nearNeighbours ) const
+{
+	numNeighbours = std::min( numNeighbours, (unsigned int)m_perm.size() );
+
+	std::vector<size_t> order;
+	sortQueries( queryFirst, queryLast, order );
+
+	nearNeighbours.clear();
+	nearNeighbours.resize( order.size() * numNeighbours, Neighbour( m_lastPoint, 0 ) );
+	if( numNeighbours )
+	{
+		NearestNNeighboursBody<QueryIterator> body( this, queryFirst, numNeighbours, order, nearNeighbours );
+		tbb::parallel_for( tbb::blocked_range<size_t>( 0, order.size(), 64 ), body );
+	}
+
+	return numNeighbours;
+}
+
 template<class PointIterator>
 void KDTree<PointIterator>::nearestNeighbourWalk( NodeIndex nodeIndex, const Point &p, PointIterator &closestPoint, BaseType &distSquared ) const
 {
@@ -259,7 +539,7 @@ void KDTree<PointIterator>::nearestNeighbourWalk( NodeIndex nodeIndex, const Poi
 		PointIterator *permLast = node.permLast();
 		for( PointIterator *perm = node.permFirst(); perm!=permLast; perm++ )
 		{
-			const Point &pp = **perm;
+			const Point &pp = leafPoint( perm );
 			BaseType dist2 = vecDistance2( p, pp );
 
 			if( dist2 < distSquared )
@@ -302,7 +582,7 @@ void KDTree<PointIterator>::nearestNeighboursWalk( NodeIndex nodeIndex, const Po
 		PointIterator *permLast = node.permLast();
 		for( PointIterator *perm = node.permFirst(); perm!=permLast; perm++ )
 		{
-			const Point &pp = **perm;
+			const Point &pp = leafPoint( perm );
 			BaseType dist2 = vecDistance2( p, pp );
 
 			if (dist2 < r2 )
@@ -344,7 +624,7 @@ void KDTree<PointIterator>::nearestNNeighboursWalk( NodeIndex nodeIndex, const P
 		PointIterator *permLast = node.permLast();
 		for( PointIterator *perm = node.permFirst(); perm!=permLast; perm++ )
 		{
-			const Point &pp = **perm;
+			const Point &pp = leafPoint( perm );
 			BaseType dist2 = vecDistance2( p, pp );
 
 			if( dist2 < maxDistSquared || nearNeighbours.size() < numNeighbours )
@@ -408,7 +688,7 @@ void KDTree<PointIterator>::enclosedPointsWalk( NodeIndex nodeIndex, const Box &
 		PointIterator *permLast = node.permLast();
 		for( PointIterator *perm = node.permFirst(); perm!=permLast; perm++ )
 		{
-			const Point &pp = **perm;
+			const Point &pp = leafPoint( perm );
 			if( boxIntersects( bound, pp ) )
 			{
 				*it++ = *perm;
@@ -92,6 +92,13 @@ class LRUCache : private boost::noncopyable
 		/// computed.
 		Ptr get( const Key &key );
 
+		/// Computes the item and stores it in the cache if it isn't held already, as for get(),
+		/// but doesn't throw if the item can not be computed. Failures are not remembered either,
+		/// so a subsequent get() will try again and throw the error itself. This makes it suitable
+		/// for speculatively loading items in the background. Returns false if the item couldn't
+		/// be computed.
+		bool prefetch( const Key &key );
+
 		/// Registers an object in the cache directly. Returns true for success and false on failure -
 		/// failure can occur if the cost exceeds the maximum cost for the cache.
 		bool set( const Key &key, const Ptr &data, Cost cost );
@@ -129,6 +136,10 @@ class LRUCache : private boost::noncopyable
 		typedef std::map<Key, CacheEntry> Cache;
 		typedef typename std::map<Key, CacheEntry>::const_iterator ConstCacheIterator;
 
+		/// Implements get() and prefetch(). When recordFailure is false, an entry for which the
+		/// getter throws is returned to its previous state rather than being marked as Failed.
+		Ptr get( const Key &key, bool recordFailure );
+
 		/// Clear out any data with a least-recently-used strategy until the current cost does not exceed the specified cost.
 		void limitCost( Cost cost );
 
@@ -138,6 +138,26 @@ bool LRUCache<Key, Ptr>::cached( const Key &key ) const
 
 template<typename Key, typename Ptr>
 Ptr LRUCache<Key, Ptr>::get( const Key& key )
+{
+	return get( key, true );
+}
+
+template<typename Key, typename Ptr>
+bool LRUCache<Key, Ptr>::prefetch( const Key& key )
+{
+	try
+	{
+		get( key, false );
+	}
+	catch( ... )
+	{
+		return false;
+	}
+	return true;
+}
+
+template<typename Key, typename Ptr>
+Ptr LRUCache<Key, Ptr>::get( const Key& key, bool recordFailure )
 {
 	Mutex::scoped_lock lock( m_mutex );
 
@@ -164,6 +184,7 @@ Ptr LRUCache<Key, Ptr>::get( const Key& key )
 		assert( cacheEntry.data==Ptr() );
 		Ptr data = Ptr();
 		Cost cost = 0;
+		const Status previousStatus = cacheEntry.status;
 		try
 		{
 			cacheEntry.status = Caching;
@@ -174,7 +195,7 @@ Ptr LRUCache<Key, Ptr>::get( const Key& key )
 		catch( ... )
 		{
 			lock.acquire( m_mutex );
-			cacheEntry.status = Failed;
+			cacheEntry.status = recordFailure ? Failed : previousStatus;
 			throw;
 		}
 		assert( cacheEntry.status != Cached ); // this would indicate that another thread somehow
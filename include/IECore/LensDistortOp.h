@@ -85,6 +85,9 @@ class LensDistortOp : public IECore::WarpOp
 		Imath::Box2i m_imageDataWindow;
 		Imath::Box2i m_distortedDataWindow;
 		IECore::FloatVectorDataPtr m_cachePtr;
+
+		class CacheBuilder;
+		friend class CacheBuilder;
 };
 
 IE_CORE_DECLAREPTR( LensDistortOp );
@@ -0,0 +1,138 @@
+//////////////////////////////////////////////////////////////////////////
+//
+//  Copyright (c) 2013, Image Engine Design Inc. All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are
+//  met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//
+//     * Neither the name of Image Engine Design nor the names of any
+//       other contributors to this software may be used to endorse or
+//       promote products derived from this software without specific prior
+//       written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+//  IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+//  THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+//  PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+//  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+//  EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+//  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+//  PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+//  LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+//  NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//////////////////////////////////////////////////////////////////////////
+
+#ifndef IECORE_MESHADJACENCY_H
+#define IECORE_MESHADJACENCY_H
+
+#include <vector>
+
+#include "tbb/mutex.h"
+#include "tbb/atomic.h"
+
+#include "OpenEXR/ImathVec.h"
+
+#include "IECore/RefCounted.h"
+#include "IECore/MurmurHash.h"
+
+namespace IECore
+{
+
+IE_CORE_FORWARDDECLARE( MeshAdjacency );
+
+/// The MeshAdjacency class holds the face and vertex relationships which are
+/// implicit in the verticesPerFace and vertexIds arrays of a MeshPrimitive, in
+/// compressed sparse row form suitable for traversal by parallel loops. Instances
+/// are immutable once constructed, and are shared between all meshes with the same
+/// topology via MeshPrimitive::adjacency(), so that ops processing a deforming sequence
+/// pay for building them only once.
+/// \ingroup geometryGroup
+class MeshAdjacency : public RefCounted
+{
+
+	public :
+
+		IE_CORE_DECLAREMEMBERPTR( MeshAdjacency );
+
+		/// Builds the adjacency for the given topology. numVertices must be
+		/// greater than every entry in vertexIds.
+		MeshAdjacency( const std::vector<int> &verticesPerFace, const std::vector<int> &vertexIds, size_t numVertices );
+		virtual ~MeshAdjacency();
+
+		size_t numFaces() const;
+		size_t numVertices() const;
+
+		/// Offsets of the first face-vertex of each face into vertexIds, with
+		/// a final entry equal to vertexIds.size(). The face-vertices of face f
+		/// are therefore in the range [ faceOffsets()[f], faceOffsets()[f+1] ).
+		const std::vector<int> &faceOffsets() const;
+
+		/// Offsets into vertexFaces() and vertexFaceVertices() for each vertex,
+		/// with a final entry equal to the total number of face-vertices. The faces
+		/// using vertex v are in the range [ vertexFaceOffsets()[v], vertexFaceOffsets()[v+1] ).
+		const std::vector<int> &vertexFaceOffsets() const;
+		/// The faces using each vertex, in increasing face order. A face using a vertex
+		/// more than once appears once per use.
+		const std::vector<int> &vertexFaces() const;
+		/// The face-vertex index ( the index into vertexIds ) corresponding to each
+		/// entry in vertexFaces().
+		const std::vector<int> &vertexFaceVertices() const;
+
+		/// The unique edges of the mesh, each stored with the lower vertex id first,
+		/// sorted lexicographically. These are computed on the first call.
+		/// \threading It is safe to call this from concurrent threads.
+		const std::vector<Imath::V2i> &edges() const;
+
+		/// Returns the memory used by this object in bytes, including the
+		/// edges if they have been computed.
+		size_t memoryUsage() const;
+
+		/// Returns a shared adjacency for the given topology, building it only if
+		/// it isn't already held in the cache. Concurrent calls for the same topology
+		/// build it only once. The hash must uniquely identify the
+		/// verticesPerFace, vertexIds and numVertices arguments. Most code should
+		/// use MeshPrimitive::adjacency() rather than call this directly, but it
+		/// is also useful for sharing adjacencies for indexed facevarying data such
+		/// as uv indices.
+		/// \threading It is safe to call this from concurrent threads.
+		static ConstMeshAdjacencyPtr cached( const MurmurHash &topologyHash, const std::vector<int> &verticesPerFace, const std::vector<int> &vertexIds, size_t numVertices );
+
+		/// Sets the maximum memory used by the adjacencies shared by
+		/// MeshPrimitive::adjacency(). This initially has a limit specified
+		/// in megabytes by the IECORE_MESHADJACENCY_MEMORY environment variable,
+		/// defaulting to 500. Note that the cost of each adjacency is measured
+		/// when it is built, and so excludes any edges computed later.
+		static void setCacheMemoryLimit( size_t bytes );
+		static size_t getCacheMemoryLimit();
+		/// Returns the memory currently used by the shared adjacencies.
+		static size_t cacheMemoryUsage();
+		/// Discards all shared adjacencies.
+		static void clearCache();
+
+	private :
+
+		size_t m_numVertices;
+		std::vector<int> m_faceOffsets;
+		std::vector<int> m_vertexFaceOffsets;
+		std::vector<int> m_vertexFaces;
+		std::vector<int> m_vertexFaceVertices;
+
+		mutable tbb::mutex m_edgesMutex;
+		mutable tbb::atomic<bool> m_edgesComputed;
+		mutable std::vector<Imath::V2i> m_edges;
+
+};
+
+} // namespace IECore
+
+#endif // IECORE_MESHADJACENCY_H
@@ -42,6 +42,7 @@ namespace IECore
 {
 
 IE_CORE_FORWARDDECLARE( MeshPrimitive )
+IE_CORE_FORWARDDECLARE( MeshAdjacency )
 
 class PolygonIterator;
 
@@ -82,6 +83,11 @@ class MeshPrimitive : public Primitive
 		void setInterpolation( const std::string &interpolation );
 		PolygonIterator faceBegin();
 		PolygonIterator faceEnd();
+		/// Returns the face and vertex adjacency for the current topology. This
+		/// is shared between all meshes with identical topology, so is only built
+		/// once for a deforming sequence.
+		/// \threading It is safe to call this from concurrent threads.
+		ConstMeshAdjacencyPtr adjacency() const;
 		//@}
 
 		virtual size_t variableSize( PrimitiveVariable::Interpolation interpolation ) const;
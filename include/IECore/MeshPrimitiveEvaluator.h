@@ -42,6 +42,7 @@
 #include "IECore/PrimitiveEvaluator.h"
 #include "IECore/MeshPrimitive.h"
 #include "IECore/BoundedKDTree.h"
+#include "IECore/BoundingVolumeHierarchy.h"
 
 namespace IECore
 {
@@ -101,9 +102,21 @@ class MeshPrimitiveEvaluator : public PrimitiveEvaluator
 		};
 		IE_CORE_DECLAREPTR( Result );
 
+		/// Specifies the acceleration structure used for ray queries.
+		enum RayAccelerator
+		{
+			/// The tree returned by triangleBoundTree(), which is also used for
+			/// closest point queries.
+			KDTreeRayAccelerator,
+			/// A BoundingVolumeHierarchy built specifically for ray queries. This
+			/// is much faster for casting large numbers of rays, at the expense of
+			/// extra construction time and memory.
+			BVHRayAccelerator
+		};
+
 		static PrimitiveEvaluatorPtr create( ConstPrimitivePtr primitive );
 
-		MeshPrimitiveEvaluator( ConstMeshPrimitivePtr mesh );
+		MeshPrimitiveEvaluator( ConstMeshPrimitivePtr mesh, RayAccelerator rayAccelerator = KDTreeRayAccelerator );
 
 		virtual ~MeshPrimitiveEvaluator();
 
@@ -124,11 +137,33 @@ class MeshPrimitiveEvaluator : public PrimitiveEvaluator
 		virtual int intersectionPoints( const Imath::V3f &origin, const Imath::V3f &direction,
 			std::vector<PrimitiveEvaluator::ResultPtr> &results, float maxDistance = Imath::limits<float>::max() ) const;
 
+		/// Batch form of intersectionPoint(), finding the closest intersection for each of many rays in
+		/// parallel. The results are resized to match the number of rays, with each element being set
+		/// to a new Result for a ray which hits the mesh, and to 0 for a ray which misses. Returns the
+		/// number of rays which hit.
+		int intersectionPoints( const std::vector<Imath::V3f> &origins, const std::vector<Imath::V3f> &directions,
+			std::vector<PrimitiveEvaluator::ResultPtr> &results, float maxDistance = Imath::limits<float>::max() ) const;
+
 		/// A query specific to the MeshPrimitiveEvaluator, this just chooses a barycentric position on a specific triangle.
 		bool barycentricPosition( unsigned int triangleIndex, const Imath::V3f &barycentricCoordinates, PrimitiveEvaluator::Result *result ) const;
 
 		virtual bool signedDistance( const Imath::V3f &p, float &distance ) const;
 
+		//! @name Batch queries
+		/// These perform many queries in parallel, returning the results as arrays
+		/// rather than allocating a Result for each query.
+		//////////////////////////////////////////////////////////////////////////
+		//@{
+		/// Batch form of closestPoint(). Each output vector which is non-zero is resized to match
+		/// the number of points and filled with the corresponding property of each closest point.
+		/// Uvs are set to 0 if the mesh doesn't have them. Returns false if the mesh has no triangles.
+		bool closestPoints( const std::vector<Imath::V3f> &points, std::vector<Imath::V3f> *positions,
+			std::vector<Imath::V3f> *normals = 0, std::vector<Imath::V2f> *uvs = 0,
+			std::vector<unsigned> *triangleIndices = 0, std::vector<Imath::V3f> *barycentricCoordinates = 0 ) const;
+		/// Batch form of signedDistance(). Returns false if the mesh has no triangles.
+		bool signedDistances( const std::vector<Imath::V3f> &points, std::vector<float> &distances ) const;
+		//@}
+
 		virtual float volume() const;
 
 		virtual Imath::V3f centerOfGravity() const;
@@ -170,6 +205,9 @@ class MeshPrimitiveEvaluator : public PrimitiveEvaluator
 		/// in this tree point to the elements in the vector returned by uvBounds(). Note that
 		/// this function may return 0 in the case of the mesh not having suitable uvs.
 		const UVBoundTree *uvBoundTree() const;
+		/// Returns the hierarchy used for ray queries, or 0 if the evaluator
+		/// was constructed with KDTreeRayAccelerator.
+		const BoundingVolumeHierarchy *boundingVolumeHierarchy() const;
 		//@}
 		
 	protected:
@@ -184,10 +222,16 @@ class MeshPrimitiveEvaluator : public PrimitiveEvaluator
 		UVBoundVector m_uvTriangles;		
 		UVBoundTree *m_uvTree;
 
+		BoundingVolumeHierarchy *m_bvh;
+		class ClosestIntersector;
+		class AllIntersector;
+
 		bool pointAtUVWalk( UVBoundTree::NodeIndex nodeIndex, const Imath::V2f &targetUV, Result *result ) const;
 		void closestPointWalk( TriangleBoundTree::NodeIndex nodeIndex, const Imath::V3f &p, float &closestDistanceSqrd, Result *result ) const;
 		bool intersectionPointWalk( TriangleBoundTree::NodeIndex nodeIndex, const Imath::Line3f &ray, float &maxDistSqrd, Result *result, bool &hit ) const;
 		void intersectionPointsWalk( TriangleBoundTree::NodeIndex nodeIndex, const Imath::Line3f &ray, float maxDistSqrd, std::vector<PrimitiveEvaluator::ResultPtr> &results ) const;
+		/// Fills in the result for a point on a triangle.
+		void setResult( unsigned triangleIndex, const Imath::V3f &barycentricCoordinates, const Imath::V3f &point, Result *result ) const;
 
 		void calculateMassProperties() const;
 		void calculateAverageNormals() const;
@@ -83,14 +83,12 @@ class MeshVertexReorderOp : public MeshPrimitiveOp
 
 		typedef std::map< FaceId, EdgeList > FaceToEdgesMap;
 		typedef std::map< FaceId, VertexList > FaceToVerticesMap;
-		typedef std::map< VertexId, FaceSet > VertexToFacesMap;
 		typedef std::map< Edge, FaceList > EdgeToConnectedFacesMap;
 
 		FaceToEdgesMap m_faceToEdgesMap;
 		FaceToVerticesMap m_faceToVerticesMap;
 		EdgeToConnectedFacesMap m_edgeToConnectedFacesMap;
-		VertexToFacesMap m_vertexToFacesMap;
-		VertexList m_faceVaryingOffsets;
+		ConstMeshAdjacencyPtr m_adjacency;
 		int m_numFaces;
 		int m_numVerts;
 
@@ -48,6 +48,12 @@ namespace IECore
 /// and a parameter to disable the operation completely. It's a little
 /// bit naughty to modify it in place but it'll probably be quite handy
 /// at times.
+///
+/// Copying the input is cheap, because the copy shares the underlying
+/// data of any TypedData it contains with the original, and the data is
+/// only duplicated when modify() requests write access to it. The
+/// amount of data actually duplicated by an operation may be queried
+/// with bytesDuplicated().
 class ModifyOp : public Op
 {
 	public :
@@ -66,6 +72,12 @@ class ModifyOp : public Op
 		BoolParameter *enableParameter();
 		const BoolParameter *enableParameter() const;
 
+		/// Returns the approximate number of bytes of data which were
+		/// duplicated on the calling thread by the most recent operation,
+		/// either when copying the input or when modifying it. See
+		/// Data::bytesDuplicated().
+		size_t bytesDuplicated() const;
+
 	protected :
 
 		/// Implemented to call modify() - implement modify rather than this.
@@ -81,6 +93,8 @@ class ModifyOp : public Op
 		BoolParameterPtr m_copyParameter;
 		BoolParameterPtr m_enableParameter;
 
+		size_t m_bytesDuplicated;
+
 };
 
 IE_CORE_DECLAREPTR( ModifyOp );
@@ -59,6 +59,11 @@ namespace IECore
 /// "All MurmurHash versions are public domain software, and the
 /// author disclaims all copyright to their code."
 ///
+/// Buffers larger than a threshold are divided into fixed size
+/// chunks which are hashed in parallel, with the chunk hashes then
+/// being hashed in order to give the final result. Because the chunk
+/// size is fixed, the result doesn't depend on the number of threads.
+///
 /// \todo Deal with endian-ness.
 class MurmurHash
 {
@@ -67,6 +72,9 @@ class MurmurHash
 
 		MurmurHash();
 		MurmurHash( const MurmurHash &other );
+		/// Constructs a hash with the internal state given by h1() and h2()
+		/// of another hash, so hashes can be stored and restored.
+		MurmurHash( uint64_t h1, uint64_t h2 );
 		
 		inline MurmurHash &append( char data );
 		inline MurmurHash &append( unsigned char data );
@@ -151,9 +159,17 @@ class MurmurHash
 		
 		std::string toString() const;
 
+		/// Returns the two halves of the internal state of the hash.
+		inline uint64_t h1() const;
+		inline uint64_t h2() const;
+
 	private :
 	
 		void append( const void *data, size_t bytes, int elementSize );
+		// Hashes the data in a single pass.
+		void appendSerial( const void *data, size_t bytes );
+		// Hashes the data as a series of chunks in parallel.
+		void appendChunked( const void *data, size_t bytes );
 	
 		uint64_t m_h1;
 		uint64_t m_h2;
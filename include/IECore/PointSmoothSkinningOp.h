@@ -69,7 +69,7 @@ class PointSmoothSkinningOp : public ModifyOp
 		typedef enum
 		{
 			Linear = 0,
-			// todo: DualQuaternion = 1
+			DualQuaternion = 1,
 			// todo: LinearDualQuaternionMix = 2
 		} Blend;
 
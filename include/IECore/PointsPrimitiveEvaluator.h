@@ -35,7 +35,7 @@
 #ifndef IECORE_POINTSPRIMITIVEEVALUATOR_H
 #define IECORE_POINTSPRIMITIVEEVALUATOR_H
 
-#include "tbb/mutex.h"
+#include "tbb/atomic.h"
 
 #include "IECore/PrimitiveEvaluator.h"
 #include "IECore/KDTree.h"
@@ -125,6 +125,17 @@ class PointsPrimitiveEvaluator : public PrimitiveEvaluator
 			std::vector<PrimitiveEvaluator::ResultPtr> &results, float maxDistance = Imath::limits<float>::max() ) const;
 		//@}
 
+		//! @name Batch Query Functions
+		/// These perform many queries in parallel, returning the results as arrays
+		/// rather than allocating a Result for each query.
+		////////////////////////////////////////////////////////////////////////////////////////
+		//@{
+		/// Batch form of closestPoint(). Each output vector which is non-zero is resized to match
+		/// the number of points and filled with the position or index of each closest point.
+		/// Returns false if there are no points.
+		bool closestPoints( const std::vector<Imath::V3f> &points, std::vector<Imath::V3f> *positions, std::vector<size_t> *pointIndices = 0 ) const;
+		//@}
+
 	protected :
 		
 		/// \todo It would be much better if PrimitiveEvaluator::Description didn't require these create()
@@ -142,11 +153,9 @@ class PointsPrimitiveEvaluator : public PrimitiveEvaluator
 		PrimitiveVariable m_p;
 		const std::vector<Imath::V3f> *m_pVector;
 		
-		void buildTree();
-		bool m_haveTree;
-		typedef tbb::mutex TreeMutex;
-		TreeMutex m_treeMutex;
-		V3fTree m_tree;		
+		void buildTree() const;
+		// built on demand and published atomically - see buildTree().
+		mutable tbb::atomic<V3fTree *> m_tree;
 		
 };
 
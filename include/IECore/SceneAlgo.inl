@@ -0,0 +1,113 @@
+//////////////////////////////////////////////////////////////////////////
+//
+//  Copyright (c) 2013, Image Engine Design Inc. All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are
+//  met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//
+//     * Neither the name of Image Engine Design nor the names of any
+//       other contributors to this software may be used to endorse or
+//       promote products derived from this software without specific prior
+//       written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+//  IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+//  THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+//  PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+//  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+//  EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+//  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+//  PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+//  LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+//  NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//////////////////////////////////////////////////////////////////////////
+
+#ifndef IECORE_SCENEALGO_INL
+#define IECORE_SCENEALGO_INL
+
+#include <vector>
+
+#include "tbb/task.h"
+
+namespace IECore
+{
+
+namespace Detail
+{
+
+template<typename ThreadableFunctor>
+class LocationTask : public tbb::task
+{
+
+	public :
+
+		LocationTask( ConstSceneInterfacePtr location, const ThreadableFunctor &f, double time )
+			:	m_location( location ), m_f( f ), m_time( time )
+		{
+		}
+
+		virtual tbb::task *execute()
+		{
+			if( !m_f( m_location.get(), m_time ) )
+			{
+				return 0;
+			}
+
+			SceneInterface::NameList childNames;
+			m_location->childNames( childNames );
+			if( childNames.empty() )
+			{
+				return 0;
+			}
+
+			// get all the children before allocating any tasks, so that
+			// if child() throws we don't leave allocated tasks behind.
+			std::vector<ConstSceneInterfacePtr> childLocations;
+			childLocations.reserve( childNames.size() );
+			for( SceneInterface::NameList::const_iterator it = childNames.begin(); it != childNames.end(); ++it )
+			{
+				childLocations.push_back( m_location->child( *it ) );
+			}
+
+			set_ref_count( childLocations.size() + 1 );
+
+			tbb::task_list children;
+			for( std::vector<ConstSceneInterfacePtr>::const_iterator it = childLocations.begin(); it != childLocations.end(); ++it )
+			{
+				children.push_back( *new( allocate_child() ) LocationTask( *it, m_f, m_time ) );
+			}
+
+			spawn_and_wait_for_all( children );
+			return 0;
+		}
+
+	private :
+
+		ConstSceneInterfacePtr m_location;
+		ThreadableFunctor m_f;
+		double m_time;
+
+};
+
+} // namespace Detail
+
+template<typename ThreadableFunctor>
+void parallelProcessLocations( const SceneInterface *scene, const ThreadableFunctor &f, double time )
+{
+	Detail::LocationTask<ThreadableFunctor> *task = new( tbb::task::allocate_root() ) Detail::LocationTask<ThreadableFunctor>( scene, f, time );
+	tbb::task::spawn_root_and_wait( *task );
+}
+
+} // namespace IECore
+
+#endif // IECORE_SCENEALGO_INL
@@ -36,10 +36,19 @@
 #define IECORE_SCENECACHE_H
 
 #include "IECore/SampledSceneInterface.h"
+#include "IECore/CompoundData.h"
 
 namespace IECore
 {
 
+/// \addtogroup environmentGroup
+///
+/// <b>IECORE_SCENECACHE_OBJECT_MEMORY</b><br>
+/// <b>IECORE_SCENECACHE_ATTRIBUTE_MEMORY</b><br>
+/// <b>IECORE_SCENECACHE_TRANSFORM_MEMORY</b><br>
+/// Used to specify in megabytes the memory limits of the caches used by
+/// SceneCache readers. See SceneCache::setCacheMemoryLimit() for more information.
+
 IE_CORE_FORWARDDECLARE( SceneCache );
 
 /// A simple means of saving and loading hierarchical descriptions of animated scene, with
@@ -113,6 +122,10 @@ class SceneCache : public SampledSceneInterface
 		virtual bool hasTag( const Name &name, bool includeChildren = true ) const;
 		virtual void readTags( NameList &tags, bool includeChildren = true ) const;
 		virtual void writeTags( const NameList &tags );
+		/// Files written by this version of SceneCache store an index of the locations holding
+		/// each local tag, so the query doesn't need to visit the locations. Files written
+		/// before that use the default implementation.
+		virtual void taggedLocations( const Name &name, std::vector<Path> &paths ) const;
 
 		virtual bool hasObject() const;
 		virtual size_t numObjectSamples() const;
@@ -130,12 +143,57 @@ class SceneCache : public SampledSceneInterface
 		virtual SceneInterfacePtr createChild( const Name &name );
 		virtual SceneInterfacePtr scene( const Path &path, MissingBehaviour missingBehaviour = ThrowIfMissing );
 		virtual ConstSceneInterfacePtr scene( const Path &path, SceneInterface::MissingBehaviour missingBehaviour = ThrowIfMissing ) const;
+
+		/// Files written by this version of SceneCache store the hashes of every object, transform
+		/// and attribute sample, so those hashes are returned without loading the data. Files
+		/// written before that fall back to loading and hashing the samples.
+		virtual void hash( HashType hashType, double time, MurmurHash &h ) const;
 		
 		// The attribute names used to mark animated topology and primitive variables
 		// when SceneCache objects are Primitives.
 		static const Name &animatedObjectTopologyAttribute;
 		static const Name &animatedObjectPrimVarsAttribute;
 
+		/// Types of the caches held by each file opened for reading.
+		enum CacheType
+		{
+			Objects = 0,
+			Attributes,
+			Transforms
+		};
+
+		/// Sets the memory limit in bytes for the caches of the given type. Each file
+		/// opened for reading after this call holds caches limited to that size, where
+		/// each cached result costs its Object::memoryUsage(). The initial limits are specified
+		/// in megabytes by the IECORE_SCENECACHE_OBJECT_MEMORY, IECORE_SCENECACHE_ATTRIBUTE_MEMORY
+		/// and IECORE_SCENECACHE_TRANSFORM_MEMORY environment variables, with the object
+		/// limit defaulting to the limit of the default ObjectPool and the others to 50 megabytes.
+		/// Because the cached objects are held by the default ObjectPool, the limits are
+		/// never allowed to exceed its own limit.
+		static void setCacheMemoryLimit( CacheType cacheType, size_t bytes );
+		static size_t getCacheMemoryLimit( CacheType cacheType );
+
+		/// Returns statistics for the cache of the given type used by the file this location
+		/// belongs to, as UInt64Data members named "hits", "misses", "evictions", "memoryUsage"
+		/// and "memoryLimit". Only available when reading.
+		CompoundDataPtr cacheStatistics( CacheType cacheType ) const;
+
+		/// Enables or disables asynchronous writing for the whole file. By default the write
+		/// methods save their data before returning. When asynchronous writing is enabled they
+		/// instead queue a copy of the data and return immediately, and a background thread
+		/// hashes and saves the queued data in the order it was written. The copy is cheap, since
+		/// TypedData shares its contents with the original until either is modified. The queue
+		/// holds at most maxQueueMemory bytes, as measured by Object::memoryUsage(), and the
+		/// write methods block when it is full. Queries on the file being written wait for
+		/// the queue to be written first. Only available when writing.
+		void setAsynchronousWrites( bool enabled, size_t maxQueueMemory = 512 * 1024 * 1024 );
+		bool getAsynchronousWrites() const;
+		/// Waits until all queued writes have completed, throwing an Exception if any of
+		/// them failed. Does nothing when asynchronous writing isn't enabled. Destruction of
+		/// the root location also waits for the queue, so calling this is only necessary
+		/// to be notified of errors. Only available when writing.
+		void flush();
+
 	protected:
 	
 		IE_CORE_FORWARDDECLARE( Implementation );
@@ -82,6 +82,17 @@ class SceneInterface : public RunTimeTyped
 			CreateIfMissing = IndexedIO::CreateIfMissing
 		} MissingBehaviour;
 
+		/// Specifies which data a call to hash() refers to.
+		typedef enum {
+			TransformHash = 0,
+			AttributesHash,
+			BoundHash,
+			ObjectHash,
+			ChildNamesHash,
+			/// Combines all of the above for the location and all its descendants.
+			HierarchyHash
+		} HashType;
+
 		/// Constant name assigned to the root location "/".
 		static const Name &rootName;
 		/// Utility variable that can be used anytime you want to refer to the root path in the Scene.
@@ -181,6 +192,10 @@ class SceneInterface : public RunTimeTyped
 		virtual void readTags( NameList &tags, bool includeChildren = true ) const = 0;
 		/// Adds tags to the current scene location.
 		virtual void writeTags( const NameList &tags ) = 0;
+		/// Appends to paths the full paths of this location and its descendants which have the
+		/// given tag written locally (see hasTag()). The default implementation walks the hierarchy,
+		/// skipping the locations where hasTag( name, true ) is false.
+		virtual void taggedLocations( const Name &name, std::vector<Path> &paths ) const;
 
 		/*
 		 * Object
@@ -224,6 +239,18 @@ class SceneInterface : public RunTimeTyped
 		/// Returns a const interface for querying the scene at the given path (full path). 
 		virtual ConstSceneInterfacePtr scene( const Path &path, MissingBehaviour missingBehaviour = ThrowIfMissing ) const = 0;
 
+		/*
+		 * Hashing
+		 */
+
+		/// Appends to h a hash of the data at this location at the given time, so that
+		/// callers can tell if the data has changed without loading it. For object and transform
+		/// the appended hash is Object::hash() of the data read at a sample time, which
+		/// relates it to the keys used by caches such as the ObjectPool. The default
+		/// implementation reads the data and hashes it, derived classes should override it
+		/// when the hashes are cheaper to obtain than the data itself.
+		virtual void hash( HashType hashType, double time, MurmurHash &h ) const;
+
 		/*
 		 * Utility functions
 		 */
@@ -0,0 +1,190 @@
+//////////////////////////////////////////////////////////////////////////
+//
+//  Copyright (c) 2013, Image Engine Design Inc. All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are
+//  met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//
+//     * Neither the name of Image Engine Design nor the names of any
+//       other contributors to this software may be used to endorse or
+//       promote products derived from this software without specific prior
+//       written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+//  IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+//  THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+//  PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+//  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+//  EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+//  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+//  PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+//  LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+//  NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//////////////////////////////////////////////////////////////////////////
+
+#ifndef IECORE_SHARDEDLRUCACHE_H
+#define IECORE_SHARDEDLRUCACHE_H
+
+#include <map>
+#include <list>
+
+#include "tbb/spin_mutex.h"
+#include "tbb/atomic.h"
+#include "tbb/concurrent_hash_map.h"
+
+#include "boost/noncopyable.hpp"
+#include "boost/function.hpp"
+
+namespace IECore
+{
+
+/// A variant of LRUCache intended for heavily multithreaded use. The entries are distributed
+/// between a number of independently locked shards according to the hash of their key, so that
+/// concurrent get() calls only contend when they happen to address the same shard. The maximum
+/// cost applies to the cache as a whole rather than to individual shards, so costs may usefully
+/// be expressed in bytes, and the Caching/Failed semantics of LRUCache are preserved - concurrent
+/// misses for the same key result in a single call to the getter. The least-recently-used ordering
+/// is maintained per shard, and eviction visits the shards in turn, so the global eviction order is
+/// an approximation of that provided by LRUCache.
+///
+/// The Key type must be usable with HashCompare, which defaults to the tbb::tbb_hash_compare used by
+/// tbb::concurrent_hash_map.
+/// \threading It is safe to call the methods of ShardedLRUCache from concurrent threads. Note that
+/// unlike LRUCache, the RemovalCallback may be called concurrently for keys in different shards.
+/// \ingroup utilityGroup
+template<typename Key, typename Ptr, typename HashCompare = tbb::tbb_hash_compare<Key> >
+class ShardedLRUCache : private boost::noncopyable
+{
+	public:
+
+		typedef Key KeyType;
+		typedef Ptr PtrType;
+		typedef size_t Cost;
+
+		/// The GetterFunction is responsible for computing the value and cost for a cache entry
+		/// when given the key. It should throw a descriptive exception if it can't get the data for
+		/// any reason.
+		typedef boost::function<Ptr ( const Key &key, Cost &cost )> GetterFunction;
+		/// The optional RemovalCallback is called whenever an item is discarded from the cache.
+		typedef boost::function<void ( const Key &key, const Ptr &data )> RemovalCallback;
+
+		ShardedLRUCache( GetterFunction getter );
+		ShardedLRUCache( GetterFunction getter, Cost maxCost );
+		ShardedLRUCache( GetterFunction getter, RemovalCallback removalCallback, Cost maxCost );
+		virtual ~ShardedLRUCache();
+
+		void clear();
+
+		// Erases the given key if it is contained in the cache. Returns whether any item was removed.
+		bool erase( const Key &key );
+
+		/// Set the maximum cost of the items held in the cache, discarding any items if necessary.
+		void setMaxCost( Cost maxCost );
+
+		/// Get the maximum possible cost of cacheable items
+		Cost getMaxCost() const;
+
+		/// Returns the current cost of items held in the cache
+		Cost currentCost() const;
+
+		/// Retrieves the item from the cache, computing it if necessary. Throws if the item can not be
+		/// computed.
+		Ptr get( const Key &key );
+
+		/// Computes the item and stores it in the cache if it isn't held already, as for get(),
+		/// but doesn't throw if the item can not be computed. Failures are not remembered either,
+		/// so a subsequent get() will try again and throw the error itself. This makes it suitable
+		/// for speculatively loading items in the background. Returns false if the item couldn't
+		/// be computed.
+		bool prefetch( const Key &key );
+
+		/// Registers an object in the cache directly. Returns true for success and false on failure -
+		/// failure can occur if the cost exceeds the maximum cost for the cache.
+		bool set( const Key &key, const Ptr &data, Cost cost );
+
+		/// Returns true if the object is in the cache.
+		bool cached( const Key &key ) const;
+
+	protected:
+
+		typedef std::list<Key> List;
+		typedef typename std::list<Key>::iterator ListIterator;
+
+		typedef tbb::spin_mutex Mutex;
+
+		enum Status
+		{
+			New, // brand new unpopulated entry
+			Caching, // unpopulated entry which is waiting for m_getter to return
+			Cached, // entry complete with value
+			Erased, // entry once had value but removed by limitCost
+			TooCostly, // entry cost exceeds m_maxCost and therefore isn't stored
+			Failed // m_getter failed when computing entry
+		};
+
+		struct CacheEntry
+		{
+			CacheEntry();
+
+			Cost cost;
+			ListIterator listIterator;
+			Status status;
+			Ptr data;
+		};
+
+		typedef std::map<Key, CacheEntry> Cache;
+		typedef typename std::map<Key, CacheEntry>::const_iterator ConstCacheIterator;
+
+		struct Shard
+		{
+			mutable Mutex mutex;
+			List list;
+			Cache cache;
+		};
+
+		enum
+		{
+			NumShards = 32
+		};
+
+		Shard &shard( const Key &key ) const;
+
+		/// Implements get() and prefetch(). When recordFailure is false, an entry for which the
+		/// getter throws is returned to its previous state rather than being marked as Failed.
+		Ptr get( const Key &key, bool recordFailure );
+
+		/// Removes the value for the entry, if it has one. Must be called with the shard mutex held.
+		void removeValue( Shard &shard, const Key &key, CacheEntry &cacheEntry, bool callRemovalCallback );
+
+		/// Clear out data with a least-recently-used strategy until the current cost does not exceed the specified cost.
+		/// Must be called without holding any shard mutex.
+		void limitCost( Cost cost );
+
+		static void nullRemovalCallback( const Key &key, const Ptr &data );
+
+		GetterFunction m_getter;
+		RemovalCallback m_removalCallback;
+		HashCompare m_hashCompare;
+
+		tbb::atomic<Cost> m_maxCost;
+		tbb::atomic<Cost> m_currentCost;
+		tbb::atomic<size_t> m_evictionShard;
+
+		mutable Shard m_shards[NumShards];
+};
+
+} // namespace IECore
+
+#include "IECore/ShardedLRUCache.inl"
+
+#endif // IECORE_SHARDEDLRUCACHE_H
@@ -0,0 +1,333 @@
+//////////////////////////////////////////////////////////////////////////
+//
+//  Copyright (c) 2013, Image Engine Design Inc. All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are
+//  met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//
+//     * Neither the name of Image Engine Design nor the names of any
+//       other contributors to this software may be used to endorse or
+//       promote products derived from this software without specific prior
+//       written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+//  IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+//  THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+//  PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+//  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+//  EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+//  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+//  PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+//  LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+//  NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//////////////////////////////////////////////////////////////////////////
+
+#ifndef IECORE_SHARDEDLRUCACHE_INL
+#define IECORE_SHARDEDLRUCACHE_INL
+
+#include <cassert>
+
+#include "tbb/tbb_thread.h"
+
+#include "IECore/Exception.h"
+
+namespace IECore
+{
+
+template<typename Key, typename Ptr, typename HashCompare>
+ShardedLRUCache<Key, Ptr, HashCompare>::CacheEntry::CacheEntry()
+	:	cost( 0 ), status( New ), data()
+{
+}
+
+template<typename Key, typename Ptr, typename HashCompare>
+ShardedLRUCache<Key, Ptr, HashCompare>::ShardedLRUCache( GetterFunction getter )
+	:	m_getter( getter ), m_removalCallback( nullRemovalCallback )
+{
+	m_maxCost = 500;
+	m_currentCost = 0;
+	m_evictionShard = 0;
+}
+
+template<typename Key, typename Ptr, typename HashCompare>
+ShardedLRUCache<Key, Ptr, HashCompare>::ShardedLRUCache( GetterFunction getter, Cost maxCost )
+	:	m_getter( getter ), m_removalCallback( nullRemovalCallback )
+{
+	m_maxCost = maxCost;
+	m_currentCost = 0;
+	m_evictionShard = 0;
+}
+
+template<typename Key, typename Ptr, typename HashCompare>
+ShardedLRUCache<Key, Ptr, HashCompare>::ShardedLRUCache( GetterFunction getter, RemovalCallback removalCallback, Cost maxCost )
+	:	m_getter( getter ), m_removalCallback( removalCallback )
+{
+	m_maxCost = maxCost;
+	m_currentCost = 0;
+	m_evictionShard = 0;
+}
+
+template<typename Key, typename Ptr, typename HashCompare>
+ShardedLRUCache<Key, Ptr, HashCompare>::~ShardedLRUCache()
+{
+}
+
+template<typename Key, typename Ptr, typename HashCompare>
+typename ShardedLRUCache<Key, Ptr, HashCompare>::Shard &ShardedLRUCache<Key, Ptr, HashCompare>::shard( const Key &key ) const
+{
+	return m_shards[ m_hashCompare.hash( key ) % NumShards ];
+}
+
+template<typename Key, typename Ptr, typename HashCompare>
+void ShardedLRUCache<Key, Ptr, HashCompare>::clear()
+{
+	for( size_t i = 0; i < NumShards; ++i )
+	{
+		Shard &shard = m_shards[i];
+		Mutex::scoped_lock lock( shard.mutex );
+
+		// as in LRUCache, we don't remove the entries themselves, as that
+		// would invalidate references currently in use on other threads in get().
+		for( typename Cache::iterator it = shard.cache.begin(); it != shard.cache.end(); ++it )
+		{
+			removeValue( shard, it->first, it->second, true );
+			if( it->second.status != Caching )
+			{
+				it->second.status = Erased;
+			}
+		}
+	}
+}
+
+template<typename Key, typename Ptr, typename HashCompare>
+void ShardedLRUCache<Key, Ptr, HashCompare>::setMaxCost( Cost maxCost )
+{
+	assert( maxCost >= Cost(0) );
+	m_maxCost = maxCost;
+	limitCost( maxCost );
+}
+
+template<typename Key, typename Ptr, typename HashCompare>
+typename ShardedLRUCache<Key, Ptr, HashCompare>::Cost ShardedLRUCache<Key, Ptr, HashCompare>::getMaxCost() const
+{
+	return m_maxCost;
+}
+
+template<typename Key, typename Ptr, typename HashCompare>
+typename ShardedLRUCache<Key, Ptr, HashCompare>::Cost ShardedLRUCache<Key, Ptr, HashCompare>::currentCost() const
+{
+	return m_currentCost;
+}
+
+template<typename Key, typename Ptr, typename HashCompare>
+bool ShardedLRUCache<Key, Ptr, HashCompare>::cached( const Key &key ) const
+{
+	const Shard &s = shard( key );
+	Mutex::scoped_lock lock( s.mutex );
+	ConstCacheIterator it = s.cache.find( key );
+	return ( it != s.cache.end() && it->second.status==Cached );
+}
+
+template<typename Key, typename Ptr, typename HashCompare>
+Ptr ShardedLRUCache<Key, Ptr, HashCompare>::get( const Key& key )
+{
+	return get( key, true );
+}
+
+template<typename Key, typename Ptr, typename HashCompare>
+bool ShardedLRUCache<Key, Ptr, HashCompare>::prefetch( const Key& key )
+{
+	try
+	{
+		get( key, false );
+	}
+	catch( ... )
+	{
+		return false;
+	}
+	return true;
+}
+
+template<typename Key, typename Ptr, typename HashCompare>
+Ptr ShardedLRUCache<Key, Ptr, HashCompare>::get( const Key& key, bool recordFailure )
+{
+	Shard &s = shard( key );
+	Mutex::scoped_lock lock( s.mutex );
+
+	CacheEntry &cacheEntry = s.cache[key]; // creates an entry if one doesn't exist yet
+
+	while( cacheEntry.status==Caching )
+	{
+		// another thread is doing the work. we need to wait
+		// until it is done.
+		lock.release();
+			while( cacheEntry.status==Caching )
+			{
+				tbb::this_tbb_thread::yield();
+			}
+		lock.acquire( s.mutex );
+	}
+
+	if( cacheEntry.status==New || cacheEntry.status==Erased || cacheEntry.status==TooCostly )
+	{
+		assert( cacheEntry.data==Ptr() );
+		Ptr data = Ptr();
+		Cost cost = 0;
+		const Status previousStatus = cacheEntry.status;
+		try
+		{
+			cacheEntry.status = Caching;
+			lock.release(); // allows other threads to do stuff while we're computing the value
+				data = m_getter( key, cost );
+		}
+		catch( ... )
+		{
+			lock.acquire( s.mutex );
+			cacheEntry.status = recordFailure ? Failed : previousStatus;
+			throw;
+		}
+		// we must not hold the lock when calling set(), because it may need
+		// to evict entries from other shards.
+		set( key, data, cost );
+		return data;
+	}
+	else if( cacheEntry.status==Cached )
+	{
+		// move the entry to the front of the list
+		s.list.splice( s.list.begin(), s.list, cacheEntry.listIterator );
+		return cacheEntry.data;
+	}
+	else
+	{
+		assert( cacheEntry.status==Failed );
+		throw Exception( "Previous attempt to get item failed." );
+	}
+}
+
+template<typename Key, typename Ptr, typename HashCompare>
+bool ShardedLRUCache<Key, Ptr, HashCompare>::set( const Key &key, const Ptr &data, Cost cost )
+{
+	Shard &s = shard( key );
+
+	// m_maxCost may be changed concurrently by setMaxCost(), so we read it
+	// once to make sure the subtraction below can't underflow.
+	const Cost maxCost = m_maxCost;
+
+	{
+		Mutex::scoped_lock lock( s.mutex );
+		CacheEntry &cacheEntry = s.cache[key]; // creates an entry if one doesn't exist yet
+		removeValue( s, key, cacheEntry, false );
+		if( cost > maxCost )
+		{
+			cacheEntry.status = TooCostly;
+			return false;
+		}
+	}
+
+	// make room for the new entry. we do this without holding our
+	// own lock, so that we never hold more than one shard lock at once.
+	limitCost( maxCost - cost );
+
+	Mutex::scoped_lock lock( s.mutex );
+	CacheEntry &cacheEntry = s.cache[key];
+	// another thread may have set the value while we weren't holding the lock
+	removeValue( s, key, cacheEntry, false );
+
+	cacheEntry.data = data;
+	cacheEntry.cost = cost;
+	cacheEntry.status = Cached;
+	s.list.push_front( key );
+	cacheEntry.listIterator = s.list.begin();
+
+	m_currentCost += cost;
+
+	assert( s.list.size() <= s.cache.size() );
+
+	return true;
+}
+
+template<typename Key, typename Ptr, typename HashCompare>
+void ShardedLRUCache<Key, Ptr, HashCompare>::limitCost( Cost cost )
+{
+	assert( cost >= Cost(0) );
+
+	// visit the shards in turn, removing the least recently used entry
+	// from each, until we're within budget or every shard is empty.
+	size_t emptyShards = 0;
+	while( m_currentCost > cost && emptyShards < NumShards )
+	{
+		Shard &s = m_shards[ m_evictionShard.fetch_and_increment() % NumShards ];
+		Mutex::scoped_lock lock( s.mutex );
+		if( s.list.empty() )
+		{
+			emptyShards++;
+			continue;
+		}
+		emptyShards = 0;
+
+		const Key key = s.list.back();
+		typename Cache::iterator it = s.cache.find( key );
+		assert( it != s.cache.end() );
+		removeValue( s, key, it->second, true );
+		it->second.status = Erased;
+	}
+}
+
+template<typename Key, typename Ptr, typename HashCompare>
+bool ShardedLRUCache<Key, Ptr, HashCompare>::erase( const Key &key )
+{
+	Shard &s = shard( key );
+	Mutex::scoped_lock lock( s.mutex );
+
+	typename Cache::iterator it = s.cache.find( key );
+
+	if( it == s.cache.end() )
+	{
+		return false;
+	}
+
+	removeValue( s, key, it->second, true );
+	if( it->second.status != Caching )
+	{
+		it->second.status = Erased;
+	}
+	return true;
+}
+
+template<typename Key, typename Ptr, typename HashCompare>
+void ShardedLRUCache<Key, Ptr, HashCompare>::removeValue( Shard &shard, const Key &key, CacheEntry &cacheEntry, bool callRemovalCallback )
+{
+	if( cacheEntry.status!=Cached )
+	{
+		return;
+	}
+
+	if( callRemovalCallback )
+	{
+		m_removalCallback( key, cacheEntry.data );
+	}
+	m_currentCost -= cacheEntry.cost;
+	shard.list.erase( cacheEntry.listIterator );
+	cacheEntry.data = Ptr();
+	cacheEntry.cost = 0;
+	cacheEntry.status = Erased;
+}
+
+template<typename Key, typename Ptr, typename HashCompare>
+void ShardedLRUCache<Key, Ptr, HashCompare>::nullRemovalCallback( const Key &key, const Ptr &data )
+{
+}
+
+} // namespace IECore
+
+#endif // IECORE_SHARDEDLRUCACHE_INL
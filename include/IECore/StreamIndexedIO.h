@@ -38,7 +38,9 @@
 #include <map>
 #include <iostream>
 #include <fstream>
+#include <vector>
 #include "tbb/recursive_mutex.h"
+#include "tbb/enumerable_thread_specific.h"
 #include "boost/optional.hpp"
 #include "boost/iostreams/filtering_stream.hpp"
 
@@ -50,7 +52,9 @@ namespace IECore
 {
 /// Abstract base class implementation of IndexedIO which operates with a stream file handle.
 /// It handles data instancing transparently for compact file sizes.
-/// Read operations are thread safe on read-only opened files.
+/// Read operations are thread safe on read-only opened files, and data reads
+/// from multiple threads can run concurrently when the StreamFile supports
+/// positional reads (see StreamFile::readAt()).
 /// \ingroup ioGroup
 class StreamIndexedIO : public IndexedIO
 {
@@ -120,6 +124,19 @@ class StreamIndexedIO : public IndexedIO
 		void write(const IndexedIO::EntryID &name, const short &x);
 		void write(const IndexedIO::EntryID &name, const unsigned short &x);
 
+		void write(const IndexedIO::EntryID &name, const float *x, unsigned long arrayLength, const MurmurHash &hash);
+		void write(const IndexedIO::EntryID &name, const double *x, unsigned long arrayLength, const MurmurHash &hash);
+		void write(const IndexedIO::EntryID &name, const half *x, unsigned long arrayLength, const MurmurHash &hash);
+		void write(const IndexedIO::EntryID &name, const int *x, unsigned long arrayLength, const MurmurHash &hash);
+		void write(const IndexedIO::EntryID &name, const int64_t *x, unsigned long arrayLength, const MurmurHash &hash);
+		void write(const IndexedIO::EntryID &name, const uint64_t *x, unsigned long arrayLength, const MurmurHash &hash);
+		void write(const IndexedIO::EntryID &name, const unsigned int *x, unsigned long arrayLength, const MurmurHash &hash);
+		void write(const IndexedIO::EntryID &name, const char *x, unsigned long arrayLength, const MurmurHash &hash);
+		void write(const IndexedIO::EntryID &name, const unsigned char *x, unsigned long arrayLength, const MurmurHash &hash);
+		void write(const IndexedIO::EntryID &name, const short *x, unsigned long arrayLength, const MurmurHash &hash);
+		void write(const IndexedIO::EntryID &name, const unsigned short *x, unsigned long arrayLength, const MurmurHash &hash);
+		void write(const IndexedIO::EntryID &name, const InternedString *x, unsigned long arrayLength, const MurmurHash &hash);
+
 		void read(const IndexedIO::EntryID &name, float *&x, unsigned long arrayLength) const;
 		void read(const IndexedIO::EntryID &name, double *&x, unsigned long arrayLength) const;
 		void read(const IndexedIO::EntryID &name, half *&x, unsigned long arrayLength) const;
@@ -146,6 +163,26 @@ class StreamIndexedIO : public IndexedIO
 		void read(const IndexedIO::EntryID &name, short &x) const;
 		void read(const IndexedIO::EntryID &name, unsigned short &x) const;
 
+		/// Describes how much data has been shared between entries rather than
+		/// written again, since the file was opened.
+		struct DeduplicationStatistics
+		{
+			DeduplicationStatistics();
+			/// The number of blocks of data written, including those which were
+			/// shared with a previous block.
+			size_t writes;
+			/// The number of writes which were shared with a previous block.
+			size_t hits;
+			/// The number of hits which were found using a precomputed hash,
+			/// without hashing or compressing the data.
+			size_t precomputedHashHits;
+			/// The number of bytes which sharing avoided writing to the file.
+			size_t bytesSaved;
+		};
+
+		/// Returns the statistics for the whole file this object belongs to.
+		DeduplicationStatistics deduplicationStatistics() const;
+
 	protected:
 
 		class Index;
@@ -176,9 +213,23 @@ class StreamIndexedIO : public IndexedIO
 				typedef Mutex::scoped_lock MutexLock;
 				Mutex & mutex();
 
+				/// Reads size bytes starting at the absolute position pos, without
+				/// affecting the current get position. This function is thread safe.
+				/// The default implementation locks mutex() and seeks the stream, but
+				/// derived classes may override it to allow concurrent reads.
+				virtual void readAt( char *buffer, size_t size, Imf::Int64 pos );
+
 				// utility function that returns a temporary buffer for io operations (not thread safe).
 				char *ioBuffer( unsigned long size );
 
+				// utility function that returns a temporary buffer owned by the calling thread,
+				// for use in conjunction with readAt(). releaseThreadIOBuffer() must be called
+				// when the buffer is no longer needed.
+				char *threadIOBuffer( unsigned long size );
+				// frees the calling thread's buffer if it is too large to be worth keeping
+				// for subsequent reads.
+				void releaseThreadIOBuffer();
+
 				/// called after the main index is saved to disk, ready to close the file.
 				virtual void flush( size_t endPosition );
 
@@ -197,6 +248,9 @@ class StreamIndexedIO : public IndexedIO
 
 				unsigned long m_ioBufferLen;
 				char *m_ioBuffer;
+
+				typedef tbb::enumerable_thread_specific< std::vector<char> > ThreadIOBuffers;
+				ThreadIOBuffers m_threadIOBuffers;
 		};
 		IE_CORE_DECLAREPTR( StreamFile );
 
@@ -213,13 +267,16 @@ class StreamIndexedIO : public IndexedIO
 		/// if the entry to remove does not exist.
 		void remove( const IndexedIO::EntryID &name, bool throwIfNonExistent );
 
-		// Write an array of POD types
+		// Write an array of POD types, optionally using a precomputed hash to share the data
 		template<typename T>
-		void write(const IndexedIO::EntryID &name, const T *x, unsigned long arrayLength);
+		void write(const IndexedIO::EntryID &name, const T *x, unsigned long arrayLength, const MurmurHash *hash = 0);
 
 		// Write an array of POD types (without temporary buffers - used on little endian platforms)
 		template<typename T>
-		void rawWrite(const IndexedIO::EntryID &name, const T *x, unsigned long arrayLength);
+		void rawWrite(const IndexedIO::EntryID &name, const T *x, unsigned long arrayLength, const MurmurHash *hash = 0);
+
+		// Write an array of InternedStrings, optionally using a precomputed hash to share the data
+		void writeInternedStrings(const IndexedIO::EntryID &name, const InternedString *x, unsigned long arrayLength, const MurmurHash *hash);
 
 		// Read an array of POD types
 		template<typename T>
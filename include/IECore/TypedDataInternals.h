@@ -35,11 +35,28 @@
 #ifndef IECORE_TYPEDDATAINTERNALS_H
 #define IECORE_TYPEDDATAINTERNALS_H
 
+#include <vector>
+
+#include "IECore/Data.h"
 #include "IECore/MurmurHash.h"
 
 namespace IECore
 {
 
+/// Returns the approximate size of data held by a SharedDataHolder, for
+/// the purposes of Data::recordBytesDuplicated().
+template<class T>
+inline size_t sharedDataSize( const T &data )
+{
+	return sizeof( T );
+}
+
+template<class T>
+inline size_t sharedDataSize( const std::vector<T> &data )
+{
+	return sizeof( std::vector<T> ) + data.size() * sizeof( T );
+}
+
 template<class T>
 class SimpleDataHolder
 {
@@ -111,6 +128,7 @@ class SharedDataHolder
 			{
 				// duplicate the data
 				m_data = new Shareable( m_data->data );
+				Data::recordBytesDuplicated( sharedDataSize( m_data->data ) );
 			}
 			m_data->hashValid = false;
 			return m_data->data;
@@ -51,7 +51,7 @@ class WarpOp : public ImagePrimitiveOp
 {
 	public:
 
-		enum FilterType { None = 0, Bilinear, TypeCount };
+		enum FilterType { None = 0, Bilinear, Bicubic, Lanczos, EWA, TypeCount };
 
 		WarpOp( const std::string &description );
 		virtual ~WarpOp();
@@ -78,6 +78,8 @@ class WarpOp : public ImagePrimitiveOp
 		/// Must be implemented by subclasses to determine where the color will come from.
 		/// The returned coordinate is on pixel space of the input image and the given V2f coordinates are on the
 		/// output image pixel space.
+		/// \threading This function is called concurrently from multiple threads, and therefore must
+		/// not modify any state without appropriate synchronisation.
 		virtual Imath::V2f warp( const Imath::V2f &p ) const = 0;
 		/// Called once per operation, after all calls to transform() have been made. This is
 		/// an opportunity to perform any cleanup necessary.
@@ -87,8 +89,8 @@ class WarpOp : public ImagePrimitiveOp
 
 		IntParameterPtr m_filterParameter;
 
-		struct Warp;
-		friend class Warp;
+		class Coordinates;
+		friend class Coordinates;
 };
 
 IE_CORE_DECLAREPTR( WarpOp );
@@ -35,6 +35,8 @@
 #ifndef IECOREGL_CACHEDCONVERTER_H
 #define IECOREGL_CACHEDCONVERTER_H
 
+#include <vector>
+
 #include "boost/function.hpp"
 
 #include "IECore/Object.h"
@@ -64,6 +66,18 @@ class CachedConverter : public IECore::RefCounted
 
 		/// Uses a custom converter for the given object. The converter is a callable object of the type ConverterFn but it also must implement a hash( object ) method.
 		template< typename T >	IECore::ConstRunTimeTypedPtr convert( const IECore::Object *object, T converter );
+
+		/// Starts converting the objects in the background, using the TBB thread pool,
+		/// so that later calls to convert() for them can return immediately. This
+		/// returns at once. Only objects whose conversion doesn't require a gl context
+		/// are prefetched - currently this means conversions to IECoreGL::Primitives,
+		/// which prepare their data on the calling thread and create their gl buffers
+		/// lazily at render time. Other objects are ignored, and will be converted by
+		/// convert() as usual. Errors are not reported by prefetch(), but by the next
+		/// call to convert() for the object in question.
+		void prefetch( const std::vector<IECore::ConstObjectPtr> &objects );
+		/// Waits for all conversions started by prefetch() to complete.
+		void waitForPrefetches();
 		
 		/// Returns the maximum amount of memory (in bytes) the cache will use.
 		size_t getMaxMemory() const;
@@ -77,7 +91,9 @@ class CachedConverter : public IECore::RefCounted
 		/// no valid gl context, it is unable to free the resources immediately.
 		/// As a workaround it defers the freeing of all resources until clearUnused()
 		/// is called on the main opengl thread. It is the responsibility of the clients
-		/// of the CachedConverter to call this from the main thread periodically.
+		/// of the CachedConverter to call this from the main thread periodically. This
+		/// is particularly important when using prefetch(), as removals made by the
+		/// background conversions are always deferred.
 		/// \todo Can we improve this situation?
 		void clearUnused();
 
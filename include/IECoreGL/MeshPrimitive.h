@@ -50,11 +50,23 @@ class MeshPrimitive : public Primitive
 
 		IE_CORE_DECLARERUNTIMETYPEDEXTENSION( IECoreGL::MeshPrimitive, MeshPrimitiveTypeId, Primitive );
 
-		/// Copies of all data are taken.
+		/// Constructs a mesh drawn with glDrawArrays(), with three vertex ids per
+		/// triangle in vertIds. Vertex and Varying primitive variables are expanded
+		/// to FaceVarying when they are added. Copies of all data are taken.
 		MeshPrimitive( IECore::ConstIntVectorDataPtr vertIds );
+		/// Constructs a mesh drawn with glDrawElements(), with three indices per
+		/// triangle in vertIds, each indexing into primitive variables of Vertex or
+		/// Varying interpolation with numVertices elements. FaceVarying primitive
+		/// variables are not supported by such meshes - ToGLMeshConverter welds them
+		/// into unique vertices instead. Copies of all data are taken.
+		MeshPrimitive( IECore::ConstIntVectorDataPtr vertIds, size_t numVertices );
 		virtual ~MeshPrimitive();
 
 		IECore::ConstIntVectorDataPtr vertexIds() const;
+		/// Returns true if the mesh is drawn with glDrawElements().
+		bool indexed() const;
+		/// Returns the number of elements in each vertex attribute.
+		size_t numVertices() const;
 
 		virtual Imath::Box3f bound() const;
 
@@ -71,6 +71,10 @@ class Primitive : public Renderable
 
 		/// Returns the bounding box for the primitive.
 		virtual Imath::Box3f bound() const = 0;
+
+		/// Returns the data for a vertex attribute registered with addVertexAttribute(),
+		/// or 0 if no such attribute exists.
+		IECore::ConstDataPtr vertexAttribute( const std::string &name ) const;
 		
 		/// High level rendering function which renders in the styles represented by
 		/// currentState, allowing representations such as wireframe over shaded etc to
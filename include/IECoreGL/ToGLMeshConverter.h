@@ -35,6 +35,8 @@
 #ifndef IECOREGL_TOGLMESHCONVERTER_H
 #define IECOREGL_TOGLMESHCONVERTER_H
 
+#include "IECore/SimpleTypedParameter.h"
+
 #include "IECoreGL/ToGLConverter.h"
 
 namespace IECore
@@ -48,6 +50,10 @@ namespace IECoreGL
 IE_CORE_FORWARDDECLARE( MeshPrimitive );
 
 /// Converts IECore::MeshPrimitive objects into IECoreGL::MeshPrimitive objects.
+/// By default the result is an indexed mesh - face-varying primitive variables are
+/// welded into unique vertices, and the triangulated faces index into them. This uses
+/// much less memory than expanding every primitive variable to face-varying, which is
+/// done when the "indexed" parameter is off.
 /// \ingroup conversionGroup
 class ToGLMeshConverter : public ToGLConverter
 {
@@ -62,6 +68,9 @@ class ToGLMeshConverter : public ToGLConverter
 		ToGLMeshConverter( IECore::ConstMeshPrimitivePtr toConvert = 0 );
 		virtual ~ToGLMeshConverter();
 
+		IECore::BoolParameter *indexedParameter();
+		const IECore::BoolParameter *indexedParameter() const;
+
 	protected :
 
 		virtual IECore::RunTimeTypedPtr doConversion( IECore::ConstObjectPtr src, IECore::ConstCompoundObjectPtr operands ) const;
@@ -70,6 +79,8 @@ class ToGLMeshConverter : public ToGLConverter
 	
 		static ConverterDescription<ToGLMeshConverter> g_description;
 
+		IECore::BoolParameterPtr m_indexedParameter;
+
 };
 
 IE_CORE_DECLAREPTR( ToGLMeshConverter );
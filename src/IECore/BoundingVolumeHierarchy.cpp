@@ -0,0 +1,278 @@
+//////////////////////////////////////////////////////////////////////////
+//
+//  Copyright (c) 2013, Image Engine Design Inc. All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are
+//  met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//
+//     * Neither the name of Image Engine Design nor the names of any
+//       other contributors to this software may be used to endorse or
+//       promote products derived from this software without specific prior
+//       written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+//  IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+//  THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+//  PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+//  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+//  EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+//  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+//  PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+//  LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+//  NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//////////////////////////////////////////////////////////////////////////
+
+#include <algorithm>
+#include <cassert>
+
+#include "IECore/BoundingVolumeHierarchy.h"
+
+using namespace IECore;
+using namespace Imath;
+
+namespace
+{
+
+const unsigned g_numBins = 16;
+
+// half the surface area of a box, which is all the surface area heuristic needs
+float halfArea( const Box3f &b )
+{
+	if( b.isEmpty() )
+	{
+		return 0.0f;
+	}
+	const V3f s = b.size();
+	return s.x * s.y + s.y * s.z + s.z * s.x;
+}
+
+struct CentroidLess
+{
+	CentroidLess( const std::vector<V3f> &centroids, int axis )
+		:	m_centroids( centroids ), m_axis( axis )
+	{
+	}
+
+	bool operator()( unsigned a, unsigned b ) const
+	{
+		return m_centroids[a][m_axis] < m_centroids[b][m_axis];
+	}
+
+	const std::vector<V3f> &m_centroids;
+	int m_axis;
+};
+
+struct InLowBins
+{
+	InLowBins( const std::vector<V3f> &centroids, int axis, float min, float scale, unsigned splitBin )
+		:	m_centroids( centroids ), m_axis( axis ), m_min( min ), m_scale( scale ), m_splitBin( splitBin )
+	{
+	}
+
+	unsigned bin( unsigned primitive ) const
+	{
+		unsigned b = (unsigned)( ( m_centroids[primitive][m_axis] - m_min ) * m_scale );
+		return std::min( b, g_numBins - 1 );
+	}
+
+	bool operator()( unsigned primitive ) const
+	{
+		return bin( primitive ) <= m_splitBin;
+	}
+
+	const std::vector<V3f> &m_centroids;
+	int m_axis;
+	float m_min;
+	float m_scale;
+	unsigned m_splitBin;
+};
+
+} // namespace
+
+BoundingVolumeHierarchy::BoundingVolumeHierarchy( const std::vector<Box3f> &bounds, unsigned maxLeafSize )
+	:	m_maxLeafSize( std::max( maxLeafSize, 1u ) ), m_bounds( &bounds )
+{
+	m_primitives.resize( bounds.size() );
+	m_centroids.resize( bounds.size() );
+	for( unsigned i = 0; i < bounds.size(); ++i )
+	{
+		m_primitives[i] = i;
+		m_centroids[i] = bounds[i].isEmpty() ? V3f( 0 ) : bounds[i].center();
+		m_bound.extendBy( bounds[i] );
+	}
+
+	m_nodes.reserve( 1 + 2 * bounds.size() / ( 3 * m_maxLeafSize ) );
+	build( m_primitives.begin(), m_primitives.end() );
+
+	m_bounds = 0;
+	std::vector<V3f>().swap( m_centroids );
+}
+
+unsigned BoundingVolumeHierarchy::build( PrimitiveIterator first, PrimitiveIterator last )
+{
+	// split the range repeatedly until we have four children or
+	// every child is small enough to be a leaf
+	std::pair<PrimitiveIterator, PrimitiveIterator> ranges[4];
+	unsigned numRanges = 0;
+	if( first != last )
+	{
+		ranges[numRanges++] = std::make_pair( first, last );
+	}
+
+	while( numRanges < 4 )
+	{
+		unsigned largest = 0;
+		size_t largestSize = 0;
+		for( unsigned i = 0; i < numRanges; ++i )
+		{
+			size_t size = ranges[i].second - ranges[i].first;
+			if( size > largestSize )
+			{
+				largest = i;
+				largestSize = size;
+			}
+		}
+
+		if( largestSize <= m_maxLeafSize )
+		{
+			break;
+		}
+
+		PrimitiveIterator middle = split( ranges[largest].first, ranges[largest].second );
+		ranges[numRanges++] = std::make_pair( middle, ranges[largest].second );
+		ranges[largest].second = middle;
+	}
+
+	const unsigned nodeIndex = m_nodes.size();
+	m_nodes.push_back( Node() );
+
+	Node node;
+	node.numChildren = numRanges;
+	for( unsigned i = 0; i < 4; ++i )
+	{
+		Box3f b;
+		if( i < numRanges )
+		{
+			b = rangeBound( ranges[i].first, ranges[i].second );
+			size_t size = ranges[i].second - ranges[i].first;
+			if( size <= m_maxLeafSize )
+			{
+				node.child[i] = ranges[i].first - m_primitives.begin();
+				node.numPrimitives[i] = size;
+			}
+			else
+			{
+				// note that this may reallocate m_nodes, so we
+				// fill in our node afterwards
+				node.child[i] = build( ranges[i].first, ranges[i].second );
+				node.numPrimitives[i] = 0;
+			}
+		}
+		else
+		{
+			b = Box3f( V3f( 0 ) );
+			node.child[i] = 0;
+			node.numPrimitives[i] = 0;
+		}
+
+		for( int a = 0; a < 3; ++a )
+		{
+			node.boundMin[a][i] = b.min[a];
+			node.boundMax[a][i] = b.max[a];
+		}
+	}
+
+	m_nodes[nodeIndex] = node;
+	return nodeIndex;
+}
+
+BoundingVolumeHierarchy::PrimitiveIterator BoundingVolumeHierarchy::split( PrimitiveIterator first, PrimitiveIterator last ) const
+{
+	assert( last - first > 1 );
+
+	// choose the axis along which the centroids are most spread out
+	Box3f centroidBound;
+	for( PrimitiveIterator it = first; it != last; ++it )
+	{
+		centroidBound.extendBy( m_centroids[*it] );
+	}
+
+	const int axis = centroidBound.majorAxis();
+	const float extent = centroidBound.size()[axis];
+
+	PrimitiveIterator middle = first + ( last - first ) / 2;
+	if( extent > 0.0f )
+	{
+		// bin the primitives by centroid and choose the split between bins
+		// which minimises the surface area heuristic.
+		const float scale = g_numBins / extent;
+		InLowBins inLowBins( m_centroids, axis, centroidBound.min[axis], scale, 0 );
+
+		Box3f binBounds[g_numBins];
+		size_t binCounts[g_numBins];
+		std::fill( binCounts, binCounts + g_numBins, 0 );
+		for( PrimitiveIterator it = first; it != last; ++it )
+		{
+			const unsigned b = inLowBins.bin( *it );
+			binBounds[b].extendBy( (*m_bounds)[*it] );
+			binCounts[b]++;
+		}
+
+		float highCosts[g_numBins];
+		Box3f highBound;
+		size_t highCount = 0;
+		for( unsigned b = g_numBins - 1; b > 0; --b )
+		{
+			highBound.extendBy( binBounds[b] );
+			highCount += binCounts[b];
+			highCosts[b] = halfArea( highBound ) * highCount;
+		}
+
+		float bestCost = Imath::limits<float>::max();
+		unsigned bestSplit = g_numBins;
+		Box3f lowBound;
+		size_t lowCount = 0;
+		for( unsigned b = 0; b < g_numBins - 1; ++b )
+		{
+			lowBound.extendBy( binBounds[b] );
+			lowCount += binCounts[b];
+			const float cost = halfArea( lowBound ) * lowCount + highCosts[b+1];
+			if( lowCount && lowCount < (size_t)( last - first ) && cost < bestCost )
+			{
+				bestCost = cost;
+				bestSplit = b;
+			}
+		}
+
+		if( bestSplit < g_numBins )
+		{
+			inLowBins.m_splitBin = bestSplit;
+			return std::partition( first, last, inLowBins );
+		}
+	}
+
+	// fall back to splitting at the median centroid, which
+	// always divides the range in two.
+	std::nth_element( first, middle, last, CentroidLess( m_centroids, axis ) );
+	return middle;
+}
+
+Box3f BoundingVolumeHierarchy::rangeBound( PrimitiveIterator first, PrimitiveIterator last ) const
+{
+	Box3f result;
+	for( PrimitiveIterator it = first; it != last; ++it )
+	{
+		result.extendBy( (*m_bounds)[*it] );
+	}
+	return result;
+}
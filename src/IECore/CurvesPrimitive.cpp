@@ -107,7 +107,7 @@ void CurvesPrimitive::copyFrom( const Object *other, CopyContext *context )
 	m_basis = tOther->m_basis;
 	m_linear = tOther->m_linear;
 	m_periodic = tOther->m_periodic;
-	m_vertsPerCurve = tOther->m_vertsPerCurve->copy(); // don't need to use context as we don't share this data with anyone
+	m_vertsPerCurve = tOther->m_vertsPerCurve; // never modified in place, so can be shared with the original
 	m_numVerts = tOther->m_numVerts;
 	m_numFaceVarying = tOther->m_numFaceVarying;
 }
@@ -32,6 +32,9 @@
 //
 //////////////////////////////////////////////////////////////////////////
 
+#include "tbb/parallel_for.h"
+#include "tbb/blocked_range.h"
+
 #include "OpenEXR/ImathFun.h"
 
 #include "IECore/CurvesPrimitiveEvaluator.h"
@@ -322,14 +325,29 @@ struct CurvesPrimitiveEvaluator::Line
 		float m_vMax;
 		
 };
+
+//////////////////////////////////////////////////////////////////////////
+// Implementation of CurvesPrimitiveEvaluator::Tree
+//////////////////////////////////////////////////////////////////////////
+
+// the tree holds iterators into bounds, so we keep them all together
+// and build them as one unit in buildTree().
+struct CurvesPrimitiveEvaluator::Tree
+{
+	std::vector<Imath::Box3f> bounds;
+	std::vector<Line> lines;
+	Box3fTree tree;
+};
 				
 //////////////////////////////////////////////////////////////////////////
 // Implementation of Evaluator
 //////////////////////////////////////////////////////////////////////////
 
 CurvesPrimitiveEvaluator::CurvesPrimitiveEvaluator( ConstCurvesPrimitivePtr curves )
-	:	m_curvesPrimitive( curves->copy() ), m_verticesPerCurve( m_curvesPrimitive->verticesPerCurve()->readable() ), m_haveTree( false )
+	:	m_curvesPrimitive( curves->copy() ), m_verticesPerCurve( m_curvesPrimitive->verticesPerCurve()->readable() )
 {
+	m_tree = 0;
+
 	m_vertexDataOffsets.reserve( m_verticesPerCurve.size() );
 	m_varyingDataOffsets.reserve( m_verticesPerCurve.size() );
 	int vertexDataOffset = 0;
@@ -353,6 +371,7 @@ CurvesPrimitiveEvaluator::CurvesPrimitiveEvaluator( ConstCurvesPrimitivePtr curv
 
 CurvesPrimitiveEvaluator::~CurvesPrimitiveEvaluator()
 {
+	delete m_tree;
 }
 
 PrimitiveEvaluatorPtr CurvesPrimitiveEvaluator::create( ConstPrimitivePtr primitive )
@@ -403,16 +422,14 @@ bool CurvesPrimitiveEvaluator::closestPoint( const Imath::V3f &p, PrimitiveEvalu
 	}
 
 	Result *typedResult = static_cast<Result *>( result );
-	// the cast isn't pretty but i think is the best of the alternatives. we want to delay building the tree until the first
-	// closestPoint() query so people don't pay the overhead if they're just using other queries. the alternative to
-	// the cast is to make the tree members mutable, but i'd rather keep them immutable so that the compiler tells us if
-	// we do anything wrong during the query.
-	const_cast<CurvesPrimitiveEvaluator *>( this )->buildTree();
+	// we delay building the tree until the first closestPoint() query so
+	// people don't pay the overhead if they're just using other queries.
+	buildTree();
 
 	unsigned curveIndex = 0;
 	float v = -1;
 	float distSquared = Imath::limits<float>::max();
-	closestPointWalk( m_tree.rootIndex(), p, curveIndex, v, distSquared );
+	closestPointWalk( m_tree->tree.rootIndex(), p, curveIndex, v, distSquared );
 	(typedResult->*typedResult->m_init)( curveIndex, v, this );
 	
 	return true;
@@ -420,15 +437,16 @@ bool CurvesPrimitiveEvaluator::closestPoint( const Imath::V3f &p, PrimitiveEvalu
 
 void CurvesPrimitiveEvaluator::closestPointWalk( Box3fTree::NodeIndex nodeIndex, const Imath::V3f &p, unsigned &curveIndex, float &v, float &closestDistSquared ) const
 {
-	assert( m_haveTree );
+	assert( m_tree );
 
-	const Box3fTree::Node &node = m_tree.node( nodeIndex );
+	const Box3fTree &tree = m_tree->tree;
+	const Box3fTree::Node &node = tree.node( nodeIndex );
 	if( node.isLeaf() )
 	{
 		Box3fTree::Iterator *permLast = node.permLast();
 		for( Box3fTree::Iterator *perm = node.permFirst(); perm!=permLast; perm++ )
 		{
-			const Line &line = m_treeLines[*perm - m_treeBounds.begin()];
+			const Line &line = m_tree->lines[*perm - m_tree->bounds.begin()];
 			
 			float t;
 			V3f cp = line.lineSegment().closestPointTo( p, t );
@@ -448,8 +466,8 @@ void CurvesPrimitiveEvaluator::closestPointWalk( Box3fTree::NodeIndex nodeIndex,
 		Box3fTree::NodeIndex lowChild = Box3fTree::lowChildIndex( nodeIndex );
 		Box3fTree::NodeIndex highChild = Box3fTree::highChildIndex( nodeIndex );
 
-		float d2Low = ( closestPointInBox( p, m_tree.node( lowChild ).bound() ) - p ).length2();
-		float d2High = ( closestPointInBox( p, m_tree.node( highChild ).bound() ) - p ).length2();
+		float d2Low = ( closestPointInBox( p, tree.node( lowChild ).bound() ) - p ).length2();
+		float d2High = ( closestPointInBox( p, tree.node( highChild ).bound() ) - p ).length2();
 	
 		if( d2Low < d2High )
 		{
@@ -471,6 +489,84 @@ void CurvesPrimitiveEvaluator::closestPointWalk( Box3fTree::NodeIndex nodeIndex,
 	}
 }
 
+namespace
+{
+
+class ClosestPointsBody
+{
+	public :
+
+		ClosestPointsBody( const CurvesPrimitiveEvaluator &evaluator, const std::vector<V3f> &points, std::vector<V3f> *positions, std::vector<unsigned> *curveIndices, std::vector<float> *vs )
+			:	m_evaluator( evaluator ), m_points( points ), m_positions( positions ), m_curveIndices( curveIndices ), m_vs( vs )
+		{
+		}
+
+		void operator()( const tbb::blocked_range<size_t> &range ) const
+		{
+			// one result is reused for every query in the range
+			PrimitiveEvaluator::ResultPtr result = m_evaluator.createResult();
+			const CurvesPrimitiveEvaluator::Result *typedResult = static_cast<const CurvesPrimitiveEvaluator::Result *>( result.get() );
+			for( size_t i = range.begin(); i != range.end(); ++i )
+			{
+				m_evaluator.closestPoint( m_points[i], result.get() );
+				if( m_positions )
+				{
+					(*m_positions)[i] = typedResult->point();
+				}
+				if( m_curveIndices )
+				{
+					(*m_curveIndices)[i] = typedResult->curveIndex();
+				}
+				if( m_vs )
+				{
+					(*m_vs)[i] = typedResult->uv()[1];
+				}
+			}
+		}
+
+	private :
+
+		const CurvesPrimitiveEvaluator &m_evaluator;
+		const std::vector<V3f> &m_points;
+		std::vector<V3f> *m_positions;
+		std::vector<unsigned> *m_curveIndices;
+		std::vector<float> *m_vs;
+
+};
+
+} // namespace
+
+bool CurvesPrimitiveEvaluator::closestPoints( const std::vector<Imath::V3f> &points, std::vector<Imath::V3f> *positions,
+	std::vector<unsigned> *curveIndices, std::vector<float> *vs ) const
+{
+	if( !m_verticesPerCurve.size() )
+	{
+		return false;
+	}
+
+	// build the tree up front rather than having several
+	// threads build it at once on their first queries.
+	buildTree();
+
+	if( positions )
+	{
+		positions->resize( points.size() );
+	}
+	if( curveIndices )
+	{
+		curveIndices->resize( points.size() );
+	}
+	if( vs )
+	{
+		vs->resize( points.size() );
+	}
+
+	ClosestPointsBody body( *this, points, positions, curveIndices, vs );
+	tbb::parallel_for( tbb::blocked_range<size_t>( 0, points.size(), 64 ), body );
+
+	return true;
+}
+
 bool CurvesPrimitiveEvaluator::pointAtUV( const Imath::V2f &uv, PrimitiveEvaluator::Result *result ) const
 {
 	return pointAtV( 0, uv[1], result );
@@ -634,19 +730,19 @@ float CurvesPrimitiveEvaluator::curveLength( unsigned curveIndex, float vStart,
 	}
 }
 
-void CurvesPrimitiveEvaluator::buildTree()
+void CurvesPrimitiveEvaluator::buildTree() const
 {
-	if( m_haveTree )
+	if( m_tree )
 	{
 		return;
 	}
-	
-	TreeMutex::scoped_lock lock( m_treeMutex );
-	if( m_haveTree )
-	{
-		// another thread may have built the tree while we waited for the mutex
-		return;
-	}
+
+	// we mustn't hold a lock while building, because large trees are built
+	// using TBB tasks, and while waiting for them this thread may pick up
+	// another task which queries this evaluator and so calls back in here.
+	// instead we build without locking and publish the result atomically,
+	// discarding our tree if another thread beat us to it.
+	Tree *tree = new Tree;
 	
 	bool linear = m_curvesPrimitive->basis() == CubicBasisf::linear();
 	const std::vector<V3f> &p = static_cast<const V3fVectorData *>( m_p.data.get() )->readable();
@@ -668,8 +764,8 @@ void CurvesPrimitiveEvaluator::buildTree()
 					Box3f b;
 					b.extendBy( p[vertIndex-1] );
 					b.extendBy( p[vertIndex] );
-					m_treeBounds.push_back( b );
-					m_treeLines.push_back( Line(  p[vertIndex-1], p[vertIndex], curveIndex, prevV, v ) );
+					tree->bounds.push_back( b );
+					tree->lines.push_back( Line(  p[vertIndex-1], p[vertIndex], curveIndex, prevV, v ) );
 				}
 				prevV = v;				
 			}
@@ -690,8 +786,8 @@ void CurvesPrimitiveEvaluator::buildTree()
 					Box3f b;
 					b.extendBy( prevP );
 					b.extendBy( p );
-					m_treeBounds.push_back( b );
-					m_treeLines.push_back( Line( prevP, p, curveIndex, prevV, v ) );
+					tree->bounds.push_back( b );
+					tree->lines.push_back( Line( prevP, p, curveIndex, prevV, v ) );
 				}
 
 				prevP = p;
@@ -700,8 +796,11 @@ void CurvesPrimitiveEvaluator::buildTree()
 		}
 	}
 	
-	m_tree.init( m_treeBounds.begin(), m_treeBounds.end() );
-	m_haveTree = true;
+	tree->tree.init( tree->bounds.begin(), tree->bounds.end() );
+	if( m_tree.compare_and_swap( tree, 0 ) != 0 )
+	{
+		delete tree;
+	}
 }
 
 const std::vector<int> &CurvesPrimitiveEvaluator::verticesPerCurve() const
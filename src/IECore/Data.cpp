@@ -32,10 +32,20 @@
 //
 //////////////////////////////////////////////////////////////////////////
 
+#include "tbb/enumerable_thread_specific.h"
+
 #include "IECore/Data.h"
 
 using namespace IECore;
 
+namespace
+{
+
+typedef tbb::enumerable_thread_specific<size_t> BytesDuplicated;
+BytesDuplicated g_bytesDuplicated( 0 );
+
+} // namespace
+
 IE_CORE_DEFINEABSTRACTOBJECTTYPEDESCRIPTION( Data );
 
 const unsigned int Data::m_ioVersion = 0;
@@ -44,6 +54,16 @@ Data::~Data()
 {
 }
 
+size_t Data::bytesDuplicated()
+{
+	return g_bytesDuplicated.local();
+}
+
+void Data::recordBytesDuplicated( size_t bytes )
+{
+	g_bytesDuplicated.local() += bytes;
+}
+
 void Data::copyFrom( const Object *other, CopyContext *context )
 {
 	Object::copyFrom( other, context );
@@ -134,134 +134,161 @@ std::string EXRImageReader::sourceColorSpace() const
 	return "linear";
 }
 
-template<class T>
-DataPtr EXRImageReader::readTypedChannel( const std::string &name, const Imath::Box2i &dataWindow, const Imf::Channel *channel )
+namespace
 {
-	assert( channel );
-	Imath::V2i pixelDimensions = dataWindow.size() + Imath::V2i( 1 );
-	unsigned numPixels = pixelDimensions.x * pixelDimensions.y;
 
+// The number of scanlines read in each pass when reading a data window narrower than the
+// one in the file. It's a multiple of the number of scanlines per chunk for all the EXR
+// compression methods, so that no chunk is decompressed more than once.
+const int g_scanlinesPerBand = 256;
+
+template<class T>
+DataPtr createChannelData( size_t numPixels, char *&base, size_t &elementSize )
+{
 	typedef TypedData<vector<T> > DataType;
 	typename DataType::Ptr data = new DataType;
 	data->writable().resize( numPixels );
+	base = (char *)data->baseWritable();
+	elementSize = sizeof( T );
+	return data;
+}
 
-	Imath::Box2i fullDataWindow = this->dataWindow();
-	if( fullDataWindow.min.x==dataWindow.min.x && fullDataWindow.max.x==dataWindow.max.x )
+} // namespace
+
+void EXRImageReader::readChannels( const std::vector<std::string> &names, const Imath::Box2i &dataWindow, bool raw, std::vector<DataPtr> &channels )
+{
+	open( true );
+
+	try
 	{
-		// the width we want to read matches the width in the file, so we can read straight
-		// into the result buffer
-		FrameBuffer frameBuffer;
-		T *buffer00 = data->baseWritable() - dataWindow.min.y * pixelDimensions.x - fullDataWindow.min.x;
-		Slice slice( channel->type, (char *)buffer00, sizeof(T), sizeof(T) * pixelDimensions.x );
-		frameBuffer.insert( name.c_str(), slice );
-		m_inputFile->setFrameBuffer( frameBuffer );
-		// exr library will choose the best order to read scanlines automatically (increasing or decreasing)
-		try
-		{
-			m_inputFile->readPixels( dataWindow.min.y, dataWindow.max.y );
-		}
-		catch( Iex::InputExc &e )
+		Imath::V2i pixelDimensions = dataWindow.size() + Imath::V2i( 1 );
+		size_t numPixels = pixelDimensions.x * pixelDimensions.y;
+		Imath::Box2i fullDataWindow = this->dataWindow();
+		const ChannelList &channelList = m_inputFile->header().channels();
+
+		// allocate the result buffers
+
+		channels.clear();
+		std::vector<const Channel *> fileChannels;
+		std::vector<char *> bases;
+		std::vector<size_t> elementSizes;
+		for( vector<string>::const_iterator it = names.begin(); it != names.end(); it++ )
 		{
-			// so we can read incomplete files
-			msg( Msg::Warning, "EXRImageReader::readChannel", e.what() );
-			return data;
+			const Channel *channel = channelList.findChannel( it->c_str() );
+			assert( channel );
+			assert( channel->xSampling==1 ); /// \todo Support subsampling when we have a need for it
+			assert( channel->ySampling==1 );
+
+			char *base = 0;
+			size_t elementSize = 0;
+			switch( channel->type )
+			{
+				case UINT :
+					BOOST_STATIC_ASSERT( sizeof( unsigned int ) == 4 );
+					channels.push_back( createChannelData<unsigned int>( numPixels, base, elementSize ) );
+					break;
+				case HALF :
+					channels.push_back( createChannelData<half>( numPixels, base, elementSize ) );
+					break;
+				case FLOAT :
+					BOOST_STATIC_ASSERT( sizeof( float ) == 4 );
+					channels.push_back( createChannelData<float>( numPixels, base, elementSize ) );
+					break;
+				default :
+					throw IOException( ( boost::format( "EXRImageReader : Unsupported data type for channel \"%s\"" ) % *it ).str() );
+			}
+			fileChannels.push_back( channel );
+			bases.push_back( base );
+			elementSizes.push_back( elementSize );
 		}
-	}
-	else
-	{
-		// widths don't match, we need to read into a temporary buffer and then transfer just
-		// the bits we need into the result buffer.
-		int numTmpPixels = fullDataWindow.size().x + 1;
-		vector<T> tmpBuffer( numTmpPixels );
-		T *tmpBufferTransferStart = &(tmpBuffer[0]) + dataWindow.min.x - fullDataWindow.min.x;
-		size_t tmpBufferTransferLength = pixelDimensions.x * sizeof( T );
-		T *transferDestination = &(data->writable()[0]);
-
-		// slice has yStride of 0 so each successive scanline just overwrites the previous one
-		Slice slice( channel->type, (char *)(&(tmpBuffer[0]) - fullDataWindow.min.x), sizeof(T), 0 );
-		FrameBuffer frameBuffer;
-		frameBuffer.insert( name.c_str(), slice );
-		m_inputFile->setFrameBuffer( frameBuffer );
-
-		int yStart = dataWindow.min.y;
-		int yEnd = dataWindow.max.y;
-		int yStep = 1;
+
+		// read all the channels at once, so each scanline is decompressed only a single time
+
 		try
 		{
-			for( int y=yStart; y!=(yEnd+yStep); y+=yStep )
+			if( fullDataWindow.min.x==dataWindow.min.x && fullDataWindow.max.x==dataWindow.max.x )
 			{
-				m_inputFile->readPixels( y );
-				memcpy( (char *)transferDestination, (const char *)tmpBufferTransferStart, tmpBufferTransferLength );
-				transferDestination += pixelDimensions.x;
+				// the width we want to read matches the width in the file, so we can read straight
+				// into the result buffers
+				FrameBuffer frameBuffer;
+				for( size_t i = 0; i < names.size(); i++ )
+				{
+					char *buffer00 = bases[i] - ( (ptrdiff_t)dataWindow.min.y * pixelDimensions.x + fullDataWindow.min.x ) * (ptrdiff_t)elementSizes[i];
+					frameBuffer.insert( names[i].c_str(), Slice( fileChannels[i]->type, buffer00, elementSizes[i], elementSizes[i] * pixelDimensions.x ) );
+				}
+				m_inputFile->setFrameBuffer( frameBuffer );
+				// exr library will choose the best order to read scanlines automatically (increasing or decreasing)
+				m_inputFile->readPixels( dataWindow.min.y, dataWindow.max.y );
+			}
+			else
+			{
+				// widths don't match, so we read bands of full width scanlines into temporary
+				// buffers and then transfer just the bits we need into the result buffers.
+				const int fullWidth = fullDataWindow.size().x + 1;
+				std::vector< std::vector<char> > tmpBuffers( names.size() );
+				for( size_t i = 0; i < names.size(); i++ )
+				{
+					tmpBuffers[i].resize( (size_t)fullWidth * g_scanlinesPerBand * elementSizes[i] );
+				}
+
+				int bandStart = dataWindow.min.y;
+				while( bandStart <= dataWindow.max.y )
+				{
+					int bandEnd = fullDataWindow.min.y + ( ( bandStart - fullDataWindow.min.y ) / g_scanlinesPerBand + 1 ) * g_scanlinesPerBand - 1;
+					bandEnd = std::min( bandEnd, dataWindow.max.y );
+
+					FrameBuffer frameBuffer;
+					for( size_t i = 0; i < names.size(); i++ )
+					{
+						char *buffer00 = &(tmpBuffers[i][0]) - ( (ptrdiff_t)bandStart * fullWidth + fullDataWindow.min.x ) * (ptrdiff_t)elementSizes[i];
+						frameBuffer.insert( names[i].c_str(), Slice( fileChannels[i]->type, buffer00, elementSizes[i], elementSizes[i] * fullWidth ) );
+					}
+					m_inputFile->setFrameBuffer( frameBuffer );
+					m_inputFile->readPixels( bandStart, bandEnd );
+
+					for( size_t i = 0; i < names.size(); i++ )
+					{
+						const size_t elementSize = elementSizes[i];
+						const size_t transferLength = pixelDimensions.x * elementSize;
+						const char *transferSource = &(tmpBuffers[i][0]) + ( dataWindow.min.x - fullDataWindow.min.x ) * elementSize;
+						char *transferDestination = bases[i] + (size_t)( bandStart - dataWindow.min.y ) * transferLength;
+						for( int y = bandStart; y <= bandEnd; y++ )
+						{
+							memcpy( transferDestination, transferSource, transferLength );
+							transferSource += fullWidth * elementSize;
+							transferDestination += transferLength;
+						}
+					}
+
+					bandStart = bandEnd + 1;
+				}
 			}
 		}
 		catch( Iex::InputExc &e )
 		{
 			// so we can read incomplete files
-			msg( Msg::Warning, "EXRImageReader::readChannel", e.what() );
-			return data;
+			msg( Msg::Warning, "EXRImageReader::readChannels", e.what() );
 		}
-	}
-
-#ifndef NDEBUG
-	for ( typename DataType::ValueType::const_iterator it = data->readable().begin(); it != data->readable().end(); ++it )
-	{
-		assert( *it == *it ); // Will fail iff NaN
-	}
-#endif
-
-	return data;
-}
-
-DataPtr EXRImageReader::readChannel( const string &name, const Imath::Box2i &dataWindow, bool raw )
-{
-	open( true );
-
-	try
-	{
 
-		const Channel *channel = m_inputFile->header().channels().findChannel( name.c_str() );
-		assert( channel );
-		assert( channel->xSampling==1 ); /// \todo Support subsampling when we have a need for it
-		assert( channel->ySampling==1 );
+		// convert to float if necessary
 
-		DataPtr res;
-		switch( channel->type )
+		if( !raw )
 		{
-			case UINT :
-				BOOST_STATIC_ASSERT( sizeof( unsigned int ) == 4 );
-				res = readTypedChannel<unsigned int>( name, dataWindow, channel );
-				if ( raw )
-				{
-					return res;
-				}
-				else
+			for( size_t i = 0; i < names.size(); i++ )
+			{
+				if( fileChannels[i]->type == UINT )
 				{
 					DataConvert< UIntVectorData, FloatVectorData, ScaledDataConversion< unsigned int, float > > converter;
-					ConstUIntVectorDataPtr vec = staticPointerCast< UIntVectorData >(res);
-					return converter( vec );
+					ConstUIntVectorDataPtr vec = staticPointerCast< UIntVectorData >( channels[i] );
+					channels[i] = converter( vec );
 				}
-
-			case HALF :
-				res = readTypedChannel<half>( name, dataWindow, channel );
-				if ( raw )
-				{
-					return res;
-				}
-				else
+				else if( fileChannels[i]->type == HALF )
 				{
 					DataConvert< HalfVectorData, FloatVectorData, ScaledDataConversion< half, float > > converter;
-					ConstHalfVectorDataPtr vec = staticPointerCast< HalfVectorData >(res);
-					return converter( vec );
+					ConstHalfVectorDataPtr vec = staticPointerCast< HalfVectorData >( channels[i] );
+					channels[i] = converter( vec );
 				}
-
-			case FLOAT :
-				BOOST_STATIC_ASSERT( sizeof( float ) == 4 );
-				return readTypedChannel<float>( name, dataWindow, channel );
-
-			default:
-				throw IOException( ( boost::format( "EXRImageReader : Unsupported data type for channel \"%s\"" ) % name ).str() );
-
+			}
 		}
 	}
 	catch ( Exception &e )
@@ -284,6 +311,14 @@ DataPtr EXRImageReader::readChannel( const string &name, const Imath::Box2i &dat
 	}
 }
 
+DataPtr EXRImageReader::readChannel( const string &name, const Imath::Box2i &dataWindow, bool raw )
+{
+	std::vector<std::string> names( 1, name );
+	std::vector<DataPtr> channels;
+	readChannels( names, dataWindow, raw, channels );
+	return channels[0];
+}
+
 bool EXRImageReader::open( bool throwOnFailure )
 {
 	if( m_inputFile && fileName()==m_inputFile->fileName() )
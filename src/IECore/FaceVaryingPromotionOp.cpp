@@ -34,11 +34,14 @@
 
 #include "boost/regex.hpp"
 #include "boost/format.hpp"
+#include "boost/type_traits/is_same.hpp"
+
+#include "tbb/parallel_for.h"
 
 #include "IECore/FaceVaryingPromotionOp.h"
 #include "IECore/DespatchTypedData.h"
 #include "IECore/CompoundParameter.h"
-#include "IECore/PolygonVertexIterator.h"
+#include "IECore/MeshAdjacency.h"
 
 using namespace IECore;
 
@@ -125,12 +128,87 @@ const BoolParameter *FaceVaryingPromotionOp::promoteVertexParameter() const
 	return parameters()->parameter<BoolParameter>( "promoteVertex" );
 }
 
+namespace
+{
+
+template<typename Container>
+class PromoteUniform
+{
+
+	public :
+
+		PromoteUniform( const Container &data, const std::vector<int> &faceOffsets, Container &result )
+			:	m_data( data ), m_faceOffsets( faceOffsets ), m_result( result )
+		{
+		}
+
+		void operator()( const tbb::blocked_range<size_t> &r ) const
+		{
+			for( size_t f = r.begin(); f != r.end(); ++f )
+			{
+				std::fill( m_result.begin() + m_faceOffsets[f], m_result.begin() + m_faceOffsets[f+1], m_data[f] );
+			}
+		}
+
+	private :
+
+		const Container &m_data;
+		const std::vector<int> &m_faceOffsets;
+		Container &m_result;
+
+};
+
+template<typename Container>
+class PromoteVertex
+{
+
+	public :
+
+		PromoteVertex( const Container &data, const std::vector<int> &vertIds, Container &result )
+			:	m_data( data ), m_vertIds( vertIds ), m_result( result )
+		{
+		}
+
+		void operator()( const tbb::blocked_range<size_t> &r ) const
+		{
+			for( size_t i = r.begin(); i != r.end(); ++i )
+			{
+				m_result[i] = m_data[m_vertIds[i]];
+			}
+		}
+
+	private :
+
+		const Container &m_data;
+		const std::vector<int> &m_vertIds;
+		Container &m_result;
+
+};
+
+// Runs the body in parallel, unless the container is a std::vector<bool>,
+// in which neighbouring elements can't be written concurrently.
+template<typename Container, typename Body>
+void promote( size_t size, const Body &body )
+{
+	tbb::blocked_range<size_t> range( 0, size, 1000 );
+	if( boost::is_same<Container, std::vector<bool> >::value )
+	{
+		body( range );
+	}
+	else
+	{
+		tbb::parallel_for( range, body );
+	}
+}
+
+} // namespace
+
 struct FaceVaryingPromotionOp::Promoter
 {
 	typedef DataPtr ReturnType;
 
-	Promoter( const std::vector<int> &vertsPerFace,  const std::vector<int> &vertIds )
-		:	m_interpolation( PrimitiveVariable::Invalid ), m_vertsPerFace( vertsPerFace ), m_vertIds( vertIds )
+	Promoter( const std::vector<int> &vertIds, ConstMeshAdjacencyPtr adjacency )
+		:	m_interpolation( PrimitiveVariable::Invalid ), m_vertIds( vertIds ), m_adjacency( adjacency )
 	{
 	}
 
@@ -143,30 +221,22 @@ struct FaceVaryingPromotionOp::Promoter
 	ReturnType operator()( T *data )
 	{	
 		typedef typename T::ValueType Container;
-		typedef typename Container::const_iterator ConstIterator;
 		
 		typename T::Ptr result = new T;
-		result->writable().reserve( m_vertIds.size() );
-		std::back_insert_iterator<Container> inserter( result->writable() );
+		Container &resultWritable = result->writable();
+		resultWritable.resize( m_vertIds.size() );
+		
 		switch( m_interpolation )
 		{
 			case PrimitiveVariable::Uniform :
 			{
-				ConstIterator dataIt = data->readable().begin();
-				for( std::vector<int>::const_iterator it=m_vertsPerFace.begin(); it!=m_vertsPerFace.end(); ++it, ++dataIt )
-				{
-					std::fill_n( inserter, *it, *dataIt );
-				}				
+				promote<Container>( m_adjacency->numFaces(), PromoteUniform<Container>( data->readable(), m_adjacency->faceOffsets(), resultWritable ) );
 				break;
 			}
 			case PrimitiveVariable::Vertex :
 			case PrimitiveVariable::Varying :
 			{
-				std::copy(
-					PolygonVertexIterator<ConstIterator>( m_vertIds.begin(), data->readable().begin() ),
-					PolygonVertexIterator<ConstIterator>( m_vertIds.end(), data->readable().begin() ),
-					inserter
-				);					
+				promote<Container>( m_vertIds.size(), PromoteVertex<Container>( data->readable(), m_vertIds, resultWritable ) );
 				break;
 			}
 			default :
@@ -177,12 +247,12 @@ struct FaceVaryingPromotionOp::Promoter
 		
 		return result;
 	}
-
+	
 	private :
-
+	
 		PrimitiveVariable::Interpolation m_interpolation;
-		const std::vector<int> &m_vertsPerFace;
 		const std::vector<int> &m_vertIds;
+		ConstMeshAdjacencyPtr m_adjacency;
 
 };
 
@@ -199,7 +269,7 @@ void FaceVaryingPromotionOp::modifyTypedPrimitive( MeshPrimitive *mesh, const Co
 	bool promoteVarying = operands->member<BoolData>( "promoteVarying" )->readable();
 	bool promoteVertex = operands->member<BoolData>( "promoteVertex" )->readable();
 
-	Promoter promoter( mesh->verticesPerFace()->readable(), mesh->vertexIds()->readable() );
+	Promoter promoter( mesh->vertexIds()->readable(), mesh->adjacency() );
 	for( PrimitiveVariableMap::iterator it=mesh->variables.begin(); it!=mesh->variables.end(); ++it )
 	{
 		switch( it->second.interpolation )
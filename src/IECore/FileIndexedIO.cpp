@@ -33,10 +33,20 @@
 //////////////////////////////////////////////////////////////////////////
 
 #include "boost/filesystem/operations.hpp"
+#include "boost/format.hpp"
 
 #include "IECore/MessageHandler.h"
 #include "IECore/FileIndexedIO.h"
 
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <errno.h>
+#include <string.h>
+#endif
+
 #ifdef _WIN32
 #include <Windows.h>
 #include <tchar.h>
@@ -135,9 +145,23 @@ class FileIndexedIO::StreamFile : public StreamIndexedIO::StreamFile
 
 		void flush( size_t endPosition );
 
+		/// When the file is opened for reading, uses positional reads on a
+		/// dedicated file descriptor so that data can be read by many threads
+		/// at once without locking the stream. If the file was opened with the
+		/// MemoryMapped flag, the data is copied directly from the mapping instead.
+		virtual void readAt( char *buffer, size_t size, Imf::Int64 pos );
+
+	private :
+
+		void map();
+
+		int m_fd;
+		const char *m_mappedData;
+		size_t m_mappedSize;
+
 };
 
-FileIndexedIO::StreamFile::StreamFile( const std::string &filename, IndexedIO::OpenMode mode ) : StreamIndexedIO::StreamFile(mode), m_filename( filename ), m_endPosition(0)
+FileIndexedIO::StreamFile::StreamFile( const std::string &filename, IndexedIO::OpenMode mode ) : StreamIndexedIO::StreamFile(mode), m_filename( filename ), m_endPosition(0), m_fd( -1 ), m_mappedData( 0 ), m_mappedSize( 0 )
 {
 	if (mode & IndexedIO::Write)
 	{
@@ -212,9 +236,77 @@ FileIndexedIO::StreamFile::StreamFile( const std::string &filename, IndexedIO::O
 			throw IOException( "FileIndexedIO: Caught error reading file '" + filename + "'" );
 		}
 
+#ifndef _WIN32
+		// if this fails we simply fall back to the locking implementation in readAt()
+		m_fd = ::open( filename.c_str(), O_RDONLY );
+		if ( m_fd >= 0 && ( mode & IndexedIO::MemoryMapped ) )
+		{
+			map();
+		}
+#endif
 	}
 }
 
+void FileIndexedIO::StreamFile::map()
+{
+#ifndef _WIN32
+	struct stat s;
+	if ( fstat( m_fd, &s ) != 0 || s.st_size == 0 )
+	{
+		return;
+	}
+
+	void *data = mmap( 0, s.st_size, PROT_READ, MAP_SHARED, m_fd, 0 );
+	if ( data == MAP_FAILED )
+	{
+		msg( Msg::Warning, "FileIndexedIO::StreamFile", boost::format ( "Unable to map file '%s' into memory, falling back to regular reads: %s" ) % m_filename % strerror( errno ) );
+		return;
+	}
+
+	m_mappedData = static_cast<const char *>( data );
+	m_mappedSize = s.st_size;
+#endif
+}
+
+void FileIndexedIO::StreamFile::readAt( char *buffer, size_t size, Imf::Int64 pos )
+{
+#ifndef _WIN32
+	if ( m_mappedData )
+	{
+		if ( pos < 0 || (size_t)pos + size > m_mappedSize )
+		{
+			throw IOException( "FileIndexedIO: Unexpected end of file reading '" + m_filename + "'" );
+		}
+		memcpy( buffer, m_mappedData + pos, size );
+		return;
+	}
+	else if ( m_fd >= 0 )
+	{
+		while( size )
+		{
+			ssize_t n = ::pread( m_fd, buffer, size, pos );
+			if ( n < 0 )
+			{
+				if ( errno == EINTR )
+				{
+					continue;
+				}
+				throw IOException( ( boost::format( "FileIndexedIO: Error reading file '%s': %s" ) % m_filename % strerror( errno ) ).str() );
+			}
+			else if ( n == 0 )
+			{
+				throw IOException( "FileIndexedIO: Unexpected end of file reading '" + m_filename + "'" );
+			}
+			buffer += n;
+			size -= n;
+			pos += n;
+		}
+		return;
+	}
+#endif
+	StreamIndexedIO::StreamFile::readAt( buffer, size, pos );
+}
+
 void FileIndexedIO::StreamFile::flush( size_t endPosition )
 {
 	m_endPosition = endPosition;
@@ -222,7 +314,18 @@ void FileIndexedIO::StreamFile::flush( size_t endPosition )
 
 FileIndexedIO::StreamFile::~StreamFile()
 {
-	if ( m_openmode == IndexedIO::Write || m_openmode == IndexedIO::Append )
+#ifndef _WIN32
+	if ( m_mappedData )
+	{
+		munmap( const_cast<char *>( m_mappedData ), m_mappedSize );
+	}
+	if ( m_fd >= 0 )
+	{
+		::close( m_fd );
+	}
+#endif
+
+	if ( m_openmode & ( IndexedIO::Write | IndexedIO::Append ) )
 	{
 		std::fstream *f = static_cast< std::fstream * >( m_stream );
 
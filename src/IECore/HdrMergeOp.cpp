@@ -43,6 +43,9 @@
 
 #include <cassert>
 
+#include "tbb/parallel_for.h"
+#include "tbb/blocked_range.h"
+
 using namespace IECore;
 using namespace Imath;
 using namespace std;
@@ -149,64 +152,110 @@ const Box2fParameter * HdrMergeOp::windowingParameter() const
 	return m_windowingParameter;
 }
 
-template< typename T >
-inline void merge( bool firstImage, size_t &pixelCount,
-					const ImagePrimitive * img, ImagePrimitive * outImg,
-					const Imath::Box2f &windowing, float intensityMultiplier,
-					FloatVectorData * outR, FloatVectorData * outG, FloatVectorData * outB, FloatVectorData * outA )
+namespace
 {
 
-	const TypedData< std::vector< T > > *inR = img->getChannel< T >( "R" );
-	const TypedData< std::vector< T > > *inG = img->getChannel< T >( "G" );
-	const TypedData< std::vector< T > > *inB = img->getChannel< T >( "B" );
+struct MergeInput
+{
+	// Exactly one of the float and half channel sets is non-zero.
+	const float *floatRGB[3];
+	const half *halfRGB[3];
+	float intensityMultiplier;
+	bool firstImage;
+};
 
-	if ( firstImage )
-	{
-		pixelCount = inR->readable().size();
-		outR->writable().resize( pixelCount, 0 );
-		outG->writable().resize( pixelCount, 0 );
-		outB->writable().resize( pixelCount, 0 );
-		outA->writable().resize( pixelCount, 0 );
-		outImg->setDisplayWindow( img->getDisplayWindow() );
-		outImg->setDataWindow( img->getDataWindow() );
-	}
-	else
+template< typename T >
+inline void accumulate( const T * const *in, const MergeInput &input, const Imath::Box2f &windowing,
+	float * const *out, float *outA, size_t begin, size_t end )
+{
+	const T *inR = in[0], *inG = in[1], *inB = in[2];
+	float *outR = out[0], *outG = out[1], *outB = out[2];
+	for ( size_t i = begin; i < end; i++ )
 	{
-		if ( pixelCount != inR->readable().size() ||
-			 pixelCount != inG->readable().size() ||
-			 pixelCount != inB->readable().size() )
+		const float r = inR[i], g = inG[i], b = inB[i];
+		float intensity = (r + g + b) / 3.0f;
+		float weight = smoothstep( windowing.min[0], windowing.min[1], intensity );
+		if ( !input.firstImage )
 		{
-			throw Exception( "Images are not of the same resolution!!" );
+			weight *= 1.0f - smoothstep( windowing.max[0], windowing.max[1], intensity );
 		}
+		float m = weight * input.intensityMultiplier;
+		outR[i] += r * m;
+		outG[i] += g * m;
+		outB[i] += b * m;
+		outA[i] += weight;
 	}
+}
+
+// Merges all the input images for a block of pixels at a time, so that the
+// output values remain in cache while each image is accumulated, and then
+// normalises the block.
+class MergeBody
+{
+	public :
 
-	const T *ptrInR = &(inR->readable()[0]);
-	const T *ptrInG = &(inG->readable()[0]);
-	const T *ptrInB = &(inB->readable()[0]);
-	float *ptrOutR = &(outR->writable()[0]);
-	float *ptrOutG = &(outG->writable()[0]);
-	float *ptrOutB = &(outB->writable()[0]);
-	float *ptrOutA = &(outA->writable()[0]);
+		MergeBody( const std::vector<MergeInput> &inputs, const Imath::Box2f &windowing, float adjustment,
+			float *outR, float *outG, float *outB, float *outA )
+			:	m_inputs( inputs ), m_windowing( windowing ), m_adjustment( adjustment ), m_outA( outA )
+		{
+			m_outRGB[0] = outR;
+			m_outRGB[1] = outG;
+			m_outRGB[2] = outB;
+		}
+
+		void operator()( const tbb::blocked_range<size_t> &range ) const
+		{
+			for( std::vector<MergeInput>::const_iterator it = m_inputs.begin(); it != m_inputs.end(); ++it )
+			{
+				if( it->floatRGB[0] )
+				{
+					accumulate<float>( it->floatRGB, *it, m_windowing, m_outRGB, m_outA, range.begin(), range.end() );
+				}
+				else
+				{
+					accumulate<half>( it->halfRGB, *it, m_windowing, m_outRGB, m_outA, range.begin(), range.end() );
+				}
+			}
 
-	for ( size_t i = 0; i < pixelCount; i++ )
+			for ( size_t i = range.begin(); i < range.end(); i++ )
+			{
+				float w = m_adjustment * m_outA[i];
+				if ( w > 0 )
+				{
+					m_outRGB[0][i] /= w;
+					m_outRGB[1][i] /= w;
+					m_outRGB[2][i] /= w;
+				}
+			}
+		}
+
+	private :
+
+		const std::vector<MergeInput> &m_inputs;
+		Imath::Box2f m_windowing;
+		float m_adjustment;
+		float *m_outRGB[3];
+		float *m_outA;
+
+};
+
+template< typename T >
+inline void getChannels( const ImagePrimitive * img, size_t pixelCount, const T **rgb )
+{
+	const char *names[3] = { "R", "G", "B" };
+	for( int i = 0; i < 3; i++ )
 	{
-		float intensity = (*ptrInR + *ptrInG + *ptrInB) / 3.0;
-		float weight = smoothstep( windowing.min[0], windowing.min[1], intensity );
-		if ( !firstImage )
+		const std::vector<T> &channel = img->getChannel< T >( names[i] )->readable();
+		if( channel.size() != pixelCount )
 		{
-			weight *= 1.0f - smoothstep( windowing.max[0], windowing.max[1], intensity );
+			throw Exception( "Images are not of the same resolution!!" );
 		}
-		float m = weight * intensityMultiplier;
-		*ptrOutR += *ptrInR * m;
-		*ptrOutG += *ptrInG * m;
-		*ptrOutB += *ptrInB * m;
-		*ptrOutA += weight;
-
-		ptrInR++; ptrInG++; ptrInB++;
-		ptrOutR++; ptrOutG++; ptrOutB++; ptrOutA++;
+		rgb[i] = pixelCount ? &(channel[0]) : 0;
 	}
 }
 
+} // namespace
+
 ObjectPtr HdrMergeOp::doOperation( const CompoundObject * operands )
 {
 	Group *imageGroup = static_cast<Group *>( m_inputGroupParameter->getValue() );
@@ -252,43 +301,51 @@ ObjectPtr HdrMergeOp::doOperation( const CompoundObject * operands )
 	outImg->variables["B"] = PrimitiveVariable( PrimitiveVariable::Vertex, outB );
 	outImg->variables["A"] = PrimitiveVariable( PrimitiveVariable::Vertex, outA );
 
-	// loop over inputs accumulating them into the buffer
+	// gather the inputs, verifying their resolution.
 	int numInputs = images.size();
 
+	const ImagePrimitive *firstImg = staticPointerCast< ImagePrimitive >( images.front() ).get();
+	outImg->setDisplayWindow( firstImg->getDisplayWindow() );
+	outImg->setDataWindow( firstImg->getDataWindow() );
+	size_t pixelCount = firstImg->getChannel< float >( "R" ) ? firstImg->getChannel< float >( "R" )->readable().size() : firstImg->getChannel< half >( "R" )->readable().size();
+
 	float exposure = exposureStep * (numInputs-1)/2.0;
-	size_t pixelCount = 0;
+	std::vector<MergeInput> inputs;
 	bool firstImage = true;
 	for ( Group::ChildContainer::const_iterator it = images.begin(); it != images.end(); it++, firstImage = false )
 	{
-		const ImagePrimitive *img = staticPointerCast< ImagePrimitive >(*it);
-		float intensityMultiplier = pow( 2.0f, exposure );
+		const ImagePrimitive *img = staticPointerCast< ImagePrimitive >(*it).get();
+		MergeInput input;
+		input.floatRGB[0] = input.floatRGB[1] = input.floatRGB[2] = 0;
+		input.halfRGB[0] = input.halfRGB[1] = input.halfRGB[2] = 0;
 		if ( img->getChannel< float >( "R" ) )
 		{
-			merge< float >( firstImage, pixelCount, img, outImg, windowing, intensityMultiplier, outR, outG, outB, outA );
+			getChannels< float >( img, pixelCount, input.floatRGB );
 		}
 		else
 		{
-			merge< half >( firstImage, pixelCount, img, outImg, windowing, intensityMultiplier, outR, outG, outB, outA );
+			getChannels< half >( img, pixelCount, input.halfRGB );
 		}
+		input.intensityMultiplier = pow( 2.0f, exposure );
+		input.firstImage = firstImage;
+		inputs.push_back( input );
 		exposure -= exposureStep;
 	}
-	
-	// normalize the outputs
-	float adjustment = pow( 2.0f, -exposureAdjustment );
-	float *ptrOutR = &(outR->writable()[0]);
-	float *ptrOutG = &(outG->writable()[0]);
-	float *ptrOutB = &(outB->writable()[0]);
-	float *ptrOutA = &(outA->writable()[0]);
-
-	for ( size_t i = 0; i < pixelCount; i++ )
+
+	outR->writable().resize( pixelCount, 0 );
+	outG->writable().resize( pixelCount, 0 );
+	outB->writable().resize( pixelCount, 0 );
+	outA->writable().resize( pixelCount, 0 );
+
+	// accumulate the inputs into the buffers and normalize the outputs, in parallel over blocks of pixels.
+	if( pixelCount )
 	{
-		float w = adjustment * ptrOutA[i];
-		if ( w > 0 )
-		{
-			ptrOutR[i] /= w;
-			ptrOutG[i] /= w;
-			ptrOutB[i] /= w;
-		}
+		float adjustment = pow( 2.0f, -exposureAdjustment );
+		MergeBody body(
+			inputs, windowing, adjustment,
+			&(outR->writable()[0]), &(outG->writable()[0]), &(outB->writable()[0]), &(outA->writable()[0])
+		);
+		tbb::parallel_for( tbb::blocked_range<size_t>( 0, pixelCount, 4096 ), body );
 	}
 
 	return outImg;
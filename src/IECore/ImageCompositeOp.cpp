@@ -52,6 +52,9 @@
 
 #include "boost/format.hpp"
 
+#include "tbb/parallel_for.h"
+#include "tbb/blocked_range2d.h"
+
 using boost::str;
 using boost::format;
 
@@ -242,31 +245,133 @@ FloatVectorDataPtr ImageCompositeOp::getChannelData( ImagePrimitive * image, con
 		>( it->second.data, converter );
 }
 
-float ImageCompositeOp::readChannelData( const ImagePrimitive * image, const FloatVectorData * data, const V2i &pixel )
+// Composites all the channels of tiles of the output image. The inner loops operate on
+// contiguous rows of floats, so that the compositing function can be inlined.
+struct ImageCompositeOp::CompositeBody
 {
-	assert( image );
-	assert( data );
 
-	V2i offset = pixel - image->getDataWindow().min;
-	if ( offset.x < 0 || offset.y < 0 )
+	struct Inputs
 	{
-		return 0.0f;
-	}
+		// The data window of the output, which is also the data window of
+		// the (cropped) image B.
+		Box2i dataWindow;
+		Box2i aDataWindow;
+		std::vector<const float *> a;
+		std::vector<const float *> b;
+		std::vector<float *> out;
+		// May be 0, in which case an alpha of 1 is used.
+		const float *aAlpha;
+		const float *bAlpha;
+	};
 
-	const int width = image->getDataWindow().size().x + 1;
-	const int height = image->getDataWindow().size().y + 1;
+	template<CompositeFn fn>
+	struct StaticFn
+	{
+		inline float operator()( float aVal, float aAlpha, float bVal, float bAlpha ) const
+		{
+			return fn( aVal, aAlpha, bVal, bAlpha );
+		}
+	};
 
-	if ( offset.x >= width || offset.y >= height )
+	struct DynamicFn
 	{
-		return 0.0f;
-	}
+		DynamicFn( CompositeFn fn ) : m_fn( fn )
+		{
+		}
 
-	const int idx = offset.y * width + offset.x;
+		inline float operator()( float aVal, float aAlpha, float bVal, float bAlpha ) const
+		{
+			return m_fn( aVal, aAlpha, bVal, bAlpha );
+		}
 
-	assert( idx >= 0 );
-	assert( idx < (int)data->readable().size() );
-	return data->readable()[ idx ];
-}
+		CompositeFn m_fn;
+	};
+
+	template<typename F>
+	class Tiles
+	{
+
+		public :
+
+			Tiles( const Inputs &inputs, const F &f = F() )
+				:	m_inputs( inputs ), m_f( f )
+			{
+			}
+
+			void operator()( const tbb::blocked_range2d<int> &tile ) const
+			{
+				const Box2i &window = m_inputs.dataWindow;
+				const Box2i &aWindow = m_inputs.aDataWindow;
+				const int width = window.size().x + 1;
+				const int aWidth = aWindow.size().x + 1;
+
+				const int tileWidth = tile.cols().size();
+				std::vector<float> aRow( tileWidth );
+				std::vector<float> aAlphaRow( tileWidth );
+				std::vector<float> bAlphaRow( tileWidth, 1.0f );
+
+				for( int ty = tile.rows().begin(); ty != tile.rows().end(); ++ty )
+				{
+					const int y = ty + window.min.y;
+					const size_t offset = (size_t)ty * width + tile.cols().begin();
+
+					// find the span of this row of the tile which lies within image A,
+					// relative to the start of the tile.
+					const int x0 = window.min.x + tile.cols().begin();
+					int aBegin = std::max( aWindow.min.x - x0, 0 );
+					int aEnd = std::min( aWindow.max.x + 1 - x0, tileWidth );
+					size_t aOffset = 0;
+					if( y < aWindow.min.y || y > aWindow.max.y || aBegin >= aEnd )
+					{
+						aBegin = aEnd = 0;
+					}
+					else
+					{
+						aOffset = (size_t)( y - aWindow.min.y ) * aWidth + ( x0 + aBegin - aWindow.min.x );
+					}
+
+					readRow( m_inputs.aAlpha, aOffset, aBegin, aEnd, aAlphaRow );
+					if( m_inputs.bAlpha )
+					{
+						std::copy( m_inputs.bAlpha + offset, m_inputs.bAlpha + offset + tileWidth, bAlphaRow.begin() );
+					}
+
+					for( size_t c = 0; c < m_inputs.out.size(); ++c )
+					{
+						readRow( m_inputs.a[c], aOffset, aBegin, aEnd, aRow );
+						const float *b = m_inputs.b[c] + offset;
+						float *out = m_inputs.out[c] + offset;
+						for( int x = 0; x < tileWidth; ++x )
+						{
+							out[x] = m_f( aRow[x], aAlphaRow[x], b[x], bAlphaRow[x] );
+						}
+					}
+				}
+			}
+
+		private :
+
+			// Fills row with the values from data in the span [begin, end), and zero
+			// outside it. Data is 0 only for missing alpha channels, in which case
+			// the row is filled with 1.
+			void readRow( const float *data, size_t offset, int begin, int end, std::vector<float> &row ) const
+			{
+				if( !data )
+				{
+					std::fill( row.begin(), row.end(), 1.0f );
+					return;
+				}
+				std::fill( row.begin(), row.begin() + begin, 0.0f );
+				std::copy( data + offset, data + offset + ( end - begin ), row.begin() + begin );
+				std::fill( row.begin() + end, row.end(), 0.0f );
+			}
+
+			const Inputs &m_inputs;
+			F m_f;
+
+	};
+
+};
 
 void ImageCompositeOp::composite( CompositeFn fn, DataWindowResult dwr, ImagePrimitive * imageB, const CompoundObject * operands )
 {
@@ -363,6 +468,9 @@ void ImageCompositeOp::composite( CompositeFn fn, DataWindowResult dwr, ImagePri
 
 	assert( newArea == (int)imageB->variableSize( PrimitiveVariable::Vertex ) );
 
+	std::vector<ConstFloatVectorDataPtr> aChannels;
+	std::vector<ConstFloatVectorDataPtr> bChannels;
+	std::vector<FloatVectorDataPtr> newBChannels;
 	for( unsigned i=0; i<channelNames.size(); i++ )
 	{
 		const StringVectorParameter::ValueType::value_type &channelName = channelNames[i];
@@ -372,26 +480,59 @@ void ImageCompositeOp::composite( CompositeFn fn, DataWindowResult dwr, ImagePri
 		FloatVectorDataPtr bData = getChannelData( imageB, channelName );
 		assert( bData->readable().size() == imageB->variableSize( PrimitiveVariable::Vertex ) );
 		FloatVectorDataPtr newBData = new FloatVectorData();
-
 		newBData->writable().resize( newArea );
-		imageB->variables[ channelName ].data = newBData;
 
-		for ( int y = newDataWindow.min.y; y <= newDataWindow.max.y; y++ )
-		{
-			int offset = (y - newDataWindow.min.y ) * newWidth;
-			for ( int x = newDataWindow.min.x; x <= newDataWindow.max.x; x++, offset++ )
-			{
-				float aVal = readChannelData( imageA, aData, V2i( x, y ) );
-				float bVal = readChannelData( imageB, bData, V2i( x, y ) );
+		aChannels.push_back( aData );
+		bChannels.push_back( bData );
+		newBChannels.push_back( newBData );
+	}
 
-				float aAlpha = aAlphaData ? readChannelData( imageA, aAlphaData, V2i( x, y ) ) : 1.0f;
-				float bAlpha = bAlphaData ? readChannelData( imageB, bAlphaData, V2i( x, y ) ) : 1.0f;
+	for( unsigned i=0; i<channelNames.size(); i++ )
+	{
+		imageB->variables[ channelNames[i] ].data = newBChannels[i];
+	}
 
-				assert( offset >= 0 );
-				assert( offset < (int)newBData->readable().size() );
-				newBData->writable()[ offset  ] = fn( aVal, aAlpha, bVal, bAlpha );
-			}
-		}
+	if( newDataWindow.isEmpty() )
+	{
+		// there are no pixels to composite, and the channel data may be
+		// empty, so we mustn't take the addresses of its elements.
+		return;
+	}
+
+	CompositeBody::Inputs inputs;
+	inputs.dataWindow = newDataWindow;
+	inputs.aDataWindow = imageA->getDataWindow();
+	inputs.aAlpha = aAlphaData ? &(aAlphaData->readable()[0]) : 0;
+	inputs.bAlpha = bAlphaData ? &(bAlphaData->readable()[0]) : 0;
+	for( unsigned i=0; i<channelNames.size(); i++ )
+	{
+		inputs.a.push_back( &(aChannels[i]->readable()[0]) );
+		inputs.b.push_back( &(bChannels[i]->readable()[0]) );
+		inputs.out.push_back( &(newBChannels[i]->writable()[0]) );
+	}
+
+	// the standard operations are despatched to instantiations in which
+	// the compositing function can be inlined.
+	tbb::blocked_range2d<int> tiles( 0, newHeight, 64, 0, newWidth, 64 );
+	if( fn == compositeOver<float> )
+	{
+		tbb::parallel_for( tiles, CompositeBody::Tiles<CompositeBody::StaticFn<compositeOver<float> > >( inputs ) );
+	}
+	else if( fn == compositeMax<float> )
+	{
+		tbb::parallel_for( tiles, CompositeBody::Tiles<CompositeBody::StaticFn<compositeMax<float> > >( inputs ) );
+	}
+	else if( fn == compositeMin<float> )
+	{
+		tbb::parallel_for( tiles, CompositeBody::Tiles<CompositeBody::StaticFn<compositeMin<float> > >( inputs ) );
+	}
+	else if( fn == compositeMultiply<float> )
+	{
+		tbb::parallel_for( tiles, CompositeBody::Tiles<CompositeBody::StaticFn<compositeMultiply<float> > >( inputs ) );
+	}
+	else
+	{
+		tbb::parallel_for( tiles, CompositeBody::Tiles<CompositeBody::DynamicFn>( inputs, CompositeBody::DynamicFn( fn ) ) );
 	}
 
 	/// displayWindow should be unchanged
@@ -136,18 +136,20 @@ ObjectPtr ImageReader::doOperation( const CompoundObject *operands )
 	vector<string> channelNames;
 	channelsToRead( channelNames );
 
-	vector<string>::const_iterator ci = channelNames.begin();
-	while( ci != channelNames.end() )
+	vector<DataPtr> channels;
+	readChannels( channelNames, dataWind, rawChannels, channels );
+	assert( channels.size() == channelNames.size() );
+
+	for( size_t i = 0; i < channelNames.size(); i++ )
 	{
-		DataPtr d = readChannel( *ci, dataWind, rawChannels );
+		DataPtr d = channels[i];
 		assert( d  );
 		assert( rawChannels || d->typeId()==FloatVectorDataTypeId );
 
 		PrimitiveVariable p( PrimitiveVariable::Vertex, d );
 		assert( image->isPrimitiveVariableValid( p ) );
 
-		image->variables[*ci] = p;
-		ci++;
+		image->variables[channelNames[i]] = p;
 	}
 
 	if ( colorspace != "linear" && !rawChannels )
@@ -187,6 +189,16 @@ DataPtr ImageReader::readChannel( const std::string &name, bool raw )
 	return readChannel( name, d, raw );
 }
 
+void ImageReader::readChannels( const std::vector<std::string> &names, const Imath::Box2i &dataWindow, bool raw, std::vector<DataPtr> &channels )
+{
+	channels.clear();
+	channels.reserve( names.size() );
+	for( vector<string>::const_iterator it = names.begin(); it != names.end(); it++ )
+	{
+		channels.push_back( readChannel( *it, dataWindow, raw ) );
+	}
+}
+
 void ImageReader::channelsToRead( vector<string> &names )
 {
 	vector<string> allNames;
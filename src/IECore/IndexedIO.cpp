@@ -39,6 +39,7 @@
 
 #include "IECore/Exception.h"
 #include "IECore/IndexedIO.h"
+#include "IECore/MurmurHash.h"
 
 using namespace IECore;
 
@@ -88,6 +89,66 @@ IndexedIO::~IndexedIO()
 {
 }
 
+void IndexedIO::write(const IndexedIO::EntryID &name, const float *x, unsigned long arrayLength, const MurmurHash &hash)
+{
+	write( name, x, arrayLength );
+}
+
+void IndexedIO::write(const IndexedIO::EntryID &name, const double *x, unsigned long arrayLength, const MurmurHash &hash)
+{
+	write( name, x, arrayLength );
+}
+
+void IndexedIO::write(const IndexedIO::EntryID &name, const half *x, unsigned long arrayLength, const MurmurHash &hash)
+{
+	write( name, x, arrayLength );
+}
+
+void IndexedIO::write(const IndexedIO::EntryID &name, const int *x, unsigned long arrayLength, const MurmurHash &hash)
+{
+	write( name, x, arrayLength );
+}
+
+void IndexedIO::write(const IndexedIO::EntryID &name, const int64_t *x, unsigned long arrayLength, const MurmurHash &hash)
+{
+	write( name, x, arrayLength );
+}
+
+void IndexedIO::write(const IndexedIO::EntryID &name, const uint64_t *x, unsigned long arrayLength, const MurmurHash &hash)
+{
+	write( name, x, arrayLength );
+}
+
+void IndexedIO::write(const IndexedIO::EntryID &name, const unsigned int *x, unsigned long arrayLength, const MurmurHash &hash)
+{
+	write( name, x, arrayLength );
+}
+
+void IndexedIO::write(const IndexedIO::EntryID &name, const char *x, unsigned long arrayLength, const MurmurHash &hash)
+{
+	write( name, x, arrayLength );
+}
+
+void IndexedIO::write(const IndexedIO::EntryID &name, const unsigned char *x, unsigned long arrayLength, const MurmurHash &hash)
+{
+	write( name, x, arrayLength );
+}
+
+void IndexedIO::write(const IndexedIO::EntryID &name, const short *x, unsigned long arrayLength, const MurmurHash &hash)
+{
+	write( name, x, arrayLength );
+}
+
+void IndexedIO::write(const IndexedIO::EntryID &name, const unsigned short *x, unsigned long arrayLength, const MurmurHash &hash)
+{
+	write( name, x, arrayLength );
+}
+
+void IndexedIO::write(const IndexedIO::EntryID &name, const InternedString *x, unsigned long arrayLength, const MurmurHash &hash)
+{
+	write( name, x, arrayLength );
+}
+
 void IndexedIO::readable(const IndexedIO::EntryID &name) const
 {
 }
@@ -104,7 +165,7 @@ void IndexedIO::validateOpenMode(IndexedIO::OpenMode &mode)
 {
 	// Clear 'other' bits
 	mode &= IndexedIO::Read | IndexedIO::Write | IndexedIO::Append
-			| IndexedIO::Shared | IndexedIO::Exclusive;
+			| IndexedIO::Shared | IndexedIO::Exclusive | IndexedIO::MemoryMapped | IndexedIO::CompressedData;
 
 	// Check for mutual exclusivity
 	if ((mode & IndexedIO::Shared)
@@ -119,6 +180,12 @@ void IndexedIO::validateOpenMode(IndexedIO::OpenMode &mode)
 		throw InvalidArgumentException("Incorrect IndexedIO open mode specified");
 	}
 
+	if ((mode & IndexedIO::MemoryMapped)
+		&& (mode & (IndexedIO::Write | IndexedIO::Append)))
+	{
+		throw InvalidArgumentException("Incorrect IndexedIO open mode specified");
+	}
+
 	// Set up default as 'read'
 	if (!(mode & IndexedIO::Read
 		|| mode & IndexedIO::Write
@@ -33,11 +33,13 @@
 //////////////////////////////////////////////////////////////////////////
 
 #include <cassert>
+#include <algorithm>
 
-#include "tbb/mutex.h"
+#include "tbb/task_group.h"
 
 #include "boost/format.hpp"
 #include "boost/bind.hpp"
+#include "boost/filesystem/operations.hpp"
 
 #include "IECore/MessageHandler.h"
 #include "IECore/OversamplesCalculator.h"
@@ -46,7 +48,7 @@
 #include "IECore/CompoundObject.h"
 #include "IECore/FileSequence.h"
 #include "IECore/EmptyFrameList.h"
-#include "IECore/LRUCache.h"
+#include "IECore/ShardedLRUCache.h"
 
 using namespace IECore;
 using namespace boost;
@@ -60,8 +62,8 @@ class InterpolatedCache::Implementation : public IECore::RefCounted
 
 	public :
 	
-		Implementation( const std::string &pathTemplate, Interpolation interpolation, const OversamplesCalculator &o, size_t maxOpenFiles )
-			:	m_cachesForTicks( bind( &Implementation::cachesForTicksGetter, this, _1, _2 ), maxOpenFiles )
+		Implementation( const std::string &pathTemplate, Interpolation interpolation, const OversamplesCalculator &o, size_t maxOpenFiles, size_t maxMemory )
+			:	m_maxOpenFiles( maxOpenFiles ), m_cachesForTicks( bind( &Implementation::cachesForTicksGetter, this, _1, _2 ), maxMemory )
 		{
 			if( pathTemplate.size() )
 			{
@@ -70,9 +72,16 @@ class InterpolatedCache::Implementation : public IECore::RefCounted
 			setInterpolation( interpolation );
 			setOversamplesCalculator( o );
 		}
+
+		~Implementation()
+		{
+			// the prefetches reference our state, so must complete first.
+			waitForPrefetches();
+		}
 	
 		void setPathTemplate( const std::string &pathTemplate )
 		{
+			waitForPrefetches();
 			if ( !m_fileSequence || getPathTemplate() != pathTemplate )
 			{
 				m_fileSequence = new FileSequence( pathTemplate, new EmptyFrameList() );
@@ -93,16 +102,36 @@ class InterpolatedCache::Implementation : public IECore::RefCounted
 		
 		void setMaxOpenFiles( size_t maxOpenFiles )
 		{
-			m_cachesForTicks.setMaxCost( maxOpenFiles );
+			waitForPrefetches();
+			// the costs of the open files depend on the limit, so we
+			// must close them all rather than just trim the excess.
+			m_maxOpenFiles = maxOpenFiles;
+			m_cachesForTicks.clear();
 		}
-		
+
 		size_t getMaxOpenFiles() const
+		{
+			return m_maxOpenFiles;
+		}
+
+		void setMaxMemory( size_t maxMemory )
+		{
+			m_cachesForTicks.setMaxCost( maxMemory );
+		}
+		
+		size_t getMaxMemory() const
 		{
 			return m_cachesForTicks.getMaxCost();
 		}
+
+		size_t memoryUsage() const
+		{
+			return m_cachesForTicks.currentCost();
+		}
 	
 		void setInterpolation( Interpolation interpolation )
 		{
+			waitForPrefetches();
 			m_interpolation = interpolation;
 		}
 
@@ -113,6 +142,7 @@ class InterpolatedCache::Implementation : public IECore::RefCounted
 
 		void setOversamplesCalculator( const OversamplesCalculator &oc )
 		{
+			waitForPrefetches();
 			m_oversamplesCalculator = oc;
 		}
 
@@ -123,7 +153,7 @@ class InterpolatedCache::Implementation : public IECore::RefCounted
 
 		ObjectPtr read( float frame, const ObjectHandle &obj, const AttributeHandle &attr ) const
 		{
-			CacheAndMutexPtr c[4]; float x = 0;
+			AttributeCachePtr c[4]; float x = 0;
 			int numCaches = caches( frame, c, x );
 			
 			assert( numCaches );
@@ -132,8 +162,7 @@ class InterpolatedCache::Implementation : public IECore::RefCounted
 			for( int i=0; i<numCaches; i++ )
 			{
 				/// \todo Can we launch each of these reads in a separate thread?
-				CacheAndMutex::Mutex::scoped_lock lock( c[i]->mutex );
-				r[i] = c[i]->cache->read( obj, attr );
+				r[i] = c[i]->read( obj, attr );
 			}
 			
 			ObjectPtr result = 0;
@@ -184,15 +213,14 @@ class InterpolatedCache::Implementation : public IECore::RefCounted
 
 		ObjectPtr readHeader( float frame, const HeaderHandle &hdr ) const
 		{
-			CacheAndMutexPtr c[4]; float x = 0;
+			AttributeCachePtr c[4]; float x = 0;
 			int numCaches = caches( frame, c, x );
 			
 			ObjectPtr r[4];
 			for( int i=0; i<numCaches; i++ )
 			{
 				/// \todo Can we launch each of these reads in a separate thread?
-				CacheAndMutex::Mutex::scoped_lock lock( c[i]->mutex );
-				r[i] = c[i]->cache->readHeader( hdr );
+				r[i] = c[i]->readHeader( hdr );
 			}
 			
 			ObjectPtr result = 0;
@@ -243,56 +271,60 @@ class InterpolatedCache::Implementation : public IECore::RefCounted
 
 		void objects( float frame, std::vector<ObjectHandle> &objs ) const
 		{
-			CacheAndMutexPtr c[4]; float x = 0;
+			AttributeCachePtr c[4]; float x = 0;
 			int numCaches = caches( frame, c, x );
 			assert( numCaches ); (void)numCaches;
-			CacheAndMutex::Mutex::scoped_lock lock( c[0]->mutex );
-			c[0]->cache->objects( objs );
+			c[0]->objects( objs );
 		}
 
 		void attributes( float frame, const ObjectHandle &obj, std::vector<AttributeHandle> &attrs ) const
 		{
-			CacheAndMutexPtr c[4]; float x = 0;
+			AttributeCachePtr c[4]; float x = 0;
 			int numCaches = caches( frame, c, x );
 			assert( numCaches ); (void)numCaches;
-			CacheAndMutex::Mutex::scoped_lock lock( c[0]->mutex );
-			c[0]->cache->attributes( obj, attrs );
+			c[0]->attributes( obj, attrs );
 		}
 
 		void attributes( float frame, const ObjectHandle &obj, const std::string regex, std::vector<AttributeHandle> &attrs ) const
 		{
-			CacheAndMutexPtr c[4]; float x = 0;
+			AttributeCachePtr c[4]; float x = 0;
 			int numCaches = caches( frame, c, x );
 			assert( numCaches ); (void)numCaches;
-			CacheAndMutex::Mutex::scoped_lock lock( c[0]->mutex );
-			c[0]->cache->attributes( obj, regex, attrs );
+			c[0]->attributes( obj, regex, attrs );
 		}
 
 		void headers( float frame, std::vector<HeaderHandle> &hds ) const
 		{
-			CacheAndMutexPtr c[4]; float x = 0;
+			AttributeCachePtr c[4]; float x = 0;
 			int numCaches = caches( frame, c, x );
 			assert( numCaches ); (void)numCaches;
-			CacheAndMutex::Mutex::scoped_lock lock( c[0]->mutex );
-			c[0]->cache->headers( hds );
+			c[0]->headers( hds );
 		}
 		
 		bool contains( float frame, const ObjectHandle &obj ) const
 		{
-			CacheAndMutexPtr c[4]; float x = 0;
+			AttributeCachePtr c[4]; float x = 0;
 			int numCaches = caches( frame, c, x );
 			assert( numCaches ); (void)numCaches;
-			CacheAndMutex::Mutex::scoped_lock lock( c[0]->mutex );
-			return c[0]->cache->contains( obj );
+			return c[0]->contains( obj );
 		}
 		
 		bool contains( float frame, const ObjectHandle &obj, const AttributeHandle &attr ) const
 		{
-			CacheAndMutexPtr c[4]; float x = 0;
+			AttributeCachePtr c[4]; float x = 0;
 			int numCaches = caches( frame, c, x );
 			assert( numCaches ); (void)numCaches;
-			CacheAndMutex::Mutex::scoped_lock lock( c[0]->mutex );
-			return c[0]->cache->contains( obj, attr );
+			return c[0]->contains( obj, attr );
+		}
+
+		void prefetch( float frame, float step, int numFrames ) const
+		{
+			m_prefetches.run( boost::bind( &Implementation::prefetchWalk, this, frame, step, numFrames ) );
+		}
+
+		void waitForPrefetches() const
+		{
+			m_prefetches.wait();
 		}
 
 	private :
@@ -300,24 +332,14 @@ class InterpolatedCache::Implementation : public IECore::RefCounted
 		FileSequencePtr m_fileSequence;
 		Interpolation m_interpolation;
 		OversamplesCalculator m_oversamplesCalculator;
-			
-		// a class to store an AttributeCache and a mutex
-		// that must be used to access it.
-		class CacheAndMutex : public IECore::RefCounted
-		{
-			public :
+		size_t m_maxOpenFiles;
 
-				typedef tbb::mutex Mutex;
-				Mutex mutex;	
-				AttributeCachePtr cache;
-
-		};
-		
-		IE_CORE_DECLAREPTR( CacheAndMutex );
+		// an lru cache mapping from ticks to attribute caches. the files are opened
+		// read only, so the AttributeCaches can be read from concurrently without
+		// any further locking, and the cache is sharded so that concurrent lookups
+		// for different ticks don't contend.
 
-		// an lru cache mapping from ticks to attribute caches
-
-		CacheAndMutexPtr cachesForTicksGetter( const int &tick, size_t &cost )
+		AttributeCachePtr cachesForTicksGetter( const int &tick, size_t &cost )
 		{			
 			if( !m_fileSequence )
 			{
@@ -325,21 +347,27 @@ class InterpolatedCache::Implementation : public IECore::RefCounted
 			}
 			
 			std::string fileName = m_fileSequence->fileNameForFrame( tick );
-			CacheAndMutexPtr result = new CacheAndMutex;
-			result->cache = new AttributeCache( fileName, IndexedIO::Read );
+			AttributeCachePtr result = new AttributeCache( fileName, IndexedIO::Read );
+			// we cost each file at its size on disk, but at no less than an equal
+			// share of the memory limit, so that no more than m_maxOpenFiles are
+			// ever kept open.
+			const size_t maxMemory = m_cachesForTicks.getMaxCost();
+			const size_t minCost = m_maxOpenFiles ? maxMemory / m_maxOpenFiles : maxMemory + 1;
+			cost = std::max( (size_t)boost::filesystem::file_size( fileName ), minCost );
 			return result;
 		}
 		
-		typedef LRUCache<int, CacheAndMutexPtr> CachesForTicks;
+		typedef ShardedLRUCache<int, AttributeCachePtr> CachesForTicks;
 		mutable CachesForTicks m_cachesForTicks;
-		
-		// function to find the relevant caches for a given frame and return
-		// them along with an interpolation type and factor. returns the number
-		// of caches found. note that this may be 1 even if interpolation has
-		// been requested, as the frame may coincide directly with a file cache
-		// and not need interpolating.
-		
-		int caches( float frame, CacheAndMutexPtr c[4], float &interpolationFactor ) const
+
+		mutable tbb::task_group m_prefetches;
+
+		// function to find the ticks of the relevant caches for a given frame, along
+		// with an interpolation factor. returns the number of ticks found. note that
+		// this may be 1 even if interpolation has been requested, as the frame may
+		// coincide directly with a file cache and not need interpolating.
+
+		int ticks( float frame, int t[4], float &interpolationFactor ) const
 		{
 		
 			int lowTick, highTick;
@@ -373,17 +401,48 @@ class InterpolatedCache::Implementation : public IECore::RefCounted
 				}
 			}
 
-			int cacheIndex = 0;
-			for( int fileNum = start; fileNum <= end; fileNum++, cacheIndex++ )
+			int tickIndex = 0;
+			for( int fileNum = start; fileNum <= end; fileNum++, tickIndex++ )
 			{				
-				int tick = m_oversamplesCalculator.nearestTick(( int )( lowTick + fileNum * step ) );				
-				c[cacheIndex] = m_cachesForTicks.get( tick );
+				t[tickIndex] = m_oversamplesCalculator.nearestTick(( int )( lowTick + fileNum * step ) );
 			}
 
-			assert( cacheIndex );
-			return cacheIndex;
+			assert( tickIndex );
+			return tickIndex;
+		}
+
+		// function to find the relevant caches for a given frame and return
+		// them along with an interpolation factor. returns the number of caches
+		// found, as for ticks().
+
+		int caches( float frame, AttributeCachePtr c[4], float &interpolationFactor ) const
+		{
+			int t[4];
+			int numCaches = ticks( frame, t, interpolationFactor );
+			for( int i = 0; i < numCaches; i++ )
+			{
+				c[i] = m_cachesForTicks.get( t[i] );
+			}
+			return numCaches;
+		}
+
+		// runs in the background for prefetch(), opening the caches needed for
+		// each frame in turn so that they're ready by the time they're read.
+
+		void prefetchWalk( float frame, float step, int numFrames ) const
+		{
+			for( int i = 1; i <= numFrames; i++ )
+			{
+				int t[4]; float x = 0;
+				int numTicks = ticks( frame + i * step, t, x );
+				for( int j = 0; j < numTicks; j++ )
+				{
+					// failures aren't recorded by prefetch(), so any error
+					// will be reported by the read that needs the file.
+					m_cachesForTicks.prefetch( t[j] );
+				}
+			}
 		}
-	
 
 };
 
@@ -391,8 +450,8 @@ class InterpolatedCache::Implementation : public IECore::RefCounted
 // InterpolatedCache class
 //////////////////////////////////////////////////////////////////////////
 
-InterpolatedCache::InterpolatedCache( const std::string &pathTemplate, Interpolation interpolation,  const OversamplesCalculator &o, size_t maxOpenFiles )
-	:	m_implementation( new Implementation( pathTemplate, interpolation, o, maxOpenFiles ) )
+InterpolatedCache::InterpolatedCache( const std::string &pathTemplate, Interpolation interpolation,  const OversamplesCalculator &o, size_t maxOpenFiles, size_t maxMemory )
+	:	m_implementation( new Implementation( pathTemplate, interpolation, o, maxOpenFiles, maxMemory ) )
 {
 }
 
@@ -420,6 +479,21 @@ size_t InterpolatedCache::getMaxOpenFiles() const
 	return m_implementation->getMaxOpenFiles();
 }
 
+void InterpolatedCache::setMaxMemory( size_t maxMemory )
+{
+	m_implementation->setMaxMemory( maxMemory );
+}
+
+size_t InterpolatedCache::getMaxMemory() const
+{
+	return m_implementation->getMaxMemory();
+}
+
+size_t InterpolatedCache::memoryUsage() const
+{
+	return m_implementation->memoryUsage();
+}
+
 void InterpolatedCache::setInterpolation( InterpolatedCache::Interpolation interpolation )
 {
 	m_implementation->setInterpolation( interpolation );
@@ -489,3 +563,13 @@ bool InterpolatedCache::contains( float frame, const ObjectHandle &obj, const At
 {
 	return m_implementation->contains( frame, obj, attr );
 }
+
+void InterpolatedCache::prefetch( float frame, float step, int numFrames ) const
+{
+	m_implementation->prefetch( frame, step, numFrames );
+}
+
+void InterpolatedCache::waitForPrefetches() const
+{
+	m_implementation->waitForPrefetches();
+}
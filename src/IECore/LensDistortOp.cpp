@@ -34,6 +34,9 @@
 
 #include <cassert>
 
+#include "tbb/parallel_for.h"
+#include "tbb/blocked_range.h"
+
 #include "IECore/LensDistortOp.h"
 #include "IECore/LensModel.h"
 #include "IECore/FastFloat.h"
@@ -96,6 +99,40 @@ const ObjectParameter * LensDistortOp::lensParameter() const
 	return m_lensParameter;
 }
 
+// Computes the warped coordinates for a range of rows of the distorted data window.
+class LensDistortOp::CacheBuilder
+{
+	public :
+
+		CacheBuilder( const LensDistortOp *op, std::vector<float> &cache )
+			:	m_op( op ), m_cache( cache )
+		{
+		}
+
+		void operator()( const tbb::blocked_range<int> &rows ) const
+		{
+			const Imath::Box2i &window = m_op->m_distortedDataWindow;
+			const int width = window.size().x + 1;
+			for( int y = rows.begin(); y != rows.end(); ++y )
+			{
+				// We interleave the X and Y vector components within the cache.
+				float *pixel = &(m_cache[(size_t)( y - window.min.y ) * width * 2]);
+				for( int x = window.min.x; x <= window.max.x; ++x )
+				{
+					Imath::V2f inPos( m_op->m_mode == kDistort ? m_op->distort( Imath::V2f( x, y ) ) : m_op->undistort( Imath::V2f( x, y ) ) );
+					*pixel++ = inPos[0];
+					*pixel++ = inPos[1];
+				}
+			}
+		}
+
+	private :
+
+		const LensDistortOp *m_op;
+		std::vector<float> &m_cache;
+
+};
+
 void LensDistortOp::begin( const CompoundObject * operands )
 {
 	// Get the lens model parameters.
@@ -123,30 +160,7 @@ void LensDistortOp::begin( const CompoundObject * operands )
 	std::vector<float> &cache( cachePtr->writable() );
 	cache.resize( ( m_distortedDataWindow.size().x + 1 ) * ( m_distortedDataWindow.size().y + 1 ) * 2 ); // We interleave the X and Y vector components within the cache.
 
-	if ( m_mode == kDistort )
-	{
-		for( int y = m_distortedDataWindow.min.y, pixelIndex = 0; y <= m_distortedDataWindow.max.y; y++ )
-		{
-			for( int x = m_distortedDataWindow.min.x; x <= m_distortedDataWindow.max.x; x++ )
-			{
-				Imath::V2f inPos( distort( Imath::V2f( x, y ) ) );
-				cache[pixelIndex++] = inPos[0];
-				cache[pixelIndex++] = inPos[1];
-			}
-		}
-	}
-	else
-	{
-		for( int y = m_distortedDataWindow.min.y, pixelIndex = 0; y <= m_distortedDataWindow.max.y; y++ )
-		{
-			for( int x = m_distortedDataWindow.min.x; x <= m_distortedDataWindow.max.x; x++ )
-			{
-				Imath::V2f inPos( undistort( Imath::V2f( x, y ) ) );
-				cache[pixelIndex++] = inPos[0];
-				cache[pixelIndex++] = inPos[1];
-			}
-		}
-	}
+	tbb::parallel_for( tbb::blocked_range<int>( m_distortedDataWindow.min.y, m_distortedDataWindow.max.y + 1 ), CacheBuilder( this, cache ) );
 
 	m_cachePtr = cachePtr;
 }
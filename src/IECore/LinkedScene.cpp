@@ -930,6 +930,47 @@ void LinkedScene::writeObject( const Object *object, double time )
 	m_mainScene->writeObject(object,time);
 }
 
+void LinkedScene::hash( HashType hashType, double time, MurmurHash &h ) const
+{
+	switch( hashType )
+	{
+		case TransformHash :
+		case AttributesHash :
+			if ( m_linkedScene && !m_atLink )
+			{
+				if ( m_timeRemapped )
+				{
+					time = remappedLinkTime( time );
+				}
+				m_linkedScene->hash( hashType, time, h );
+			}
+			else
+			{
+				m_mainScene->hash( hashType, time, h );
+			}
+			break;
+		case BoundHash :
+		case ObjectHash :
+		case ChildNamesHash :
+			if ( m_linkedScene )
+			{
+				if ( m_timeRemapped )
+				{
+					time = remappedLinkTime( time );
+				}
+				m_linkedScene->hash( hashType, time, h );
+			}
+			else
+			{
+				m_mainScene->hash( hashType, time, h );
+			}
+			break;
+		default :
+			// the hierarchy may cross links, so we let the base class recurse through our own children.
+			SceneInterface::hash( hashType, time, h );
+	}
+}
+
 void LinkedScene::childNames( NameList &childNames ) const
 {
 	if ( m_linkedScene )
@@ -0,0 +1,357 @@
+//////////////////////////////////////////////////////////////////////////
+//
+//  Copyright (c) 2013, Image Engine Design Inc. All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are
+//  met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//
+//     * Neither the name of Image Engine Design nor the names of any
+//       other contributors to this software may be used to endorse or
+//       promote products derived from this software without specific prior
+//       written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+//  IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+//  THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+//  PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+//  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+//  EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+//  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+//  PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+//  LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+//  NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//////////////////////////////////////////////////////////////////////////
+
+#include <algorithm>
+#include <cstdlib>
+
+#include "boost/lexical_cast.hpp"
+
+#include "tbb/parallel_for.h"
+#include "tbb/parallel_sort.h"
+
+#include "IECore/Exception.h"
+#include "IECore/MeshAdjacency.h"
+#include "IECore/ShardedLRUCache.h"
+
+using namespace IECore;
+using namespace Imath;
+using namespace std;
+
+//////////////////////////////////////////////////////////////////////////
+// Internal utilities
+//////////////////////////////////////////////////////////////////////////
+
+namespace
+{
+
+struct EdgeLess
+{
+	bool operator()( const V2i &a, const V2i &b ) const
+	{
+		return a.x < b.x || ( a.x == b.x && a.y < b.y );
+	}
+};
+
+// Writes the edge from each face-vertex to the next one in the same face.
+class FaceEdges
+{
+
+	public :
+
+		FaceEdges( const vector<int> &faceOffsets, const vector<int> &vertexIds, vector<V2i> &edges )
+			:	m_faceOffsets( faceOffsets ), m_vertexIds( vertexIds ), m_edges( edges )
+		{
+		}
+
+		void operator()( const tbb::blocked_range<size_t> &r ) const
+		{
+			for( size_t f = r.begin(); f != r.end(); ++f )
+			{
+				const int begin = m_faceOffsets[f];
+				const int end = m_faceOffsets[f+1];
+				for( int i = begin; i < end; ++i )
+				{
+					const int v0 = m_vertexIds[i];
+					const int v1 = m_vertexIds[i + 1 < end ? i + 1 : begin];
+					m_edges[i] = V2i( std::min( v0, v1 ), std::max( v0, v1 ) );
+				}
+			}
+		}
+
+	private :
+
+		const vector<int> &m_faceOffsets;
+		const vector<int> &m_vertexIds;
+		vector<V2i> &m_edges;
+
+};
+
+// Throws if the topology can't be used to build a MeshAdjacency.
+void validateTopology( const vector<int> &verticesPerFace, const vector<int> &vertexIds, size_t numVertices )
+{
+	size_t numFaceVertices = 0;
+	for( vector<int>::const_iterator it = verticesPerFace.begin(); it != verticesPerFace.end(); ++it )
+	{
+		numFaceVertices += *it;
+	}
+
+	if( numFaceVertices != vertexIds.size() )
+	{
+		throw InvalidArgumentException( "MeshAdjacency : Sum of verticesPerFace does not match the number of vertexIds." );
+	}
+
+	for( vector<int>::const_iterator it = vertexIds.begin(); it != vertexIds.end(); ++it )
+	{
+		if( *it < 0 || (size_t)*it >= numVertices )
+		{
+			throw InvalidArgumentException( "MeshAdjacency : Vertex id out of range." );
+		}
+	}
+}
+
+// Conceptually the key for the cache is just the hash of the
+// topology, but the getter also needs the topology itself to build
+// the adjacency from. We therefore pass the topology as well as the
+// hash in the key, but never access it outside of the getter - as
+// there is no guarantee that it is alive outside of the call to
+// MeshAdjacency::cached().
+struct CacheKey
+{
+
+	CacheKey( const MurmurHash &h, const vector<int> *vpf, const vector<int> *vids, size_t nv )
+		:	hash( h ), verticesPerFace( vpf ), vertexIds( vids ), numVertices( nv )
+	{
+	}
+
+	bool operator == ( const CacheKey &other ) const
+	{
+		return hash == other.hash;
+	}
+
+	bool operator < ( const CacheKey &other ) const
+	{
+		return hash < other.hash;
+	}
+
+	MurmurHash hash;
+	const vector<int> *verticesPerFace;
+	const vector<int> *vertexIds;
+	size_t numVertices;
+
+};
+
+struct CacheKeyHashCompare
+{
+
+	size_t hash( const CacheKey &key ) const
+	{
+		return tbb_hasher( key.hash );
+	}
+
+	bool equal( const CacheKey &a, const CacheKey &b ) const
+	{
+		return a == b;
+	}
+
+};
+
+typedef ShardedLRUCache<CacheKey, ConstMeshAdjacencyPtr, CacheKeyHashCompare> AdjacencyCache;
+
+ConstMeshAdjacencyPtr getter( const CacheKey &key, size_t &cost )
+{
+	ConstMeshAdjacencyPtr result = new MeshAdjacency( *key.verticesPerFace, *key.vertexIds, key.numVertices );
+	cost = result->memoryUsage();
+	return result;
+}
+
+AdjacencyCache *createAdjacencyCache()
+{
+	const char *m = getenv( "IECORE_MESHADJACENCY_MEMORY" );
+	size_t mi = m ? boost::lexical_cast<size_t>( m ) : 500;
+	return new AdjacencyCache( getter, 1024 * 1024 * mi );
+}
+
+// the cache is created at load time, so that concurrent
+// calls to adjacencyCache() don't race to create it.
+AdjacencyCache *g_adjacencyCache = createAdjacencyCache();
+
+AdjacencyCache &adjacencyCache()
+{
+	return *g_adjacencyCache;
+}
+
+} // namespace
+
+//////////////////////////////////////////////////////////////////////////
+// MeshAdjacency
+//////////////////////////////////////////////////////////////////////////
+
+MeshAdjacency::MeshAdjacency( const std::vector<int> &verticesPerFace, const std::vector<int> &vertexIds, size_t numVertices )
+	:	m_numVertices( numVertices )
+{
+	validateTopology( verticesPerFace, vertexIds, numVertices );
+
+	const size_t numFaces = verticesPerFace.size();
+	const size_t numFaceVertices = vertexIds.size();
+
+	m_faceOffsets.resize( numFaces + 1 );
+	m_faceOffsets[0] = 0;
+	for( size_t f = 0; f < numFaces; ++f )
+	{
+		m_faceOffsets[f+1] = m_faceOffsets[f] + verticesPerFace[f];
+	}
+
+	// count the uses of each vertex, and turn the counts into offsets.
+	m_vertexFaceOffsets.resize( numVertices + 1, 0 );
+	for( size_t i = 0; i < numFaceVertices; ++i )
+	{
+		m_vertexFaceOffsets[vertexIds[i]+1]++;
+	}
+	for( size_t v = 0; v < numVertices; ++v )
+	{
+		m_vertexFaceOffsets[v+1] += m_vertexFaceOffsets[v];
+	}
+
+	// fill in the faces for each vertex. we visit the faces in order so that
+	// the faces for each vertex come out sorted, which means that gathering
+	// over them accumulates in the same order as a serial loop over the faces.
+	m_vertexFaces.resize( numFaceVertices );
+	m_vertexFaceVertices.resize( numFaceVertices );
+	vector<int> cursor( m_vertexFaceOffsets.begin(), m_vertexFaceOffsets.end() - 1 );
+	for( size_t f = 0; f < numFaces; ++f )
+	{
+		for( int i = m_faceOffsets[f]; i < m_faceOffsets[f+1]; ++i )
+		{
+			const int c = cursor[vertexIds[i]]++;
+			m_vertexFaces[c] = f;
+			m_vertexFaceVertices[c] = i;
+		}
+	}
+
+	// the edges aren't needed by most clients, so they
+	// are only computed on demand by edges().
+	m_edgesComputed = false;
+}
+
+MeshAdjacency::~MeshAdjacency()
+{
+}
+
+size_t MeshAdjacency::numFaces() const
+{
+	return m_faceOffsets.size() - 1;
+}
+
+size_t MeshAdjacency::numVertices() const
+{
+	return m_numVertices;
+}
+
+const std::vector<int> &MeshAdjacency::faceOffsets() const
+{
+	return m_faceOffsets;
+}
+
+const std::vector<int> &MeshAdjacency::vertexFaceOffsets() const
+{
+	return m_vertexFaceOffsets;
+}
+
+const std::vector<int> &MeshAdjacency::vertexFaces() const
+{
+	return m_vertexFaces;
+}
+
+const std::vector<int> &MeshAdjacency::vertexFaceVertices() const
+{
+	return m_vertexFaceVertices;
+}
+
+const std::vector<Imath::V2i> &MeshAdjacency::edges() const
+{
+	if( m_edgesComputed )
+	{
+		return m_edges;
+	}
+
+	// we compute the edges without holding the lock, because waiting for the
+	// parallel loops below may cause this thread to pick up another task which
+	// calls edges() on this adjacency, and would deadlock on the mutex.
+	// concurrent first calls may therefore compute the edges more than once,
+	// but only the first result is kept.
+
+	// recover the vertex ids from the vertex to face-vertex adjacency,
+	// so that we don't need to keep a reference to the topology.
+	vector<int> vertexIds( m_vertexFaceVertices.size() );
+	for( size_t v = 0; v < m_numVertices; ++v )
+	{
+		for( int i = m_vertexFaceOffsets[v]; i < m_vertexFaceOffsets[v+1]; ++i )
+		{
+			vertexIds[m_vertexFaceVertices[i]] = v;
+		}
+	}
+
+	// gather every face edge, then sort and remove the duplicates
+	// from edges shared between faces.
+	vector<V2i> edges( vertexIds.size() );
+	tbb::parallel_for( tbb::blocked_range<size_t>( 0, numFaces(), 1000 ), FaceEdges( m_faceOffsets, vertexIds, edges ) );
+	tbb::parallel_sort( edges.begin(), edges.end(), EdgeLess() );
+	edges.erase( std::unique( edges.begin(), edges.end() ), edges.end() );
+
+	tbb::mutex::scoped_lock lock( m_edgesMutex );
+	if( !m_edgesComputed )
+	{
+		vector<V2i>( edges ).swap( m_edges );
+		m_edgesComputed = true;
+	}
+	return m_edges;
+}
+
+size_t MeshAdjacency::memoryUsage() const
+{
+	tbb::mutex::scoped_lock lock( m_edgesMutex );
+	return sizeof( MeshAdjacency ) +
+		( m_faceOffsets.capacity() + m_vertexFaceOffsets.capacity() + m_vertexFaces.capacity() + m_vertexFaceVertices.capacity() ) * sizeof( int ) +
+		m_edges.capacity() * sizeof( V2i );
+}
+
+void MeshAdjacency::setCacheMemoryLimit( size_t bytes )
+{
+	adjacencyCache().setMaxCost( bytes );
+}
+
+size_t MeshAdjacency::getCacheMemoryLimit()
+{
+	return adjacencyCache().getMaxCost();
+}
+
+size_t MeshAdjacency::cacheMemoryUsage()
+{
+	return adjacencyCache().currentCost();
+}
+
+void MeshAdjacency::clearCache()
+{
+	adjacencyCache().clear();
+}
+
+ConstMeshAdjacencyPtr MeshAdjacency::cached( const MurmurHash &topologyHash, const std::vector<int> &verticesPerFace, const std::vector<int> &vertexIds, size_t numVertices )
+{
+	// we validate before going to the cache, because the cache would
+	// record a failure in the getter and report it for all subsequent
+	// calls, rather than the InvalidArgumentException the constructor
+	// throws.
+	validateTopology( verticesPerFace, vertexIds, numVertices );
+	return adjacencyCache().get( CacheKey( topologyHash, &verticesPerFace, &vertexIds, numVertices ) );
+}
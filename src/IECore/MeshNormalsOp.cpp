@@ -33,11 +33,14 @@
 //////////////////////////////////////////////////////////////////////////
 
 #include "IECore/MeshNormalsOp.h"
+#include "IECore/MeshAdjacency.h"
 #include "IECore/DespatchTypedData.h"
 #include "IECore/CompoundParameter.h"
 
 #include "boost/format.hpp"
 
+#include "tbb/parallel_for.h"
+
 using namespace IECore;
 using namespace std;
 
@@ -87,12 +90,89 @@ const StringParameter * MeshNormalsOp::nPrimVarNameParameter() const
 	return parameters()->parameter<StringParameter>( "nPrimVarName" );
 }
 
+namespace
+{
+
+template<typename Vec>
+class FaceNormals
+{
+
+	public :
+
+		FaceNormals( const vector<Vec> &points, const vector<int> &vertIds, const vector<int> &faceOffsets, vector<Vec> &faceNormals )
+			:	m_points( points ), m_vertIds( vertIds ), m_faceOffsets( faceOffsets ), m_faceNormals( faceNormals )
+		{
+		}
+
+		void operator()( const tbb::blocked_range<size_t> &r ) const
+		{
+			for( size_t f = r.begin(); f != r.end(); ++f )
+			{
+				const int *vertId = &(m_vertIds[m_faceOffsets[f]]);
+				const Vec &p0 = m_points[*vertId];
+				const Vec &p1 = m_points[*(vertId+1)];
+				const Vec &p2 = m_points[*(vertId+2)];
+
+				Vec normal = (p2-p1).cross(p0-p1);
+				normal.normalize();
+				m_faceNormals[f] = normal;
+			}
+		}
+
+	private :
+
+		const vector<Vec> &m_points;
+		const vector<int> &m_vertIds;
+		const vector<int> &m_faceOffsets;
+		vector<Vec> &m_faceNormals;
+
+};
+
+// Sums the normals of the faces using each vertex. The adjacency lists
+// the faces in increasing order, so the sums are identical to those from
+// accumulating the face normals onto the vertices in a serial loop.
+template<typename Vec>
+class VertexNormals
+{
+
+	public :
+
+		VertexNormals( const vector<Vec> &faceNormals, const MeshAdjacency *adjacency, vector<Vec> &normals )
+			:	m_faceNormals( faceNormals ), m_vertexFaceOffsets( adjacency->vertexFaceOffsets() ), m_vertexFaces( adjacency->vertexFaces() ), m_normals( normals )
+		{
+		}
+
+		void operator()( const tbb::blocked_range<size_t> &r ) const
+		{
+			for( size_t v = r.begin(); v != r.end(); ++v )
+			{
+				Vec normal( 0 );
+				for( int i = m_vertexFaceOffsets[v]; i < m_vertexFaceOffsets[v+1]; ++i )
+				{
+					normal += m_faceNormals[m_vertexFaces[i]];
+				}
+				normal.normalize();
+				m_normals[v] = normal;
+			}
+		}
+
+	private :
+
+		const vector<Vec> &m_faceNormals;
+		const vector<int> &m_vertexFaceOffsets;
+		const vector<int> &m_vertexFaces;
+		vector<Vec> &m_normals;
+
+};
+
+} // namespace
+
 struct MeshNormalsOp::CalculateNormals
 {
 	typedef DataPtr ReturnType;
 
-	CalculateNormals( const IntVectorData * vertsPerFace, const IntVectorData * vertIds )
-		:	m_vertsPerFace( vertsPerFace ), m_vertIds( vertIds )
+	CalculateNormals( const IntVectorData * vertIds, ConstMeshAdjacencyPtr adjacency )
+		:	m_vertIds( vertIds ), m_adjacency( adjacency )
 	{
 	}
 
@@ -103,7 +183,6 @@ struct MeshNormalsOp::CalculateNormals
 		typedef typename VecContainer::value_type Vec;
 
 		const typename T::ValueType &points = data->readable();
-		const vector<int> &vertsPerFace = m_vertsPerFace->readable();
 		const vector<int> &vertIds = m_vertIds->readable();
 
 		typename T::Ptr normalsData = new T;
@@ -111,37 +190,26 @@ struct MeshNormalsOp::CalculateNormals
 		VecContainer &normals = normalsData->writable();
 		normals.resize( points.size(), Vec( 0 ) );
 
-		// for each face, calculate its normal, and accumulate that normal onto
-		// the normal for each of its vertices.
-		const int *vertId = &(vertIds[0]);
-		for( vector<int>::const_iterator it = vertsPerFace.begin(); it!=vertsPerFace.end(); it++ )
-		{
-			const Vec &p0 = points[*vertId];
-			const Vec &p1 = points[*(vertId+1)];
-			const Vec &p2 = points[*(vertId+2)];
-
-			Vec normal = (p2-p1).cross(p0-p1);
-			normal.normalize();
-			for( int i=0; i<*it; i++ )
-			{
-				normals[*vertId] += normal;
-				vertId++;
-			}
-		}
+		// calculate the normal for each face, then sum the face
+		// normals for each vertex.
+		VecContainer faceNormals( m_adjacency->numFaces() );
+		tbb::parallel_for(
+			tbb::blocked_range<size_t>( 0, faceNormals.size(), 1000 ),
+			FaceNormals<Vec>( points, vertIds, m_adjacency->faceOffsets(), faceNormals )
+		);
 
-		// normalize each of the vertex normals
-		for( typename VecContainer::iterator it=normals.begin(); it!=normals.end(); it++ )
-		{
-			it->normalize();
-		}
+		tbb::parallel_for(
+			tbb::blocked_range<size_t>( 0, std::min( normals.size(), m_adjacency->numVertices() ), 1000 ),
+			VertexNormals<Vec>( faceNormals, m_adjacency.get(), normals )
+		);
 
 		return normalsData;
 	}
 
 	private :
 
-		ConstIntVectorDataPtr m_vertsPerFace;
 		ConstIntVectorDataPtr m_vertIds;
+		ConstMeshAdjacencyPtr m_adjacency;
 
 };
 
@@ -171,7 +239,7 @@ void MeshNormalsOp::modifyTypedPrimitive( MeshPrimitive * mesh, const CompoundOb
 		throw InvalidArgumentException( e );
 	}
 
-	CalculateNormals f( mesh->verticesPerFace(), mesh->vertexIds() );
+	CalculateNormals f( mesh->vertexIds(), mesh->adjacency() );
 	DataPtr n = despatchTypedData<CalculateNormals, TypeTraits::IsVec3VectorTypedData, HandleErrors>( pvIt->second.data, f );
 
 	mesh->variables[ nPrimVarNameParameter()->getTypedValue() ] = PrimitiveVariable( PrimitiveVariable::Vertex, n );
@@ -36,6 +36,7 @@
 #include <numeric>
 
 #include "IECore/MeshPrimitive.h"
+#include "IECore/MeshAdjacency.h"
 #include "IECore/Renderer.h"
 #include "IECore/PolygonIterator.h"
 #include "IECore/MurmurHash.h"
@@ -181,6 +182,15 @@ void MeshPrimitive::setInterpolation( const std::string &interpolation )
 	m_interpolation = interpolation;
 }
 
+ConstMeshAdjacencyPtr MeshPrimitive::adjacency() const
+{
+	MurmurHash h;
+	m_verticesPerFace->hash( h );
+	m_vertexIds->hash( h );
+	h.append( (uint64_t)m_numVertices );
+	return MeshAdjacency::cached( h, m_verticesPerFace->readable(), m_vertexIds->readable(), m_numVertices );
+}
+
 PolygonIterator MeshPrimitive::faceBegin()
 {
 	return PolygonIterator( m_verticesPerFace->readable().begin(), m_vertexIds->readable().begin(), 0 );
@@ -223,8 +233,9 @@ void MeshPrimitive::copyFrom( const Object *other, IECore::Object::CopyContext *
 {
 	Primitive::copyFrom( other, context );
 	const MeshPrimitive *tOther = static_cast<const MeshPrimitive *>( other );
-	m_verticesPerFace = tOther->m_verticesPerFace->copy();
-	m_vertexIds = tOther->m_vertexIds->copy();
+	// the topology is never modified in place, so can be shared with the original
+	m_verticesPerFace = tOther->m_verticesPerFace;
+	m_vertexIds = tOther->m_vertexIds;
 	m_numVertices = tOther->m_numVertices;
 	m_interpolation = tOther->m_interpolation;
 }
@@ -34,6 +34,9 @@
 
 #include <cassert>
 
+#include "tbb/parallel_for.h"
+#include "tbb/blocked_range.h"
+
 #include "OpenEXR/ImathBoxAlgo.h"
 #include "OpenEXR/ImathLineAlgo.h"
 #include "OpenEXR/ImathMatrix.h"
@@ -205,7 +208,7 @@ const V3i &MeshPrimitiveEvaluator::Result::vertexIds() const
 	return m_vertexIds;
 }
 
-MeshPrimitiveEvaluator::MeshPrimitiveEvaluator( ConstMeshPrimitivePtr mesh ) : m_uvTree(0), m_haveMassProperties( false ), m_haveSurfaceArea( false ), m_haveAverageNormals( false )
+MeshPrimitiveEvaluator::MeshPrimitiveEvaluator( ConstMeshPrimitivePtr mesh, RayAccelerator rayAccelerator ) : m_uvTree(0), m_bvh(0), m_haveMassProperties( false ), m_haveSurfaceArea( false ), m_haveAverageNormals( false )
 {
 	if (! mesh )
 	{
@@ -305,6 +308,11 @@ MeshPrimitiveEvaluator::MeshPrimitiveEvaluator( ConstMeshPrimitivePtr mesh ) : m
 	{
 		m_uvTree = 0;
 	}
+
+	if( rayAccelerator == BVHRayAccelerator )
+	{
+		m_bvh = new BoundingVolumeHierarchy( m_triangles );
+	}
 }
 
 PrimitiveEvaluatorPtr MeshPrimitiveEvaluator::create( ConstPrimitivePtr primitive )
@@ -324,6 +332,9 @@ MeshPrimitiveEvaluator::~MeshPrimitiveEvaluator()
 
 	delete m_uvTree;
 	m_uvTree = 0;
+
+	delete m_bvh;
+	m_bvh = 0;
 }
 
 ConstPrimitivePtr MeshPrimitiveEvaluator::primitive() const
@@ -656,13 +667,15 @@ bool MeshPrimitiveEvaluator::signedDistance( const Imath::V3f &p, float &distanc
 		calculateAverageNormals();
 	}
 
-	ResultPtr result = new Result();
+	// a local result avoids a heap allocation per query, which
+	// matters when many queries are made in parallel.
+	Result result;
 
-	bool found = closestPoint( p, result );
+	bool found = closestPoint( p, &result );
 
 	if (found)
 	{
-		const Imath::V3f &bary = result->barycentricCoordinates();
+		const Imath::V3f &bary = result.barycentricCoordinates();
 
 		/// Is nearest feature an edge, or the triangle itself?
 
@@ -671,17 +684,17 @@ bool MeshPrimitiveEvaluator::signedDistance( const Imath::V3f &p, float &distanc
 		if ( region == 0  )
 		{
 			assert( region == 0 );
-			const Imath::V3f &n = result->normal();
-			float planeConstant = n.dot( result->point() );
+			const Imath::V3f &n = result.normal();
+			float planeConstant = n.dot( result.point() );
 			float sign = n.dot( p ) - planeConstant;
-			distance = (result->point() - p ).length() * (sign < Imath::limits<float>::epsilon() ? -1.0 : 1.0 );
+			distance = (result.point() - p ).length() * (sign < Imath::limits<float>::epsilon() ? -1.0 : 1.0 );
 			return true;
 		}
 		else  if ( region % 2 == 1 )
 		{
 			// Closest feature is an edge, so we need to use the average normal of the adjoining triangles
 
-			const V3i &triangleVertexIds = result->vertexIds();
+			const V3i &triangleVertexIds = result.vertexIds();
 			Edge edge;
 
 			if ( region == 1 )
@@ -702,9 +715,9 @@ bool MeshPrimitiveEvaluator::signedDistance( const Imath::V3f &p, float &distanc
 			assert (it != m_edgeAverageNormals.end() );
 
 			const Imath::V3f &n = it->second;
-			float planeConstant = n.dot( result->point() );
+			float planeConstant = n.dot( result.point() );
 			float sign = n.dot( p ) - planeConstant;
-			distance = (result->point() - p ).length() * (sign < Imath::limits<float>::epsilon() ? -1.0 : 1.0 );
+			distance = (result.point() - p ).length() * (sign < Imath::limits<float>::epsilon() ? -1.0 : 1.0 );
 			return true;
 		}
 		else
@@ -712,7 +725,7 @@ bool MeshPrimitiveEvaluator::signedDistance( const Imath::V3f &p, float &distanc
 			// Closest feature is a vertex, so we need to use the angle weighted normal of the adjoining triangles
 			assert( region % 2 == 0 );
 
-			const V3i &triangleVertexIds = result->vertexIds();
+			const V3i &triangleVertexIds = result.vertexIds();
 
 			int closestVertex = 1;
 			if ( region == 2 )
@@ -732,9 +745,9 @@ bool MeshPrimitiveEvaluator::signedDistance( const Imath::V3f &p, float &distanc
 			assert( triangleVertexIds[ closestVertex ] < (int)(m_vertexAngleWeightedNormals->readable().size()) );
 
 			const V3f &n = m_vertexAngleWeightedNormals->readable()[ triangleVertexIds[ closestVertex ] ];
-			float planeConstant = n.dot( result->point() );
+			float planeConstant = n.dot( result.point() );
 			float sign = n.dot( p ) - planeConstant;
-			distance = (result->point() - p ).length() * (sign < Imath::limits<float>::epsilon() ? -1.0 : 1.0 );
+			distance = (result.point() - p ).length() * (sign < Imath::limits<float>::epsilon() ? -1.0 : 1.0 );
 			return true;
 		}
 	}
@@ -744,6 +757,136 @@ bool MeshPrimitiveEvaluator::signedDistance( const Imath::V3f &p, float &distanc
 	}
 }
 
+namespace
+{
+
+class ClosestPointsBody
+{
+	public :
+
+		ClosestPointsBody( const MeshPrimitiveEvaluator &evaluator, const std::vector<V3f> &points, std::vector<V3f> *positions,
+			std::vector<V3f> *normals, std::vector<V2f> *uvs, std::vector<unsigned> *triangleIndices, std::vector<V3f> *barycentricCoordinates )
+			:	m_evaluator( evaluator ), m_points( points ), m_positions( positions ), m_normals( normals ), m_uvs( uvs ),
+				m_triangleIndices( triangleIndices ), m_barycentricCoordinates( barycentricCoordinates ), m_haveUVs( evaluator.uvBounds() != 0 )
+		{
+		}
+
+		void operator()( const tbb::blocked_range<size_t> &range ) const
+		{
+			MeshPrimitiveEvaluator::Result result;
+			for( size_t i = range.begin(); i != range.end(); ++i )
+			{
+				m_evaluator.closestPoint( m_points[i], &result );
+				if( m_positions )
+				{
+					(*m_positions)[i] = result.point();
+				}
+				if( m_normals )
+				{
+					(*m_normals)[i] = result.normal();
+				}
+				if( m_uvs )
+				{
+					(*m_uvs)[i] = m_haveUVs ? result.uv() : V2f( 0 );
+				}
+				if( m_triangleIndices )
+				{
+					(*m_triangleIndices)[i] = result.triangleIndex();
+				}
+				if( m_barycentricCoordinates )
+				{
+					(*m_barycentricCoordinates)[i] = result.barycentricCoordinates();
+				}
+			}
+		}
+
+	private :
+
+		const MeshPrimitiveEvaluator &m_evaluator;
+		const std::vector<V3f> &m_points;
+		std::vector<V3f> *m_positions;
+		std::vector<V3f> *m_normals;
+		std::vector<V2f> *m_uvs;
+		std::vector<unsigned> *m_triangleIndices;
+		std::vector<V3f> *m_barycentricCoordinates;
+		bool m_haveUVs;
+
+};
+
+class SignedDistancesBody
+{
+	public :
+
+		SignedDistancesBody( const MeshPrimitiveEvaluator &evaluator, const std::vector<V3f> &points, std::vector<float> &distances )
+			:	m_evaluator( evaluator ), m_points( points ), m_distances( distances )
+		{
+		}
+
+		void operator()( const tbb::blocked_range<size_t> &range ) const
+		{
+			for( size_t i = range.begin(); i != range.end(); ++i )
+			{
+				m_evaluator.signedDistance( m_points[i], m_distances[i] );
+			}
+		}
+
+	private :
+
+		const MeshPrimitiveEvaluator &m_evaluator;
+		const std::vector<V3f> &m_points;
+		std::vector<float> &m_distances;
+
+};
+
+template<typename T>
+void resizeOutput( std::vector<T> *output, size_t size )
+{
+	if( output )
+	{
+		output->resize( size );
+	}
+}
+
+} // namespace
+
+bool MeshPrimitiveEvaluator::closestPoints( const std::vector<V3f> &points, std::vector<V3f> *positions,
+	std::vector<V3f> *normals, std::vector<V2f> *uvs, std::vector<unsigned> *triangleIndices, std::vector<V3f> *barycentricCoordinates ) const
+{
+	if( m_triangles.size() == 0 )
+	{
+		return false;
+	}
+
+	resizeOutput( positions, points.size() );
+	resizeOutput( normals, points.size() );
+	resizeOutput( uvs, points.size() );
+	resizeOutput( triangleIndices, points.size() );
+	resizeOutput( barycentricCoordinates, points.size() );
+
+	ClosestPointsBody body( *this, points, positions, normals, uvs, triangleIndices, barycentricCoordinates );
+	tbb::parallel_for( tbb::blocked_range<size_t>( 0, points.size(), 64 ), body );
+
+	return true;
+}
+
+bool MeshPrimitiveEvaluator::signedDistances( const std::vector<V3f> &points, std::vector<float> &distances ) const
+{
+	if( m_triangles.size() == 0 )
+	{
+		return false;
+	}
+
+	// compute these once up front rather than having every
+	// thread wait for them on its first query.
+	calculateAverageNormals();
+
+	distances.resize( points.size() );
+	SignedDistancesBody body( *this, points, distances );
+	tbb::parallel_for( tbb::blocked_range<size_t>( 0, points.size(), 64 ), body );
+
+	return true;
+}
+
 PrimitiveEvaluator::ResultPtr MeshPrimitiveEvaluator::createResult() const
 {
       return new Result();
@@ -792,6 +935,109 @@ bool MeshPrimitiveEvaluator::pointAtUV( const Imath::V2f &uv, PrimitiveEvaluator
 	return pointAtUVWalk( m_uvTree->rootIndex(), uv, mr );
 }
 
+class MeshPrimitiveEvaluator::ClosestIntersector
+{
+	public :
+
+		ClosestIntersector( const MeshPrimitiveEvaluator *evaluator, const Imath::Line3f &ray )
+			:	m_evaluator( evaluator ), m_ray( ray ), m_hit( false ), m_triangleIndex( 0 )
+		{
+		}
+
+		void operator()( unsigned triangleIndex, float &maxDistance )
+		{
+			const std::vector<int> &vertexIds = *(m_evaluator->m_meshVertexIds);
+			const std::vector<V3f> &p = m_evaluator->m_verts->readable();
+			const size_t vertIdOffset = triangleIndex * 3;
+
+			V3f hitPoint, bary;
+			bool front;
+			if( triangleRayIntersection( p[vertexIds[vertIdOffset]], p[vertexIds[vertIdOffset+1]], p[vertexIds[vertIdOffset+2]], m_ray.pos, m_ray.dir, hitPoint, bary, front ) )
+			{
+				const float distance = ( hitPoint - m_ray.pos ).length();
+				if( distance < maxDistance )
+				{
+					maxDistance = distance;
+					m_hit = true;
+					m_triangleIndex = triangleIndex;
+					m_point = hitPoint;
+					m_bary = bary;
+				}
+			}
+		}
+
+		bool hit() const { return m_hit; }
+		unsigned triangleIndex() const { return m_triangleIndex; }
+		const V3f &point() const { return m_point; }
+		const V3f &barycentricCoordinates() const { return m_bary; }
+
+	private :
+
+		const MeshPrimitiveEvaluator *m_evaluator;
+		const Imath::Line3f &m_ray;
+		bool m_hit;
+		unsigned m_triangleIndex;
+		V3f m_point;
+		V3f m_bary;
+
+};
+
+class MeshPrimitiveEvaluator::AllIntersector
+{
+	public :
+
+		AllIntersector( const MeshPrimitiveEvaluator *evaluator, const Imath::Line3f &ray, std::vector<PrimitiveEvaluator::ResultPtr> &results )
+			:	m_evaluator( evaluator ), m_ray( ray ), m_results( results )
+		{
+		}
+
+		void operator()( unsigned triangleIndex, float &maxDistance )
+		{
+			const std::vector<int> &vertexIds = *(m_evaluator->m_meshVertexIds);
+			const std::vector<V3f> &p = m_evaluator->m_verts->readable();
+			const size_t vertIdOffset = triangleIndex * 3;
+
+			V3f hitPoint, bary;
+			bool front;
+			if( triangleRayIntersection( p[vertexIds[vertIdOffset]], p[vertexIds[vertIdOffset+1]], p[vertexIds[vertIdOffset+2]], m_ray.pos, m_ray.dir, hitPoint, bary, front ) )
+			{
+				if( ( hitPoint - m_ray.pos ).length() < maxDistance )
+				{
+					ResultPtr result = new Result();
+					m_evaluator->setResult( triangleIndex, bary, hitPoint, result.get() );
+					m_results.push_back( result );
+				}
+			}
+		}
+
+	private :
+
+		const MeshPrimitiveEvaluator *m_evaluator;
+		const Imath::Line3f &m_ray;
+		std::vector<PrimitiveEvaluator::ResultPtr> &m_results;
+
+};
+
+void MeshPrimitiveEvaluator::setResult( unsigned triangleIndex, const Imath::V3f &barycentricCoordinates, const Imath::V3f &point, Result *result ) const
+{
+	const size_t vertIdOffset = triangleIndex * 3;
+	result->m_vertexIds = Imath::V3i( (*m_meshVertexIds)[vertIdOffset], (*m_meshVertexIds)[vertIdOffset+1], (*m_meshVertexIds)[vertIdOffset+2] );
+	result->m_triangleIdx = triangleIndex;
+	result->m_bary = barycentricCoordinates;
+	result->m_p = point;
+
+	if ( m_u.interpolation != PrimitiveVariable::Invalid && m_v.interpolation != PrimitiveVariable::Invalid )
+	{
+		result->m_uv = V2f(
+			result->floatPrimVar( m_u ),
+			result->floatPrimVar( m_v )
+		);
+	}
+
+	const std::vector<V3f> &p = m_verts->readable();
+	result->m_n = triangleNormal( p[result->m_vertexIds[0]], p[result->m_vertexIds[1]], p[result->m_vertexIds[2]] );
+}
+
 bool MeshPrimitiveEvaluator::intersectionPoint( const Imath::V3f &origin, const Imath::V3f &direction,
 	PrimitiveEvaluator::Result *result, float maxDistance ) const
 {
@@ -812,6 +1058,17 @@ bool MeshPrimitiveEvaluator::intersectionPoint( const Imath::V3f &origin, const
 	ray.pos = origin;
 	ray.dir = direction.normalized();
 
+	if( m_bvh )
+	{
+		ClosestIntersector intersector( this, ray );
+		m_bvh->intersect( ray.pos, ray.dir, maxDistance, intersector );
+		if( intersector.hit() )
+		{
+			setResult( intersector.triangleIndex(), intersector.barycentricCoordinates(), intersector.point(), mr );
+		}
+		return intersector.hit();
+	}
+
 	bool hit = false;
 
 	intersectionPointWalk( m_tree->rootIndex(), ray, maxDistSqrd, mr, hit );
@@ -836,11 +1093,90 @@ int MeshPrimitiveEvaluator::intersectionPoints( const Imath::V3f &origin, const
 	ray.pos = origin;
 	ray.dir = direction.normalized();
 
+	if( m_bvh )
+	{
+		AllIntersector intersector( this, ray, results );
+		m_bvh->intersect( ray.pos, ray.dir, maxDistance, intersector );
+		return results.size();
+	}
+
 	intersectionPointsWalk( m_tree->rootIndex(), ray, maxDistSqrd, results );
 
 	return results.size();
 }
 
+namespace
+{
+
+class IntersectionPointsBody
+{
+	public :
+
+		IntersectionPointsBody( const MeshPrimitiveEvaluator &evaluator, const std::vector<V3f> &origins, const std::vector<V3f> &directions, float maxDistance, std::vector<PrimitiveEvaluator::ResultPtr> &results )
+			:	m_evaluator( evaluator ), m_origins( origins ), m_directions( directions ), m_maxDistance( maxDistance ), m_results( results )
+		{
+		}
+
+		void operator()( const tbb::blocked_range<size_t> &range ) const
+		{
+			// results for misses are reused for the next ray
+			PrimitiveEvaluator::ResultPtr result = 0;
+			for( size_t i = range.begin(); i != range.end(); ++i )
+			{
+				if( !result )
+				{
+					result = m_evaluator.createResult();
+				}
+				if( m_evaluator.intersectionPoint( m_origins[i], m_directions[i], result.get(), m_maxDistance ) )
+				{
+					m_results[i] = result;
+					result = 0;
+				}
+				else
+				{
+					m_results[i] = 0;
+				}
+			}
+		}
+
+	private :
+
+		const MeshPrimitiveEvaluator &m_evaluator;
+		const std::vector<V3f> &m_origins;
+		const std::vector<V3f> &m_directions;
+		float m_maxDistance;
+		std::vector<PrimitiveEvaluator::ResultPtr> &m_results;
+
+};
+
+} // namespace
+
+int MeshPrimitiveEvaluator::intersectionPoints( const std::vector<V3f> &origins, const std::vector<V3f> &directions,
+	std::vector<PrimitiveEvaluator::ResultPtr> &results, float maxDistance ) const
+{
+	if( origins.size() != directions.size() )
+	{
+		throw InvalidArgumentException( "MeshPrimitiveEvaluator::intersectionPoints : Number of origins and directions differ" );
+	}
+
+	results.clear();
+	results.resize( origins.size() );
+
+	IntersectionPointsBody body( *this, origins, directions, maxDistance, results );
+	tbb::parallel_for( tbb::blocked_range<size_t>( 0, origins.size(), 64 ), body );
+
+	int numHits = 0;
+	for( std::vector<PrimitiveEvaluator::ResultPtr>::const_iterator it = results.begin(); it != results.end(); ++it )
+	{
+		if( *it )
+		{
+			numHits++;
+		}
+	}
+
+	return numHits;
+}
+
 bool MeshPrimitiveEvaluator::barycentricPosition( unsigned int triangleIndex, const Imath::V3f &barycentricCoordinates, PrimitiveEvaluator::Result *result ) const
 {
 	if( triangleIndex > m_triangles.size() )
@@ -1313,6 +1649,11 @@ const MeshPrimitiveEvaluator::UVBoundTree *MeshPrimitiveEvaluator::uvBoundTree()
 	return m_uvTree;
 }
 
+const BoundingVolumeHierarchy *MeshPrimitiveEvaluator::boundingVolumeHierarchy() const
+{
+	return m_bvh;
+}
+
 void MeshPrimitiveEvaluator::triangleUVs( size_t triangleIndex, const Imath::V3i &vertexIds, Imath::V2f uv[3] ) const
 {
 	const std::vector<float> &u = ((FloatVectorData *)(m_u.data.get()))->readable();
@@ -37,9 +37,12 @@
 
 #include "boost/format.hpp"
 
+#include "tbb/parallel_for.h"
+
 #include "IECore/DataCastOp.h"
 #include "IECore/Convert.h"
 #include "IECore/MeshTangentsOp.h"
+#include "IECore/MeshAdjacency.h"
 #include "IECore/DespatchTypedData.h"
 #include "IECore/CompoundParameter.h"
 
@@ -181,12 +184,184 @@ const StringParameter * MeshTangentsOp::vTangentPrimVarNameParameter() const
 	return m_vTangentPrimVarNameParameter;
 }
 
+namespace
+{
+
+template<typename Vec>
+class FaceTangents
+{
+
+	public :
+
+		FaceTangents( const vector<Vec> &points, const vector<int> &vertIds, const vector<float> &u, const vector<float> &v, vector<Vec> &tangents, vector<Vec> &bitangents, vector<Vec> &normals )
+			:	m_points( points ), m_vertIds( vertIds ), m_u( u ), m_v( v ), m_tangents( tangents ), m_bitangents( bitangents ), m_normals( normals )
+		{
+		}
+
+		void operator()( const tbb::blocked_range<size_t> &r ) const
+		{
+			for( size_t faceIndex = r.begin(); faceIndex != r.end(); ++faceIndex )
+			{
+				// indices into the facevarying data for this face
+				size_t fvi0 = faceIndex * 3;
+				size_t fvi1 = fvi0 + 1;
+				size_t fvi2 = fvi1 + 1;
+				assert( fvi2 < m_vertIds.size() );
+				assert( fvi2 < m_u.size() );
+				assert( fvi2 < m_v.size() );
+
+				// positions for each vertex of this face
+				const Vec &p0 = m_points[ m_vertIds[ fvi0 ] ];
+				const Vec &p1 = m_points[ m_vertIds[ fvi1 ] ];
+				const Vec &p2 = m_points[ m_vertIds[ fvi2 ] ];
+
+				// uv coordinates for each vertex of this face
+				const Imath::V2f uv0( m_u[ fvi0 ], m_v[ fvi0 ] );
+				const Imath::V2f uv1( m_u[ fvi1 ], m_v[ fvi1 ] );
+				const Imath::V2f uv2( m_u[ fvi2 ], m_v[ fvi2 ] );
+
+				// compute tangents and normal for this face
+				const Vec e0 = p1 - p0;
+				const Vec e1 = p2 - p0;
+
+				const Imath::V2f e0uv = uv1 - uv0;
+				const Imath::V2f e1uv = uv2 - uv0;
+
+				m_tangents[faceIndex] = ( e0 * -e1uv.y + e1 * e0uv.y ).normalized();
+				m_bitangents[faceIndex] = ( e0 * -e1uv.x + e1 * e0uv.x ).normalized();
+
+				Vec normal = (p2-p1).cross(p0-p1);
+				normal.normalize();
+				m_normals[faceIndex] = normal;
+			}
+		}
+
+	private :
+
+		const vector<Vec> &m_points;
+		const vector<int> &m_vertIds;
+		const vector<float> &m_u;
+		const vector<float> &m_v;
+		vector<Vec> &m_tangents;
+		vector<Vec> &m_bitangents;
+		vector<Vec> &m_normals;
+
+};
+
+// Sums the face values for each unique uv index, using an adjacency built from
+// the uv indices, and then normalizes and orthogonalizes the results.
+template<typename Vec>
+class UniqueTangents
+{
+
+	public :
+
+		UniqueTangents( const MeshAdjacency *uvAdjacency, const vector<Vec> &faceTangents, const vector<Vec> &faceBitangents, const vector<Vec> &faceNormals, bool orthoTangents, vector<Vec> &uTangents, vector<Vec> &vTangents )
+			:	m_offsets( uvAdjacency->vertexFaceOffsets() ), m_faces( uvAdjacency->vertexFaces() ),
+				m_faceTangents( faceTangents ), m_faceBitangents( faceBitangents ), m_faceNormals( faceNormals ),
+				m_orthoTangents( orthoTangents ), m_uTangents( uTangents ), m_vTangents( vTangents )
+		{
+		}
+
+		void operator()( const tbb::blocked_range<size_t> &r ) const
+		{
+			for( size_t i = r.begin(); i != r.end(); ++i )
+			{
+				// accumulate the values from all the faces sharing this uv. the faces
+				// are visited in increasing order, so this gives the same results as
+				// accumulating face by face.
+				Vec uTangent( 0 );
+				Vec vTangent( 0 );
+				Vec normal( 0 );
+				for( int j = m_offsets[i]; j < m_offsets[i+1]; ++j )
+				{
+					const int f = m_faces[j];
+					uTangent += m_faceTangents[f];
+					vTangent += m_faceBitangents[f];
+					normal += m_faceNormals[f];
+				}
+
+				// normalize and orthogonalize everything
+				normal.normalize();
+
+				uTangent.normalize();
+				vTangent.normalize();
+
+				// Make uTangent/vTangent orthogonal to normal
+				uTangent -= normal * uTangent.dot( normal );
+				vTangent -= normal * vTangent.dot( normal );
+
+				uTangent.normalize();
+				vTangent.normalize();
+
+				if ( m_orthoTangents )
+				{
+					vTangent -= uTangent * vTangent.dot( uTangent );
+					vTangent.normalize();
+				}
+
+				// make things less sinister
+				if( uTangent.cross( vTangent ).dot( normal ) < 0.0f )
+				{
+					uTangent *= -1.0f;
+				}
+
+				m_uTangents[i] = uTangent;
+				m_vTangents[i] = vTangent;
+			}
+		}
+
+	private :
+
+		const vector<int> &m_offsets;
+		const vector<int> &m_faces;
+		const vector<Vec> &m_faceTangents;
+		const vector<Vec> &m_faceBitangents;
+		const vector<Vec> &m_faceNormals;
+		bool m_orthoTangents;
+		vector<Vec> &m_uTangents;
+		vector<Vec> &m_vTangents;
+
+};
+
+template<typename Vec>
+class FaceVaryingTangents
+{
+
+	public :
+
+		FaceVaryingTangents( const vector<int> &uvIds, const vector<Vec> &uTangents, const vector<Vec> &vTangents, vector<Vec> &fvUTangents, vector<Vec> &fvVTangents )
+			:	m_uvIds( uvIds ), m_uTangents( uTangents ), m_vTangents( vTangents ), m_fvUTangents( fvUTangents ), m_fvVTangents( fvVTangents )
+		{
+		}
+
+		void operator()( const tbb::blocked_range<size_t> &r ) const
+		{
+			for( size_t i = r.begin(); i != r.end(); ++i )
+			{
+				m_fvUTangents[i] = m_uTangents[m_uvIds[i]];
+				m_fvVTangents[i] = m_vTangents[m_uvIds[i]];
+			}
+		}
+
+	private :
+
+		const vector<int> &m_uvIds;
+		const vector<Vec> &m_uTangents;
+		const vector<Vec> &m_vTangents;
+		vector<Vec> &m_fvUTangents;
+		vector<Vec> &m_fvVTangents;
+
+};
+
+} // namespace
+
 struct MeshTangentsOp::CalculateTangents
 {
 	typedef void ReturnType;
 
-	CalculateTangents( const vector<int> &vertsPerFace, const vector<int> &vertIds, const vector<float> &u, const vector<float> &v, const vector<int> &uvIndices, bool orthoTangents )
-		:	m_vertsPerFace( vertsPerFace ), m_vertIds( vertIds ), m_u( u ), m_v( v ), m_uvIds( uvIndices ), m_orthoTangents( orthoTangents )
+	CalculateTangents( const vector<int> &vertIds, const vector<float> &u, const vector<float> &v, const vector<int> &uvIndices, const MeshAdjacency *uvAdjacency, bool orthoTangents )
+		:	m_vertIds( vertIds ), m_u( u ), m_v( v ), m_uvIds( uvIndices ), m_uvAdjacency( uvAdjacency ), m_orthoTangents( orthoTangents )
 	{
 
 	}
@@ -198,98 +373,31 @@ struct MeshTangentsOp::CalculateTangents
 		typedef typename VecContainer::value_type Vec;
 
 		const VecContainer &points = data->readable();
-		
+
+		// compute the tangents and normal for each face.
+		const size_t numFaces = m_uvAdjacency->numFaces();
+		VecContainer faceTangents( numFaces );
+		VecContainer faceBitangents( numFaces );
+		VecContainer faceNormals( numFaces );
+		tbb::parallel_for(
+			tbb::blocked_range<size_t>( 0, numFaces, 1000 ),
+			FaceTangents<Vec>( points, m_vertIds, m_u, m_v, faceTangents, faceBitangents, faceNormals )
+		);
+
 		// the uvIndices array is indexed as with any other facevarying data. the values in the
 		// array specify the connectivity of the uvs - where two facevertices have the same index
 		// they are known to be sharing a uv. for each one of these unique indices we compute
 		// the tangents and normal, by accumulating all the tangents and normals for the faces
 		// that reference them. we then take this data and shuffle it back into facevarying
 		// primvars for the mesh.
-		int numUniqueTangents = 1 + *max_element( m_uvIds.begin(), m_uvIds.end() );
-		
+		const size_t numUniqueTangents = m_uvAdjacency->numVertices();
 		VecContainer uTangents( numUniqueTangents, Vec( 0 ) );
 		VecContainer vTangents( numUniqueTangents, Vec( 0 ) );
-		VecContainer normals( numUniqueTangents, Vec( 0 ) );
-		
-		for( size_t faceIndex = 0; faceIndex < m_vertsPerFace.size() ; faceIndex++ )
-		{
-			
-			assert( m_vertsPerFace[faceIndex] == 3 );
-
-			// indices into the facevarying data for this face 
-			size_t fvi0 = faceIndex * 3;
-			size_t fvi1 = fvi0 + 1;
-			size_t fvi2 = fvi1 + 1;
-			assert( fvi2 < m_vertIds.size() );
-			assert( fvi2 < m_u.size() );
-			assert( fvi2 < m_v.size() );
-			
-			// positions for each vertex of this face
-			const Vec &p0 = points[ m_vertIds[ fvi0 ] ];
-			const Vec &p1 = points[ m_vertIds[ fvi1 ] ];
-			const Vec &p2 = points[ m_vertIds[ fvi2 ] ];
-
-			// uv coordinates for each vertex of this face
-			const Imath::V2f uv0( m_u[ fvi0 ], m_v[ fvi0 ] );
-			const Imath::V2f uv1( m_u[ fvi1 ], m_v[ fvi1 ] );
-			const Imath::V2f uv2( m_u[ fvi2 ], m_v[ fvi2 ] );
-
-			// compute tangents and normal for this face
-			const Vec e0 = p1 - p0;
-			const Vec e1 = p2 - p0;
-
-			const Imath::V2f e0uv = uv1 - uv0;
-			const Imath::V2f e1uv = uv2 - uv0;
-
-			Vec tangent   = ( e0 * -e1uv.y + e1 * e0uv.y ).normalized();
-			Vec bitangent = ( e0 * -e1uv.x + e1 * e0uv.x ).normalized();
-
-			Vec normal = (p2-p1).cross(p0-p1);
-			normal.normalize();
-
-			// and accumlate them into the computation so far
-			uTangents[ m_uvIds[fvi0] ] += tangent;
-			uTangents[ m_uvIds[fvi1] ] += tangent;
-			uTangents[ m_uvIds[fvi2] ] += tangent;
-			
-			vTangents[ m_uvIds[fvi0] ] += bitangent;
-			vTangents[ m_uvIds[fvi1] ] += bitangent;
-			vTangents[ m_uvIds[fvi2] ] += bitangent;
-			
-			normals[ m_uvIds[fvi0] ] += normal;
-			normals[ m_uvIds[fvi1] ] += normal;
-			normals[ m_uvIds[fvi2] ] += normal;
-			
-		}
+		tbb::parallel_for(
+			tbb::blocked_range<size_t>( 0, numUniqueTangents, 1000 ),
+			UniqueTangents<Vec>( m_uvAdjacency, faceTangents, faceBitangents, faceNormals, m_orthoTangents, uTangents, vTangents )
+		);
 
-		// normalize and orthogonalize everything
-		for( size_t i = 0; i < uTangents.size(); i++ )
-		{
-			normals[i].normalize();
-
-			uTangents[i].normalize();
-			vTangents[i].normalize();
-
-			// Make uTangent/vTangent orthogonal to normal
-			uTangents[i] -= normals[i] * uTangents[i].dot( normals[i] );
-			vTangents[i] -= normals[i] * vTangents[i].dot( normals[i] );
-
-			uTangents[i].normalize();
-			vTangents[i].normalize();
-
-			if ( m_orthoTangents )
-			{
-				vTangents[i] -= uTangents[i] * vTangents[i].dot( uTangents[i] );
-				vTangents[i].normalize();
-			}
-		
-			// make things less sinister
-			if( uTangents[i].cross( vTangents[i] ).dot( normals[i] ) < 0.0f )
-			{
-				uTangents[i] *= -1.0f;
-			}
-		}
-		
 		// convert the tangents back to facevarying data and add that to the mesh
 		typename T::Ptr fvUD = new T();
 		typename T::Ptr fvVD = new T();
@@ -300,13 +408,11 @@ struct MeshTangentsOp::CalculateTangents
 		VecContainer &fvVTangents = fvVD->writable();
 		fvUTangents.resize( m_uvIds.size() );
 		fvVTangents.resize( m_uvIds.size() );
-		
-		for( unsigned i=0; i<m_uvIds.size(); i++ )
-		{
-			fvUTangents[i] = uTangents[m_uvIds[i]];
-			fvVTangents[i] = vTangents[m_uvIds[i]];
-		}
 
+		tbb::parallel_for(
+			tbb::blocked_range<size_t>( 0, m_uvIds.size(), 1000 ),
+			FaceVaryingTangents<Vec>( m_uvIds, uTangents, vTangents, fvUTangents, fvVTangents )
+		);
 	}
 	
 	// this is the data filled in by operator() above, ready to be added onto the mesh
@@ -315,11 +421,11 @@ struct MeshTangentsOp::CalculateTangents
 	
 	private :
 
-		const vector<int> &m_vertsPerFace;
 		const vector<int> &m_vertIds;
 		const vector<float> &m_u;
 		const vector<float> &m_v;
 		const vector<int> &m_uvIds;
+		const MeshAdjacency *m_uvAdjacency;
 		bool m_orthoTangents;
 		
 };
@@ -393,7 +499,28 @@ void MeshTangentsOp::modifyTypedPrimitive( MeshPrimitive * mesh, const CompoundO
 
 	bool orthoTangents = orthogonalizeTangentsParameter()->getTypedValue();
 
-	CalculateTangents f( vertsPerFace->readable(), mesh->vertexIds()->readable(), uData->readable(), vData->readable(), uvIndicesData->readable(), orthoTangents );
+	// the tangents are accumulated over the faces sharing each uv index, which we find
+	// using an adjacency built from the uv indices in place of the vertex ids. when the
+	// indices are the vertex ids we can reuse the adjacency shared by the mesh itself, and
+	// otherwise we share one keyed on the uv indices, so that it is still only built once
+	// for a deforming sequence.
+	ConstMeshAdjacencyPtr uvAdjacency = 0;
+	if( uvIndicesData == mesh->vertexIds() )
+	{
+		uvAdjacency = mesh->adjacency();
+	}
+	else
+	{
+		const vector<int> &uvIndices = uvIndicesData->readable();
+		const size_t numUniqueTangents = uvIndices.size() ? 1 + *max_element( uvIndices.begin(), uvIndices.end() ) : 0;
+		MurmurHash h;
+		vertsPerFace->hash( h );
+		uvIndicesData->hash( h );
+		h.append( (uint64_t)numUniqueTangents );
+		uvAdjacency = MeshAdjacency::cached( h, vertsPerFace->readable(), uvIndices, numUniqueTangents );
+	}
+
+	CalculateTangents f( mesh->vertexIds()->readable(), uData->readable(), vData->readable(), uvIndicesData->readable(), uvAdjacency.get(), orthoTangents );
 
 	despatchTypedData<CalculateTangents, TypeTraits::IsFloatVec3VectorTypedData, HandleErrors>( pData, f );
 
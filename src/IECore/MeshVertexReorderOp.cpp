@@ -34,6 +34,7 @@
 
 #include "IECore/CompoundParameter.h"
 #include "IECore/MeshVertexReorderOp.h"
+#include "IECore/MeshAdjacency.h"
 #include "IECore/DespatchTypedData.h"
 
 #include "boost/format.hpp"
@@ -240,7 +241,7 @@ void MeshVertexReorderOp::visitFace(
 	}
 
 	/// Create the "face-varying" mapping
-	int faceVaryingRemapStart = m_faceVaryingOffsets[ currentFace ];
+	int faceVaryingRemapStart = m_adjacency->faceOffsets()[ currentFace ];
 	int fvRelativeIdx = currentEdgeVertexOrigin;
 	for ( i = 0; i < numFaceVertices; i++ )
 	{
@@ -292,8 +293,7 @@ void MeshVertexReorderOp::buildInternalTopology( const MeshPrimitive * mesh )
 	m_faceToEdgesMap.clear();
 	m_faceToVerticesMap.clear();
 	m_edgeToConnectedFacesMap.clear();
-	m_faceVaryingOffsets.clear();
-	m_vertexToFacesMap.clear();
+	m_adjacency = mesh->adjacency();
 
 	m_numFaces = mesh->verticesPerFace()->readable().size();
 	m_numVerts = mesh->variableSize( PrimitiveVariable::Vertex );
@@ -303,17 +303,14 @@ void MeshVertexReorderOp::buildInternalTopology( const MeshPrimitive * mesh )
 		throw InvalidArgumentException( "MeshVertexReorderOp : Cannot reorder empty mesh." );
 	}
 
-	int vertOffset = 0;
-	int faceVaryingIdx = 0;
+	const std::vector<int> &faceOffsets = m_adjacency->faceOffsets();
 
 	for ( int f = 0; f < m_numFaces; f++ )
 	{
-		int numFaceVertices = mesh->verticesPerFace()->readable()[f];
+		const int vertOffset = faceOffsets[f];
+		const int numFaceVertices = faceOffsets[f+1] - vertOffset;
 		assert( numFaceVertices >= 3 );
 
-		m_faceVaryingOffsets.push_back( faceVaryingIdx );
-		faceVaryingIdx += numFaceVertices;
-
 		for ( int v = 0; v < numFaceVertices; v++ )
 		{
 			assert( vertOffset < ( int )mesh->vertexIds()->readable().size() );
@@ -321,8 +318,6 @@ void MeshVertexReorderOp::buildInternalTopology( const MeshPrimitive * mesh )
 
 			assert( vertexId < m_numVerts );
 
-			m_vertexToFacesMap[ vertexId ].insert( f );
-
 			m_faceToVerticesMap[ f ].push_back( vertexId );
 
 			int nextVertexId = mesh->vertexIds()->readable()[ vertOffset + (( v + 1 ) % numFaceVertices )];
@@ -332,8 +327,6 @@ void MeshVertexReorderOp::buildInternalTopology( const MeshPrimitive * mesh )
 			m_edgeToConnectedFacesMap[ Edge( vertexId, nextVertexId )].push_back( f );
 			m_edgeToConnectedFacesMap[ Edge( nextVertexId, vertexId )].push_back( f );
 		}
-
-		vertOffset += numFaceVertices;
 	}
 
 	for ( EdgeToConnectedFacesMap::const_iterator it = m_edgeToConnectedFacesMap.begin(); it != m_edgeToConnectedFacesMap.end(); ++it )
@@ -362,21 +355,26 @@ void MeshVertexReorderOp::modifyTypedPrimitive( MeshPrimitive * mesh, const Comp
 
 	Imath::V3i faceVtxSrc = m_startingVerticesParameter->getTypedValue();
 
+	const std::vector<int> &vertexFaceOffsets = m_adjacency->vertexFaceOffsets();
+	const std::vector<int> &vertexFaces = m_adjacency->vertexFaces();
+	FaceSet vtxFaces[3];
 	for ( int i = 0; i < 3; i++ )
 	{
-		if ( m_vertexToFacesMap.find( faceVtxSrc[i] ) == m_vertexToFacesMap.end() )
+		const int v = faceVtxSrc[i];
+		if ( v < 0 || v >= (int)m_adjacency->numVertices() || vertexFaceOffsets[v] == vertexFaceOffsets[v+1] )
 		{
 			throw InvalidArgumentException(
 			        ( boost::format( "MeshVertexReorderOp : Cannot find vertex %d" ) % faceVtxSrc[i] ).str()
 			);
 		}
+		vtxFaces[i].insert( vertexFaces.begin() + vertexFaceOffsets[v], vertexFaces.begin() + vertexFaceOffsets[v+1] );
 	}
 
 	FaceSet tmp;
 
-	const FaceSet &vtx0Faces = m_vertexToFacesMap[ faceVtxSrc[0] ];
-	const FaceSet &vtx1Faces = m_vertexToFacesMap[ faceVtxSrc[1] ];
-	const FaceSet &vtx2Faces = m_vertexToFacesMap[ faceVtxSrc[2] ];
+	const FaceSet &vtx0Faces = vtxFaces[0];
+	const FaceSet &vtx1Faces = vtxFaces[1];
+	const FaceSet &vtx2Faces = vtxFaces[2];
 
 	std::set_intersection(
 	        vtx0Faces.begin(),  vtx0Faces.end(),
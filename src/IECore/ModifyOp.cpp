@@ -35,13 +35,14 @@
 #include "IECore/ModifyOp.h"
 #include "IECore/CompoundObject.h"
 #include "IECore/CompoundParameter.h"
+#include "IECore/Data.h"
 
 using namespace IECore;
 
 IE_CORE_DEFINERUNTIMETYPED( ModifyOp );
 
 ModifyOp::ModifyOp( const std::string &description, ParameterPtr resultParameter, ParameterPtr inputParameter )
-	:	Op( description, resultParameter )
+	:	Op( description, resultParameter ), m_bytesDuplicated( 0 )
 {
 	parameters()->addParameter( inputParameter );
 	m_inputParameter = inputParameter;
@@ -96,8 +97,15 @@ const BoolParameter *ModifyOp::enableParameter() const
 	return m_enableParameter;
 }
 
+size_t ModifyOp::bytesDuplicated() const
+{
+	return m_bytesDuplicated;
+}
+
 ObjectPtr ModifyOp::doOperation( const CompoundObject *operands )
 {
+	const size_t bytesDuplicatedBefore = Data::bytesDuplicated();
+
 	ObjectPtr object = m_inputParameter->getValue();
 	if( m_copyParameter->getTypedValue() )
 	{
@@ -107,5 +115,7 @@ ObjectPtr ModifyOp::doOperation( const CompoundObject *operands )
 	{
 		modify( object, operands );
 	}
+
+	m_bytesDuplicated = Data::bytesDuplicated() - bytesDuplicatedBefore;
 	return object;
 }
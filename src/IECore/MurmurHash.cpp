@@ -34,11 +34,21 @@
 
 #include <iomanip>
 #include <sstream>
+#include <vector>
+#include <algorithm>
+
+#include "tbb/parallel_for.h"
+#include "tbb/blocked_range.h"
 
 #include "IECore/MurmurHash.h"
 
 using namespace IECore;
 
+// Buffers of at least this size are hashed in parallel chunks. Note that
+// changing either value changes the hashes of large buffers.
+static const size_t g_chunkSize = 1024 * 1024;
+static const size_t g_minChunkedSize = 4 * g_chunkSize;
+
 static inline uint64_t rotl64( uint64_t x, int8_t r )
 {
   return (x << r) | (x >> (64 - r));
@@ -65,9 +75,79 @@ MurmurHash::MurmurHash( const MurmurHash &other )
 {
 }
 
+MurmurHash::MurmurHash( uint64_t h1, uint64_t h2 )
+	:	m_h1( h1 ), m_h2( h2 )
+{
+}
+
+namespace
+{
+
+class ChunkHasher
+{
+
+	public :
+
+		ChunkHasher( const char *data, size_t bytes, std::vector<uint64_t> &chunkHashes )
+			:	m_data( data ), m_bytes( bytes ), m_chunkHashes( chunkHashes )
+		{
+		}
+
+		void operator()( const tbb::blocked_range<size_t> &range ) const
+		{
+			for( size_t i = range.begin(); i != range.end(); ++i )
+			{
+				const size_t begin = i * g_chunkSize;
+				const size_t size = std::min( g_chunkSize, m_bytes - begin );
+				MurmurHash h;
+				h.append( m_data + begin, size );
+				m_chunkHashes[i*2] = h.h1();
+				m_chunkHashes[i*2+1] = h.h2();
+			}
+		}
+
+	private :
+
+		const char *m_data;
+		size_t m_bytes;
+		std::vector<uint64_t> &m_chunkHashes;
+
+};
+
+} // namespace
+
 void MurmurHash::append( const void *data, size_t bytes, int elementSize )
 {
-	const int nBlocks = bytes / 16;
+	if( bytes >= g_minChunkedSize )
+	{
+		appendChunked( data, bytes );
+	}
+	else
+	{
+		appendSerial( data, bytes );
+	}
+}
+
+void MurmurHash::appendChunked( const void *data, size_t bytes )
+{
+	const size_t numChunks = ( bytes + g_chunkSize - 1 ) / g_chunkSize;
+	std::vector<uint64_t> chunkHashes( numChunks * 2 );
+
+	ChunkHasher chunkHasher( (const char *)data, bytes, chunkHashes );
+	tbb::parallel_for( tbb::blocked_range<size_t>( 0, numChunks ), chunkHasher );
+
+	// combine the chunk hashes in order, so the result is
+	// independent of the order they were computed in.
+	appendSerial( &(chunkHashes[0]), chunkHashes.size() * sizeof( uint64_t ) );
+	// hash the length at a fixed width, so that 32 and 64 bit
+	// builds give the same results.
+	const uint64_t length = bytes;
+	appendSerial( &length, sizeof( length ) );
+}
+
+void MurmurHash::appendSerial( const void *data, size_t bytes )
+{
+	const size_t nBlocks = bytes / 16;
 	
 	const uint64_t c1 = 0x87c37b91114253d5;
 	const uint64_t c2 = 0x4cf5ad432745937f;
@@ -75,7 +155,7 @@ void MurmurHash::append( const void *data, size_t bytes, int elementSize )
 	// body
 	
 	const uint64_t *blocks = (const uint64_t *)data;
-	for( int i = 0; i < nBlocks; i++ )
+	for( size_t i = 0; i < nBlocks; i++ )
 	{
 		uint64_t k1 = blocks[i*2];
 		uint64_t k2 = blocks[i*2+1];
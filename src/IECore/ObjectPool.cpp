@@ -33,7 +33,7 @@
 //////////////////////////////////////////////////////////////////////////
 
 #include "boost/lexical_cast.hpp"
-#include "IECore/LRUCache.h"
+#include "IECore/ShardedLRUCache.h"
 #include "IECore/ObjectPool.h"
 
 using namespace IECore;
@@ -49,7 +49,7 @@ struct ObjectPool::MemberData
 	{
 	}
 
-	LRUCache< MurmurHash, ConstObjectPtr > cache;
+	ShardedLRUCache< MurmurHash, ConstObjectPtr > cache;
 
 	/// our getter always returns NULL
 	static ConstObjectPtr getter( const MurmurHash &h, size_t &cost )
@@ -37,6 +37,11 @@
 
 #include "boost/format.hpp"
 
+#include "tbb/parallel_for.h"
+#include "tbb/blocked_range.h"
+
+#include "OpenEXR/ImathMatrixAlgo.h"
+
 #include "IECore/PointsPrimitive.h"
 #include "IECore/ObjectParameter.h"
 #include "IECore/CompoundParameter.h"
@@ -92,12 +97,16 @@ PointSmoothSkinningOp::PointSmoothSkinningOp() :
 
 	IntParameter::PresetsContainer blendPresets;
 	blendPresets.push_back( IntParameter::Preset( "Linear", Linear ) );
+	blendPresets.push_back( IntParameter::Preset( "DualQuaternion", DualQuaternion ) );
 	m_blendParameter = new IntParameter(
 	        "blend",
-	        "Blending algorithm used to deform the mesh.",
-	        Linear,
+	        "Blending algorithm used to deform the mesh. Linear blends the skinning matrices, "
+	        "while DualQuaternion blends their rigid components, avoiding the loss of volume that linear "
+	        "blending produces around twisting joints. DualQuaternion ignores any scaling and shearing "
+	        "in the skinning matrices.",
 	        Linear,
 	        Linear,
+	        DualQuaternion,
 	        blendPresets,
 	        true
 	);
@@ -184,6 +193,258 @@ const IntParameter * PointSmoothSkinningOp::blendParameter() const
 }
 
 
+namespace
+{
+
+// An affine transform stored as the 12 significant elements of an M44f, so that
+// weighted sums of transforms can be computed with simple loops.
+struct AffineMatrix
+{
+
+	AffineMatrix()
+	{
+	}
+
+	AffineMatrix( const M44f &m )
+	{
+		for( int i = 0; i < 4; i++ )
+		{
+			for( int j = 0; j < 3; j++ )
+			{
+				v[i*3+j] = m[i][j];
+			}
+		}
+	}
+
+	inline V3f transformPoint( const V3f &p ) const
+	{
+		return V3f(
+			p.x * v[0] + p.y * v[3] + p.z * v[6] + v[9],
+			p.x * v[1] + p.y * v[4] + p.z * v[7] + v[10],
+			p.x * v[2] + p.y * v[5] + p.z * v[8] + v[11]
+		);
+	}
+
+	inline V3f transformDirection( const V3f &d ) const
+	{
+		return V3f(
+			d.x * v[0] + d.y * v[3] + d.z * v[6],
+			d.x * v[1] + d.y * v[4] + d.z * v[7],
+			d.x * v[2] + d.y * v[5] + d.z * v[8]
+		);
+	}
+
+	float v[12];
+
+};
+
+// A unit dual quaternion representing a rigid transform, as described in
+// "Skinning with Dual Quaternions" by Kavan et al.
+struct DualQuat
+{
+
+	DualQuat()
+	{
+	}
+
+	// Creates the dual quaternion for the rotation and translation of m, ignoring
+	// any scaling and shearing.
+	DualQuat( const M44f &m )
+	{
+		M44f r = m;
+		V3f scale, shear;
+		extractAndRemoveScalingAndShear( r, scale, shear, false );
+
+		// the rotation, for row vectors as used by Imath
+		float w, x, y, z;
+		const float trace = r[0][0] + r[1][1] + r[2][2];
+		if( trace > 0.0f )
+		{
+			const float s = sqrtf( trace + 1.0f ) * 2.0f;
+			w = 0.25f * s;
+			x = ( r[1][2] - r[2][1] ) / s;
+			y = ( r[2][0] - r[0][2] ) / s;
+			z = ( r[0][1] - r[1][0] ) / s;
+		}
+		else if( r[0][0] > r[1][1] && r[0][0] > r[2][2] )
+		{
+			const float s = sqrtf( 1.0f + r[0][0] - r[1][1] - r[2][2] ) * 2.0f;
+			w = ( r[1][2] - r[2][1] ) / s;
+			x = 0.25f * s;
+			y = ( r[0][1] + r[1][0] ) / s;
+			z = ( r[0][2] + r[2][0] ) / s;
+		}
+		else if( r[1][1] > r[2][2] )
+		{
+			const float s = sqrtf( 1.0f + r[1][1] - r[0][0] - r[2][2] ) * 2.0f;
+			w = ( r[2][0] - r[0][2] ) / s;
+			x = ( r[0][1] + r[1][0] ) / s;
+			y = 0.25f * s;
+			z = ( r[1][2] + r[2][1] ) / s;
+		}
+		else
+		{
+			const float s = sqrtf( 1.0f + r[2][2] - r[0][0] - r[1][1] ) * 2.0f;
+			w = ( r[0][1] - r[1][0] ) / s;
+			x = ( r[0][2] + r[2][0] ) / s;
+			y = ( r[1][2] + r[2][1] ) / s;
+			z = 0.25f * s;
+		}
+
+		// the dual part is half the translation multiplied by the rotation
+		const V3f t( m[3][0], m[3][1], m[3][2] );
+		const V3f qv( x, y, z );
+		const V3f dv = ( t * w + ( t % qv ) ) * 0.5f;
+		v[0] = w; v[1] = x; v[2] = y; v[3] = z;
+		v[4] = -0.5f * ( t ^ qv ); v[5] = dv.x; v[6] = dv.y; v[7] = dv.z;
+	}
+
+	// The first four elements are the real part and the last four the dual part,
+	// each stored as w, x, y, z.
+	float v[8];
+
+};
+
+// Deforms the points and (optionally) normals of a range of points in a single pass,
+// using skinning data which has been precomputed once for the pose.
+class SkinningBody
+{
+
+	public :
+
+		SkinningBody( const SmoothSkinningData *ssd, V3f *p, V3f *n )
+			:	m_pointIndexOffsets( &(ssd->pointIndexOffsets()->readable()[0]) ),
+				m_pointInfluenceCounts( &(ssd->pointInfluenceCounts()->readable()[0]) ),
+				m_pointInfluenceIndices( ssd->pointInfluenceIndices()->readable().size() ? &(ssd->pointInfluenceIndices()->readable()[0]) : 0 ),
+				m_pointInfluenceWeights( ssd->pointInfluenceWeights()->readable().size() ? &(ssd->pointInfluenceWeights()->readable()[0]) : 0 ),
+				m_p( p ), m_n( n ), m_matrices( 0 ), m_dualQuaternions( 0 )
+		{
+		}
+
+		void setMatrices( const std::vector<AffineMatrix> *matrices )
+		{
+			m_matrices = matrices;
+		}
+
+		void setDualQuaternions( const std::vector<DualQuat> *dualQuaternions )
+		{
+			m_dualQuaternions = dualQuaternions;
+		}
+
+		void operator()( const tbb::blocked_range<size_t> &range ) const
+		{
+			if( m_matrices )
+			{
+				linear( range );
+			}
+			else
+			{
+				dualQuaternion( range );
+			}
+		}
+
+	private :
+
+		void linear( const tbb::blocked_range<size_t> &range ) const
+		{
+			const AffineMatrix *matrices = &((*m_matrices)[0]);
+			for( size_t i = range.begin(); i != range.end(); ++i )
+			{
+				AffineMatrix m;
+				std::fill( m.v, m.v + 12, 0.0f );
+
+				const int begin = m_pointIndexOffsets[i];
+				const int end = begin + m_pointInfluenceCounts[i];
+				for( int j = begin; j < end; ++j )
+				{
+					const float *skin = matrices[m_pointInfluenceIndices[j]].v;
+					const float weight = m_pointInfluenceWeights[j];
+					for( int k = 0; k < 12; ++k )
+					{
+						m.v[k] += skin[k] * weight;
+					}
+				}
+
+				m_p[i] = m.transformPoint( m_p[i] );
+				if( m_n )
+				{
+					m_n[i] = m.transformDirection( m_n[i] );
+				}
+			}
+		}
+
+		void dualQuaternion( const tbb::blocked_range<size_t> &range ) const
+		{
+			const DualQuat *dualQuaternions = &((*m_dualQuaternions)[0]);
+			for( size_t i = range.begin(); i != range.end(); ++i )
+			{
+				DualQuat q;
+				std::fill( q.v, q.v + 8, 0.0f );
+
+				const int begin = m_pointIndexOffsets[i];
+				const int end = begin + m_pointInfluenceCounts[i];
+				const float *pivot = begin < end ? dualQuaternions[m_pointInfluenceIndices[begin]].v : 0;
+				for( int j = begin; j < end; ++j )
+				{
+					const float *skin = dualQuaternions[m_pointInfluenceIndices[j]].v;
+					float weight = m_pointInfluenceWeights[j];
+					// q and -q represent the same rotation, so we flip those facing away
+					// from the first influence to blend along the shortest path.
+					if( pivot[0] * skin[0] + pivot[1] * skin[1] + pivot[2] * skin[2] + pivot[3] * skin[3] < 0.0f )
+					{
+						weight = -weight;
+					}
+					for( int k = 0; k < 8; ++k )
+					{
+						q.v[k] += skin[k] * weight;
+					}
+				}
+
+				const float length = sqrtf( q.v[0] * q.v[0] + q.v[1] * q.v[1] + q.v[2] * q.v[2] + q.v[3] * q.v[3] );
+				if( length == 0.0f )
+				{
+					// no influences, or weights summing to 0. this is consistent
+					// with the result of linear blending.
+					m_p[i] = V3f( 0 );
+					if( m_n )
+					{
+						m_n[i] = V3f( 0 );
+					}
+					continue;
+				}
+
+				const float rw = q.v[0] / length;
+				const V3f rv( q.v[1] / length, q.v[2] / length, q.v[3] / length );
+				const float dw = q.v[4] / length;
+				const V3f dv( q.v[5] / length, q.v[6] / length, q.v[7] / length );
+
+				const V3f translation = ( dv * rw - rv * dw + ( rv % dv ) ) * 2.0f;
+				m_p[i] = rotate( rw, rv, m_p[i] ) + translation;
+				if( m_n )
+				{
+					m_n[i] = rotate( rw, rv, m_n[i] );
+				}
+			}
+		}
+
+		static inline V3f rotate( float w, const V3f &v, const V3f &p )
+		{
+			return p + ( v % ( ( v % p ) + p * w ) ) * 2.0f;
+		}
+
+		const int *m_pointIndexOffsets;
+		const int *m_pointInfluenceCounts;
+		const int *m_pointInfluenceIndices;
+		const float *m_pointInfluenceWeights;
+		V3f *m_p;
+		V3f *m_n;
+		const std::vector<AffineMatrix> *m_matrices;
+		const std::vector<DualQuat> *m_dualQuaternions;
+
+};
+
+} // namespace
+
 void PointSmoothSkinningOp::modify( Object *input, const CompoundObject *operands )
 {
 	// get the input parameters
@@ -273,7 +534,7 @@ void PointSmoothSkinningOp::modify( Object *input, const CompoundObject *operand
 	// generate skinning matrices
 	// we are pre-creating these as in the typical use-case the number of influence objects is much lower
 	// than the number of vertices that are going to be deformed
-    std::vector<M44f> skin_data;
+	std::vector<M44f> skin_data;
 	skin_data.reserve( inf_size );
 
 	std::vector<M44f>::const_iterator ip_it = ssd->influencePose()->readable().begin();
@@ -287,63 +548,30 @@ void PointSmoothSkinningOp::modify( Object *input, const CompoundObject *operand
 		++ip_it;
 	}
 
-
-	// iterate through all the points in the source primitive and deform using the weighted skinning matrices
-	if ( blend == Linear )
+	if ( !p_size )
 	{
-        std::vector<V3f>::iterator p_it = p_data.begin();
-
-		// todo, thread this
-        // deform our P
-        for ( p_it=p_data.begin(); p_it!=p_data.end(); ++p_it )
-        {
-			V3f p_new(0,0,0);
-
-			int p_id = p_it - p_data.begin();
-			int p_influence_count = ssd->pointInfluenceCounts()->readable()[p_id];
-			int p_index_offset = ssd->pointIndexOffsets()->readable()[p_id];
-
-			for (int p_influence_id = p_index_offset; p_influence_id < (p_index_offset+p_influence_count);
-					p_influence_id++)
-			{
-				int influence_id = ssd->pointInfluenceIndices()->readable()[p_influence_id];
-				float weight = ssd->pointInfluenceWeights()->readable()[p_influence_id];
-				p_new += (*p_it) * skin_data[influence_id] * weight;
-			}
-
-			(*p_it) = p_new;
+		return;
+	}
 
-        }
+	V3f *n_ptr = 0;
+	if ( deform_n )
+	{
+		n_ptr = &(pt->variableData<V3fVectorData>(normal_var)->writable()[0]);
+	}
 
-        // deform our N
-        if ( deform_n )
-        {
-        	V3fVectorData *n = pt->variableData<V3fVectorData>(normal_var);
-         	std::vector<V3f> &n_data =  n->writable();
-
-        	std::vector<V3f>::iterator n_it = n_data.begin();
-        	V3f n_unw;
-            for ( n_it=n_data.begin(); n_it!=n_data.end(); ++n_it )
-            {
-    			V3f n_new(0,0,0);
-
-    			int n_id = n_it - n_data.begin();
-    			int n_influence_count = ssd->pointInfluenceCounts()->readable()[n_id];
-    			int n_index_offset = ssd->pointIndexOffsets()->readable()[n_id];
-
-    			for (int n_influence_id = n_index_offset; n_influence_id < (n_index_offset+n_influence_count);
-    					n_influence_id++)
-    			{
-    				int influence_id = ssd->pointInfluenceIndices()->readable()[n_influence_id];
-    				float weight = ssd->pointInfluenceWeights()->readable()[n_influence_id];
-
-    				skin_data[influence_id].multDirMatrix((*n_it),n_unw);
-    				n_new += n_unw * weight;
-    			}
-
-    			(*n_it) = n_new;
-            }
-        }
+	// deform P and N together, in parallel over blocks of points
+	SkinningBody body( ssd.get(), &(p_data[0]), n_ptr );
+	std::vector<AffineMatrix> matrices;
+	std::vector<DualQuat> dualQuaternions;
+	if ( blend == Linear )
+	{
+		matrices.insert( matrices.end(), skin_data.begin(), skin_data.end() );
+		body.setMatrices( &matrices );
+	}
+	else if ( blend == DualQuaternion )
+	{
+		dualQuaternions.insert( dualQuaternions.end(), skin_data.begin(), skin_data.end() );
+		body.setDualQuaternions( &dualQuaternions );
 	}
 	else
 	{
@@ -351,4 +579,5 @@ void PointSmoothSkinningOp::modify( Object *input, const CompoundObject *operand
 		assert(0);
 	}
 
+	tbb::parallel_for( tbb::blocked_range<size_t>( 0, p_size, 1024 ), body );
 }
@@ -147,8 +147,10 @@ half PointsPrimitiveEvaluator::Result::halfPrimVar( const PrimitiveVariable &pv
 //////////////////////////////////////////////////////////////////////////
 
 PointsPrimitiveEvaluator::PointsPrimitiveEvaluator( ConstPointsPrimitivePtr points )
-	:	m_pointsPrimitive( points->copy() ), m_haveTree( false )
+	:	m_pointsPrimitive( points->copy() )
 {
+	m_tree = 0;
+
 	PrimitiveVariableMap::iterator pIt = m_pointsPrimitive->variables.find( "P" );
 	if( pIt==m_pointsPrimitive->variables.end() )
 	{
@@ -164,6 +166,7 @@ PointsPrimitiveEvaluator::PointsPrimitiveEvaluator( ConstPointsPrimitivePtr poin
 
 PointsPrimitiveEvaluator::~PointsPrimitiveEvaluator()
 {
+	delete m_tree;
 }
 
 PrimitiveEvaluatorPtr PointsPrimitiveEvaluator::create( ConstPrimitivePtr primitive )
@@ -213,18 +216,50 @@ bool PointsPrimitiveEvaluator::closestPoint( const Imath::V3f &p, PrimitiveEvalu
 		return false;
 	}
 
-	// the cast isn't pretty but i think is the best of the alternatives. we want to delay building the tree until the first
-	// closestPoint() query so people don't pay the overhead if they're just using other queries. the alternative to
-	// the cast is to make the tree members mutable, but i'd rather keep them immutable so that the compiler tells us if
-	// we do anything wrong during the queries.
-	const_cast<PointsPrimitiveEvaluator *>( this )->buildTree();
+	// we delay building the tree until the first closestPoint() query so
+	// people don't pay the overhead if they're just using other queries.
+	buildTree();
 
-	V3fTree::Iterator it = m_tree.nearestNeighbour( p );
+	V3fTree::Iterator it = m_tree->nearestNeighbour( p );
 	static_cast<Result *>( result )->m_pointIndex = it - m_pVector->begin();
 	
 	return true;
 }
 
+bool PointsPrimitiveEvaluator::closestPoints( const std::vector<Imath::V3f> &points, std::vector<Imath::V3f> *positions, std::vector<size_t> *pointIndices ) const
+{
+	if( !m_pointsPrimitive->getNumPoints() )
+	{
+		return false;
+	}
+
+	buildTree();
+
+	// the batch query sorts the points spatially and runs in parallel
+	std::vector<V3fTree::Iterator> nearest;
+	m_tree->nearestNeighbour( points.begin(), points.end(), nearest );
+
+	if( positions )
+	{
+		positions->resize( nearest.size() );
+		for( size_t i = 0; i < nearest.size(); ++i )
+		{
+			(*positions)[i] = *(nearest[i]);
+		}
+	}
+
+	if( pointIndices )
+	{
+		pointIndices->resize( nearest.size() );
+		for( size_t i = 0; i < nearest.size(); ++i )
+		{
+			(*pointIndices)[i] = nearest[i] - m_pVector->begin();
+		}
+	}
+
+	return true;
+}
+
 bool PointsPrimitiveEvaluator::pointAtUV( const Imath::V2f &uv, PrimitiveEvaluator::Result *result ) const
 {
 	throw NotImplementedException( __PRETTY_FUNCTION__ );
@@ -242,20 +277,21 @@ int PointsPrimitiveEvaluator::intersectionPoints( const Imath::V3f &origin, cons
 	throw NotImplementedException( __PRETTY_FUNCTION__ );
 }
 
-void PointsPrimitiveEvaluator::buildTree()
+void PointsPrimitiveEvaluator::buildTree() const
 {
-	if( m_haveTree )
+	if( m_tree )
 	{
 		return;
 	}
-	
-	TreeMutex::scoped_lock lock( m_treeMutex );
-	if( m_haveTree )
+
+	// we mustn't hold a lock while building, because large trees are built
+	// using TBB tasks, and while waiting for them this thread may pick up
+	// another task which queries this evaluator and so calls back in here.
+	// instead we build without locking and publish the result atomically,
+	// discarding our tree if another thread beat us to it.
+	V3fTree *tree = new V3fTree( m_pVector->begin(), m_pVector->end() );
+	if( m_tree.compare_and_swap( tree, 0 ) != 0 )
 	{
-		// another thread may have built the tree while we waited for the mutex
-		return;
+		delete tree;
 	}
-	
-	m_tree.init( m_pVector->begin(), m_pVector->end() );
-	m_haveTree = true;
 }
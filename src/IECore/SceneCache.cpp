@@ -32,8 +32,22 @@
 //
 //////////////////////////////////////////////////////////////////////////
 
+#include <algorithm>
+#include <deque>
+
 #include"boost/tuple/tuple.hpp"
+#include "boost/lexical_cast.hpp"
+#include "boost/scoped_ptr.hpp"
+#include "boost/shared_ptr.hpp"
+#include "boost/bind.hpp"
+#include "boost/function.hpp"
+#include "boost/noncopyable.hpp"
+#include "boost/thread/mutex.hpp"
+#include "boost/thread/condition_variable.hpp"
 #include "tbb/concurrent_hash_map.h"
+#include "tbb/atomic.h"
+#include "tbb/mutex.h"
+#include "tbb/tbb_thread.h"
 
 #include "OpenEXR/ImathBoxAlgo.h"
 
@@ -75,6 +89,10 @@ static InternedString attributesEntry("attributes");
 static InternedString childrenEntry("children");
 static InternedString sampleTimesEntry("sampleTimes");
 static InternedString tagsEntry("tags");
+static InternedString hashesEntry("hashes");
+static InternedString tagIndexEntry("tagIndex");
+static InternedString parentsEntry("parents");
+static InternedString namesEntry("names");
 
 const SceneInterface::Name &SceneCache::animatedObjectTopologyAttribute = InternedString( "sceneInterface:animatedObjectTopology" );
 const SceneInterface::Name &SceneCache::animatedObjectPrimVarsAttribute = InternedString( "sceneInterface:animatedObjectPrimVars" );
@@ -89,6 +107,13 @@ class SceneCache::Implementation : public RefCounted
 		{
 		}
 
+		/// Called before querying the file. Writers with asynchronous
+		/// writes enabled complete any pending writes, so that the
+		/// queries see them.
+		virtual void waitForWrites() const
+		{
+		}
+
 		std::string fileName() const
 		{
 			if ( m_indexedIO->typeId() == FileIndexedIOTypeId )
@@ -100,11 +125,13 @@ class SceneCache::Implementation : public RefCounted
 
 		bool hasObject() const
 		{
+			waitForWrites();
 			return m_indexedIO->hasEntry( objectEntry );
 		}
 
 		bool hasAttribute( const Name &name ) const
 		{
+			waitForWrites();
 			ConstIndexedIOPtr attributes = m_indexedIO->subdirectory( attributesEntry, IndexedIO::NullIfMissing );
 			if ( !attributes )
 				return false;
@@ -114,6 +141,7 @@ class SceneCache::Implementation : public RefCounted
 
 		void attributeNames( NameList &attrsNames ) const
 		{
+			waitForWrites();
 			ConstIndexedIOPtr attributes = m_indexedIO->subdirectory( attributesEntry, IndexedIO::NullIfMissing );
 			if ( !attributes )
 			{
@@ -126,6 +154,7 @@ class SceneCache::Implementation : public RefCounted
 
 		bool hasTag( const Name &name, bool includeChildren ) const
 		{
+			waitForWrites();
 			ConstIndexedIOPtr tagsIO = m_indexedIO->subdirectory( tagsEntry, IndexedIO::NullIfMissing );
 			if ( !tagsIO )
 			{
@@ -146,6 +175,7 @@ class SceneCache::Implementation : public RefCounted
 
 		void readTags( NameList &tags, bool includeChildren ) const
 		{
+			waitForWrites();
 			ConstIndexedIOPtr tagsIO = m_indexedIO->subdirectory( tagsEntry, IndexedIO::NullIfMissing );
 			if ( tagsIO )
 			{
@@ -167,6 +197,7 @@ class SceneCache::Implementation : public RefCounted
 
 		void childNames( NameList &childNames ) const
 		{
+			waitForWrites();
 			ConstIndexedIOPtr children = m_indexedIO->subdirectory( childrenEntry, IndexedIO::NullIfMissing );
 			if ( !children )
 			{
@@ -179,6 +210,7 @@ class SceneCache::Implementation : public RefCounted
 
 		bool hasChild( const Name &name ) const
 		{
+			waitForWrites();
 			ConstIndexedIOPtr children = m_indexedIO->subdirectory( childrenEntry, IndexedIO::NullIfMissing );
 			if ( !children )
 			{
@@ -237,7 +269,7 @@ class SceneCache::ReaderImplementation : public SceneCache::Implementation
 			else
 			{
 				// only the root instance allocate the map.
-				m_sharedData = new SharedData;
+				m_sharedData = new SharedData( io->parentDirectory() );
 			}
 		}
 	
@@ -578,6 +610,74 @@ class SceneCache::ReaderImplementation : public SceneCache::Implementation
 			return object;
 		}
 
+		void hash( SceneInterface::HashType hashType, double time, MurmurHash &h ) const
+		{
+			size_t sample1, sample2;
+			double x;
+			switch( hashType )
+			{
+				case SceneInterface::TransformHash :
+					x = transformSampleInterval( time, sample1, sample2 );
+					if ( x == 1 )
+					{
+						h.append( transformSampleHash( sample2 ) );
+					}
+					else if ( x == 0 )
+					{
+						h.append( transformSampleHash( sample1 ) );
+					}
+					else
+					{
+						appendInterpolatedHash( transformSampleHash( sample1 ), transformSampleHash( sample2 ), x, h );
+					}
+					break;
+				case SceneInterface::AttributesHash :
+					{
+						NameList attrs;
+						attributeNames( attrs );
+						for ( NameList::const_iterator it = attrs.begin(); it != attrs.end(); it++ )
+						{
+							h.append( *it );
+							x = attributeSampleInterval( *it, time, sample1, sample2 );
+							if ( x == 1 )
+							{
+								h.append( attributeSampleHash( *it, sample2 ) );
+							}
+							else if ( x == 0 )
+							{
+								h.append( attributeSampleHash( *it, sample1 ) );
+							}
+							else
+							{
+								appendInterpolatedHash( attributeSampleHash( *it, sample1 ), attributeSampleHash( *it, sample2 ), x, h );
+							}
+						}
+					}
+					break;
+				case SceneInterface::ObjectHash :
+					if ( !hasObject() )
+					{
+						break;
+					}
+					x = objectSampleInterval( time, sample1, sample2 );
+					if ( x == 1 )
+					{
+						h.append( objectSampleHash( sample2 ) );
+					}
+					else if ( x == 0 )
+					{
+						h.append( objectSampleHash( sample1 ) );
+					}
+					else
+					{
+						appendInterpolatedHash( objectSampleHash( sample1 ), objectSampleHash( sample2 ), x, h );
+					}
+					break;
+				default :
+					throw InvalidArgumentException( "SceneCache::ReaderImplementation::hash : Unsupported hash type" );
+			}
+		}
+
 		static PrimitiveVariableMap readObjectPrimitiveVariablesAtSample( const IndexedIOPtr &io, const std::vector<InternedString> &primVarNames, size_t sample )
 		{
 			return Primitive::loadPrimitiveVariables( io->subdirectory( objectEntry ), sampleEntry(sample), primVarNames );
@@ -667,18 +767,145 @@ class SceneCache::ReaderImplementation : public SceneCache::Implementation
 		typedef IECore::ComputationCache< SimpleCacheKey > SimpleCache;
 		typedef IECore::ComputationCache< AttributeCacheKey > AttributeCache;
 
+		/// Index of the locations holding each local tag, stored by the writer in the "tagIndex"
+		/// directory of the file. Locations are numbered in depth first order, so the descendants
+		/// of a location are the contiguous range of ids following it.
+		class TagIndex
+		{
+			public :
+
+				TagIndex( ConstIndexedIOPtr io )
+				{
+					size_t numLocations = io->entry( parentsEntry ).arrayLength();
+					m_parents.resize( numLocations );
+					::uint64_t *parents = &m_parents[0];
+					io->read( parentsEntry, parents, numLocations );
+					m_names.resize( numLocations );
+					InternedString *names = &m_names[0];
+					io->read( namesEntry, names, numLocations );
+
+					// the end of a subtree is the end of its last child's subtree.
+					m_subtreeEnds.resize( numLocations );
+					for ( size_t i = 0; i < numLocations; i++ )
+					{
+						m_subtreeEnds[i] = i + 1;
+					}
+					for ( size_t i = numLocations - 1; i > 0; i-- )
+					{
+						::uint64_t &parentEnd = m_subtreeEnds[ m_parents[i] ];
+						parentEnd = std::max( parentEnd, m_subtreeEnds[i] );
+					}
+
+					ConstIndexedIOPtr tagsIO = io->subdirectory( tagsEntry );
+					NameList tags;
+					tagsIO->entryIds( tags );
+					for ( NameList::const_iterator it = tags.begin(); it != tags.end(); it++ )
+					{
+						std::vector< ::uint64_t > &ids = m_tagLocations[*it];
+						ids.resize( tagsIO->entry( *it ).arrayLength() );
+						::uint64_t *idsPtr = &ids[0];
+						tagsIO->read( *it, idsPtr, ids.size() );
+					}
+				}
+
+				void taggedLocations( const SceneCache::Path &root, const SceneCache::Name &tag, std::vector<SceneCache::Path> &paths ) const
+				{
+					TagLocations::const_iterator tit = m_tagLocations.find( tag );
+					if ( tit == m_tagLocations.end() )
+					{
+						return;
+					}
+
+					size_t rootId = 0;
+					for ( SceneCache::Path::const_iterator it = root.begin(); it != root.end(); it++ )
+					{
+						// visit the children of rootId, skipping their subtrees
+						size_t childId = rootId + 1;
+						while ( childId < m_subtreeEnds[rootId] && m_names[childId] != *it )
+						{
+							childId = m_subtreeEnds[childId];
+						}
+						if ( childId >= m_subtreeEnds[rootId] )
+						{
+							return;
+						}
+						rootId = childId;
+					}
+
+					const std::vector< ::uint64_t > &ids = tit->second;
+					std::vector< ::uint64_t >::const_iterator begin = std::lower_bound( ids.begin(), ids.end(), rootId );
+					std::vector< ::uint64_t >::const_iterator end = std::lower_bound( begin, ids.end(), m_subtreeEnds[rootId] );
+					for ( ; begin != end; begin++ )
+					{
+						paths.push_back( SceneCache::Path() );
+						path( *begin, paths.back() );
+					}
+				}
+
+			private :
+
+				void path( size_t id, SceneCache::Path &p ) const
+				{
+					for ( ; id != 0; id = m_parents[id] )
+					{
+						p.push_back( m_names[id] );
+					}
+					std::reverse( p.begin(), p.end() );
+				}
+
+				typedef std::map< SceneCache::Name, std::vector< ::uint64_t > > TagLocations;
+
+				std::vector< ::uint64_t > m_parents;
+				std::vector< InternedString > m_names;
+				std::vector< ::uint64_t > m_subtreeEnds;
+				TagLocations m_tagLocations;
+
+		};
+
 		/// Hold pointers to values allocated/deallocated by the root scene object (the last one to die)
 		class SharedData : public RefCounted
 		{
 			public :
 
-				SharedData() : 
-					objectCache( new SimpleCache( doReadObjectAtSample, simpleHash,  10000 )  ), 
-					attributeCache( new AttributeCache( doReadAttributeAtSample, attributeHash, 1000) ), 
-					transformCache( new SimpleCache(  doReadTransformAtSample, simpleHash, 1000) )
+				SharedData( ConstIndexedIOPtr fileRoot ) : 
+					objectCache( new SimpleCache( doReadObjectAtSample, simpleHash, getCacheMemoryLimit( Objects ), ObjectPool::defaultObjectPool(), SimpleCache::MemoryCost ) ), 
+					attributeCache( new AttributeCache( doReadAttributeAtSample, attributeHash, getCacheMemoryLimit( Attributes ), ObjectPool::defaultObjectPool(), AttributeCache::MemoryCost ) ), 
+					transformCache( new SimpleCache( doReadTransformAtSample, simpleHash, getCacheMemoryLimit( Transforms ), ObjectPool::defaultObjectPool(), SimpleCache::MemoryCost ) ),
+					fileRoot( fileRoot ),
+					tagIndexLoaded( false )
 				{
 				}
 
+				/// Returns the tag index, loading it on first use, or 0 for files written without one.
+				const TagIndex *tagIndex()
+				{
+					tbb::mutex::scoped_lock lock( tagIndexMutex );
+					if ( !tagIndexLoaded )
+					{
+						if ( fileRoot->hasEntry( tagIndexEntry ) )
+						{
+							m_tagIndex.reset( new TagIndex( fileRoot->subdirectory( tagIndexEntry ) ) );
+						}
+						tagIndexLoaded = true;
+					}
+					return m_tagIndex.get();
+				}
+
+				CompoundDataPtr cacheStatistics( CacheType cacheType ) const
+				{
+					switch( cacheType )
+					{
+						case Objects :
+							return cacheStatistics( objectCache.get() );
+						case Attributes :
+							return cacheStatistics( attributeCache.get() );
+						case Transforms :
+							return cacheStatistics( transformCache.get() );
+						default :
+							throw InvalidArgumentException( "Invalid cache type" );
+					}
+				}
+
 				/// utility function used by the ReaderImplementation to use the LRUCache for transform reading
 				IECore::ConstDataPtr readTransformAtSample( const ReaderImplementation *reader, size_t sample )
 				{
@@ -740,9 +967,27 @@ class SceneCache::ReaderImplementation : public SceneCache::Implementation
 				SimpleCache::Ptr objectCache;
 				AttributeCache::Ptr attributeCache;
 				SimpleCache::Ptr transformCache;
+				ConstIndexedIOPtr fileRoot;
+				tbb::mutex tagIndexMutex;
+				bool tagIndexLoaded;
 
 			private :
 
+				boost::scoped_ptr<TagIndex> m_tagIndex;
+
+			template< typename Cache >
+			static CompoundDataPtr cacheStatistics( const Cache *cache )
+			{
+				CompoundDataPtr result = new CompoundData;
+				CompoundDataMap &m = result->writable();
+				m["hits"] = new UInt64Data( cache->hits() );
+				m["misses"] = new UInt64Data( cache->misses() );
+				m["evictions"] = new UInt64Data( cache->evictions() );
+				m["memoryUsage"] = new UInt64Data( cache->cachedComputations() );
+				m["memoryLimit"] = new UInt64Data( cache->getMaxComputations() );
+				return result;
+			}
+
 			// utility function that copies all the values from the rhs dictionary to the lhs.
 			template< typename T >
 			static void mergeMaps ( T& lhs, const T& rhs) 
@@ -771,6 +1016,29 @@ class SceneCache::ReaderImplementation : public SceneCache::Implementation
 
 		};
 
+	public :
+
+		CompoundDataPtr cacheStatistics( CacheType cacheType ) const
+		{
+			return m_sharedData->cacheStatistics( cacheType );
+		}
+
+		/// Returns false if the file has no tag index.
+		bool taggedLocations( const SceneCache::Name &name, std::vector<SceneCache::Path> &paths ) const
+		{
+			const TagIndex *index = m_sharedData->tagIndex();
+			if ( !index )
+			{
+				return false;
+			}
+			SceneCache::Path p;
+			path( p );
+			index->taggedLocations( p, name, paths );
+			return true;
+		}
+
+	private :
+
 		ReaderImplementationPtr m_parent;
 		mutable SharedData *m_sharedData;
 
@@ -780,6 +1048,12 @@ class SceneCache::ReaderImplementation : public SceneCache::Implementation
 		mutable AttributeSamplesMap m_attributeSampleTimes;
 		mutable const SampleTimes *m_objectSampleTimes;
 
+		/// hashes of the samples of the transform, object and attributes, loaded by sampleHashes().
+		typedef std::pair< IndexedIO::EntryID, IndexedIO::EntryID > SampleHashesKey;
+		typedef std::map< SampleHashesKey, std::vector< ::uint64_t > > SampleHashesMap;
+		mutable SampleHashesMap m_sampleHashes;
+		mutable tbb::mutex m_sampleHashesMutex;
+
 		IndexedIOPtr globalSampleTimes() const
 		{
 			if ( m_parent )
@@ -919,6 +1193,86 @@ class SceneCache::ReaderImplementation : public SceneCache::Implementation
 			return Object::load( get<0>(key)->m_indexedIO->subdirectory(attributesEntry)->subdirectory(get<1>(key)), sampleEntry(get<2>(key)) );
 		}
 
+		// Returns the hashes stored by the writer for all the samples of the transform, object
+		// or the named attribute, loading them on first use. The result is empty for files
+		// written without hashes.
+		const std::vector< ::uint64_t > &sampleHashes( const IndexedIO::EntryID &entry, const IndexedIO::EntryID &name ) const
+		{
+			tbb::mutex::scoped_lock lock( m_sampleHashesMutex );
+			std::pair< SampleHashesMap::iterator, bool > it = m_sampleHashes.insert( SampleHashesMap::value_type( SampleHashesKey( entry, name ), std::vector< ::uint64_t >() ) );
+			if ( it.second )
+			{
+				ConstIndexedIOPtr location = m_indexedIO->subdirectory( entry, IndexedIO::NullIfMissing );
+				if ( location && entry == attributesEntry )
+				{
+					location = location->subdirectory( name, IndexedIO::NullIfMissing );
+				}
+				if ( location && location->hasEntry( hashesEntry ) )
+				{
+					std::vector< ::uint64_t > &hashes = it.first->second;
+					hashes.resize( location->entry( hashesEntry ).arrayLength() );
+					::uint64_t *hashesPtr = &hashes[0];
+					location->read( hashesEntry, hashesPtr, hashes.size() );
+				}
+			}
+			return it.first->second;
+		}
+
+		// Gets the hash stored by the writer for the given sample.
+		// Returns false if the file was written without hashes.
+		bool restoreSampleHash( const IndexedIO::EntryID &entry, const IndexedIO::EntryID &name, size_t sample, MurmurHash &h ) const
+		{
+			const std::vector< ::uint64_t > &hashes = sampleHashes( entry, name );
+			if ( sample * 2 + 1 >= hashes.size() )
+			{
+				return false;
+			}
+			h = MurmurHash( hashes[sample * 2], hashes[sample * 2 + 1] );
+			return true;
+		}
+
+		MurmurHash transformSampleHash( size_t sample ) const
+		{
+			MurmurHash h;
+			if ( !restoreSampleHash( transformEntry, IndexedIO::EntryID(), sample, h ) )
+			{
+				h = readTransformAtSample( sample )->Object::hash();
+			}
+			return h;
+		}
+
+		MurmurHash attributeSampleHash( const SceneCache::Name &name, size_t sample ) const
+		{
+			MurmurHash h;
+			if ( !restoreSampleHash( attributesEntry, name, sample, h ) )
+			{
+				h = readAttributeAtSample( name, sample )->hash();
+			}
+			return h;
+		}
+
+		MurmurHash objectSampleHash( size_t sample ) const
+		{
+			MurmurHash h;
+			if ( !restoreSampleHash( objectEntry, IndexedIO::EntryID(), sample, h ) )
+			{
+				h = readObjectAtSample( sample )->hash();
+			}
+			return h;
+		}
+
+		// Appends the hash for a value interpolated between two samples. Interpolating
+		// equal samples gives the same value at any time, so we hash just one of them.
+		static void appendInterpolatedHash( const MurmurHash &h1, const MurmurHash &h2, double x, MurmurHash &h )
+		{
+			h.append( h1 );
+			if ( h1 != h2 )
+			{
+				h.append( h2 );
+				h.append( x );
+			}
+		}
+
 		/// Determine defaults when transform and bounds are not stored in the file.
 		/// The reader will return one sample at time 0 with empty bounding box and
 		/// with identity transform.
@@ -941,6 +1295,163 @@ class SceneCache::ReaderImplementation : public SceneCache::Implementation
 
 SceneCache::ReaderImplementation::Defaults SceneCache::ReaderImplementation::g_defaults;
 
+namespace
+{
+
+/// Performs the writes for a SceneCache with asynchronous writes enabled, in the order in which
+/// they were queued, on a background thread. Each write is split into a prepare function,
+/// which does work that doesn't touch the file (hashing, computing bounds), and a write
+/// function, which is run with ioMutex() locked so that it can't interleave with the
+/// IndexedIO calls still made from the calling thread. The queue is limited by the memory
+/// cost given for each write, and push() blocks until there is room for another.
+class WriteQueue : private boost::noncopyable
+{
+
+	public :
+
+		typedef boost::function<void ()> Function;
+
+		WriteQueue( size_t maxMemory )
+			:	m_maxMemory( maxMemory ), m_queuedMemory( 0 ), m_busy( false ), m_stop( false )
+		{
+			tbb::tbb_thread thread( boost::bind( &WriteQueue::run, this ) );
+			m_thread = thread;
+		}
+
+		~WriteQueue()
+		{
+			{
+				boost::mutex::scoped_lock lock( m_mutex );
+				m_stop = true;
+			}
+			m_condition.notify_all();
+			m_thread.join();
+		}
+
+		size_t getMaxMemory() const
+		{
+			return m_maxMemory;
+		}
+
+		void push( const Function &prepare, const Function &write, size_t cost )
+		{
+			boost::mutex::scoped_lock lock( m_mutex );
+			// apply back-pressure when the queue is full. a single item costing more than
+			// the limit is still accepted once everything before it has been written.
+			while( m_queuedMemory && m_queuedMemory + cost > m_maxMemory )
+			{
+				m_condition.wait( lock );
+			}
+			m_items.push_back( Item( prepare, write, cost ) );
+			m_queuedMemory += cost;
+			m_condition.notify_all();
+		}
+
+		/// Waits until all queued writes are complete, and throws if any of
+		/// them failed since the last call.
+		void wait()
+		{
+			boost::mutex::scoped_lock lock( m_mutex );
+			while( m_items.size() || m_busy )
+			{
+				m_condition.wait( lock );
+			}
+			if( m_error.size() )
+			{
+				std::string error;
+				std::swap( error, m_error );
+				throw Exception( error );
+			}
+		}
+
+		boost::mutex &ioMutex()
+		{
+			return m_ioMutex;
+		}
+
+	private :
+
+		struct Item
+		{
+			Item( const Function &p, const Function &w, size_t c ) : prepare( p ), write( w ), cost( c )
+			{
+			}
+
+			Function prepare;
+			Function write;
+			size_t cost;
+		};
+
+		void run()
+		{
+			while( true )
+			{
+				Item item( Function(), Function(), 0 );
+				{
+					boost::mutex::scoped_lock lock( m_mutex );
+					while( m_items.empty() && !m_stop )
+					{
+						m_condition.wait( lock );
+					}
+					if( m_items.empty() )
+					{
+						return;
+					}
+					item = m_items.front();
+					m_items.pop_front();
+					m_busy = true;
+				}
+
+				std::string error;
+				try
+				{
+					if( item.prepare )
+					{
+						item.prepare();
+					}
+					boost::mutex::scoped_lock ioLock( m_ioMutex );
+					item.write();
+				}
+				catch( std::exception &e )
+				{
+					error = e.what();
+				}
+				catch( ... )
+				{
+					error = "Unknown exception";
+				}
+
+				// release the item's references before reporting it done, so
+				// that the data is freed before the queue makes room for more.
+				const size_t cost = item.cost;
+				item = Item( Function(), Function(), 0 );
+
+				boost::mutex::scoped_lock lock( m_mutex );
+				if( error.size() && m_error.empty() )
+				{
+					m_error = error;
+				}
+				m_queuedMemory -= cost;
+				m_busy = false;
+				m_condition.notify_all();
+			}
+		}
+
+		const size_t m_maxMemory;
+		size_t m_queuedMemory;
+		bool m_busy;
+		bool m_stop;
+		std::deque<Item> m_items;
+		std::string m_error;
+		boost::mutex m_mutex;
+		boost::condition_variable m_condition;
+		boost::mutex m_ioMutex;
+		tbb::tbb_thread m_thread;
+
+};
+
+} // namespace
+
 /// Writer implementation for SceneCache
 /// Each location keeps refcount pointers to their child locations, so they can always return the same (unfinished child) and when the root is destroyed, it
 /// can trigger the recursive computation of bounding boxes and the global storage of all sampleTime vectors used in the file.
@@ -950,7 +1461,7 @@ class SceneCache::WriterImplementation : public SceneCache::Implementation
 
 		IE_CORE_DECLAREPTR( WriterImplementation )
 
-		WriterImplementation( IndexedIOPtr io, Implementation *parent = 0) : SceneCache::Implementation( io ), m_parent(static_cast< WriterImplementation* >( parent ))
+		WriterImplementation( IndexedIOPtr io, Implementation *parent = 0) : SceneCache::Implementation( io ), m_parent(static_cast< WriterImplementation* >( parent )), m_numObjectBounds( 0 )
 		{
 			if ( m_parent )
 			{
@@ -969,6 +1480,19 @@ class SceneCache::WriterImplementation : public SceneCache::Implementation
 			// the root location destruction triggers the flush on the file.
 			if ( !m_parent )
 			{
+				if ( m_writeQueue )
+				{
+					try
+					{
+						m_writeQueue->wait();
+					}
+					catch ( std::exception &e )
+					{
+						msg( Msg::Error, "SceneCache::~SceneCache", ( boost::format( "Corrupted file resulted from exception while writing data: %s." ) % e.what() ).str() );
+					}
+					m_writeQueue.reset();
+				}
+
 				try
 				{
 					flush();
@@ -1021,8 +1545,7 @@ class SceneCache::WriterImplementation : public SceneCache::Implementation
 			size_t sampleIndex = m_boundSampleTimes.size();
 			m_boundSampleTimes.push_back( time );
 			m_boundSamples.push_back( bound );
-			IndexedIOPtr io = m_indexedIO->subdirectory( boundEntry, IndexedIO::CreateIfMissing );
-			io->write( sampleEntry(sampleIndex), bound.min.getValue(), 6 );
+			queueWrite( WriteQueue::Function(), boost::bind( &WriterImplementation::saveBound, this, bound, sampleIndex ), sizeof( bound ) );
 		}
 
 		void writeTransform( const Data *transform, double time )
@@ -1055,9 +1578,15 @@ class SceneCache::WriterImplementation : public SceneCache::Implementation
 			}
 			size_t sampleIndex = m_transformSampleTimes.size();
 			m_transformSampleTimes.push_back( time );
-			IndexedIOPtr io = m_indexedIO->subdirectory( transformEntry, IndexedIO::CreateIfMissing );
-			((const Object *)transform)->save( io, sampleEntry(sampleIndex) );
-			m_transformSamples.push_back( transform );
+			// when writing asynchronously we hold a copy, so the caller is free to modify
+			// the original. the copy is cheap, as TypedData shares its contents until written to.
+			ConstDataPtr sample = writeQueue() ? ConstDataPtr( transform->copy() ) : ConstDataPtr( transform );
+			m_transformSamples.push_back( sample );
+			queueWrite(
+				boost::bind( &WriterImplementation::hashTransform, this, sample ),
+				boost::bind( &WriterImplementation::saveTransform, this, sample, sampleIndex ),
+				sample->memoryUsage()
+			);
 		}
 
 		void writeAttribute( const SceneCache::Name &name, const Object *attribute, double time )
@@ -1080,9 +1609,12 @@ class SceneCache::WriterImplementation : public SceneCache::Implementation
 			}
 			size_t sampleIndex = sampleTimes.size();
 			sampleTimes.push_back( time );
-			IndexedIOPtr io = m_indexedIO->subdirectory( attributesEntry, IndexedIO::CreateIfMissing );
-			io = io->subdirectory( name, IndexedIO::CreateIfMissing );
-			attribute->save( io, sampleEntry(sampleIndex) );
+			ConstObjectPtr sample = writeQueue() ? ConstObjectPtr( attribute->copy() ) : ConstObjectPtr( attribute );
+			queueWrite(
+				boost::bind( &WriterImplementation::hashAttribute, this, name, sample ),
+				boost::bind( &WriterImplementation::saveAttribute, this, name, sample, sampleIndex ),
+				sample->memoryUsage()
+			);
 		}
 
 		void writeTag( const char *tag )
@@ -1101,6 +1633,11 @@ class SceneCache::WriterImplementation : public SceneCache::Implementation
 				return;
 			}
 			writable();
+			queueWrite( WriteQueue::Function(), boost::bind( &WriterImplementation::saveTags, this, tags, fromChildren ), tags.size() * sizeof( Name ) );
+		}
+
+		void saveTags( const NameList &tags, bool fromChildren )
+		{
 			IndexedIOPtr io = m_indexedIO->subdirectory( tagsEntry, IndexedIO::CreateIfMissing );
 			for ( NameList::const_iterator tIt = tags.begin(); tIt != tags.end(); tIt++ )
 			{
@@ -1144,74 +1681,61 @@ class SceneCache::WriterImplementation : public SceneCache::Implementation
 			}
 			size_t sampleIndex = m_objectSampleTimes.size();
 			m_objectSampleTimes.push_back( time );
-			IndexedIOPtr io = m_indexedIO->subdirectory( objectEntry, IndexedIO::CreateIfMissing );
-			object->save( io, sampleEntry(sampleIndex) );
-			
-			const VisibleRenderable *renderable = runTimeCast< const VisibleRenderable >( object );
-			if ( renderable )
+
+			if ( runTimeCast< const VisibleRenderable >( object ) )
 			{
-				if ( !m_objectSamples.size() && m_objectSampleTimes.size() > 1 )
+				if ( !m_numObjectBounds && m_objectSampleTimes.size() > 1 )
 				{
 					throw Exception( "Either all object samples must have bounds (VisibleRenderable) or none of them!" );
 				}
-				
-				const Primitive *primitive = runTimeCast< const Primitive >( renderable );
-				if ( primitive )
-				{
-					MurmurHash topologyHash;
-					primitive->topologyHash( topologyHash );
-					topologyHash.append( primitive->typeId() );
-					if ( !m_objectSamples.empty() && topologyHash != m_animatedObjectTopology.first )
-					{
-						m_animatedObjectTopology.second = true;
-					}
-					else
-					{
-						m_animatedObjectTopology = AnimatedHashTest( topologyHash, false );
-					}
-					
-					for ( PrimitiveVariableMap::const_iterator it = primitive->variables.begin(); it != primitive->variables.end(); ++it )
-					{
-						Name primVarName = Name( it->first );
-						
-						MurmurHash hash;
-						it->second.data->hash( hash );
-						hash.append( it->second.interpolation );
-						
-						AnimatedPrimVarMap::iterator pIt = m_animatedObjectPrimVars.find( primVarName );
-						if ( pIt == m_animatedObjectPrimVars.end() )
-						{
-							m_animatedObjectPrimVars.insert( AnimatedPrimVarMap::value_type( primVarName, AnimatedHashTest( hash, false ) ) );
-						}
-						else if ( hash != pIt->second.first )
-						{
-							pIt->second.second = true;
-						}
-					}
-				}
-				
-				Box3f bf = renderable->bound();
-				Box3d bd(
-					V3d( bf.min.x, bf.min.y, bf.min.z ),
-					V3f( bf.max.x, bf.max.y, bf.max.z )
-				);
-				m_objectSamples.push_back( bd );
+				m_numObjectBounds++;
 			}
 			else
 			{
-				if ( m_objectSamples.size() )
+				if ( m_numObjectBounds )
 				{
 					throw Exception( "Either all object samples must have bounds (VisibleRenderable) or none of them!" );
 				}
 			}
 
-			if ( sampleIndex == 0 )
+			ConstObjectPtr sample = writeQueue() ? ConstObjectPtr( object->copy() ) : ConstObjectPtr( object );
+			queueWrite(
+				boost::bind( &WriterImplementation::prepareObject, this, sample ),
+				boost::bind( &WriterImplementation::saveObject, this, sample, sampleIndex ),
+				sample->memoryUsage()
+			);
+		}
+
+		void setAsynchronousWrites( bool enabled, size_t maxQueueMemory )
+		{
+			if ( m_parent )
 			{
-				// save the type of object as a tag
-				char objectTypeTag[128];
-				strcpy( objectTypeTag, "ObjectType:");
-				strcpy( &objectTypeTag[11], object->typeName() );
-				writeTag( objectTypeTag );
+				m_parent->setAsynchronousWrites( enabled, maxQueueMemory );
+				return;
+			}
+
+			writable();
+			if ( m_writeQueue )
+			{
+				m_writeQueue->wait();
+				m_writeQueue.reset();
+			}
+			if ( enabled )
+			{
+				m_writeQueue.reset( new WriteQueue( maxQueueMemory ) );
+			}
+		}
+
+		bool getAsynchronousWrites() const
+		{
+			return writeQueue() != 0;
+		}
+
+		virtual void waitForWrites() const
+		{
+			if ( WriteQueue *queue = writeQueue() )
+			{
+				queue->wait();
 			}
 		}
 
@@ -1228,6 +1752,7 @@ class SceneCache::WriterImplementation : public SceneCache::Implementation
 				return it->second;
 			}
 
+			IOLock lock( writeQueue() );
 			IndexedIOPtr children = m_indexedIO->subdirectory( childrenEntry, (IndexedIO::MissingBehaviour)missingBehaviour );
 			if ( !children )
 			{
@@ -1246,6 +1771,7 @@ class SceneCache::WriterImplementation : public SceneCache::Implementation
 		SceneCache::ImplementationPtr createChild( const SceneCache::Name &name )
 		{
 			writable();
+			IOLock lock( writeQueue() );
 			IndexedIOPtr children = m_indexedIO->subdirectory( childrenEntry, IndexedIO::CreateIfMissing );
 			if ( children->hasEntry( name ) )
 			{
@@ -1270,9 +1796,168 @@ class SceneCache::WriterImplementation : public SceneCache::Implementation
 	private :
 
 		typedef std::vector< Imath::Box3d > BoxSamples;
+		typedef std::vector< MurmurHash > Hashes;
 		typedef ConstDataPtr TransformSample;
 		typedef std::vector< TransformSample > TransformSamples;
 
+		WriteQueue *writeQueue() const
+		{
+			if ( m_parent )
+			{
+				return m_parent->writeQueue();
+			}
+			return m_writeQueue.get();
+		}
+
+		/// Holds the IndexedIO lock of the queue if there is one, for
+		/// IndexedIO operations made outside of the queue.
+		class IOLock : private boost::noncopyable
+		{
+
+			public :
+
+				IOLock( WriteQueue *queue )
+					:	m_queue( queue )
+				{
+					if ( m_queue )
+					{
+						m_queue->ioMutex().lock();
+					}
+				}
+
+				~IOLock()
+				{
+					if ( m_queue )
+					{
+						m_queue->ioMutex().unlock();
+					}
+				}
+
+			private :
+
+				WriteQueue *m_queue;
+
+		};
+
+		/// Performs a write, either immediately or by queuing it when asynchronous writes are
+		/// enabled. The prepare function performs any work which doesn't touch the file, and
+		/// the write function saves to the file. The functions must only modify state which
+		/// isn't accessed outside of them until waitForWrites() has been called.
+		void queueWrite( const WriteQueue::Function &prepare, const WriteQueue::Function &write, size_t cost )
+		{
+			if ( WriteQueue *queue = writeQueue() )
+			{
+				queue->push( prepare, write, cost );
+			}
+			else
+			{
+				if ( prepare )
+				{
+					prepare();
+				}
+				write();
+			}
+		}
+
+		void saveBound( const Imath::Box3d &bound, size_t sampleIndex )
+		{
+			IndexedIOPtr io = m_indexedIO->subdirectory( boundEntry, IndexedIO::CreateIfMissing );
+			io->write( sampleEntry(sampleIndex), bound.min.getValue(), 6 );
+		}
+
+		void hashTransform( ConstDataPtr transform )
+		{
+			m_transformHashes.push_back( transform->Object::hash() );
+		}
+
+		void saveTransform( ConstDataPtr transform, size_t sampleIndex )
+		{
+			IndexedIOPtr io = m_indexedIO->subdirectory( transformEntry, IndexedIO::CreateIfMissing );
+			((const Object *)transform.get())->save( io, sampleEntry(sampleIndex) );
+		}
+
+		void hashAttribute( const SceneCache::Name &name, ConstObjectPtr attribute )
+		{
+			m_attributeHashes[name].push_back( attribute->hash() );
+		}
+
+		void saveAttribute( const SceneCache::Name &name, ConstObjectPtr attribute, size_t sampleIndex )
+		{
+			IndexedIOPtr io = m_indexedIO->subdirectory( attributesEntry, IndexedIO::CreateIfMissing );
+			io = io->subdirectory( name, IndexedIO::CreateIfMissing );
+			attribute->save( io, sampleEntry(sampleIndex) );
+		}
+
+		// Computes the hash and bound of an object sample, and tracks which
+		// parts of primitives are animated.
+		void prepareObject( ConstObjectPtr object )
+		{
+			m_objectHashes.push_back( object->hash() );
+
+			const VisibleRenderable *renderable = runTimeCast< const VisibleRenderable >( object.get() );
+			if ( !renderable )
+			{
+				return;
+			}
+
+			const Primitive *primitive = runTimeCast< const Primitive >( renderable );
+			if ( primitive )
+			{
+				MurmurHash topologyHash;
+				primitive->topologyHash( topologyHash );
+				topologyHash.append( primitive->typeId() );
+				if ( !m_objectSamples.empty() && topologyHash != m_animatedObjectTopology.first )
+				{
+					m_animatedObjectTopology.second = true;
+				}
+				else
+				{
+					m_animatedObjectTopology = AnimatedHashTest( topologyHash, false );
+				}
+
+				for ( PrimitiveVariableMap::const_iterator it = primitive->variables.begin(); it != primitive->variables.end(); ++it )
+				{
+					Name primVarName = Name( it->first );
+
+					MurmurHash hash;
+					it->second.data->hash( hash );
+					hash.append( it->second.interpolation );
+
+					AnimatedPrimVarMap::iterator pIt = m_animatedObjectPrimVars.find( primVarName );
+					if ( pIt == m_animatedObjectPrimVars.end() )
+					{
+						m_animatedObjectPrimVars.insert( AnimatedPrimVarMap::value_type( primVarName, AnimatedHashTest( hash, false ) ) );
+					}
+					else if ( hash != pIt->second.first )
+					{
+						pIt->second.second = true;
+					}
+				}
+			}
+
+			Box3f bf = renderable->bound();
+			Box3d bd(
+				V3d( bf.min.x, bf.min.y, bf.min.z ),
+				V3f( bf.max.x, bf.max.y, bf.max.z )
+			);
+			m_objectSamples.push_back( bd );
+		}
+
+		void saveObject( ConstObjectPtr object, size_t sampleIndex )
+		{
+			IndexedIOPtr io = m_indexedIO->subdirectory( objectEntry, IndexedIO::CreateIfMissing );
+			object->save( io, sampleEntry(sampleIndex) );
+
+			if ( sampleIndex == 0 )
+			{
+				// save the type of object as a tag
+				char objectTypeTag[128];
+				strcpy( objectTypeTag, "ObjectType:");
+				strcpy( &objectTypeTag[11], object->typeName() );
+				writeTag( objectTypeTag );
+			}
+		}
+
 		IndexedIOPtr globalSampleTimes()
 		{
 			if ( m_parent )
@@ -1319,6 +2004,62 @@ class SceneCache::WriterImplementation : public SceneCache::Implementation
 			location->createSubdirectory( sampleTimesEntry )->createSubdirectory( samplesEntry );
 		}
 
+		typedef std::map< SceneCache::Name, std::vector< ::uint64_t > > TagLocations;
+
+		// Numbers this location and its descendants in depth first order, recording
+		// their parents, names and local tags for the tag index.
+		void collectTagIndex( ::uint64_t parentId, std::vector< ::uint64_t > &parents, std::vector< InternedString > &names, TagLocations &tagLocations ) const
+		{
+			::uint64_t id = parents.size();
+			parents.push_back( parentId );
+			names.push_back( name() );
+
+			NameList tags;
+			readTags( tags, false );
+			for ( NameList::const_iterator it = tags.begin(); it != tags.end(); it++ )
+			{
+				tagLocations[*it].push_back( id );
+			}
+
+			for ( std::map< SceneCache::Name, WriterImplementationPtr >::const_iterator cit = m_children.begin(); cit != m_children.end(); cit++ )
+			{
+				cit->second->collectTagIndex( id, parents, names, tagLocations );
+			}
+		}
+
+		// Stores the locations holding each local tag in the file, so readers
+		// can find the tagged descendants of a location without visiting them.
+		void writeTagIndex()
+		{
+			std::vector< ::uint64_t > parents;
+			std::vector< InternedString > names;
+			TagLocations tagLocations;
+			collectTagIndex( 0, parents, names, tagLocations );
+
+			IndexedIOPtr io = m_indexedIO->parentDirectory()->subdirectory( tagIndexEntry, IndexedIO::CreateIfMissing );
+			io->write( parentsEntry, &parents[0], parents.size() );
+			io->write( namesEntry, &names[0], names.size() );
+			IndexedIOPtr tagsIO = io->subdirectory( tagsEntry, IndexedIO::CreateIfMissing );
+			for ( TagLocations::const_iterator it = tagLocations.begin(); it != tagLocations.end(); it++ )
+			{
+				tagsIO->write( it->first, &(it->second[0]), it->second.size() );
+			}
+		}
+
+		// Stores the hashes of all the samples in the file location, so readers
+		// can return them without loading the samples.
+		static void storeHashes( const Hashes &hashes, IndexedIOPtr location )
+		{
+			std::vector< ::uint64_t > data;
+			data.reserve( hashes.size() * 2 );
+			for ( Hashes::const_iterator it = hashes.begin(); it != hashes.end(); it++ )
+			{
+				data.push_back( it->h1() );
+				data.push_back( it->h2() );
+			}
+			location->write( hashesEntry, &data[0], data.size() );
+		}
+
 		// function called when bounding boxes were not explicitly defined in this scene location.
 		// the function accumulates bounding box samples in the variables m_boundSampleTimes and m_boundSamples.
 		void accumulateBoxSamples( const SampleTimes &sampleTimes, const BoxSamples &boxSamples )
@@ -1482,6 +2223,12 @@ class SceneCache::WriterImplementation : public SceneCache::Implementation
 		//
 		void flush()
 		{
+			if ( !m_parent && m_sampleTimesMap )
+			{
+				// the tag index needs the children, which are released as they are flushed.
+				writeTagIndex();
+			}
+
 			/// first call flush recursively on children...
 			for ( std::map< SceneCache::Name, WriterImplementationPtr >::const_iterator cit = m_children.begin(); cit != m_children.end(); cit++ )
 			{
@@ -1494,6 +2241,7 @@ class SceneCache::WriterImplementation : public SceneCache::Implementation
 			{
 				io = m_indexedIO->subdirectory( transformEntry, IndexedIO::CreateIfMissing );
 				storeSampleTimes( m_transformSampleTimes, io );
+				storeHashes( m_transformHashes, io );
 			}
 			
 			// detect if topology or prim vars are animated
@@ -1525,14 +2273,17 @@ class SceneCache::WriterImplementation : public SceneCache::Implementation
 				io = m_indexedIO->subdirectory( attributesEntry, IndexedIO::CreateIfMissing );
 				for ( AttributeSamplesMap::const_iterator it = m_attributeSampleTimes.begin(); it != m_attributeSampleTimes.end(); it++ )
 				{
-					storeSampleTimes( it->second, io->subdirectory( it->first, IndexedIO::CreateIfMissing ) );
+					IndexedIOPtr attributeIO = io->subdirectory( it->first, IndexedIO::CreateIfMissing );
+					storeSampleTimes( it->second, attributeIO );
+					storeHashes( m_attributeHashes[it->first], attributeIO );
 				}
 			}
 			// save the object sample times
 			if ( m_objectSampleTimes.size() )
 			{
 				io = m_indexedIO->subdirectory( objectEntry, IndexedIO::CreateIfMissing );
-				storeSampleTimes( m_objectSampleTimes, io );				
+				storeSampleTimes( m_objectSampleTimes, io );
+				storeHashes( m_objectHashes, io );
 			}
 			// We have to compute the bounding box over time for the object and each child if there's no bound overrides writen.
 			bool computedBounds = false;
@@ -1871,6 +2622,7 @@ class SceneCache::WriterImplementation : public SceneCache::Implementation
 
 		typedef std::map< SampleTimes, ::uint64_t > SampleTimesMap;
 		typedef std::map< SceneCache::Name, SampleTimes > AttributeSamplesMap;
+		typedef std::map< SceneCache::Name, Hashes > AttributeHashesMap;
 
 		SampleTimesMap *m_sampleTimesMap;
 		SampleTimes m_boundSampleTimes;		// implicit or explicit bound sample times
@@ -1883,18 +2635,104 @@ class SceneCache::WriterImplementation : public SceneCache::Implementation
 		BoxSamples m_objectSamples;
 		// overwriting bounding boxes (or used during flush to compute the final bounding boxes).
 		BoxSamples m_boundSamples;
+		// hashes of each sample, stored in the file during flush.
+		Hashes m_transformHashes;
+		AttributeHashesMap m_attributeHashes;
+		Hashes m_objectHashes;
 		
 		typedef std::pair< MurmurHash, bool> AnimatedHashTest;
 		typedef std::map< SceneCache::Name, AnimatedHashTest > AnimatedPrimVarMap;
 		
 		AnimatedHashTest m_animatedObjectTopology;
 		AnimatedPrimVarMap m_animatedObjectPrimVars;
+
+		// the number of object samples with bounds, so that we can check
+		// their consistency without waiting for the bounds to be computed.
+		size_t m_numObjectBounds;
+
+		// only held by the root, and only when writing asynchronously.
+		boost::shared_ptr<WriteQueue> m_writeQueue;
 };
 
 //////////////////////////////////////////////////////////////////////////
 // SceneCache
 //////////////////////////////////////////////////////////////////////////
 
+namespace
+{
+
+size_t cacheMemoryLimitFromEnvironment( const char *variable, size_t defaultLimit )
+{
+	const char *m = getenv( variable );
+	return m ? 1024 * 1024 * boost::lexical_cast<size_t>( m ) : defaultLimit;
+}
+
+struct CacheMemoryLimits
+{
+	CacheMemoryLimits()
+	{
+		limits[SceneCache::Objects] = cacheMemoryLimitFromEnvironment( "IECORE_SCENECACHE_OBJECT_MEMORY", ObjectPool::defaultObjectPool()->getMaxMemoryUsage() );
+		limits[SceneCache::Attributes] = cacheMemoryLimitFromEnvironment( "IECORE_SCENECACHE_ATTRIBUTE_MEMORY", 1024 * 1024 * 50 );
+		limits[SceneCache::Transforms] = cacheMemoryLimitFromEnvironment( "IECORE_SCENECACHE_TRANSFORM_MEMORY", 1024 * 1024 * 50 );
+	}
+
+	tbb::atomic<size_t> limits[3];
+};
+
+CacheMemoryLimits &cacheMemoryLimits()
+{
+	static CacheMemoryLimits l;
+	return l;
+}
+
+/// make sure the limits are initialised at load time and avoid
+/// running conditions on multi-threaded environments.
+CacheMemoryLimits &g_cacheMemoryLimits = cacheMemoryLimits();
+
+} // namespace
+
+void SceneCache::setCacheMemoryLimit( CacheType cacheType, size_t bytes )
+{
+	if( cacheType < Objects || cacheType > Transforms )
+	{
+		throw InvalidArgumentException( "SceneCache::setCacheMemoryLimit : Invalid cache type" );
+	}
+	cacheMemoryLimits().limits[cacheType] = bytes;
+}
+
+size_t SceneCache::getCacheMemoryLimit( CacheType cacheType )
+{
+	if( cacheType < Objects || cacheType > Transforms )
+	{
+		throw InvalidArgumentException( "SceneCache::getCacheMemoryLimit : Invalid cache type" );
+	}
+	return std::min( (size_t)cacheMemoryLimits().limits[cacheType], ObjectPool::defaultObjectPool()->getMaxMemoryUsage() );
+}
+
+CompoundDataPtr SceneCache::cacheStatistics( CacheType cacheType ) const
+{
+	ReaderImplementation *reader = ReaderImplementation::reader( m_implementation.get() );
+	return reader->cacheStatistics( cacheType );
+}
+
+void SceneCache::setAsynchronousWrites( bool enabled, size_t maxQueueMemory )
+{
+	WriterImplementation *writer = WriterImplementation::writer( m_implementation.get() );
+	writer->setAsynchronousWrites( enabled, maxQueueMemory );
+}
+
+bool SceneCache::getAsynchronousWrites() const
+{
+	WriterImplementation *writer = WriterImplementation::writer( m_implementation.get() );
+	return writer->getAsynchronousWrites();
+}
+
+void SceneCache::flush()
+{
+	WriterImplementation *writer = WriterImplementation::writer( m_implementation.get() );
+	writer->waitForWrites();
+}
+
 SceneCache::SceneCache( const std::string &fileName, IndexedIO::OpenMode mode )
 {
 	if( mode & IndexedIO::Append )
@@ -2142,6 +2980,15 @@ void SceneCache::readTags( NameList &tags, bool includeChildren ) const
 	return m_implementation->readTags(tags, includeChildren);
 }
 
+void SceneCache::taggedLocations( const Name &name, std::vector<Path> &paths ) const
+{
+	ReaderImplementation *reader = ReaderImplementation::reader( m_implementation.get() );
+	if ( !reader->taggedLocations( name, paths ) )
+	{
+		SceneInterface::taggedLocations( name, paths );
+	}
+}
+
 void SceneCache::writeTags( const NameList &tags )
 {
 	WriterImplementation *writer = WriterImplementation::writer( m_implementation.get() );
@@ -2276,6 +3123,21 @@ ConstSceneInterfacePtr SceneCache::scene( const Path &path, SceneCache::MissingB
 	return duplicate( impl );
 }
 
+void SceneCache::hash( HashType hashType, double time, MurmurHash &h ) const
+{
+	switch( hashType )
+	{
+		case TransformHash :
+		case AttributesHash :
+		case ObjectHash :
+			ReaderImplementation::reader( m_implementation.get() )->hash( hashType, time, h );
+			break;
+		default :
+			// bounds and child names are cheap to read.
+			SceneInterface::hash( hashType, time, h );
+	}
+}
+
 SceneCachePtr SceneCache::duplicate( ImplementationPtr& impl ) const
 {
 	return new SceneCache( impl );
@@ -35,6 +35,8 @@
 #include "boost/filesystem/convenience.hpp"
 #include "boost/tokenizer.hpp"
 #include "IECore/SceneInterface.h"
+#include "IECore/Exception.h"
+#include "IECore/MurmurHash.h"
 
 using namespace IECore;
 
@@ -118,6 +120,84 @@ SceneInterface::~SceneInterface()
 {
 }
 
+void SceneInterface::taggedLocations( const Name &name, std::vector<Path> &paths ) const
+{
+	if ( !hasTag( name, true ) )
+	{
+		return;
+	}
+	if ( hasTag( name, false ) )
+	{
+		paths.push_back( Path() );
+		path( paths.back() );
+	}
+	NameList children;
+	childNames( children );
+	for ( NameList::const_iterator it = children.begin(); it != children.end(); it++ )
+	{
+		child( *it )->taggedLocations( name, paths );
+	}
+}
+
+void SceneInterface::hash( HashType hashType, double time, MurmurHash &h ) const
+{
+	switch( hashType )
+	{
+		case TransformHash :
+			h.append( readTransform( time )->Object::hash() );
+			break;
+		case AttributesHash :
+			{
+				NameList attrs;
+				attributeNames( attrs );
+				for ( NameList::const_iterator it = attrs.begin(); it != attrs.end(); it++ )
+				{
+					h.append( *it );
+					h.append( readAttribute( *it, time )->hash() );
+				}
+			}
+			break;
+		case BoundHash :
+			h.append( readBound( time ) );
+			break;
+		case ObjectHash :
+			if ( hasObject() )
+			{
+				h.append( readObject( time )->hash() );
+			}
+			break;
+		case ChildNamesHash :
+			{
+				NameList children;
+				childNames( children );
+				for ( NameList::const_iterator it = children.begin(); it != children.end(); it++ )
+				{
+					h.append( *it );
+				}
+			}
+			break;
+		case HierarchyHash :
+			{
+				// every location hashes the data of all the other types,
+				// followed by the hierarchy hashes of its children.
+				hash( TransformHash, time, h );
+				hash( AttributesHash, time, h );
+				hash( BoundHash, time, h );
+				hash( ObjectHash, time, h );
+				NameList children;
+				childNames( children );
+				for ( NameList::const_iterator it = children.begin(); it != children.end(); it++ )
+				{
+					h.append( *it );
+					child( *it )->hash( HierarchyHash, time, h );
+				}
+			}
+			break;
+		default :
+			throw InvalidArgumentException( "SceneInterface::hash : Invalid hash type" );
+	}
+}
+
 void SceneInterface::pathToString( const SceneInterface::Path &p, std::string &path )
 {
 	if ( !p.size() )
@@ -47,6 +47,7 @@
 #include "boost/iostreams/filtering_stream.hpp"
 #include "boost/iostreams/stream.hpp"
 #include "boost/iostreams/filter/gzip.hpp"
+#include "boost/iostreams/filter/zlib.hpp"
 
 #include "IECore/ByteOrder.h"
 #include "IECore/MemoryStream.h"
@@ -57,6 +58,7 @@
 
 #define HARDLINK				127
 #define SUBINDEX_DIR			126
+#define COMPRESSED_DATA			0x40
 
 static const Imf::Int64 g_unversionedMagicNumber = 0x0B00B1E5;
 static const Imf::Int64 g_versionedMagicNumber = 0xB00B1E50;
@@ -66,11 +68,20 @@ static const Imf::Int64 g_versionedMagicNumber = 0xB00B1E50;
 /// Version 5: introduced subindex as zipped data blocks (to reduce size of the main index). 
 ///            Hard links are represented as regular data nodes, that points to same data on file (no removal of data ever). 
 ///            Removed the linkCount field on the data nodes.
-static const Imf::Int64 g_currentVersion = 5;
+/// Version 6: index and subindex blocks are compressed with zlib at its fastest level instead of gzip.
+///            Data nodes may optionally be compressed (see IndexedIO::CompressedData).
+static const Imf::Int64 g_currentVersion = 6;
+
+/// Data nodes smaller than this are never compressed, as the savings wouldn't be worth the cost of decompressing them.
+static const unsigned long g_minCompressedDataSize = 64 * 1024;
+
+/// Per-thread read buffers larger than this are freed after use rather than kept for the next read,
+/// so that the memory held by a file doesn't grow to the largest block read by each thread.
+static const size_t g_maxRetainedThreadIOBufferSize = 1024 * 1024;
 
 /// FileFormat ::= Data Index IndexOffset Version MagicNumber
 /// Data ::= DataEntry*
-/// Index ::= zip(StringCache NodeTree FreePages)
+/// Index ::= zip(StringCache NodeTree FreePages) ( gzip up to version 5, zlib after that )
 
 /// DataEntry ::= Stores data from nodes: 
 ///                [Data nodes] binary data indexed by DataOffset/DataSize and 
@@ -84,16 +95,17 @@ static const Imf::Int64 g_currentVersion = 5;
 
 /// NodeTree Node* ( A Directory node followed by it's child nodes )
 /// Node ::= EntryType EntryStringCacheID NodeCount ( if EntryType == Directory )
-///          EntryType EntryStringCacheID DataType ArrayLength DataOffset DataSize ( if EntryType == File )
+///          EntryType EntryStringCacheID DataType ArrayLength DataOffset DataSize CompressedSize ( if EntryType == File )
 ///			 EntryType EntryStringCacheID SubIndexOffset ( If EntryType == SUBINDEX_DIR )
 /// EntryType ::= char ( value from IndexedIO::EntryType )
 /// EntryStringCacheID ::= int64 ( index in StringCache )
-/// DataType ::= char ( value from IndexedIO::DataType )
+/// DataType ::= char ( value from IndexedIO::DataType, with the COMPRESSED_DATA bit set if the data is zlib compressed )
 /// ArrayLength ::= int64 ( if DataType is array, then this tells how long they are )
 /// NodeID ::= int64 ( unique Id of this node in the file )
 /// ParentNodeID ::= int64 ( Id for the parent node )
 /// DataOffset ::= int64 ( this is offset where the data is located )
-/// DataSize ::= int64 ( number of bytes stored in the data section )
+/// DataSize ::= int64 ( number of bytes of uncompressed data )
+/// CompressedSize ::= int64 ( number of bytes stored in the data section - only present if DataType has the COMPRESSED_DATA bit set )
 /// NodeCount ::= unsigned int ( number of child nodes in the directory - stored right after this node leading to recursive definition of a tree )
 /// SubIndexOffset :: = int64 ( offset in the Data block where there's a zipped index that contains all the child nodes from this node - and possibly other nodes )
 
@@ -110,6 +122,32 @@ static const Imf::Int64 g_currentVersion = 5;
 using namespace IECore;
 namespace io = boost::iostreams;
 
+/// Pushes the filter used to compress index and subindex blocks in the given file format version.
+static void pushCompressor( io::filtering_ostream &stream, Imf::Int64 version )
+{
+	if ( version >= 6 )
+	{
+		stream.push( io::zlib_compressor( io::zlib_params( io::zlib::best_speed ) ) );
+	}
+	else
+	{
+		stream.push( io::gzip_compressor() );
+	}
+}
+
+/// Pushes the filter used to decompress index and subindex blocks in the given file format version.
+static void pushDecompressor( io::filtering_istream &stream, Imf::Int64 version )
+{
+	if ( version >= 6 )
+	{
+		stream.push( io::zlib_decompressor() );
+	}
+	else
+	{
+		stream.push( io::gzip_decompressor() );
+	}
+}
+
 IE_CORE_DEFINERUNTIMETYPEDDESCRIPTION( StreamIndexedIO )
 
 //// Templated functions for stream files //////
@@ -306,6 +344,10 @@ class DataNode : public BaseNode
 {
 	public :
 
+		DataNode() : m_dataType( IndexedIO::Invalid ), m_arrayLength( 0 ), m_offset( 0 ), m_size( 0 ), m_compressedSize( 0 )
+		{
+		}
+
 		/// data fields from IndexedIO::Entry
 		IndexedIO::DataType m_dataType;
 
@@ -315,9 +357,13 @@ class DataNode : public BaseNode
 		/// The offset in the file to this node's data
 		Imf::Int64 m_offset;
 
-		/// The size of this node's data chunk within the file
+		/// The size of this node's data, once uncompressed
 		Imf::Int64 m_size;
 
+		/// The size of this node's data chunk within the file if
+		/// it is compressed, or 0 if it is stored uncompressed.
+		Imf::Int64 m_compressedSize;
+
 		IndexedIO::EntryType entryType() const
 		{
 			return IndexedIO::File;
@@ -428,6 +474,24 @@ class StreamIndexedIO::Index : public RefCounted
 		/// \param prefixSize If true than it will prepend to the block, the size of it
 		Imf::Int64 writeUniqueData( const char *data, unsigned int size, bool prefixSize = false );
 
+		/// Writes the data at the next writable location, without checking for a previous copy.
+		/// \param prefixSize If true than it will prepend to the block, the size of it
+		Imf::Int64 writeData( const char *data, unsigned int size, bool prefixSize = false );
+
+		/// Saves the data for the given node, setting its offset and sizes. The data is compressed
+		/// if the file was opened with IndexedIO::CompressedData, it is large enough and compression
+		/// actually makes it smaller. If a hash uniquely identifying the data is given, it is used
+		/// to find a previous copy of the data, in which case it is neither hashed nor compressed.
+		void writeNodeData( DataNode *node, const char *data, unsigned long size, const MurmurHash *dataHash = 0 );
+
+		const StreamIndexedIO::DeduplicationStatistics &deduplicationStatistics() const;
+
+		/// Writes the (possibly compressed) block of data for writeNodeData(), setting the node's offset.
+		void writeNodeBlock( DataNode *node, const char *block, unsigned long blockSize, const MurmurHash *dataHash );
+
+		/// Reads the uncompressed data for the given node into buffer, which must hold at least node->m_size bytes.
+		void readNodeData( const DataNode *node, char *buffer ) const;
+
 		/// flushes the children of the given directory node to a subindex in the file
 		void commitNodeToSubIndex( Node *n );
 
@@ -440,6 +504,11 @@ class StreamIndexedIO::Index : public RefCounted
 
 		Imf::Int64 m_version;
 
+		/// The format version used for the blocks we write, and to read back subindices.
+		/// Files prior to version 6 keep using the version 5 format when appended to,
+		/// so that all of their subindices are compressed in the same way.
+		Imf::Int64 m_writeVersion;
+
 		bool m_hasChanged;
 
 		Imf::Int64 m_offset;
@@ -452,6 +521,12 @@ class StreamIndexedIO::Index : public RefCounted
 		typedef std::map< std::pair<MurmurHash,unsigned int>, Imf::Int64 > HashToDataMap;
 		HashToDataMap m_hashToDataMap;
 
+		// maps precomputed hashes and uncompressed sizes to the offset and compressed size of the data
+		typedef std::map< std::pair<MurmurHash,unsigned long>, std::pair<Imf::Int64,Imf::Int64> > PrecomputedHashToDataMap;
+		PrecomputedHashToDataMap m_precomputedHashToDataMap;
+
+		StreamIndexedIO::DeduplicationStatistics m_deduplicationStatistics;
+
 		StringCache m_stringCache;
 
 		StreamIndexedIO::StreamFilePtr m_stream;
@@ -718,7 +793,7 @@ void StreamIndexedIO::Node::removeChild( const IndexedIO::EntryID &childName, bo
 //
 ///////////////////////////////////////////////
 
-StreamIndexedIO::Index::Index( StreamIndexedIO::StreamFilePtr stream ) : m_root(0), m_version(g_currentVersion), m_hasChanged(false), m_offset(0), m_next(0), m_stream(stream)
+StreamIndexedIO::Index::Index( StreamIndexedIO::StreamFilePtr stream ) : m_root(0), m_version(g_currentVersion), m_writeVersion(g_currentVersion), m_hasChanged(false), m_offset(0), m_next(0), m_stream(stream)
 {
 	m_stringCache.add(IndexedIO::rootName);
 }
@@ -781,6 +856,8 @@ void StreamIndexedIO::Index::openStream()
 			throw IOException("Not a StreamIndexedIO file");
 		}
 
+		m_writeVersion = m_version >= 6 ? g_currentVersion : 5;
+
 		f.seekg( m_offset, std::ios::beg );
 
 		if (m_version >= 2 )
@@ -789,7 +866,7 @@ void StreamIndexedIO::Index::openStream()
 			char *compressedIndex = new char[ end - m_offset ];
 			f.read( compressedIndex, end - m_offset );
 			MemoryStreamSource source( compressedIndex, end - m_offset, true );
-			decompressingStream.push( io::gzip_decompressor() );
+			pushDecompressor( decompressingStream, m_version );
 			decompressingStream.push( source );
 			assert( decompressingStream.is_complete() );
 
@@ -989,7 +1066,8 @@ BaseNode *StreamIndexedIO::Index::readNode( F &f )
 		IndexedIO::DataType dataType = IndexedIO::Invalid;
 		Imf::Int64 arrayLength = 0;
 		f.read( &t, sizeof(char) );
-		dataType = (IndexedIO::DataType)t;
+		bool compressed = m_version >= 6 && ( t & COMPRESSED_DATA );
+		dataType = (IndexedIO::DataType)( compressed ? t & ~COMPRESSED_DATA : t );
 	
 		if ( IndexedIO::Entry::isArray( dataType ) )
 		{
@@ -1002,6 +1080,10 @@ BaseNode *StreamIndexedIO::Index::readNode( F &f )
 		n->m_arrayLength = static_cast<unsigned long>( arrayLength );
 		readLittleEndian( f,n->m_offset );
 		readLittleEndian( f,n->m_size );
+		if ( compressed )
+		{
+			readLittleEndian( f,n->m_compressedSize );
+		}
 		return n;
 	}
 	else if ( entryType == IndexedIO::Directory )
@@ -1134,6 +1216,10 @@ void StreamIndexedIO::Index::writeDataNode( DataNode *node, F &f )
 	writeLittleEndian( f, id );
 
 	t = node->m_dataType;
+	if ( node->m_compressedSize )
+	{
+		t |= COMPRESSED_DATA;
+	}
 	f.write( &t, sizeof(char) );
 
 	if ( IndexedIO::Entry::isArray( node->m_dataType ) )
@@ -1143,6 +1229,11 @@ void StreamIndexedIO::Index::writeDataNode( DataNode *node, F &f )
 
 	writeLittleEndian(f, node->m_offset);
 	writeLittleEndian(f, node->m_size);
+
+	if ( node->m_compressedSize )
+	{
+		writeLittleEndian(f, node->m_compressedSize);
+	}
 }
 
 template < typename F >
@@ -1192,7 +1283,7 @@ Imf::Int64 StreamIndexedIO::Index::write()
 
 	MemoryStreamSink sink;
 	io::filtering_ostream compressingStream;
-	compressingStream.push( io::gzip_compressor() );
+	pushCompressor( compressingStream, m_writeVersion );
 	compressingStream.push( sink );
 	assert( compressingStream.is_complete() );
 
@@ -1226,7 +1317,7 @@ Imf::Int64 StreamIndexedIO::Index::write()
 	f.write( data, sz );
 
 	writeLittleEndian( f, m_offset );
-	writeLittleEndian( f, g_currentVersion );
+	writeLittleEndian( f, m_writeVersion );
 	writeLittleEndian( f, g_versionedMagicNumber );
 
 	m_hasChanged = false;
@@ -1429,11 +1520,6 @@ void StreamIndexedIO::Index::addFreePage(  Imf::Int64 offset, Imf::Int64 sz )
 
 Imf::Int64 StreamIndexedIO::Index::writeUniqueData( const char *data, unsigned int size, bool prefixSize )
 {
-	m_hasChanged = true;
-
-	/// Find next writable location
-	Imf::Int64 loc;
-
 	// compute hash for the data
 	MurmurHash hash;
 	hash.append( data, size );
@@ -1445,17 +1531,37 @@ Imf::Int64 StreamIndexedIO::Index::writeUniqueData( const char *data, unsigned i
 		totalSize += sizeof( unsigned int );
 	}
 
+	m_deduplicationStatistics.writes++;
+
 	// see if it's already stored by another node..
 	std::pair< HashToDataMap::iterator,bool > ret = m_hashToDataMap.insert( HashToDataMap::value_type( std::pair< MurmurHash,Imf::Int64>(hash,totalSize), 0 ) );
 	if ( !ret.second )
 	{
 		// we already saved this data, so we dont save any additional data
+		m_deduplicationStatistics.hits++;
+		m_deduplicationStatistics.bytesSaved += totalSize;
 		return ret.first->second;
 	}
 
-	/// New data, find next writable location.
-	loc = allocate( totalSize );
-	ret.first->second = loc;
+	/// New data, write it at the next writable location.
+	ret.first->second = writeData( data, size, prefixSize );
+
+	return ret.first->second;
+}
+
+Imf::Int64 StreamIndexedIO::Index::writeData( const char *data, unsigned int size, bool prefixSize )
+{
+	m_hasChanged = true;
+
+	unsigned int totalSize = size;
+
+	if ( prefixSize )
+	{
+		totalSize += sizeof( unsigned int );
+	}
+
+	/// Find next writable location
+	Imf::Int64 loc = allocate( totalSize );
 
 	/// Seek 'write' pointer to writable location
 	m_stream->seekp( loc, std::ios::beg );
@@ -1471,6 +1577,98 @@ Imf::Int64 StreamIndexedIO::Index::writeUniqueData( const char *data, unsigned i
 	return loc;
 }
 
+void StreamIndexedIO::Index::writeNodeData( DataNode *node, const char *data, unsigned long size, const MurmurHash *dataHash )
+{
+	node->m_size = size;
+	node->m_compressedSize = 0;
+
+	if ( dataHash )
+	{
+		PrecomputedHashToDataMap::const_iterator it = m_precomputedHashToDataMap.find( PrecomputedHashToDataMap::key_type( *dataHash, size ) );
+		if ( it != m_precomputedHashToDataMap.end() )
+		{
+			// we already saved this data, so we dont need to look at it again
+			node->m_offset = it->second.first;
+			node->m_compressedSize = it->second.second;
+			m_deduplicationStatistics.writes++;
+			m_deduplicationStatistics.hits++;
+			m_deduplicationStatistics.precomputedHashHits++;
+			m_deduplicationStatistics.bytesSaved += node->m_compressedSize ? node->m_compressedSize : size;
+			return;
+		}
+	}
+
+	if ( m_writeVersion >= 6 && ( m_stream->openMode() & IndexedIO::CompressedData ) && size >= g_minCompressedDataSize )
+	{
+		MemoryStreamSink sink;
+		io::filtering_ostream compressingStream;
+		pushCompressor( compressingStream, m_writeVersion );
+		compressingStream.push( sink );
+		assert( compressingStream.is_complete() );
+
+		compressingStream.write( data, size );
+
+		compressingStream.pop();
+		compressingStream.pop();
+
+		char *compressedData = 0;
+		std::streamsize compressedSize;
+		sink.get( compressedData, compressedSize );
+
+		if ( compressedSize < (std::streamsize)size )
+		{
+			node->m_compressedSize = compressedSize;
+			writeNodeBlock( node, compressedData, compressedSize, dataHash );
+			return;
+		}
+	}
+
+	writeNodeBlock( node, data, size, dataHash );
+}
+
+void StreamIndexedIO::Index::writeNodeBlock( DataNode *node, const char *block, unsigned long blockSize, const MurmurHash *dataHash )
+{
+	if ( !dataHash )
+	{
+		node->m_offset = writeUniqueData( block, blockSize );
+		return;
+	}
+
+	// the precomputed hash identifies the data, so there's no need to hash it here
+	m_deduplicationStatistics.writes++;
+	node->m_offset = writeData( block, blockSize );
+	m_precomputedHashToDataMap[ PrecomputedHashToDataMap::key_type( *dataHash, node->m_size ) ] = std::make_pair( node->m_offset, node->m_compressedSize );
+}
+
+const StreamIndexedIO::DeduplicationStatistics &StreamIndexedIO::Index::deduplicationStatistics() const
+{
+	return m_deduplicationStatistics;
+}
+
+void StreamIndexedIO::Index::readNodeData( const DataNode *node, char *buffer ) const
+{
+	if ( !node->m_compressedSize )
+	{
+		m_stream->readAt( buffer, node->m_size, node->m_offset );
+		return;
+	}
+
+	std::vector<char> compressedData( node->m_compressedSize );
+	m_stream->readAt( &compressedData[0], node->m_compressedSize, node->m_offset );
+
+	io::filtering_istream decompressingStream;
+	MemoryStreamSource source( &compressedData[0], node->m_compressedSize, false );
+	pushDecompressor( decompressingStream, m_writeVersion );
+	decompressingStream.push( source );
+	assert( decompressingStream.is_complete() );
+
+	decompressingStream.read( buffer, node->m_size );
+	if ( decompressingStream.gcount() != node->m_size )
+	{
+		throw IOException( "StreamIndexedIO: Failed to decompress data for entry '" + node->m_name.value() + "'" );
+	}
+}
+
 void StreamIndexedIO::Index::deallocateWalk( BaseNode* n )
 {
 	assert(n);
@@ -1523,7 +1721,7 @@ void StreamIndexedIO::Index::commitNodeToSubIndex( Node *n )
 	{
 		MemoryStreamSink sink;
 		io::filtering_ostream compressingStream;
-		compressingStream.push( io::gzip_compressor() );
+		pushCompressor( compressingStream, m_writeVersion );
 		compressingStream.push( sink );
 		assert( compressingStream.is_complete() );
 
@@ -1590,7 +1788,7 @@ void StreamIndexedIO::Index::readNodeFromSubIndex( Node *n )
 
 	io::filtering_istream decompressingStream;
 	MemoryStreamSource source( data, subindexSize, false );
-	decompressingStream.push( io::gzip_decompressor() );
+	pushDecompressor( decompressingStream, m_writeVersion );
 	decompressingStream.push( source );
 	assert( decompressingStream.is_complete() );
 
@@ -1667,6 +1865,25 @@ char *StreamIndexedIO::StreamFile::ioBuffer( unsigned long size )
 	return m_ioBuffer;
 }
 
+char *StreamIndexedIO::StreamFile::threadIOBuffer( unsigned long size )
+{
+	std::vector<char> &buffer = m_threadIOBuffers.local();
+	if ( buffer.size() < size )
+	{
+		buffer.resize( size );
+	}
+	return &buffer[0];
+}
+
+void StreamIndexedIO::StreamFile::releaseThreadIOBuffer()
+{
+	std::vector<char> &buffer = m_threadIOBuffers.local();
+	if ( buffer.size() > g_maxRetainedThreadIOBufferSize )
+	{
+		std::vector<char>().swap( buffer );
+	}
+}
+
 StreamIndexedIO::StreamFile::Mutex & StreamIndexedIO::StreamFile::mutex()
 {
 	return m_mutex;
@@ -1728,6 +1945,13 @@ void StreamIndexedIO::StreamFile::read( char *buffer, size_t size )
 	m_stream->read( buffer, size );
 }
 
+void StreamIndexedIO::StreamFile::readAt( char *buffer, size_t size, Imf::Int64 pos )
+{
+	MutexLock lock( m_mutex );
+	m_stream->seekg( pos, std::ios::beg );
+	m_stream->read( buffer, size );
+}
+
 void StreamIndexedIO::StreamFile::write( const char *buffer, size_t size )
 {
 	m_stream->write( buffer, size );
@@ -2069,12 +2293,22 @@ ConstIndexedIOPtr StreamIndexedIO::directory( const IndexedIO::EntryIDList &path
 	return const_cast< StreamIndexedIO * >(this)->directory( path, missingBehaviour == IndexedIO::CreateIfMissing ? IndexedIO::ThrowIfMissing : missingBehaviour );
 }
 
+StreamIndexedIO::DeduplicationStatistics::DeduplicationStatistics()
+	:	writes( 0 ), hits( 0 ), precomputedHashHits( 0 ), bytesSaved( 0 )
+{
+}
+
+StreamIndexedIO::DeduplicationStatistics StreamIndexedIO::deduplicationStatistics() const
+{
+	return m_node->m_idx->deduplicationStatistics();
+}
+
 void StreamIndexedIO::commit()
 {
 	m_node->m_idx->commitNodeToSubIndex( m_node );
 }
 
-void StreamIndexedIO::write(const IndexedIO::EntryID &name, const InternedString *x, unsigned long arrayLength)
+void StreamIndexedIO::writeInternedStrings(const IndexedIO::EntryID &name, const InternedString *x, unsigned long arrayLength, const MurmurHash *hash)
 {
 	writable(name);
 	remove(name, false);
@@ -2106,8 +2340,7 @@ void StreamIndexedIO::write(const IndexedIO::EntryID &name, const InternedString
 
 	node->m_dataType = dataType;
 	node->m_arrayLength = arrayLength;
-	node->m_offset = index->writeUniqueData( data, size );
-	node->m_size = size;
+	index->writeNodeData( node, data, size, hash );
 
 	delete [] ids;
 }
@@ -2125,21 +2358,15 @@ void StreamIndexedIO::read(const IndexedIO::EntryID &name, InternedString *&x, u
 	}
 
 	Imf::Int64 *ids = new Imf::Int64[arrayLength];
-	Imf::Int64 size = node->m_size;
-	StreamIndexedIO::StreamFile &f = streamFile();
-	{
-		StreamFile::MutexLock lock( f.mutex() );
-		f.seekg( node->m_offset, std::ios::beg );
 
 #ifdef IE_CORE_LITTLE_ENDIAN
-		// raw read
-		f.read( (char*)ids, size );
-	}
+	// raw read
+	m_node->m_idx->readNodeData( node, (char*)ids );
 #else
-		char *data = f.ioBuffer(size);
-		f.read( data, size );
-	}
+	char *data = streamFile().threadIOBuffer(node->m_size);
+	m_node->m_idx->readNodeData( node, data );
 	IndexedIO::DataFlattenTraits<Imf::Int64*>::unflatten( data, ids, arrayLength );
+	streamFile().releaseThreadIOBuffer();
 #endif
 
 	const StringCache &stringCache = m_node->m_idx->stringCache();
@@ -2156,7 +2383,7 @@ void StreamIndexedIO::read(const IndexedIO::EntryID &name, InternedString *&x, u
 }
 
 template<typename T>
-void StreamIndexedIO::write(const IndexedIO::EntryID &name, const T *x, unsigned long arrayLength)
+void StreamIndexedIO::write(const IndexedIO::EntryID &name, const T *x, unsigned long arrayLength, const MurmurHash *hash)
 {
 	writable(name);
 	remove(name, false);
@@ -2173,8 +2400,7 @@ void StreamIndexedIO::write(const IndexedIO::EntryID &name, const T *x, unsigned
 
 		node->m_dataType = dataType;
 		node->m_arrayLength = arrayLength;
-		node->m_offset = m_node->m_idx->writeUniqueData( data, size );
-		node->m_size = size;
+		m_node->m_idx->writeNodeData( node, data, size, hash );
 	}
 
 	else
@@ -2184,7 +2410,7 @@ void StreamIndexedIO::write(const IndexedIO::EntryID &name, const T *x, unsigned
 }
 
 template<typename T>
-void StreamIndexedIO::rawWrite(const IndexedIO::EntryID &name, const T *x, unsigned long arrayLength)
+void StreamIndexedIO::rawWrite(const IndexedIO::EntryID &name, const T *x, unsigned long arrayLength, const MurmurHash *hash)
 {
 	writable(name);
 	remove(name, false);
@@ -2197,8 +2423,7 @@ void StreamIndexedIO::rawWrite(const IndexedIO::EntryID &name, const T *x, unsig
 
 		node->m_dataType = dataType;
 		node->m_arrayLength = arrayLength;
-		node->m_offset = m_node->m_idx->writeUniqueData( (char*)x, size );
-		node->m_size = size;
+		m_node->m_idx->writeNodeData( node, (const char*)x, size, hash );
 	}
 	else
 	{
@@ -2224,8 +2449,7 @@ void StreamIndexedIO::write(const IndexedIO::EntryID &name, const T &x)
 
 		node->m_dataType = dataType;
 		node->m_arrayLength = 0;
-		node->m_offset = m_node->m_idx->writeUniqueData( data, size );
-		node->m_size = size;
+		m_node->m_idx->writeNodeData( node, data, size );
 	}
 	else
 	{
@@ -2247,8 +2471,7 @@ void StreamIndexedIO::rawWrite(const IndexedIO::EntryID &name, const T &x)
 
 		node->m_dataType = dataType;
 		node->m_arrayLength = 0;
-		node->m_offset = m_node->m_idx->writeUniqueData( (char*)&x, size );
-		node->m_size = size;
+		m_node->m_idx->writeNodeData( node, (const char*)&x, size );
 	}
 	else
 	{
@@ -2269,15 +2492,10 @@ void StreamIndexedIO::read(const IndexedIO::EntryID &name, T *&x, unsigned long
 		throw IOException( "StreamIndexedIO: Entry not found '" + name.value() + "'" );
 	}
 
-	StreamIndexedIO::StreamFile &f = streamFile();
-	Imf::Int64 size = node->m_size;
-	{
-		StreamFile::MutexLock lock( f.mutex() );
-		char *data = f.ioBuffer(size);
-		f.seekg( node->m_offset, std::ios::beg );
-		f.read( data, size );
-		IndexedIO::DataFlattenTraits<T*>::unflatten( data, x, arrayLength );
-	}
+	char *data = streamFile().threadIOBuffer(node->m_size);
+	m_node->m_idx->readNodeData( node, data );
+	IndexedIO::DataFlattenTraits<T*>::unflatten( data, x, arrayLength );
+	streamFile().releaseThreadIOBuffer();
 }
 
 template<typename T>
@@ -2293,18 +2511,12 @@ void StreamIndexedIO::rawRead(const IndexedIO::EntryID &name, T *&x, unsigned lo
 		throw IOException( "StreamIndexedIO: Entry not found '" + name.value() + "'" );
 	}
 
-	Imf::Int64 size = node->m_size;
 	if (!x)
 	{
 		x = new T[arrayLength];
 	}
 
-	StreamIndexedIO::StreamFile &f = streamFile();
-	{
-		StreamFile::MutexLock lock( f.mutex() );
-		f.seekg( node->m_offset, std::ios::beg );
-		f.read( (char*)x, size );
-	}
+	m_node->m_idx->readNodeData( node, (char*)x );
 }
 
 template<typename T>
@@ -2320,15 +2532,10 @@ void StreamIndexedIO::read(const IndexedIO::EntryID &name, T &x) const
 		throw IOException( "StreamIndexedIO: Entry not found '" + name.value() + "'" );
 	}
 
-	Imf::Int64 size = node->m_size;
-	StreamIndexedIO::StreamFile &f = streamFile();
-	{
-		StreamFile::MutexLock lock( f.mutex() );
-		char *data = f.ioBuffer(size);
-		f.seekg( node->m_offset, std::ios::beg );
-		f.read( data, size );
-		IndexedIO::DataFlattenTraits<T>::unflatten( data, x );
-	}
+	char *data = streamFile().threadIOBuffer(node->m_size);
+	m_node->m_idx->readNodeData( node, data );
+	IndexedIO::DataFlattenTraits<T>::unflatten( data, x );
+	streamFile().releaseThreadIOBuffer();
 }
 
 template<typename T>
@@ -2344,13 +2551,7 @@ void StreamIndexedIO::rawRead(const IndexedIO::EntryID &name, T &x) const
 		throw IOException( "StreamIndexedIO: Entry not found '" + name.value() + "'" );
 	}
 
-	Imf::Int64 size = node->m_size;
-	StreamIndexedIO::StreamFile &f = streamFile();
-	{
-		StreamFile::MutexLock lock( f.mutex() );
-		f.seekg( node->m_offset, std::ios::beg );
-		f.read( (char*)&x, size );
-	}
+	m_node->m_idx->readNodeData( node, (char*)&x );
 }
 
 #ifdef IE_CORE_LITTLE_ENDIAN
@@ -2482,6 +2683,74 @@ void StreamIndexedIO::write(const IndexedIO::EntryID &name, const unsigned short
 {
 	WRITE<unsigned short>(name, x);
 }
+
+void StreamIndexedIO::write(const IndexedIO::EntryID &name, const InternedString *x, unsigned long arrayLength)
+{
+	writeInternedStrings(name, x, arrayLength, 0);
+}
+
+// Write with a precomputed hash
+
+void StreamIndexedIO::write(const IndexedIO::EntryID &name, const float *x, unsigned long arrayLength, const MurmurHash &hash)
+{
+	WRITE<float>(name, x, arrayLength, &hash);
+}
+
+void StreamIndexedIO::write(const IndexedIO::EntryID &name, const double *x, unsigned long arrayLength, const MurmurHash &hash)
+{
+	WRITE<double>(name, x, arrayLength, &hash);
+}
+
+void StreamIndexedIO::write(const IndexedIO::EntryID &name, const half *x, unsigned long arrayLength, const MurmurHash &hash)
+{
+	WRITE<half>(name, x, arrayLength, &hash);
+}
+
+void StreamIndexedIO::write(const IndexedIO::EntryID &name, const int *x, unsigned long arrayLength, const MurmurHash &hash)
+{
+	WRITE<int>(name, x, arrayLength, &hash);
+}
+
+void StreamIndexedIO::write(const IndexedIO::EntryID &name, const int64_t *x, unsigned long arrayLength, const MurmurHash &hash)
+{
+	WRITE<int64_t>(name, x, arrayLength, &hash);
+}
+
+void StreamIndexedIO::write(const IndexedIO::EntryID &name, const uint64_t *x, unsigned long arrayLength, const MurmurHash &hash)
+{
+	WRITE<uint64_t>(name, x, arrayLength, &hash);
+}
+
+void StreamIndexedIO::write(const IndexedIO::EntryID &name, const unsigned int *x, unsigned long arrayLength, const MurmurHash &hash)
+{
+	WRITE<unsigned int>(name, x, arrayLength, &hash);
+}
+
+void StreamIndexedIO::write(const IndexedIO::EntryID &name, const char *x, unsigned long arrayLength, const MurmurHash &hash)
+{
+	WRITE<char>(name, x, arrayLength, &hash);
+}
+
+void StreamIndexedIO::write(const IndexedIO::EntryID &name, const unsigned char *x, unsigned long arrayLength, const MurmurHash &hash)
+{
+	WRITE<unsigned char>(name, x, arrayLength, &hash);
+}
+
+void StreamIndexedIO::write(const IndexedIO::EntryID &name, const short *x, unsigned long arrayLength, const MurmurHash &hash)
+{
+	WRITE<short>(name, x, arrayLength, &hash);
+}
+
+void StreamIndexedIO::write(const IndexedIO::EntryID &name, const unsigned short *x, unsigned long arrayLength, const MurmurHash &hash)
+{
+	WRITE<unsigned short>(name, x, arrayLength, &hash);
+}
+
+void StreamIndexedIO::write(const IndexedIO::EntryID &name, const InternedString *x, unsigned long arrayLength, const MurmurHash &hash)
+{
+	writeInternedStrings(name, x, arrayLength, &hash);
+}
+
 // Read
 
 void StreamIndexedIO::read(const IndexedIO::EntryID &name, float *&x, unsigned long arrayLength) const
@@ -32,6 +32,8 @@
 //
 //////////////////////////////////////////////////////////////////////////
 
+#include <algorithm>
+
 #include "IECore/CompoundObject.h"
 #include "IECore/MeshPrimitive.h"
 #include "IECore/TriangulateOp.h"
@@ -39,6 +41,12 @@
 #include "IECore/TriangleAlgo.h"
 #include "IECore/Exception.h"
 #include "IECore/CompoundParameter.h"
+#include "IECore/MeshAdjacency.h"
+
+#include "boost/type_traits/is_same.hpp"
+
+#include "tbb/parallel_for.h"
+#include "tbb/spin_mutex.h"
 
 using namespace IECore;
 
@@ -88,6 +96,211 @@ const BoolParameter * TriangulateOp::throwExceptionsParameter() const
 	return m_throwExceptionsParameter;
 }
 
+namespace
+{
+
+template<typename Container>
+class Remap
+{
+
+	public :
+
+		Remap( const Container &data, const std::vector<int> &indices, Container &result )
+			:	m_data( data ), m_indices( indices ), m_result( result )
+		{
+		}
+
+		void operator()( const tbb::blocked_range<size_t> &r ) const
+		{
+			for( size_t i = r.begin(); i != r.end(); ++i )
+			{
+				m_result[i] = m_data[m_indices[i]];
+			}
+		}
+
+	private :
+
+		const Container &m_data;
+		const std::vector<int> &m_indices;
+		Container &m_result;
+
+};
+
+/// Triangulates a range of faces as simple triangle fans. The position of the output for each
+/// face is known in advance from triangleOffsets, so faces can be processed in any order. When
+/// invalid faces are found, the first one is recorded rather than an exception being thrown, so
+/// that the error reported is the same as that from triangulating serially.
+template<typename Vec>
+class TriangulateFaces
+{
+
+	public :
+
+		TriangulateFaces(
+			const std::vector<Vec> &p, const std::vector<int> &vertexIds, const std::vector<int> &faceOffsets,
+			const std::vector<int> &triangleOffsets, float tolerance, bool throwExceptions,
+			std::vector<int> &newVertexIds, std::vector<int> &faceVaryingIndices, std::vector<int> &uniformIndices,
+			tbb::spin_mutex &errorMutex, size_t &errorFace, const char *&error
+		)
+			:	m_p( p ), m_vertexIds( vertexIds ), m_faceOffsets( faceOffsets ), m_triangleOffsets( triangleOffsets ),
+				m_tolerance( tolerance ), m_throwExceptions( throwExceptions ),
+				m_newVertexIds( newVertexIds ), m_faceVaryingIndices( faceVaryingIndices ), m_uniformIndices( uniformIndices ),
+				m_errorMutex( errorMutex ), m_errorFace( errorFace ), m_error( error )
+		{
+		}
+
+		void operator()( const tbb::blocked_range<size_t> &r ) const
+		{
+			for( size_t faceIdx = r.begin(); faceIdx != r.end(); ++faceIdx )
+			{
+				const int faceVertexIdStart = m_faceOffsets[faceIdx];
+				const int numFaceVerts = m_faceOffsets[faceIdx+1] - faceVertexIdStart;
+				int triangle = m_triangleOffsets[faceIdx];
+
+				if ( numFaceVerts > 3 )
+				{
+					/// For the time being, just do a simple triangle fan.
+
+					const int i0 = faceVertexIdStart + 0;
+					const int v0 = m_vertexIds[ i0 ];
+
+					int i1 = faceVertexIdStart + 1;
+					int i2 = faceVertexIdStart + 2;
+					int v1 = m_vertexIds[ i1 ];
+					int v2 = m_vertexIds[ i2 ];
+
+					const Vec firstTriangleNormal = triangleNormal( m_p[ v0 ], m_p[ v1 ], m_p[ v2 ] );
+
+					if( m_throwExceptions && !convex( faceVertexIdStart, numFaceVerts, firstTriangleNormal ) )
+					{
+						setError( faceIdx, "TriangulateOp cannot deal with concave polygons" );
+						return;
+					}
+
+					for (int i = 1; i < numFaceVerts - 1; i++)
+					{
+						i1 = faceVertexIdStart + ( (i + 0) % numFaceVerts );
+						i2 = faceVertexIdStart + ( (i + 1) % numFaceVerts );
+						v1 = m_vertexIds[ i1 ];
+						v2 = m_vertexIds[ i2 ];
+
+						if ( m_throwExceptions && fabs( triangleNormal( m_p[ v0 ], m_p[ v1 ], m_p[ v2 ] ).dot( firstTriangleNormal ) - 1.0 ) > m_tolerance )
+						{
+							setError( faceIdx, "TriangulateOp cannot deal with non-planar polygons" );
+							return;
+						}
+
+						addTriangle( triangle++, faceIdx, i0, i1, i2 );
+					}
+				}
+				else
+				{
+					assert( numFaceVerts == 3 );
+					addTriangle( triangle, faceIdx, faceVertexIdStart, faceVertexIdStart + 1, faceVertexIdStart + 2 );
+				}
+			}
+		}
+
+	private :
+
+		/// Convexivity test - for each edge, all other vertices must be on the same "side" of it
+		bool convex( int faceVertexIdStart, int numFaceVerts, const Vec &firstTriangleNormal ) const
+		{
+			for (int i = 0; i < numFaceVerts - 1; i++)
+			{
+				const int edgeStart = m_vertexIds[ faceVertexIdStart + i + 0 ];
+				const int edgeEnd = m_vertexIds[ faceVertexIdStart + i + 1 ];
+
+				const Vec edge = m_p[ edgeEnd ] - m_p[ edgeStart ];
+				const float edgeLength = edge.length();
+
+				if (edgeLength > m_tolerance)
+				{
+					const Vec edgeDirection = edge / edgeLength;
+
+					/// Construct a plane whose normal is perpendicular to both the edge and the polygon's normal
+					const Vec planeNormal = edgeDirection.cross( firstTriangleNormal );
+					const float planeConstant = planeNormal.dot( m_p[ edgeStart ] );
+
+					int sign = 0;
+					bool first = true;
+					for (int j = 0; j < numFaceVerts; j++)
+					{
+						const int testVertex = m_vertexIds[ faceVertexIdStart + j ];
+
+						if ( testVertex != edgeStart && testVertex != edgeEnd )
+						{
+							float signedDistance = planeNormal.dot( m_p[ testVertex ] ) - planeConstant;
+
+							if ( fabs(signedDistance) > m_tolerance)
+							{
+								int thisSign = 1;
+								if ( signedDistance < 0.0 )
+								{
+									thisSign = -1;
+								}
+								if (first)
+								{
+									sign = thisSign;
+									first = false;
+								}
+								else if ( thisSign != sign )
+								{
+									assert( sign != 0 );
+									return false;
+								}
+							}
+						}
+					}
+				}
+			}
+			return true;
+		}
+
+		void addTriangle( int triangle, int faceIdx, int i0, int i1, int i2 ) const
+		{
+			const int t = triangle * 3;
+
+			/// Triangulate the vertices
+			m_newVertexIds[t] = m_vertexIds[i0];
+			m_newVertexIds[t+1] = m_vertexIds[i1];
+			m_newVertexIds[t+2] = m_vertexIds[i2];
+
+			/// Store the indices required to rebuild the facevarying primvars
+			m_faceVaryingIndices[t] = i0;
+			m_faceVaryingIndices[t+1] = i1;
+			m_faceVaryingIndices[t+2] = i2;
+
+			m_uniformIndices[triangle] = faceIdx;
+		}
+
+		void setError( size_t faceIdx, const char *error ) const
+		{
+			tbb::spin_mutex::scoped_lock lock( m_errorMutex );
+			if( !m_error || faceIdx < m_errorFace )
+			{
+				m_errorFace = faceIdx;
+				m_error = error;
+			}
+		}
+
+		const std::vector<Vec> &m_p;
+		const std::vector<int> &m_vertexIds;
+		const std::vector<int> &m_faceOffsets;
+		const std::vector<int> &m_triangleOffsets;
+		float m_tolerance;
+		bool m_throwExceptions;
+		std::vector<int> &m_newVertexIds;
+		std::vector<int> &m_faceVaryingIndices;
+		std::vector<int> &m_uniformIndices;
+		tbb::spin_mutex &m_errorMutex;
+		size_t &m_errorFace;
+		const char *&m_error;
+
+};
+
+} // namespace
+
 /// A functor for use with despatchTypedData, which copies elements from another vector, as specified by an array of indices into that data
 struct TriangleDataRemap
 {
@@ -104,18 +317,25 @@ struct TriangleDataRemap
 	size_t operator() ( T * data )
 	{
 		assert( data );
-		typename T::ValueType &dataWritable = data->writable();
+		typedef typename T::ValueType Container;
+		Container &dataWritable = data->writable();
 		
 		const T * otherData = runTimeCast<const T, const Data>( m_other );
 		assert( otherData );
-		const typename T::ValueType &otherDataReadable = otherData->readable();
+		const Container &otherDataReadable = otherData->readable();
 
-		dataWritable.clear();
-		dataWritable.reserve( m_indices.size() );
+		dataWritable.resize( m_indices.size() );
 
-		for ( std::vector<int>::const_iterator it = m_indices.begin(); it != m_indices.end(); ++it )
+		Remap<Container> remap( otherDataReadable, m_indices, dataWritable );
+		tbb::blocked_range<size_t> range( 0, m_indices.size(), 1000 );
+		if( boost::is_same<Container, std::vector<bool> >::value )
+		{
+			// neighbouring elements of a vector<bool> can't be written concurrently
+			remap( range );
+		}
+		else
 		{
-			dataWritable.push_back( otherDataReadable[ *it ] );
+			tbb::parallel_for( range, remap );
 		}
 
 		assert( dataWritable.size() == m_indices.size() );
@@ -146,152 +366,49 @@ struct TriangulateOp::TriangulateFn
 
 		const typename T::ValueType &pReadable = p->readable();
 
-		MeshPrimitivePtr meshCopy = m_mesh->copy();
-
-		ConstIntVectorDataPtr verticesPerFace = m_mesh->verticesPerFace();
-		const std::vector<int> &verticesPerFaceReadable = verticesPerFace->readable();
 		ConstIntVectorDataPtr vertexIds = m_mesh->vertexIds();
 		const std::vector<int> &vertexIdsReadable = vertexIds->readable();
 
+		ConstMeshAdjacencyPtr adjacency = m_mesh->adjacency();
+		const std::vector<int> &faceOffsets = adjacency->faceOffsets();
+		const size_t numFaces = adjacency->numFaces();
+
+		/// Find where the triangles for each face will start, so the faces can be
+		/// triangulated in parallel.
+		std::vector<int> triangleOffsets( numFaces + 1 );
+		triangleOffsets[0] = 0;
+		for( size_t f = 0; f < numFaces; ++f )
+		{
+			const int numFaceVerts = faceOffsets[f+1] - faceOffsets[f];
+			triangleOffsets[f+1] = triangleOffsets[f] + std::max( numFaceVerts - 2, 1 );
+		}
+		const size_t numTriangles = triangleOffsets[numFaces];
+
 		IntVectorDataPtr newVertexIds = new IntVectorData();
 		std::vector<int> &newVertexIdsWritable = newVertexIds->writable();
-		newVertexIdsWritable.reserve( vertexIdsReadable.size() );
+		newVertexIdsWritable.resize( numTriangles * 3 );
 
 		IntVectorDataPtr newVerticesPerFace = new IntVectorData();
-		std::vector<int> &newVerticesPerFaceWritable = newVerticesPerFace->writable();
-		newVerticesPerFaceWritable.reserve( verticesPerFaceReadable.size() );
-
-		std::vector<int> faceVaryingIndices;
-		std::vector<int> uniformIndices;
-		int faceVertexIdStart = 0;
-		int faceIdx = 0;
-		for ( IntVectorData::ValueType::const_iterator it = verticesPerFaceReadable.begin(); it != verticesPerFaceReadable.end(); ++it, ++faceIdx )
+		newVerticesPerFace->writable().resize( numTriangles, 3 );
+
+		std::vector<int> faceVaryingIndices( numTriangles * 3 );
+		std::vector<int> uniformIndices( numTriangles );
+
+		tbb::spin_mutex errorMutex;
+		size_t errorFace = 0;
+		const char *error = 0;
+		tbb::parallel_for(
+			tbb::blocked_range<size_t>( 0, numFaces, 1000 ),
+			TriangulateFaces<Vec>(
+				pReadable, vertexIdsReadable, faceOffsets, triangleOffsets, m_tolerance, m_throwExceptions,
+				newVertexIdsWritable, faceVaryingIndices, uniformIndices,
+				errorMutex, errorFace, error
+			)
+		);
+
+		if( error )
 		{
-			int numFaceVerts = *it;
-
-			if ( numFaceVerts > 3 )
-			{
-				/// For the time being, just do a simple triangle fan.
-
-				const int i0 = faceVertexIdStart + 0;
-				const int v0 = vertexIdsReadable[ i0 ];
-
-				int i1 = faceVertexIdStart + 1;
-				int i2 = faceVertexIdStart + 2;
-				int v1 = vertexIdsReadable[ i1 ];
-				int v2 = vertexIdsReadable[ i2 ];
-
-				const Vec firstTriangleNormal = triangleNormal( pReadable[ v0 ], pReadable[ v1 ], pReadable[ v2 ] );
-
-				if (m_throwExceptions)
-				{
-					/// Convexivity test - for each edge, all other vertices must be on the same "side" of it
-					for (int i = 0; i < numFaceVerts - 1; i++)
-					{
-						const int edgeStartIndex = faceVertexIdStart + i + 0;
-						const int edgeStart = vertexIdsReadable[ edgeStartIndex ];
-
-						const int edgeEndIndex = faceVertexIdStart + i + 1;
-						const int edgeEnd = vertexIdsReadable[ edgeEndIndex ];
-
-						const Vec edge = pReadable[ edgeEnd ] - pReadable[ edgeStart ];
-						const float edgeLength = edge.length();
-
-						if (edgeLength > m_tolerance)
-						{
-							const Vec edgeDirection = edge / edgeLength;
-
-							/// Construct a plane whose normal is perpendicular to both the edge and the polygon's normal
-							const Vec planeNormal = edgeDirection.cross( firstTriangleNormal );
-							const float planeConstant = planeNormal.dot( pReadable[ edgeStart ] );
-
-							int sign = 0;
-							bool first = true;
-							for (int j = 0; j < numFaceVerts; j++)
-							{
-								const int testVertexIndex = faceVertexIdStart + j;
-								const int testVertex = vertexIdsReadable[ testVertexIndex ];
-
-								if ( testVertex != edgeStart && testVertex != edgeEnd )
-								{
-									float signedDistance = planeNormal.dot( pReadable[ testVertex ] ) - planeConstant;
-
-									if ( fabs(signedDistance) > m_tolerance)
-									{
-										int thisSign = 1;
-										if ( signedDistance < 0.0 )
-										{
-											thisSign = -1;
-										}
-										if (first)
-										{
-											sign = thisSign;
-											first = false;
-										}
-										else if ( thisSign != sign )
-										{
-											assert( sign != 0 );
-											throw InvalidArgumentException("TriangulateOp cannot deal with concave polygons");
-										}
-									}
-								}
-							}
-						}
-					}
-				}
-
-				for (int i = 1; i < numFaceVerts - 1; i++)
-				{
-					i1 = faceVertexIdStart + ( (i + 0) % numFaceVerts );
-					i2 = faceVertexIdStart + ( (i + 1) % numFaceVerts );
-					v1 = vertexIdsReadable[ i1 ];
-					v2 = vertexIdsReadable[ i2 ];
-
-					if ( m_throwExceptions && fabs( triangleNormal( pReadable[ v0 ], pReadable[ v1 ], pReadable[ v2 ] ).dot( firstTriangleNormal ) - 1.0 ) > m_tolerance )
-					{
-						throw InvalidArgumentException("TriangulateOp cannot deal with non-planar polygons");
-					}
-
-					/// Create a new triangle
-					newVerticesPerFaceWritable.push_back( 3 );
-
-					/// Triangulate the vertices
-					newVertexIdsWritable.push_back( v0 );
-					newVertexIdsWritable.push_back( v1 );
-					newVertexIdsWritable.push_back( v2 );
-
-					/// Store the indices required to rebuild the facevarying primvars
-					faceVaryingIndices.push_back( i0 );
-					faceVaryingIndices.push_back( i1 );
-					faceVaryingIndices.push_back( i2 );
-
-					uniformIndices.push_back( faceIdx );
-				}
-			}
-			else
-			{
-				assert( numFaceVerts == 3 );
-
-				int i0 = faceVertexIdStart + 0;
-				int i1 = faceVertexIdStart + 1;
-				int i2 = faceVertexIdStart + 2;
-
-				newVerticesPerFaceWritable.push_back( 3 );
-
-				/// Copy across the vertexId data
-				newVertexIdsWritable.push_back( vertexIdsReadable[ i0 ] );
-				newVertexIdsWritable.push_back( vertexIdsReadable[ i1 ] );
-				newVertexIdsWritable.push_back( vertexIdsReadable[ i2 ] );
-
-				/// Store the indices required to rebuild the facevarying primvars
-				faceVaryingIndices.push_back( i0 );
-				faceVaryingIndices.push_back( i1 );
-				faceVaryingIndices.push_back( i2 );
-
-				uniformIndices.push_back( faceIdx );
-			}
-
-			faceVertexIdStart += numFaceVerts;
+			throw InvalidArgumentException( error );
 		}
 
 		m_mesh->setTopology( newVerticesPerFace, newVertexIds, m_mesh->interpolation() );
@@ -129,7 +129,7 @@ LongVectorDataAlias::TypeDescription<IntVectorData> LongVectorDataAlias::m_typeD
 		Data::save( context );																		\
 		IndexedIO *container = context->rawContainer();												\
 		assert( ( sizeof( TNAME::ValueType::value_type ) / sizeof( TNAME::BaseType ) ) == N );		\
-		container->write( g_valueEntry, baseReadable(), baseSize() );								\
+		container->write( g_valueEntry, baseReadable(), baseSize(), Object::hash() );				\
 	}																								\
 	template<>																						\
 	void TNAME::load( LoadContextPtr context )														\
@@ -32,11 +32,17 @@
 //
 //////////////////////////////////////////////////////////////////////////
 
+#include <cmath>
+
+#include "tbb/parallel_for.h"
+#include "tbb/blocked_range.h"
+#include "tbb/blocked_range2d.h"
+
 #include "IECore/WarpOp.h"
-#include "IECore/Interpolator.h"
 #include "IECore/DespatchTypedData.h"
 #include "IECore/TypeTraits.h"
 #include "IECore/CompoundParameter.h"
+#include "IECore/FastFloat.h"
 
 using namespace IECore;
 using namespace Imath;
@@ -50,9 +56,14 @@ WarpOp::WarpOp( const std::string &description )
 	IntParameter::PresetsContainer filterPresets;
 	filterPresets.push_back( IntParameter::Preset( "None", WarpOp::None ) );
 	filterPresets.push_back( IntParameter::Preset( "Bilinear", WarpOp::Bilinear ) );
+	filterPresets.push_back( IntParameter::Preset( "Bicubic", WarpOp::Bicubic ) );
+	filterPresets.push_back( IntParameter::Preset( "Lanczos", WarpOp::Lanczos ) );
+	filterPresets.push_back( IntParameter::Preset( "EWA", WarpOp::EWA ) );
 	m_filterParameter = new IntParameter(
 		"filter",
-		"Defines the filter to be used on the warped coordinates.",
+		"Defines the filter to be used on the warped coordinates. Bicubic and Lanczos give sharper results than "
+		"Bilinear, and EWA filters over the area covered by each pixel, which avoids aliasing where the warp "
+		"strongly compresses the image.",
 		(int)WarpOp::Bilinear,
 		(int)WarpOp::None,
 		(int)WarpOp::TypeCount - 1,
@@ -78,125 +89,391 @@ const IntParameter * WarpOp::filterParameter() const
 	return m_filterParameter;
 }
 
-struct WarpOp::Warp
+// Computes the warped coordinates for a range of output rows.
+class WarpOp::Coordinates
 {
-	typedef void ReturnType;
-
-	Warp( WarpOp * warp, WarpOp::FilterType filter, const Imath::Box2i &warpedDataWindow, const Imath::Box2i &originalDataWindow )
-		:	m_warpOp( warp ), m_filter( filter ), m_outputDataWindow( warpedDataWindow ), m_inputDataWindow( originalDataWindow )
-	{
-	}
+	public :
 
-	inline void computePixelCoordinates( float x, float y, int &x1, int &y1, int &x2, int &y2, float &ratioX, float &ratioY )
-	{
-		Imath::V2f inPos = m_warpOp->warp( Imath::V2f( x, y ) );
-		x1 = int(inPos.x);
-		y1 = int(inPos.y);
-		if ( x1 > inPos.x )
+		Coordinates( const WarpOp *warpOp, const Imath::Box2i &outputDataWindow, std::vector<Imath::V2f> &coordinates )
+			:	m_warpOp( warpOp ), m_outputDataWindow( outputDataWindow ), m_coordinates( coordinates )
 		{
-			ratioX = x1 - inPos.x;
-			x2 = x1;
-			x1--;
 		}
-		else
+
+		void operator()( const tbb::blocked_range<int> &rows ) const
 		{
-			x2 = x1 + 1;
-			ratioX = inPos.x - x1;
+			const int outputWidth = m_outputDataWindow.size().x + 1;
+			for( int y = rows.begin(); y != rows.end(); ++y )
+			{
+				Imath::V2f *coordinate = &(m_coordinates[(size_t)y * outputWidth]);
+				for( int x = m_outputDataWindow.min.x; x <= m_outputDataWindow.max.x; ++x, ++coordinate )
+				{
+					*coordinate = m_warpOp->warp( Imath::V2f( x, y + m_outputDataWindow.min.y ) );
+				}
+			}
 		}
-		if ( y1 > inPos.y )
+
+	private :
+
+		const WarpOp *m_warpOp;
+		Imath::Box2i m_outputDataWindow;
+		std::vector<Imath::V2f> &m_coordinates;
+
+};
+
+namespace
+{
+
+// Performs the None filter directly on the typed data, so that values
+// are copied exactly.
+template<typename Container>
+class NearestBody
+{
+	public :
+
+		NearestBody( const std::vector<V2f> &coordinates, const Container &input, const Box2i &inputDataWindow, Container &output )
+			:	m_coordinates( coordinates ), m_input( input ), m_inputDataWindow( inputDataWindow ), m_output( output )
 		{
-			ratioY = y1 - inPos.y;
-			y2 = y1;
-			y1--;
 		}
-		else
+
+		void operator()( const tbb::blocked_range<size_t> &range ) const
 		{
-			y2 = y1 + 1;
-			ratioY = inPos.y - y1;
+			const int inputWidth = m_inputDataWindow.size().x + 1;
+			const int inputHeight = m_inputDataWindow.size().y + 1;
+			for( size_t i = range.begin(); i != range.end(); ++i )
+			{
+				int x = int( m_coordinates[i].x ) - m_inputDataWindow.min.x;
+				int y = int( m_coordinates[i].y ) - m_inputDataWindow.min.y;
+				x = ( x < 0 ? 0 : ( x >= inputWidth ? inputWidth - 1 : x ) );
+				y = ( y < 0 ? 0 : ( y >= inputHeight ? inputHeight - 1 : y ) );
+				m_output[i] = m_input[x + y * inputWidth];
+			}
 		}
-		x1 -= m_inputDataWindow.min.x;
-		y1 -= m_inputDataWindow.min.y;
-		x2 -= m_inputDataWindow.min.x;
-		y2 -= m_inputDataWindow.min.y;
-	}
 
-	template<typename V>
-	inline V clampXY( const std::vector<V> &buffer, int x, int y, int width, int height ) const
+	private :
+
+		const std::vector<V2f> &m_coordinates;
+		const Container &m_input;
+		Box2i m_inputDataWindow;
+		Container &m_output;
+
+};
+
+struct NearestWarp
+{
+	typedef void ReturnType;
+
+	NearestWarp( const std::vector<V2f> &coordinates, const Box2i &inputDataWindow )
+		:	m_coordinates( coordinates ), m_inputDataWindow( inputDataWindow )
 	{
-		x = ( x < 0 ? 0 : ( x >= width ? width - 1 : x ));
-		y = ( y < 0 ? 0 : ( y >= height ? height - 1 : y ));
-		return buffer[ x + y * width ];
 	}
 
 	template<typename T>
-	ReturnType operator()( T * data )
+	ReturnType operator()( T *data )
 	{
 		typedef typename T::ValueType Container;
-		typedef typename Container::value_type V;
-		typedef typename Container::iterator It;
 		typename T::Ptr inData = data->copy();
-		const Container &inBuffer = inData->readable();
-		unsigned int outputWidth = m_outputDataWindow.size().x + 1;
-		unsigned int inputWidth = m_inputDataWindow.size().x + 1;
-		unsigned int inputHeight = m_inputDataWindow.size().y + 1;
-		Container &outBuffer = data->writable();
-		outBuffer.resize( outputWidth * (m_outputDataWindow.size().y + 1) );
-		int x1, x2, y1, y2;
-		float ratioX, ratioY;
-		unsigned pixelIndex=0;
-		double r1, r2, r;
-
-		switch( m_filter )
-		{
-		case WarpOp::None:
-			for( int y=m_outputDataWindow.min.y; y<=m_outputDataWindow.max.y; y++ )
+		Container &output = data->writable();
+		output.resize( m_coordinates.size() );
+		NearestBody<Container> body( m_coordinates, inData->readable(), m_inputDataWindow, output );
+		tbb::parallel_for( tbb::blocked_range<size_t>( 0, m_coordinates.size(), 1024 ), body );
+	}
+
+	const std::vector<V2f> &m_coordinates;
+	Box2i m_inputDataWindow;
+};
+
+// Copies a channel into one component of a buffer in which the
+// channels of each pixel are stored together.
+struct Interleave
+{
+	typedef void ReturnType;
+
+	Interleave( std::vector<float> &buffer, size_t channelIndex, size_t numChannels )
+		:	m_buffer( buffer ), m_channelIndex( channelIndex ), m_numChannels( numChannels )
+	{
+	}
+
+	template<typename T>
+	ReturnType operator()( T *data )
+	{
+		const typename T::ValueType &channel = data->readable();
+		float *out = &(m_buffer[m_channelIndex]);
+		for( size_t i = 0; i < channel.size(); ++i, out += m_numChannels )
+		{
+			*out = (float)channel[i];
+		}
+	}
+
+	std::vector<float> &m_buffer;
+	size_t m_channelIndex;
+	size_t m_numChannels;
+};
+
+// The inverse of Interleave.
+struct Deinterleave
+{
+	typedef void ReturnType;
+
+	Deinterleave( const std::vector<float> &buffer, size_t channelIndex, size_t numChannels )
+		:	m_buffer( buffer ), m_channelIndex( channelIndex ), m_numChannels( numChannels )
+	{
+	}
+
+	template<typename T>
+	ReturnType operator()( T *data )
+	{
+		typedef typename T::ValueType::value_type V;
+		typename T::ValueType &channel = data->writable();
+		channel.resize( m_buffer.size() / m_numChannels );
+		const float *in = &(m_buffer[m_channelIndex]);
+		for( size_t i = 0; i < channel.size(); ++i, in += m_numChannels )
+		{
+			channel[i] = (V)*in;
+		}
+	}
+
+	const std::vector<float> &m_buffer;
+	size_t m_channelIndex;
+	size_t m_numChannels;
+};
+
+inline float catmullRom( float x )
+{
+	x = fabsf( x );
+	if( x < 1.0f )
+	{
+		return ( 1.5f * x - 2.5f ) * x * x + 1.0f;
+	}
+	else if( x < 2.0f )
+	{
+		return ( ( -0.5f * x + 2.5f ) * x - 4.0f ) * x + 2.0f;
+	}
+	return 0.0f;
+}
+
+inline float lanczos3( float x )
+{
+	x = fabsf( x );
+	if( x < 1e-5f )
+	{
+		return 1.0f;
+	}
+	else if( x >= 3.0f )
+	{
+		return 0.0f;
+	}
+	const float pix = M_PI * x;
+	return 3.0f * sinf( pix ) * sinf( pix / 3.0f ) / ( pix * pix );
+}
+
+// Filters all channels at once from an interleaved input buffer into an interleaved
+// output buffer. The filter weights for each pixel are computed once and applied to
+// all channels in a single inner loop.
+class FilterBody
+{
+	public :
+
+		FilterBody( WarpOp::FilterType filter, const std::vector<V2f> &coordinates, int outputWidth, int outputHeight,
+			const std::vector<float> &input, const Box2i &inputDataWindow, size_t numChannels, std::vector<float> &output )
+			:	m_filter( filter ), m_coordinates( coordinates ), m_outputWidth( outputWidth ), m_outputHeight( outputHeight ),
+				m_input( input ), m_inputOrigin( inputDataWindow.min ), m_inputWidth( inputDataWindow.size().x + 1 ),
+				m_inputHeight( inputDataWindow.size().y + 1 ), m_numChannels( numChannels ), m_output( output )
+		{
+		}
+
+		void operator()( const tbb::blocked_range2d<int> &tile ) const
+		{
+			for( int y = tile.rows().begin(); y != tile.rows().end(); ++y )
 			{
-				for( int x=m_outputDataWindow.min.x; x<=m_outputDataWindow.max.x; x++, pixelIndex++ )
+				for( int x = tile.cols().begin(); x != tile.cols().end(); ++x )
 				{
-					Imath::V2f inPos = m_warpOp->warp( Imath::V2f( x, y ) );
-					x1 = int(inPos.x) - m_inputDataWindow.min.x;
-					y1 = int(inPos.y) - m_inputDataWindow.min.y;
-					outBuffer[pixelIndex] = clampXY<V>( inBuffer, x1, y1, inputWidth, inputHeight);
+					const size_t i = (size_t)y * m_outputWidth + x;
+					const V2f p = m_coordinates[i] - V2f( m_inputOrigin );
+					float *out = &(m_output[i * m_numChannels]);
+					switch( m_filter )
+					{
+						case WarpOp::Bicubic :
+							separable( p, 2, catmullRom, out );
+							break;
+						case WarpOp::Lanczos :
+							separable( p, 3, lanczos3, out );
+							break;
+						case WarpOp::EWA :
+							ewa( x, y, p, out );
+							break;
+						default :
+							bilinear( p, out );
+					}
 				}
 			}
-			break;
+		}
+
+	private :
+
+		// Accumulates a weighted input pixel, clamping to the edges of the data window.
+		inline void tap( int x, int y, float weight, float *out ) const
+		{
+			x = ( x < 0 ? 0 : ( x >= m_inputWidth ? m_inputWidth - 1 : x ) );
+			y = ( y < 0 ? 0 : ( y >= m_inputHeight ? m_inputHeight - 1 : y ) );
+			const float *in = &(m_input[( (size_t)y * m_inputWidth + x ) * m_numChannels]);
+			for( size_t c = 0; c < m_numChannels; ++c )
+			{
+				out[c] += weight * in[c];
+			}
+		}
 
-		case WarpOp::Bilinear:
-			for( int y=m_outputDataWindow.min.y; y<=m_outputDataWindow.max.y; y++ )
+		inline void normalise( float weightSum, float *out ) const
+		{
+			if( weightSum != 0.0f && weightSum != 1.0f )
 			{
-				for( int x=m_outputDataWindow.min.x; x<=m_outputDataWindow.max.x; x++, pixelIndex++ )
+				const float m = 1.0f / weightSum;
+				for( size_t c = 0; c < m_numChannels; ++c )
 				{
-					computePixelCoordinates( x, y, x1, y1, x2, y2, ratioX, ratioY );
-					LinearInterpolator<double>()( (double)clampXY<V>( inBuffer, x1, y1, inputWidth, inputHeight ),
-												  (double)clampXY<V>( inBuffer, x2, y1, inputWidth, inputHeight ), ratioX, r1 );
-					LinearInterpolator<double>()( (double)clampXY<V>( inBuffer, x1, y2, inputWidth, inputHeight ),
-												  (double)clampXY<V>( inBuffer, x2, y2, inputWidth, inputHeight ), ratioX, r2 );
-					LinearInterpolator<double>()( r1, r2, ratioY, r );
-					outBuffer[pixelIndex] = (V)r;
+					out[c] *= m;
 				}
 			}
-			break;
+		}
 
-		default:
-			throw Exception("Invalid filter type!");
+		void bilinear( const V2f &p, float *out ) const
+		{
+			const int x0 = fastFloatFloor( p.x );
+			const int y0 = fastFloatFloor( p.y );
+			const float fx = p.x - x0;
+			const float fy = p.y - y0;
+			tap( x0, y0, ( 1.0f - fx ) * ( 1.0f - fy ), out );
+			tap( x0 + 1, y0, fx * ( 1.0f - fy ), out );
+			tap( x0, y0 + 1, ( 1.0f - fx ) * fy, out );
+			tap( x0 + 1, y0 + 1, fx * fy, out );
+		}
+
+		void separable( const V2f &p, int radius, float (*kernel)( float ), float *out ) const
+		{
+			const int x0 = fastFloatFloor( p.x ) - radius + 1;
+			const int y0 = fastFloatFloor( p.y ) - radius + 1;
+			const int numTaps = radius * 2;
+
+			float wx[6], wy[6];
+			float sumX = 0.0f, sumY = 0.0f;
+			for( int i = 0; i < numTaps; ++i )
+			{
+				wx[i] = kernel( p.x - ( x0 + i ) );
+				wy[i] = kernel( p.y - ( y0 + i ) );
+				sumX += wx[i];
+				sumY += wy[i];
+			}
+
+			for( int j = 0; j < numTaps; ++j )
+			{
+				for( int i = 0; i < numTaps; ++i )
+				{
+					tap( x0 + i, y0 + j, wx[i] * wy[j], out );
+				}
+			}
+
+			normalise( sumX * sumY, out );
+		}
+
+		// Elliptical weighted average filtering with a gaussian kernel, as described
+		// by Heckbert in "Fundamentals of Texture Mapping and Image Warping". The
+		// ellipse is derived from the derivatives of the warp at the output pixel.
+		void ewa( int x, int y, const V2f &p, float *out ) const
+		{
+			const V2f dx = derivative( x, y, 1, 0 );
+			const V2f dy = derivative( x, y, 0, 1 );
+
+			// the added 1s ensure the ellipse covers at least one input
+			// pixel, so that magnified areas reconstruct smoothly.
+			const float a = dx.y * dx.y + dy.y * dy.y + 1.0f;
+			const float b = -2.0f * ( dx.x * dx.y + dy.x * dy.y );
+			const float c = dx.x * dx.x + dy.x * dy.x + 1.0f;
+			const float f = a * c - b * b * 0.25f;
+
+			// extent of the ellipse, limited to bound the cost
+			// in the case of extreme distortions.
+			const float maxRadius = 16.0f;
+			const float radiusX = std::min( sqrtf( c ), maxRadius );
+			const float radiusY = std::min( sqrtf( a ), maxRadius );
+
+			const int xMin = (int)ceilf( p.x - radiusX );
+			const int xMax = (int)floorf( p.x + radiusX );
+			const int yMin = (int)ceilf( p.y - radiusY );
+			const int yMax = (int)floorf( p.y + radiusY );
+
+			float weightSum = 0.0f;
+			for( int ty = yMin; ty <= yMax; ++ty )
+			{
+				const float v = ty - p.y;
+				for( int tx = xMin; tx <= xMax; ++tx )
+				{
+					const float u = tx - p.x;
+					const float q = ( a * u * u + b * u * v + c * v * v ) / f;
+					if( q < 1.0f )
+					{
+						const float weight = expf( -2.0f * q );
+						tap( tx, ty, weight, out );
+						weightSum += weight;
+					}
+				}
+			}
+
+			if( weightSum == 0.0f )
+			{
+				bilinear( p, out );
+				return;
+			}
+
+			normalise( weightSum, out );
+		}
+
+		// Computes the derivative of the warped coordinates along the given
+		// output axis using finite differences.
+		V2f derivative( int x, int y, int stepX, int stepY ) const
+		{
+			const int x0 = std::max( x - stepX, 0 );
+			const int y0 = std::max( y - stepY, 0 );
+			const int x1 = std::min( x + stepX, m_outputWidth - 1 );
+			const int y1 = std::min( y + stepY, m_outputHeight - 1 );
+			const int steps = ( x1 - x0 ) + ( y1 - y0 );
+			if( !steps )
+			{
+				return V2f( stepX, stepY );
+			}
+			const V2f &p0 = m_coordinates[(size_t)y0 * m_outputWidth + x0];
+			const V2f &p1 = m_coordinates[(size_t)y1 * m_outputWidth + x1];
+			return ( p1 - p0 ) / (float)steps;
 		}
-	}
 
-	private :
-		WarpOp * m_warpOp;
 		WarpOp::FilterType m_filter;
-		Imath::Box2i m_outputDataWindow;
-		Imath::Box2i m_inputDataWindow;
+		const std::vector<V2f> &m_coordinates;
+		int m_outputWidth;
+		int m_outputHeight;
+		const std::vector<float> &m_input;
+		V2i m_inputOrigin;
+		int m_inputWidth;
+		int m_inputHeight;
+		size_t m_numChannels;
+		std::vector<float> &m_output;
+
 };
 
+} // namespace
+
 void WarpOp::modifyTypedPrimitive( ImagePrimitive * image, const CompoundObject * operands )
 {
 	Imath::Box2i originalDataWindow = image->getDataWindow();
 
 	begin( operands );
 	Imath::Box2i newDataWindow = warpedDataWindow( originalDataWindow );
+	const FilterType filter = (FilterType)m_filterParameter->getNumericValue();
+	if( filter < None || filter >= TypeCount )
+	{
+		throw Exception( "Invalid filter type!" );
+	}
+
+	// find the channels to warp
+
 	std::string error;
-	Warp w( this, (FilterType)m_filterParameter->getNumericValue(), newDataWindow, originalDataWindow );
+	std::vector<DataPtr> channels;
 	for( PrimitiveVariableMap::iterator it = image->variables.begin(); it != image->variables.end(); it++ )
 	{
 		if( it->second.interpolation!=PrimitiveVariable::Vertex &&
@@ -210,8 +487,48 @@ void WarpOp::modifyTypedPrimitive( ImagePrimitive * image, const CompoundObject
 		{
 			throw Exception( error );
 		}
-		despatchTypedData<Warp, TypeTraits::IsNumericVectorTypedData>( it->second.data, w );
+		channels.push_back( it->second.data );
+	}
+
+	// compute the warped coordinates once, for use by all channels
+
+	const int outputWidth = newDataWindow.size().x + 1;
+	const int outputHeight = newDataWindow.size().y + 1;
+	std::vector<Imath::V2f> coordinates( (size_t)outputWidth * outputHeight );
+	tbb::parallel_for( tbb::blocked_range<int>( 0, outputHeight ), Coordinates( this, newDataWindow, coordinates ) );
+
+	// and filter
+
+	if( filter == None )
+	{
+		NearestWarp nearestWarp( coordinates, originalDataWindow );
+		for( std::vector<DataPtr>::const_iterator it = channels.begin(); it != channels.end(); ++it )
+		{
+			despatchTypedData<NearestWarp, TypeTraits::IsNumericVectorTypedData>( *it, nearestWarp );
+		}
 	}
+	else if( channels.size() )
+	{
+		const size_t numChannels = channels.size();
+		const size_t numInputPixels = (size_t)( originalDataWindow.size().x + 1 ) * ( originalDataWindow.size().y + 1 );
+		std::vector<float> input( numInputPixels * numChannels );
+		for( size_t i = 0; i < numChannels; ++i )
+		{
+			Interleave interleave( input, i, numChannels );
+			despatchTypedData<Interleave, TypeTraits::IsNumericVectorTypedData>( channels[i], interleave );
+		}
+
+		std::vector<float> output( coordinates.size() * numChannels, 0.0f );
+		FilterBody body( filter, coordinates, outputWidth, outputHeight, input, originalDataWindow, numChannels, output );
+		tbb::parallel_for( tbb::blocked_range2d<int>( 0, outputHeight, 64, 0, outputWidth, 64 ), body );
+
+		for( size_t i = 0; i < numChannels; ++i )
+		{
+			Deinterleave deinterleave( output, i, numChannels );
+			despatchTypedData<Deinterleave, TypeTraits::IsNumericVectorTypedData>( channels[i], deinterleave );
+		}
+	}
+
 	end();
 	image->setDataWindow( newDataWindow );
 }
@@ -32,15 +32,24 @@
 //
 //////////////////////////////////////////////////////////////////////////
 
+#include <set>
+
 #include "boost/lexical_cast.hpp"
 #include "boost/format.hpp"
 #include "boost/bind.hpp"
 #include "boost/bind/placeholders.hpp"
 
+#include "tbb/mutex.h"
+#include "tbb/task_group.h"
+#include "tbb/parallel_for.h"
+#include "tbb/blocked_range.h"
+#include "tbb/task_arena.h"
+
 #include "IECore/LRUCache.h"
 #include "IECore/MurmurHash.h"
 
 #include "IECoreGL/ToGLConverter.h"
+#include "IECoreGL/Primitive.h"
 #include "IECoreGL/CachedConverter.h"
 
 using namespace IECoreGL;
@@ -99,9 +108,26 @@ struct CachedConverter::MemberData
 		cost = key.object->memoryUsage();
 		IECore::RunTimeTypedPtr ret;
 
+		// conversions may use parallel loops, and while waiting for them this
+		// thread could otherwise pick up a prefetch task for the entry it is
+		// computing, and wait forever for that entry to be cached. we isolate
+		// the conversion so that it can only pick up its own tasks.
+		tbb::this_task_arena::isolate( boost::bind( &MemberData::convertObject, boost::cref( key ), boost::ref( ret ) ) );
+
+		// It would be unsafe to access object from outside of this function,
+		// so we zero it out so that it will be obvious if anyone ever does.
+		// The only way I could see this happening is if the LRUCache implementation
+		// changed.
+		key.object = 0;
+
+		return ret;
+	}
+
+	static void convertObject( const CacheKey &key, IECore::RunTimeTypedPtr &result )
+	{
 		if ( key.converter )
 		{
-			ret = key.converter(key.object);
+			result = key.converter(key.object);
 		}
 		else
 		{
@@ -116,26 +142,72 @@ struct CachedConverter::MemberData
 					)
 				);
 			}
-			ret = converter->convert();
+			result = converter->convert();
 		}
-
-		// It would be unsafe to access object from outside of this function,
-		// so we zero it out so that it will be obvious if anyone ever does.
-		// The only way I could see this happening is if the LRUCache implementation
-		// changed.
-		key.object = 0;
-
-		return ret;
 	}
 	
+	typedef IECore::LRUCache<CacheKey, IECore::RunTimeTypedPtr> Cache;
+
 	void removalCallback( const CacheKey &key, const IECore::RunTimeTypedPtr &value )
 	{
+		// removals may be made concurrently by convert() calls on other threads
+		// and by prefetches, so we must lock before deferring them.
+		tbb::mutex::scoped_lock lock( deferredRemovalsMutex );
 		deferredRemovals.push_back( value );
 	}
-	
-	typedef IECore::LRUCache<CacheKey, IECore::RunTimeTypedPtr> Cache;
+
+	// Functor for use with tbb::parallel_for, to convert a range of
+	// the objects passed to prefetch().
+	class Prefetcher
+	{
+
+		public :
+
+			Prefetcher( Cache &cache, const std::vector<CacheKey> &keys )
+				:	m_cache( cache ), m_keys( keys )
+			{
+			}
+
+			void operator()( const tbb::blocked_range<size_t> &r ) const
+			{
+				for( size_t i = r.begin(); i != r.end(); ++i )
+				{
+					// failures aren't recorded by prefetch(), so any error
+					// will be reported by the next call to convert().
+					m_cache.prefetch( m_keys[i] );
+				}
+			}
+
+		private :
+
+			Cache &m_cache;
+			const std::vector<CacheKey> &m_keys;
+
+	};
+
+	// Task for use with tbb::task_group, which owns the objects to be
+	// prefetched, keeping them alive until the conversions are complete.
+	struct PrefetchTask
+	{
+		PrefetchTask( Cache &c, const std::vector<IECore::ConstObjectPtr> &o, const std::vector<CacheKey> &k )
+			:	cache( c ), objects( o ), keys( k )
+		{
+		}
+
+		void operator()() const
+		{
+			tbb::parallel_for( tbb::blocked_range<size_t>( 0, keys.size() ), Prefetcher( cache, keys ) );
+		}
+
+		Cache &cache;
+		std::vector<IECore::ConstObjectPtr> objects;
+		std::vector<CacheKey> keys;
+	};
+
 	Cache cache;
+	tbb::mutex deferredRemovalsMutex;
 	std::vector<IECore::RunTimeTypedPtr> deferredRemovals;
+	tbb::task_group prefetches;
 	
 };
 
@@ -146,6 +218,9 @@ CachedConverter::CachedConverter( size_t maxMemory )
 
 CachedConverter::~CachedConverter()
 {
+	// the prefetches reference the cache, so must complete
+	// before we can destroy it.
+	waitForPrefetches();
 	delete m_data;
 }
 
@@ -159,6 +234,51 @@ IECore::ConstRunTimeTypedPtr CachedConverter::convert( const IECore::Object *obj
 	return m_data->cache.get( MemberData::CacheKey( object, converter, converterHash ) );
 }
 
+void CachedConverter::prefetch( const std::vector<IECore::ConstObjectPtr> &objects )
+{
+	std::vector<IECore::ConstObjectPtr> toPrefetch;
+	std::vector<MemberData::CacheKey> keys;
+	toPrefetch.reserve( objects.size() );
+	keys.reserve( objects.size() );
+	std::set<IECore::MurmurHash> hashes;
+	for( std::vector<IECore::ConstObjectPtr>::const_iterator it = objects.begin(); it != objects.end(); ++it )
+	{
+		if( !*it )
+		{
+			continue;
+		}
+		// objects with the same hash share a cache entry, so we prefetch
+		// only the first of them - the tasks for the others would just
+		// wait for it to be converted.
+		const IECore::MurmurHash hash = (*it)->hash();
+		if( !hashes.insert( hash ).second )
+		{
+			continue;
+		}
+		// we can only safely prefetch conversions which don't need a gl context,
+		// so we check that the converter convert() would use produces a Primitive.
+		ToGLConverterPtr converter = ToGLConverter::create( *it );
+		ToGLConverterPtr primitiveConverter = ToGLConverter::create( *it, Primitive::staticTypeId() );
+		if( converter && primitiveConverter && converter->typeId() == primitiveConverter->typeId() )
+		{
+			toPrefetch.push_back( *it );
+			keys.push_back( MemberData::CacheKey( it->get(), ConverterFn(), hash ) );
+		}
+	}
+
+	if( toPrefetch.empty() )
+	{
+		return;
+	}
+
+	m_data->prefetches.run( MemberData::PrefetchTask( m_data->cache, toPrefetch, keys ) );
+}
+
+void CachedConverter::waitForPrefetches()
+{
+	m_data->prefetches.wait();
+}
+
 size_t CachedConverter::getMaxMemory() const
 {
 	return m_data->cache.getMaxCost();
@@ -172,7 +292,13 @@ void CachedConverter::setMaxMemory( size_t maxMemory )
 
 void CachedConverter::clearUnused()
 {
-	m_data->deferredRemovals.clear();
+	// swap the removals out under the lock, so that we don't destroy
+	// anything while holding it.
+	std::vector<IECore::RunTimeTypedPtr> removals;
+	{
+		tbb::mutex::scoped_lock lock( m_data->deferredRemovalsMutex );
+		removals.swap( m_data->deferredRemovals );
+	}
 }
 
 CachedConverterPtr CachedConverter::defaultCachedConverter()
@@ -34,11 +34,16 @@
 
 #include <cassert>
 
+#include "boost/format.hpp"
+
 #include "IECore/DespatchTypedData.h"
+#include "IECore/MessageHandler.h"
 
 #include "IECoreGL/MeshPrimitive.h"
 #include "IECoreGL/GL.h"
 #include "IECoreGL/State.h"
+#include "IECoreGL/Buffer.h"
+#include "IECoreGL/CachedConverter.h"
 
 #include "OpenEXR/ImathMath.h"
 
@@ -53,13 +58,18 @@ using namespace std;
 
 struct MeshPrimitive::MemberData : public IECore::RefCounted
 {
-	MemberData( IECore::ConstIntVectorDataPtr verts ) : vertIds( verts )
+	MemberData( IECore::ConstIntVectorDataPtr verts, bool i, size_t n )
+		:	vertIds( verts ), indexed( i ), numVertices( n )
 	{
 	}
 
 	IECore::ConstIntVectorDataPtr vertIds;
+	bool indexed;
+	size_t numVertices;
 	Imath::Box3f bound;
 
+	mutable IECoreGL::ConstBufferPtr vertIdsBuffer;
+
 	/// \todo This could be removed and the ToGLMeshConverter could use FaceVaryingPromotionOp
 	/// to convert everything to FaceVarying before being added.
 	class ToFaceVaryingConverter
@@ -103,7 +113,12 @@ struct MeshPrimitive::MemberData : public IECore::RefCounted
 IE_CORE_DEFINERUNTIMETYPED( MeshPrimitive );
 
 MeshPrimitive::MeshPrimitive( IECore::ConstIntVectorDataPtr vertIds )
-	:	m_memberData( new MemberData( vertIds->copy() ) )
+	:	m_memberData( new MemberData( vertIds->copy(), false, vertIds->readable().size() ) )
+{
+}
+
+MeshPrimitive::MeshPrimitive( IECore::ConstIntVectorDataPtr vertIds, size_t numVertices )
+	:	m_memberData( new MemberData( vertIds->copy(), true, numVertices ) )
 {
 }
 
@@ -116,6 +131,16 @@ IECore::ConstIntVectorDataPtr MeshPrimitive::vertexIds() const
 	return m_memberData->vertIds;
 }
 
+bool MeshPrimitive::indexed() const
+{
+	return m_memberData->indexed;
+}
+
+size_t MeshPrimitive::numVertices() const
+{
+	return m_memberData->numVertices;
+}
+
 void MeshPrimitive::addPrimitiveVariable( const std::string &name, const IECore::PrimitiveVariable &primVar )
 {
 	if ( primVar.interpolation==IECore::PrimitiveVariable::Vertex || primVar.interpolation==IECore::PrimitiveVariable::Varying )
@@ -135,6 +160,13 @@ void MeshPrimitive::addPrimitiveVariable( const std::string &name, const IECore:
 			}
 		}
 
+		if( m_memberData->indexed )
+		{
+			// the vertex ids index directly into the data
+			addVertexAttribute( name, primVar.data );
+			return;
+		}
+
 		MemberData::ToFaceVaryingConverter primVarConverter( m_memberData->vertIds );
 		// convert to facevarying
 		IECore::DataPtr newData = IECore::despatchTypedData< MemberData::ToFaceVaryingConverter, IECore::TypeTraits::IsVectorTypedData >( primVar.data, primVarConverter );
@@ -142,6 +174,11 @@ void MeshPrimitive::addPrimitiveVariable( const std::string &name, const IECore:
 	}
 	else if ( primVar.interpolation==IECore::PrimitiveVariable::FaceVarying )
 	{
+		if( m_memberData->indexed )
+		{
+			IECore::msg( IECore::Msg::Warning, "MeshPrimitive::addPrimitiveVariable", boost::format( "Primitive variable \"%s\" is FaceVarying, which is not supported by indexed meshes." ) % name );
+			return;
+		}
 		addVertexAttribute( name, primVar.data );
 	}
 	else if ( primVar.interpolation==IECore::PrimitiveVariable::Constant )
@@ -153,7 +190,22 @@ void MeshPrimitive::addPrimitiveVariable( const std::string &name, const IECore:
 void MeshPrimitive::renderInstances( size_t numInstances ) const
 {
 	unsigned vertexCount = m_memberData->vertIds->readable().size();
-	glDrawArraysInstancedARB( GL_TRIANGLES, 0, vertexCount, numInstances );
+	if( !m_memberData->indexed )
+	{
+		glDrawArraysInstancedARB( GL_TRIANGLES, 0, vertexCount, numInstances );
+		return;
+	}
+
+	if( !m_memberData->vertIdsBuffer )
+	{
+		// we don't build the actual buffer until now, because in the constructor we're not guaranteed
+		// a valid GL context.
+		CachedConverterPtr cachedConverter = CachedConverter::defaultCachedConverter();
+		m_memberData->vertIdsBuffer = IECore::runTimeCast<const Buffer>( cachedConverter->convert( m_memberData->vertIds ) );
+	}
+
+	Buffer::ScopedBinding indexBinding( *(m_memberData->vertIdsBuffer), GL_ELEMENT_ARRAY_BUFFER );
+	glDrawElementsInstancedARB( GL_TRIANGLES, vertexCount, GL_UNSIGNED_INT, 0, numInstances );
 }
 
 Imath::Box3f MeshPrimitive::bound() const
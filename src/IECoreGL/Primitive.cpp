@@ -303,6 +303,16 @@ void Primitive::addVertexAttribute( const std::string &name, IECore::ConstDataPt
 {
 	m_vertexAttributes[name] = data->copy();
 }
+
+IECore::ConstDataPtr Primitive::vertexAttribute( const std::string &name ) const
+{
+	AttributeMap::const_iterator it = m_vertexAttributes.find( name );
+	if( it == m_vertexAttributes.end() )
+	{
+		return 0;
+	}
+	return it->second;
+}
 		
 bool Primitive::depthSortRequested( const State * state ) const
 {
@@ -34,19 +34,409 @@
 
 #include <cassert>
 
+#include <algorithm>
+
 #include "boost/format.hpp"
+#include "boost/type_traits/is_same.hpp"
+
+#include "tbb/parallel_for.h"
 
 #include "IECoreGL/ToGLMeshConverter.h"
 #include "IECoreGL/MeshPrimitive.h"
 
 #include "IECore/MeshPrimitive.h"
+#include "IECore/MeshAdjacency.h"
 #include "IECore/TriangulateOp.h"
 #include "IECore/MeshNormalsOp.h"
 #include "IECore/DespatchTypedData.h"
 #include "IECore/MessageHandler.h"
+#include "IECore/CompoundParameter.h"
 
 using namespace IECoreGL;
 
+//////////////////////////////////////////////////////////////////////////
+// Implementation of indexed conversion
+//////////////////////////////////////////////////////////////////////////
+
+namespace
+{
+
+/// Compares the values of a face-varying primitive variable at two face-vertices,
+/// so that face-vertices sharing a vertex and all their values can be welded together.
+class FaceVaryingComparator : public IECore::RefCounted
+{
+
+	public :
+
+		virtual bool equal( int faceVertex0, int faceVertex1 ) const = 0;
+
+};
+
+IE_CORE_DECLAREPTR( FaceVaryingComparator );
+
+template<typename T>
+class TypedFaceVaryingComparator : public FaceVaryingComparator
+{
+
+	public :
+
+		TypedFaceVaryingComparator( const T *data )
+			:	m_data( data ), m_values( data->readable() )
+		{
+		}
+
+		virtual bool equal( int faceVertex0, int faceVertex1 ) const
+		{
+			return m_values[faceVertex0] == m_values[faceVertex1];
+		}
+
+	private :
+
+		typename T::ConstPtr m_data;
+		const typename T::ValueType &m_values;
+
+};
+
+struct ComparatorCreator
+{
+	typedef FaceVaryingComparatorPtr ReturnType;
+
+	template<typename T>
+	ReturnType operator()( T *data )
+	{
+		return new TypedFaceVaryingComparator<T>( data );
+	}
+};
+
+typedef std::vector<ConstFaceVaryingComparatorPtr> Comparators;
+
+/// Finds the unique vertices for a range of mesh vertices. For each mesh vertex the
+/// face-vertices using it are compared to the representatives found so far, becoming
+/// a new representative only if their face-varying values differ from all of them.
+/// Each face-vertex is assigned the index of its representative amongst those for its
+/// vertex, so no synchronisation is needed between vertices.
+class WeldVertices
+{
+
+	public :
+
+		WeldVertices(
+			const IECore::MeshAdjacency &adjacency, const Comparators &comparators,
+			std::vector<int> &localIndices, std::vector<int> &representatives, std::vector<int> &numUnique
+		)
+			:	m_vertexFaceOffsets( adjacency.vertexFaceOffsets() ), m_vertexFaceVertices( adjacency.vertexFaceVertices() ),
+				m_comparators( comparators ), m_localIndices( localIndices ), m_representatives( representatives ), m_numUnique( numUnique )
+		{
+		}
+
+		void operator()( const tbb::blocked_range<size_t> &r ) const
+		{
+			for( size_t v = r.begin(); v != r.end(); ++v )
+			{
+				const int begin = m_vertexFaceOffsets[v];
+				const int end = m_vertexFaceOffsets[v+1];
+				int numUnique = 0;
+				for( int i = begin; i < end; ++i )
+				{
+					const int faceVertex = m_vertexFaceVertices[i];
+					int u = 0;
+					while( u < numUnique && !equal( faceVertex, m_representatives[begin+u] ) )
+					{
+						u++;
+					}
+					if( u == numUnique )
+					{
+						m_representatives[begin+numUnique++] = faceVertex;
+					}
+					m_localIndices[faceVertex] = u;
+				}
+				m_numUnique[v] = numUnique;
+			}
+		}
+
+	private :
+
+		bool equal( int faceVertex0, int faceVertex1 ) const
+		{
+			for( Comparators::const_iterator it = m_comparators.begin(), eIt = m_comparators.end(); it != eIt; ++it )
+			{
+				if( !(*it)->equal( faceVertex0, faceVertex1 ) )
+				{
+					return false;
+				}
+			}
+			return true;
+		}
+
+		const std::vector<int> &m_vertexFaceOffsets;
+		const std::vector<int> &m_vertexFaceVertices;
+		const Comparators &m_comparators;
+		std::vector<int> &m_localIndices;
+		std::vector<int> &m_representatives;
+		std::vector<int> &m_numUnique;
+
+};
+
+/// Records the mesh vertex and representative face-vertex for each unique vertex
+/// of a range of mesh vertices.
+class UniqueVertexSources
+{
+
+	public :
+
+		UniqueVertexSources(
+			const IECore::MeshAdjacency &adjacency, const std::vector<int> &representatives, const std::vector<int> &uniqueOffsets,
+			std::vector<int> &vertexSources, std::vector<int> &faceVertexSources
+		)
+			:	m_vertexFaceOffsets( adjacency.vertexFaceOffsets() ), m_representatives( representatives ), m_uniqueOffsets( uniqueOffsets ),
+				m_vertexSources( vertexSources ), m_faceVertexSources( faceVertexSources )
+		{
+		}
+
+		void operator()( const tbb::blocked_range<size_t> &r ) const
+		{
+			for( size_t v = r.begin(); v != r.end(); ++v )
+			{
+				const int representativesBegin = m_vertexFaceOffsets[v];
+				for( int u = m_uniqueOffsets[v], eU = m_uniqueOffsets[v+1]; u < eU; ++u )
+				{
+					m_vertexSources[u] = v;
+					m_faceVertexSources[u] = m_representatives[representativesBegin + u - m_uniqueOffsets[v]];
+				}
+			}
+		}
+
+	private :
+
+		const std::vector<int> &m_vertexFaceOffsets;
+		const std::vector<int> &m_representatives;
+		const std::vector<int> &m_uniqueOffsets;
+		std::vector<int> &m_vertexSources;
+		std::vector<int> &m_faceVertexSources;
+
+};
+
+/// Triangulates a range of faces as simple triangle fans, in the same way as
+/// TriangulateOp, writing indices of unique vertices into a preallocated array.
+class TriangulateIndices
+{
+
+	public :
+
+		TriangulateIndices(
+			const std::vector<int> &vertexIds, const std::vector<int> &faceOffsets, const std::vector<int> &triangleOffsets,
+			const std::vector<int> &localIndices, const std::vector<int> &uniqueOffsets, std::vector<int> &indices
+		)
+			:	m_vertexIds( vertexIds ), m_faceOffsets( faceOffsets ), m_triangleOffsets( triangleOffsets ),
+				m_localIndices( localIndices ), m_uniqueOffsets( uniqueOffsets ), m_indices( indices )
+		{
+		}
+
+		void operator()( const tbb::blocked_range<size_t> &r ) const
+		{
+			for( size_t f = r.begin(); f != r.end(); ++f )
+			{
+				const int faceBegin = m_faceOffsets[f];
+				const int faceEnd = m_faceOffsets[f+1];
+				int *out = &m_indices[0] + m_triangleOffsets[f] * 3;
+				for( int i = faceBegin + 1; i < faceEnd - 1; ++i )
+				{
+					*out++ = uniqueIndex( faceBegin );
+					*out++ = uniqueIndex( i );
+					*out++ = uniqueIndex( i + 1 );
+				}
+			}
+		}
+
+	private :
+
+		int uniqueIndex( int faceVertex ) const
+		{
+			return m_uniqueOffsets[m_vertexIds[faceVertex]] + m_localIndices[faceVertex];
+		}
+
+		const std::vector<int> &m_vertexIds;
+		const std::vector<int> &m_faceOffsets;
+		const std::vector<int> &m_triangleOffsets;
+		const std::vector<int> &m_localIndices;
+		const std::vector<int> &m_uniqueOffsets;
+		std::vector<int> &m_indices;
+
+};
+
+template<typename Container>
+class Gather
+{
+
+	public :
+
+		Gather( const Container &data, const std::vector<int> &indices, Container &result )
+			:	m_data( data ), m_indices( indices ), m_result( result )
+		{
+		}
+
+		void operator()( const tbb::blocked_range<size_t> &r ) const
+		{
+			for( size_t i = r.begin(); i != r.end(); ++i )
+			{
+				m_result[i] = m_data[m_indices[i]];
+			}
+		}
+
+	private :
+
+		const Container &m_data;
+		const std::vector<int> &m_indices;
+		Container &m_result;
+
+};
+
+/// A functor for use with despatchTypedData, which returns new data holding the
+/// elements specified by an array of indices.
+struct PrimitiveVariableGatherer
+{
+	typedef IECore::DataPtr ReturnType;
+
+	PrimitiveVariableGatherer( const std::vector<int> &indices )
+		:	m_indices( indices )
+	{
+	}
+
+	template<typename T>
+	ReturnType operator()( T *data )
+	{
+		typedef typename T::ValueType Container;
+		typename T::Ptr result = new T;
+		Container &resultWritable = result->writable();
+		resultWritable.resize( m_indices.size() );
+
+		Gather<Container> gather( data->readable(), m_indices, resultWritable );
+		tbb::blocked_range<size_t> range( 0, m_indices.size(), 1000 );
+		if( boost::is_same<Container, std::vector<bool> >::value )
+		{
+			// neighbouring elements of a vector<bool> can't be written concurrently
+			gather( range );
+		}
+		else
+		{
+			tbb::parallel_for( range, gather );
+		}
+
+		return result;
+	}
+
+	const std::vector<int> &m_indices;
+};
+
+/// Welds the face-vertices of the mesh into unique vertices, returning an indexed MeshPrimitive
+/// and filling weldedVariables with the primitive variables to add to it, of Vertex interpolation
+/// in place of Vertex, Varying and FaceVarying. The primitive variables are taken from variables
+/// rather than the mesh, so that the caller can add to them without modifying the mesh.
+MeshPrimitivePtr weldedMesh( const IECore::MeshPrimitive *mesh, const IECore::PrimitiveVariableMap &variables, IECore::PrimitiveVariableMap &weldedVariables )
+{
+	IECore::ConstMeshAdjacencyPtr adjacency = mesh->adjacency();
+	const std::vector<int> &vertexIds = mesh->vertexIds()->readable();
+	const std::vector<int> &faceOffsets = adjacency->faceOffsets();
+	const size_t numVertices = adjacency->numVertices();
+	const size_t numFaces = adjacency->numFaces();
+
+	// find the primitive variables which need welding, and those which need gathering
+
+	Comparators comparators;
+	for( IECore::PrimitiveVariableMap::const_iterator it = variables.begin(); it != variables.end(); ++it )
+	{
+		const IECore::PrimitiveVariable &primVar = it->second;
+		if(
+			!primVar.data ||
+			primVar.interpolation == IECore::PrimitiveVariable::Constant ||
+			primVar.interpolation == IECore::PrimitiveVariable::Uniform
+		)
+		{
+			weldedVariables.insert( *it );
+			continue;
+		}
+
+		if( !mesh->isPrimitiveVariableValid( primVar ) )
+		{
+			IECore::msg( IECore::Msg::Warning, "ToGLMeshConverter", boost::format( "Ignoring invalid primitive variable \"%s\"" ) % it->first );
+			continue;
+		}
+
+		if( primVar.interpolation == IECore::PrimitiveVariable::FaceVarying )
+		{
+			comparators.push_back(
+				IECore::despatchTypedData<ComparatorCreator, IECore::TypeTraits::IsVectorTypedData>( primVar.data )
+			);
+		}
+	}
+
+	// weld the face-vertices of each vertex
+
+	std::vector<int> localIndices( vertexIds.size() );
+	std::vector<int> representatives( vertexIds.size() );
+	std::vector<int> numUnique( numVertices );
+	WeldVertices weldVertices( *adjacency, comparators, localIndices, representatives, numUnique );
+	tbb::parallel_for( tbb::blocked_range<size_t>( 0, numVertices, 1000 ), weldVertices );
+
+	std::vector<int> uniqueOffsets( numVertices + 1 );
+	uniqueOffsets[0] = 0;
+	for( size_t v = 0; v < numVertices; ++v )
+	{
+		uniqueOffsets[v+1] = uniqueOffsets[v] + numUnique[v];
+	}
+	const size_t numUniqueVertices = uniqueOffsets.back();
+
+	std::vector<int> vertexSources( numUniqueVertices );
+	std::vector<int> faceVertexSources( numUniqueVertices );
+	UniqueVertexSources uniqueVertexSources( *adjacency, representatives, uniqueOffsets, vertexSources, faceVertexSources );
+	tbb::parallel_for( tbb::blocked_range<size_t>( 0, numVertices, 1000 ), uniqueVertexSources );
+
+	// triangulate
+
+	std::vector<int> triangleOffsets( numFaces + 1 );
+	triangleOffsets[0] = 0;
+	for( size_t f = 0; f < numFaces; ++f )
+	{
+		triangleOffsets[f+1] = triangleOffsets[f] + std::max( faceOffsets[f+1] - faceOffsets[f] - 2, 0 );
+	}
+
+	IECore::IntVectorDataPtr indicesData = new IECore::IntVectorData;
+	std::vector<int> &indices = indicesData->writable();
+	indices.resize( triangleOffsets.back() * 3 );
+	if( indices.size() )
+	{
+		TriangulateIndices triangulateIndices( vertexIds, faceOffsets, triangleOffsets, localIndices, uniqueOffsets, indices );
+		tbb::parallel_for( tbb::blocked_range<size_t>( 0, numFaces, 1000 ), triangulateIndices );
+	}
+
+	// gather the primitive variables for the unique vertices
+
+	PrimitiveVariableGatherer vertexGatherer( vertexSources );
+	PrimitiveVariableGatherer faceVertexGatherer( faceVertexSources );
+	for( IECore::PrimitiveVariableMap::const_iterator it = variables.begin(); it != variables.end(); ++it )
+	{
+		const IECore::PrimitiveVariable &primVar = it->second;
+		if( weldedVariables.find( it->first ) != weldedVariables.end() || !mesh->isPrimitiveVariableValid( primVar ) )
+		{
+			continue;
+		}
+
+		PrimitiveVariableGatherer &gatherer = primVar.interpolation == IECore::PrimitiveVariable::FaceVarying ? faceVertexGatherer : vertexGatherer;
+		weldedVariables[it->first] = IECore::PrimitiveVariable(
+			IECore::PrimitiveVariable::Vertex,
+			IECore::despatchTypedData<PrimitiveVariableGatherer, IECore::TypeTraits::IsVectorTypedData>( primVar.data, gatherer )
+		);
+	}
+
+	return new MeshPrimitive( indicesData, numUniqueVertices );
+}
+
+} // namespace
+
+//////////////////////////////////////////////////////////////////////////
+// ToGLMeshConverter
+//////////////////////////////////////////////////////////////////////////
+
 IE_CORE_DEFINERUNTIMETYPED( ToGLMeshConverter );
 
 ToGLConverter::ConverterDescription<ToGLMeshConverter> ToGLMeshConverter::g_description;
@@ -55,15 +445,37 @@ ToGLMeshConverter::ToGLMeshConverter( IECore::ConstMeshPrimitivePtr toConvert )
 	:	ToGLConverter( "Converts IECore::MeshPrimitive objects to IECoreGL::MeshPrimitive objects.", IECore::MeshPrimitiveTypeId )
 {
 	srcParameter()->setValue( IECore::constPointerCast<IECore::MeshPrimitive>( toConvert ) );
+
+	m_indexedParameter = new IECore::BoolParameter(
+		"indexed",
+		"When on, face-varying primitive variables are welded into unique vertices, and the "
+		"mesh is drawn by indexing into them. When off, all primitive variables are expanded "
+		"to face-varying, which uses considerably more memory.",
+		true
+	);
+
+	parameters()->addParameter( m_indexedParameter );
 }
 
 ToGLMeshConverter::~ToGLMeshConverter()
 {
 }
 
+IECore::BoolParameter *ToGLMeshConverter::indexedParameter()
+{
+	return m_indexedParameter;
+}
+
+const IECore::BoolParameter *ToGLMeshConverter::indexedParameter() const
+{
+	return m_indexedParameter;
+}
+
 IECore::RunTimeTypedPtr ToGLMeshConverter::doConversion( IECore::ConstObjectPtr src, IECore::ConstCompoundObjectPtr operands ) const
 {
-	IECore::MeshPrimitivePtr mesh = IECore::staticPointerCast<IECore::MeshPrimitive>( src->copy() ); // safe because the parameter validated it for us
+	// safe because the parameter validated it for us. we don't modify the mesh, so that
+	// conversions can run concurrently with other users of it, without having to copy it.
+	IECore::ConstMeshPrimitivePtr mesh = IECore::staticPointerCast<const IECore::MeshPrimitive>( src );
 
 	if( mesh->interpolation() != "linear" )
 	{
@@ -73,18 +485,26 @@ IECore::RunTimeTypedPtr ToGLMeshConverter::doConversion( IECore::ConstObjectPtr
 		if( mesh->variables.find( "N" )==mesh->variables.end() )
 		{
 			IECore::MeshNormalsOpPtr normalOp = new IECore::MeshNormalsOp();
-			normalOp->inputParameter()->setValue( mesh );
-			normalOp->copyParameter()->setTypedValue( false );
-			normalOp->operate();
+			normalOp->inputParameter()->setValue( IECore::constPointerCast<IECore::MeshPrimitive>( mesh ) );
+			normalOp->copyParameter()->setTypedValue( true );
+			mesh = IECore::runTimeCast<IECore::MeshPrimitive>( normalOp->operate() );
+			assert( mesh );
 		}
 	}
-		
-	IECore::TriangulateOpPtr op = new IECore::TriangulateOp();
-	op->inputParameter()->setValue( mesh );
-	op->throwExceptionsParameter()->setTypedValue( false ); // it's better to see something than nothing
 
-	mesh = IECore::runTimeCast< IECore::MeshPrimitive > ( op->operate() );
-	assert( mesh );
+	const bool indexed = operands->member<IECore::BoolData>( "indexed" )->readable();
+	if( !indexed )
+	{
+		IECore::TriangulateOpPtr op = new IECore::TriangulateOp();
+		op->inputParameter()->setValue( IECore::constPointerCast<IECore::MeshPrimitive>( mesh ) );
+		op->copyParameter()->setTypedValue( true );
+		op->throwExceptionsParameter()->setTypedValue( false ); // it's better to see something than nothing
+
+		mesh = IECore::runTimeCast< IECore::MeshPrimitive > ( op->operate() );
+		assert( mesh );
+	}
+
+	IECore::PrimitiveVariableMap variables = mesh->variables;
 
 	IECore::ConstV3fVectorDataPtr p = 0;
 	IECore::PrimitiveVariableMap::const_iterator pIt = mesh->variables.find( "P" );
@@ -100,20 +520,6 @@ IECore::RunTimeTypedPtr ToGLMeshConverter::doConversion( IECore::ConstObjectPtr
 		throw IECore::Exception( "Must specify primitive variable \"P\", of type V3fVectorData and interpolation type Vertex." );
 	}
 
-	MeshPrimitivePtr glMesh = new MeshPrimitive( mesh->vertexIds() );
-
-	for ( IECore::PrimitiveVariableMap::iterator pIt = mesh->variables.begin(); pIt != mesh->variables.end(); ++pIt )
-	{
-		if ( pIt->second.data )
-		{
-			glMesh->addPrimitiveVariable( pIt->first, pIt->second );
-		}
-		else
-		{
-			IECore::msg( IECore::Msg::Warning, "ToGLMeshConverter", boost::format( "No data given for primvar \"%s\"" ) % pIt->first );
-		}
-	}
-
 	IECore::PrimitiveVariableMap::const_iterator sIt = mesh->variables.find( "s" );
 	IECore::PrimitiveVariableMap::const_iterator tIt = mesh->variables.find( "t" );
 	if ( sIt != mesh->variables.end() && tIt != mesh->variables.end() )
@@ -137,7 +543,7 @@ IECore::RunTimeTypedPtr ToGLMeshConverter::doConversion( IECore::ConstObjectPtr
 				{
 					stData->writable()[i] = Imath::V2f( s->readable()[i], t->readable()[i] );
 				}
-				glMesh->addPrimitiveVariable( "st", IECore::PrimitiveVariable( sIt->second.interpolation, stData ) );
+				variables["st"] = IECore::PrimitiveVariable( sIt->second.interpolation, stData );
 			}
 			else
 			{
@@ -154,5 +560,29 @@ IECore::RunTimeTypedPtr ToGLMeshConverter::doConversion( IECore::ConstObjectPtr
 		IECore::msg( IECore::Msg::Warning, "ToGLMeshConverter", "Primitive variable \"s\" or \"t\" found, but not both." );
 	}
 
+	MeshPrimitivePtr glMesh;
+	if( indexed )
+	{
+		IECore::PrimitiveVariableMap weldedVariables;
+		glMesh = weldedMesh( mesh.get(), variables, weldedVariables );
+		variables.swap( weldedVariables );
+	}
+	else
+	{
+		glMesh = new MeshPrimitive( mesh->vertexIds() );
+	}
+
+	for ( IECore::PrimitiveVariableMap::iterator pIt = variables.begin(); pIt != variables.end(); ++pIt )
+	{
+		if ( pIt->second.data )
+		{
+			glMesh->addPrimitiveVariable( pIt->first, pIt->second );
+		}
+		else
+		{
+			IECore::msg( IECore::Msg::Warning, "ToGLMeshConverter", boost::format( "No data given for primvar \"%s\"" ) % pIt->first );
+		}
+	}
+
 	return glMesh;
 }
@@ -50,11 +50,33 @@ static IECore::RunTimeTypedPtr convert( CachedConverter &c, IECore::ObjectPtr o
 	return IECore::constPointerCast<IECore::RunTimeTyped>( c.convert( o.get() ) );
 }
 
+static void prefetch( CachedConverter &c, object objects )
+{
+	std::vector<IECore::ConstObjectPtr> o;
+	const size_t size = len( objects );
+	o.reserve( size );
+	for( size_t i = 0; i < size; ++i )
+	{
+		o.push_back( extract<IECore::ObjectPtr>( objects[i] )() );
+	}
+
+	IECorePython::ScopedGILRelease gilRelease;
+	c.prefetch( o );
+}
+
+static void waitForPrefetches( CachedConverter &c )
+{
+	IECorePython::ScopedGILRelease gilRelease;
+	c.waitForPrefetches();
+}
+
 void IECoreGL::bindCachedConverter()
 {
 	IECorePython::RefCountedClass<CachedConverter, IECore::RefCounted>( "CachedConverter" )
 		.def( init<size_t>() )
 		.def( "convert", &convert )
+		.def( "prefetch", &prefetch )
+		.def( "waitForPrefetches", &waitForPrefetches )
 		.def( "getMaxMemory", &CachedConverter::getMaxMemory )
 		.def( "setMaxMemory", &CachedConverter::setMaxMemory )
 		.def( "clearUnused", &CachedConverter::clearUnused )
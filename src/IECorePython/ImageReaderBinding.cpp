@@ -37,6 +37,7 @@
 #include "IECore/ImageReader.h"
 #include "IECore/VectorTypedData.h"
 #include "IECorePython/RunTimeTypedBinding.h"
+#include "IECorePython/ScopedGILRelease.h"
 
 using std::string;
 using namespace boost;
@@ -46,22 +47,35 @@ using namespace IECore;
 namespace IECorePython
 {
 
+static bool isComplete( ImageReader &that )
+{
+	ScopedGILRelease gilRelease;
+	return that.isComplete();
+}
+
 static StringVectorDataPtr channelNames( ImageReader &that )
 {
+	ScopedGILRelease gilRelease;
 	StringVectorDataPtr result( new StringVectorData );
 	that.channelNames( result->writable() );
 	return result;
 }
 
+static DataPtr readChannel( ImageReader &that, const std::string &name, bool raw )
+{
+	ScopedGILRelease gilRelease;
+	return that.readChannel( name, raw );
+}
+
 void bindImageReader()
 {
 
 	RunTimeTypedClass<ImageReader>()
-		.def( "isComplete", &ImageReader::isComplete )
+		.def( "isComplete", &isComplete )
 		.def( "channelNames", &channelNames )
 		.def( "dataWindow", &ImageReader::dataWindow )
 		.def( "displayWindow", &ImageReader::displayWindow )
-		.def( "readChannel", (DataPtr (ImageReader::*)( const std::string &, bool ))&ImageReader::readChannel, ( arg_("name"), arg_( "raw" ) = false ) )
+		.def( "readChannel", &readChannel, ( arg_("name"), arg_( "raw" ) = false ) )
 		.def( "sourceColorSpace", &ImageReader::sourceColorSpace )
 	;
 
@@ -47,9 +47,11 @@
 
 #include "IECorePython/RunTimeTypedBinding.h"
 #include "IECorePython/IECoreBinding.h"
+#include "IECorePython/ScopedGILRelease.h"
 
 using namespace boost::python;
 using namespace IECore;
+using IECorePython::ScopedGILRelease;
 
 void bindIndexedIOBase();
 void bindStreamIndexedIO();
@@ -93,6 +95,7 @@ struct IndexedIOHelper
 	template< typename T, typename P >
 	static typename T::Ptr constructorAtRoot( P firstParam, IndexedIO::OpenMode mode )
 	{
+		ScopedGILRelease gilRelease;
 		return new T( firstParam, IndexedIO::rootPath, mode );
 	}
 
@@ -101,11 +104,13 @@ struct IndexedIOHelper
 	{
 		IndexedIO::EntryIDList rootPath;
 		IndexedIOHelper::listToEntryIds( root, rootPath );
+		ScopedGILRelease gilRelease;
 		return new T( firstParam, rootPath, mode );
 	}
 
 	static IndexedIOPtr createAtRoot( const std::string &path, IndexedIO::OpenMode mode)
 	{
+		ScopedGILRelease gilRelease;
 		return IndexedIO::create( path, IndexedIO::rootPath, mode );
 	}
 
@@ -113,6 +118,7 @@ struct IndexedIOHelper
 	{
 		IndexedIO::EntryIDList rootPath;
 		IndexedIOHelper::listToEntryIds( root, rootPath );
+		ScopedGILRelease gilRelease;
 		return IndexedIO::create( path, rootPath, mode );
 	}
 
@@ -127,14 +133,24 @@ struct IndexedIOHelper
 	{
 		IndexedIO::EntryIDList path;
 		IndexedIOHelper::listToEntryIds( l, path );
+		ScopedGILRelease gilRelease;
 		return p->directory(path, missingBehaviour);
 	}
 
+	static IndexedIOPtr subdirectory(IndexedIOPtr p, const IndexedIO::EntryID &name, IndexedIO::MissingBehaviour missingBehaviour )
+	{
+		ScopedGILRelease gilRelease;
+		return p->subdirectory(name, missingBehaviour);
+	}
+
 	static list entryIds(IndexedIOPtr p)
 	{
 		assert(p);
 		IndexedIO::EntryIDList l;
-		p->entryIds(l);
+		{
+			ScopedGILRelease gilRelease;
+			p->entryIds(l);
+		}
 		return IndexedIOHelper::entryIDsToList( l );
 	}
 
@@ -142,7 +158,10 @@ struct IndexedIOHelper
 	{
 		assert(p);
 		IndexedIO::EntryIDList l;
-		p->entryIds(l, type);
+		{
+			ScopedGILRelease gilRelease;
+			p->entryIds(l, type);
+		}
 		return IndexedIOHelper::entryIDsToList( l );
 	}
 	
@@ -165,6 +184,7 @@ struct IndexedIOHelper
 	{
 		assert(p);
 
+		ScopedGILRelease gilRelease;
 		const typename T::value_type *data = &(x->readable())[0];
 		p->write( name, data, (unsigned long)x->readable().size() );
 	}
@@ -172,6 +192,7 @@ struct IndexedIOHelper
 	template<typename T>
 	static typename TypedData<T>::Ptr readSingle(IndexedIOPtr p, const IndexedIO::EntryID &name, const IndexedIO::Entry &entry)
 	{
+		ScopedGILRelease gilRelease;
 		T data;
 		p->read(name, data);
 		return new TypedData<T>( data );
@@ -180,6 +201,7 @@ struct IndexedIOHelper
 	template<typename T>
 	static typename TypedData< std::vector<T> >::Ptr readArray(IndexedIOPtr p, const IndexedIO::EntryID &name, const IndexedIO::Entry &entry)
 	{
+		ScopedGILRelease gilRelease;
 		unsigned long count = entry.arrayLength();
 		typename TypedData<std::vector<T> >::Ptr x = new TypedData<std::vector<T> > ();
 		x->writable().resize( entry.arrayLength() );
@@ -278,7 +300,6 @@ struct IndexedIOHelper
 void bindIndexedIOBase()
 {
 	IndexedIOPtr (IndexedIO::*nonConstParentDirectory)() = &IndexedIO::parentDirectory;
-	IndexedIOPtr (IndexedIO::*nonConstSubdirectory)(const IndexedIO::EntryID &, IndexedIO::MissingBehaviour) = &IndexedIO::subdirectory;
 	void (IndexedIO::*writeFloat)(const IndexedIO::EntryID &, const float &) = &IndexedIO::write;
 	void (IndexedIO::*writeDouble)(const IndexedIO::EntryID &, const double &) = &IndexedIO::write;
 	void (IndexedIO::*writeInt)(const IndexedIO::EntryID &, const int &) = &IndexedIO::write;
@@ -305,6 +326,8 @@ void bindIndexedIOBase()
 			.value("Append", IndexedIO::Append)
 			.value("Shared", IndexedIO::Shared)
 			.value("Exclusive", IndexedIO::Exclusive)
+			.value("MemoryMapped", IndexedIO::MemoryMapped)
+			.value("CompressedData", IndexedIO::CompressedData)
 			.export_values()
 		;
 
@@ -370,7 +393,7 @@ void bindIndexedIOBase()
 	indexedIOClass.def("openMode", &IndexedIO::openMode)
 		.def("parentDirectory", nonConstParentDirectory)
 		.def("directory",  &IndexedIOHelper::directory, ( arg( "path" ), arg( "missingBehaviour" ) = IndexedIO::ThrowIfMissing ) )
-		.def("subdirectory", nonConstSubdirectory, ( arg( "name" ), arg( "missingBehaviour" ) = IndexedIO::ThrowIfMissing ) )
+		.def("subdirectory", &IndexedIOHelper::subdirectory, ( arg( "name" ), arg( "missingBehaviour" ) = IndexedIO::ThrowIfMissing ) )
 		.def("createSubdirectory", &IndexedIO::createSubdirectory )
 		.def("path", &IndexedIOHelper::path)
 		.def("remove", &IndexedIO::remove)
@@ -407,7 +430,16 @@ void bindIndexedIOBase()
 
 void bindStreamIndexedIO()
 {
-	IECorePython::RunTimeTypedClass<StreamIndexedIO>();
+	scope streamIndexedIOScope = IECorePython::RunTimeTypedClass<StreamIndexedIO>()
+		.def( "deduplicationStatistics", &StreamIndexedIO::deduplicationStatistics )
+	;
+
+	class_<StreamIndexedIO::DeduplicationStatistics>( "DeduplicationStatistics" )
+		.def_readonly( "writes", &StreamIndexedIO::DeduplicationStatistics::writes )
+		.def_readonly( "hits", &StreamIndexedIO::DeduplicationStatistics::hits )
+		.def_readonly( "precomputedHashHits", &StreamIndexedIO::DeduplicationStatistics::precomputedHashHits )
+		.def_readonly( "bytesSaved", &StreamIndexedIO::DeduplicationStatistics::bytesSaved )
+	;
 }
 
 void bindFileIndexedIO()
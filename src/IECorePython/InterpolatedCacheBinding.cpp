@@ -154,6 +154,12 @@ struct InterpolatedCacheHelper
 		return cache->contains( frame, obj, attr );
 	}
 
+	static void waitForPrefetches( InterpolatedCachePtr cache )
+	{
+		ScopedGILRelease gilRelease;
+		cache->waitForPrefetches();
+	}
+
 };
 
 void bindInterpolatedCache()
@@ -172,13 +178,14 @@ void bindInterpolatedCache()
 	}
 	interpolatedCacheClass
 		.def(
-			init<const std::string &, InterpolatedCache::Interpolation, const OversamplesCalculator &, size_t>
+			init<const std::string &, InterpolatedCache::Interpolation, const OversamplesCalculator &, size_t, size_t>
 			(
 				(
 					arg( "pathTemplate" ) = std::string(""),
 					arg( "interpolation" ) = InterpolatedCache::None,
 					arg( "oversamplesCalculator" ) = OversamplesCalculator(),
-					arg( "maxOpenFiles" ) = 10
+					arg( "maxOpenFiles" ) = 10,
+					arg( "maxMemory" ) = 500 * 1024 * 1024
 				)
 			)
 		)
@@ -186,6 +193,9 @@ void bindInterpolatedCache()
 		.def("getPathTemplate", &InterpolatedCache::getPathTemplate, return_value_policy<copy_const_reference>() )
 		.def("setMaxOpenFiles", &InterpolatedCache::setMaxOpenFiles )
 		.def("getMaxOpenFiles", &InterpolatedCache::getMaxOpenFiles )
+		.def("setMaxMemory", &InterpolatedCache::setMaxMemory )
+		.def("getMaxMemory", &InterpolatedCache::getMaxMemory )
+		.def("memoryUsage", &InterpolatedCache::memoryUsage )
 		.def("setInterpolation", &InterpolatedCache::setInterpolation )
 		.def("getInterpolation", &InterpolatedCache::getInterpolation )
 		.def("setOversamplesCalculator", &InterpolatedCache::setOversamplesCalculator )
@@ -196,6 +206,8 @@ void bindInterpolatedCache()
 		.def("readHeader", &InterpolatedCacheHelper::readHeader2 )
 		.def("contains", &InterpolatedCacheHelper::contains )
 		.def("contains", &InterpolatedCacheHelper::contains2 )
+		.def("prefetch", &InterpolatedCache::prefetch, ( boost::python::arg_( "frame" ), boost::python::arg_( "step" ) = 1.0f, boost::python::arg_( "numFrames" ) = 1 ) )
+		.def("waitForPrefetches", &InterpolatedCacheHelper::waitForPrefetches )
 		.def("objects", &InterpolatedCacheHelper::objects)
 		.def("headers", &InterpolatedCacheHelper::headers)
 		.def("attributes", make_function( &InterpolatedCacheHelper::attributes  , default_call_policies(), ( boost::python::arg_( "obj" ), boost::python::arg_( "regex" ) = object() ) ) )
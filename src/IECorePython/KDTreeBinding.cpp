@@ -46,6 +46,7 @@
 #include "IECore/VectorTypedData.h"
 
 #include "IECorePython/KDTreeBinding.h"
+#include "IECorePython/ScopedGILRelease.h"
 
 using namespace boost::python;
 using namespace IECore;
@@ -77,6 +78,7 @@ struct KDTreeWrapper
 
 	KDTreeWrapper(PointDataPtr points)
 	{
+		ScopedGILRelease gilRelease;
 		m_points = points->copy();
 		m_tree = new T(m_points->readable().begin(), m_points->readable().end());
 	}
@@ -91,6 +93,7 @@ struct KDTreeWrapper
 	{
 		assert(m_tree);
 
+		ScopedGILRelease gilRelease;
 		typename T::Iterator it = m_tree->nearestNeighbour(p);
 
 		return std::distance( m_points->readable().begin(), it );
@@ -100,6 +103,8 @@ struct KDTreeWrapper
 	{
 		assert(m_tree);
 
+		ScopedGILRelease gilRelease;
+
 		typedef std::vector<typename T::Iterator> PointArray;
 
 		PointArray points;
@@ -123,6 +128,8 @@ struct KDTreeWrapper
 	{
 		assert(m_tree);
 
+		ScopedGILRelease gilRelease;
+
 		typedef std::vector<typename T::Neighbour> NeighbourArray;
 
 		NeighbourArray points;
@@ -144,6 +151,8 @@ struct KDTreeWrapper
 	
 	IntVectorDataPtr enclosedPoints( const Box &bound )
 	{
+		ScopedGILRelease gilRelease;
+
 		typedef std::vector<typename T::Iterator> PointArray;
 
 		PointArray points;
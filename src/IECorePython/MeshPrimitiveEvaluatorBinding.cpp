@@ -38,6 +38,7 @@
 #include "IECorePython/MeshPrimitiveEvaluatorBinding.h"
 #include "IECorePython/RunTimeTypedBinding.h"
 #include "IECorePython/RefCountedBinding.h"
+#include "IECorePython/ScopedGILRelease.h"
 
 using namespace IECore;
 using namespace boost::python;
@@ -46,23 +47,32 @@ using namespace IECore;
 namespace IECorePython
 {
 
+static MeshPrimitiveEvaluatorPtr constructor( MeshPrimitivePtr mesh, MeshPrimitiveEvaluator::RayAccelerator rayAccelerator )
+{
+	ScopedGILRelease gilRelease;
+	return new MeshPrimitiveEvaluator( mesh, rayAccelerator );
+}
+
 static bool barycentricPosition( const MeshPrimitiveEvaluator &e, unsigned int t, const Imath::V3f &b, PrimitiveEvaluator::Result *r )
 {
+	ScopedGILRelease gilRelease;
 	e.validateResult( r );
 	return e.barycentricPosition( t, b, r );
 }
 
 void bindMeshPrimitiveEvaluator()
 {
-	object m = RunTimeTypedClass<MeshPrimitiveEvaluator>()
-		.def( init< MeshPrimitivePtr > () )
-		.def( "barycentricPosition", &barycentricPosition )
-		.def( "uvBound", &MeshPrimitiveEvaluator::uvBound )	
-	;
+	RunTimeTypedClass<MeshPrimitiveEvaluator> m;
 
 	{
 		scope ms( m );
 
+		// bound before the constructor, which uses it for a default argument
+		enum_<MeshPrimitiveEvaluator::RayAccelerator>( "RayAccelerator" )
+			.value( "KDTree", MeshPrimitiveEvaluator::KDTreeRayAccelerator )
+			.value( "BVH", MeshPrimitiveEvaluator::BVHRayAccelerator )
+		;
+
 		RefCountedClass<MeshPrimitiveEvaluator::Result, PrimitiveEvaluator::Result>( "Result" )
 			.def( "triangleIndex", &MeshPrimitiveEvaluator::Result::triangleIndex )
 			.def( "barycentricCoordinates", &MeshPrimitiveEvaluator::Result::barycentricCoordinates, return_value_policy<copy_const_reference>() )
@@ -70,6 +80,12 @@ void bindMeshPrimitiveEvaluator()
 		;
 
 	}
+
+	m
+		.def( "__init__", make_constructor( &constructor, default_call_policies(), ( boost::python::arg_( "mesh" ), boost::python::arg_( "rayAccelerator" ) = MeshPrimitiveEvaluator::KDTreeRayAccelerator ) ) )
+		.def( "barycentricPosition", &barycentricPosition )
+		.def( "uvBound", &MeshPrimitiveEvaluator::uvBound )	
+	;
 }
 
 }
@@ -71,6 +71,7 @@ void bindModifyOp()
 {
 	RunTimeTypedClass<ModifyOp, ModifyOpWrapPtr>()
 		.def( init< const std::string &, ParameterPtr, ParameterPtr >() )
+		.def( "bytesDuplicated", &ModifyOp::bytesDuplicated )
 	;
 }
 
@@ -40,6 +40,8 @@
 #include "IECore/MurmurHash.h"
 #include "IECorePython/ObjectBinding.h"
 #include "IECorePython/RunTimeTypedBinding.h"
+#include "IECorePython/ScopedGILLock.h"
+#include "IECorePython/ScopedGILRelease.h"
 
 using namespace boost::python;
 using namespace IECore;
@@ -52,6 +54,8 @@ static ObjectPtr creator( void *data )
 	assert( data );
 	PyObject *d = (PyObject *)(data );
 
+	// we may be called from load() or copy() with the GIL released
+	ScopedGILLock gilLock;
 	ObjectPtr r = call< ObjectPtr >( d );
 	return r;
 }
@@ -68,13 +72,43 @@ static void registerAbstractType( TypeId typeId, const std::string &typeName )
 	Object::registerType( typeId, typeName, 0, (void*)0 );
 }
 
+static ObjectPtr copy( const Object &o )
+{
+	ScopedGILRelease gilRelease;
+	return o.copy();
+}
+
+static ObjectPtr load( ConstIndexedIOPtr ioInterface, const IndexedIO::EntryID &name )
+{
+	ScopedGILRelease gilRelease;
+	return Object::load( ioInterface, name );
+}
+
+static void save( const Object &o, IndexedIOPtr ioInterface, const IndexedIO::EntryID &name )
+{
+	ScopedGILRelease gilRelease;
+	o.save( ioInterface, name );
+}
+
+static MurmurHash hash( const Object &o )
+{
+	ScopedGILRelease gilRelease;
+	return o.hash();
+}
+
+static void hash2( const Object &o, MurmurHash &h )
+{
+	ScopedGILRelease gilRelease;
+	o.hash( h );
+}
+
 void bindObject()
 {
 
 	RunTimeTypedClass<Object>()
 		.def( self == self )
 		.def( self != self )
-		.def( "copy", &Object::copy )
+		.def( "copy", &copy )
 		.def( "copyFrom", (void (Object::*)( const Object * ) )&Object::copyFrom )
 		.def( "isType", (bool (*)( const std::string &) )&Object::isType )
 		.def( "isType", (bool (*)( TypeId) )&Object::isType )
@@ -85,12 +119,12 @@ void bindObject()
 		.def( "create", (ObjectPtr (*)( const std::string &) )&Object::create )
 		.def( "create", (ObjectPtr (*)( TypeId ) )&Object::create )
 		.staticmethod( "create" )
-		.def( "load", (ObjectPtr (*)( ConstIndexedIOPtr, const IndexedIO::EntryID & ) )&Object::load )
+		.def( "load", &load )
 		.staticmethod( "load" )
-		.def( "save", (void (Object::*)( IndexedIOPtr, const IndexedIO::EntryID & )const )&Object::save )
+		.def( "save", &save )
 		.def( "memoryUsage", (size_t (Object::*)()const )&Object::memoryUsage, "Returns the number of bytes this instance occupies in memory" )
-		.def( "hash", (MurmurHash (Object::*)() const)&Object::hash )
-		.def( "hash", (void (Object::*)( MurmurHash & ) const)&Object::hash )
+		.def( "hash", &hash )
+		.def( "hash", &hash2 )
 		.def( "registerType", registerType )
 		.def( "registerType", registerAbstractType )
 		.staticmethod( "registerType" )
@@ -37,6 +37,7 @@
 #include "IECore/ParticleReader.h"
 #include "IECore/VectorTypedData.h"
 #include "IECorePython/RunTimeTypedBinding.h"
+#include "IECorePython/ScopedGILRelease.h"
 
 using std::string;
 using namespace boost;
@@ -53,12 +54,18 @@ static StringVectorDataPtr attributeNames( ParticleReader &that )
 	return result;
 }
 
+static DataPtr readAttribute( ParticleReader &that, const std::string &name )
+{
+	ScopedGILRelease gilRelease;
+	return that.readAttribute( name );
+}
+
 void bindParticleReader()
 {
 	RunTimeTypedClass<ParticleReader>()
 		.def( "numParticles", &ParticleReader::numParticles )
 		.def( "attributeNames", &attributeNames )
-		.def( "readAttribute", &ParticleReader::readAttribute )
+		.def( "readAttribute", &readAttribute )
 	;
 }
 
@@ -37,6 +37,7 @@
 #include "IECore/PrimitiveEvaluator.h"
 #include "IECorePython/PrimitiveEvaluatorBinding.h"
 #include "IECorePython/RunTimeTypedBinding.h"
+#include "IECorePython/ScopedGILRelease.h"
 
 using namespace IECore;
 using namespace boost::python;
@@ -54,11 +55,13 @@ struct PrimitiveEvaluatorHelper
 			PyErr_SetString( PyExc_ValueError, "Null primitive" );
 			throw_error_already_set();
 		}
+		ScopedGILRelease gilRelease;
 		return PrimitiveEvaluator::create( primitive );
 	}
 
 	static float signedDistance( PrimitiveEvaluator &evaluator, const Imath::V3f &p )
 	{
+		ScopedGILRelease gilRelease;
 
 		float distance = 0.0;
 		bool success = evaluator.signedDistance( p, distance );
@@ -72,6 +75,7 @@ struct PrimitiveEvaluatorHelper
 
 	static bool closestPoint( PrimitiveEvaluator &evaluator, const Imath::V3f &p, PrimitiveEvaluator::Result *result )
 	{
+		ScopedGILRelease gilRelease;
 		evaluator.validateResult( result );
 
 		return evaluator.closestPoint( p, result );
@@ -79,6 +83,7 @@ struct PrimitiveEvaluatorHelper
 
 	static bool pointAtUV( PrimitiveEvaluator &evaluator, const Imath::V2f &uv, PrimitiveEvaluator::Result *result )
 	{
+		ScopedGILRelease gilRelease;
 		evaluator.validateResult( result );
 
 		return evaluator.pointAtUV( uv, result );
@@ -86,6 +91,7 @@ struct PrimitiveEvaluatorHelper
 
 	static bool intersectionPoint( PrimitiveEvaluator& evaluator, const Imath::V3f &origin, const Imath::V3f &direction, PrimitiveEvaluator::Result *result )
 	{
+		ScopedGILRelease gilRelease;
 		evaluator.validateResult( result );
 
 		return evaluator.intersectionPoint( origin, direction, result );
@@ -93,6 +99,7 @@ struct PrimitiveEvaluatorHelper
 
 	static bool intersectionPointMaxDist( PrimitiveEvaluator& evaluator, const Imath::V3f &origin, const Imath::V3f &direction, PrimitiveEvaluator::Result *result, float maxDist )
 	{
+		ScopedGILRelease gilRelease;
 		evaluator.validateResult( result );
 
 		return evaluator.intersectionPoint( origin, direction, result, maxDist );
@@ -101,7 +108,10 @@ struct PrimitiveEvaluatorHelper
 	static list intersectionPoints( PrimitiveEvaluator& evaluator, const Imath::V3f &origin, const Imath::V3f &direction )
 	{
 		std::vector< PrimitiveEvaluator::ResultPtr > results;
-		evaluator.intersectionPoints( origin, direction, results );
+		{
+			ScopedGILRelease gilRelease;
+			evaluator.intersectionPoints( origin, direction, results );
+		}
 
 		list result;
 
@@ -116,7 +126,10 @@ struct PrimitiveEvaluatorHelper
 	static list intersectionPoints( PrimitiveEvaluator& evaluator, const Imath::V3f &origin, const Imath::V3f &direction, float maxDistance )
 	{
 		std::vector< PrimitiveEvaluator::ResultPtr > results;
-		evaluator.intersectionPoints( origin, direction, results, maxDistance );
+		{
+			ScopedGILRelease gilRelease;
+			evaluator.intersectionPoints( origin, direction, results, maxDistance );
+		}
 
 		list result;
 
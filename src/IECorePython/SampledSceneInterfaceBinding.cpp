@@ -38,6 +38,7 @@
 
 #include "IECore/SampledSceneInterface.h"
 #include "IECorePython/RunTimeTypedBinding.h"
+#include "IECorePython/ScopedGILRelease.h"
 
 using namespace boost::python;
 using namespace IECore;
@@ -73,8 +74,15 @@ static tuple objectSampleInterval( const SampledSceneInterface &m, double time )
 	return make_tuple( x, floorIndex, ceilIndex );
 }
 
+static Imath::Box3d readBoundAtSample( const SampledSceneInterface &m, size_t sampleIndex )
+{
+	ScopedGILRelease gilRelease;
+	return m.readBoundAtSample( sampleIndex );
+}
+
 DataPtr readTransformAtSample( SampledSceneInterface &m, size_t sampleIndex )
 {
+	ScopedGILRelease gilRelease;
 	ConstDataPtr d = m.readTransformAtSample(sampleIndex);
 	if ( d )
 	{
@@ -83,8 +91,15 @@ DataPtr readTransformAtSample( SampledSceneInterface &m, size_t sampleIndex )
 	return 0;
 }
 
+static Imath::M44d readTransformAsMatrixAtSample( const SampledSceneInterface &m, size_t sampleIndex )
+{
+	ScopedGILRelease gilRelease;
+	return m.readTransformAsMatrixAtSample( sampleIndex );
+}
+
 ObjectPtr readAttributeAtSample( SampledSceneInterface &m, const SceneInterface::Name &name, size_t sampleIndex )
 {
+	ScopedGILRelease gilRelease;
 	ConstObjectPtr o = m.readAttributeAtSample(name,sampleIndex);
 	if ( o )
 	{
@@ -95,6 +110,7 @@ ObjectPtr readAttributeAtSample( SampledSceneInterface &m, const SceneInterface:
 
 ObjectPtr readObjectAtSample( SampledSceneInterface &m, size_t sampleIndex )
 {
+	ScopedGILRelease gilRelease;
 	ConstObjectPtr o = m.readObjectAtSample(sampleIndex);
 	if ( o )
 	{
@@ -114,9 +130,9 @@ void bindSampledSceneInterface()
 		.def( "transformSampleTime", &SampledSceneInterface::transformSampleTime )
 		.def( "attributeSampleTime", &SampledSceneInterface::attributeSampleTime )
 		.def( "objectSampleTime", &SampledSceneInterface::objectSampleTime )
-		.def( "readBoundAtSample", &SampledSceneInterface::readBoundAtSample )
+		.def( "readBoundAtSample", &readBoundAtSample )
 		.def( "readTransformAtSample", &readTransformAtSample )
-		.def( "readTransformAsMatrixAtSample", &SampledSceneInterface::readTransformAsMatrixAtSample )
+		.def( "readTransformAsMatrixAtSample", &readTransformAsMatrixAtSample )
 		.def( "readAttributeAtSample", &readAttributeAtSample )
 		.def( "readObjectAtSample", &readObjectAtSample )
 
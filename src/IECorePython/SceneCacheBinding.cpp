@@ -38,6 +38,7 @@
 
 #include "IECore/SceneCache.h"
 #include "IECorePython/RunTimeTypedBinding.h"
+#include "IECorePython/ScopedGILRelease.h"
 
 using namespace boost::python;
 using namespace IECore;
@@ -47,19 +48,49 @@ namespace IECorePython
 
 static SceneCachePtr constructor( const std::string &fileName, IndexedIO::OpenMode mode )
 {
+	ScopedGILRelease gilRelease;
 	return new SceneCache( fileName, mode );
 }
 
 static SceneCachePtr constructor2( IECore::IndexedIOPtr indexedIO )
 {
+	ScopedGILRelease gilRelease;
 	return new SceneCache( indexedIO );
 }
 
+static void setAsynchronousWrites( SceneCache &scene, bool enabled, size_t maxQueueMemory )
+{
+	// may wait for previously queued writes
+	ScopedGILRelease gilRelease;
+	scene.setAsynchronousWrites( enabled, maxQueueMemory );
+}
+
+static void flush( SceneCache &scene )
+{
+	ScopedGILRelease gilRelease;
+	scene.flush();
+}
+
 void bindSceneCache()
 {
-	RunTimeTypedClass<SceneCache>()
+	object sceneCacheClass = RunTimeTypedClass<SceneCache>()
 		.def( "__init__", make_constructor( &constructor ), "Opens a scene file for read or write." )
 		.def( "__init__", make_constructor( &constructor2 ), "Opens a scene from a previously opened file handle." )
+		.def( "setCacheMemoryLimit", &SceneCache::setCacheMemoryLimit ).staticmethod( "setCacheMemoryLimit" )
+		.def( "getCacheMemoryLimit", &SceneCache::getCacheMemoryLimit ).staticmethod( "getCacheMemoryLimit" )
+		.def( "cacheStatistics", &SceneCache::cacheStatistics )
+		.def( "setAsynchronousWrites", &setAsynchronousWrites, ( arg( "enabled" ), arg( "maxQueueMemory" ) = 512 * 1024 * 1024 ) )
+		.def( "getAsynchronousWrites", &SceneCache::getAsynchronousWrites )
+		.def( "flush", &flush )
+	;
+
+	scope s( sceneCacheClass );
+
+	enum_< SceneCache::CacheType > ("CacheType")
+		.value("Objects", SceneCache::Objects)
+		.value("Attributes", SceneCache::Attributes)
+		.value("Transforms", SceneCache::Transforms)
+		.export_values()
 	;
 }
 
@@ -36,8 +36,10 @@
 
 #include "IECore/SceneInterface.h"
 #include "IECore/SharedSceneInterfaces.h"
+#include "IECore/MurmurHash.h"
 #include "IECorePython/RunTimeTypedBinding.h"
 #include "IECorePython/IECoreBinding.h"
+#include "IECorePython/ScopedGILRelease.h"
 
 using namespace boost::python;
 using namespace IECore;
@@ -58,7 +60,10 @@ inline list arrayToList( std::vector<IndexedIO::EntryID> &ids )
 static list childNames( const SceneInterface &m )
 {
 	SceneInterface::NameList n;
-	m.childNames( n );
+	{
+		ScopedGILRelease gilRelease;
+		m.childNames( n );
+	}
 	return arrayToList( n );
 }
 
@@ -69,6 +74,21 @@ static list path( const SceneInterface &m )
 	return arrayToList( p );
 }
 
+static list taggedLocations( const SceneInterface &m, const SceneInterface::Name &name )
+{
+	std::vector<SceneInterface::Path> paths;
+	{
+		ScopedGILRelease gilRelease;
+		m.taggedLocations( name, paths );
+	}
+	list result;
+	for ( std::vector<SceneInterface::Path>::iterator it = paths.begin(); it != paths.end(); it++ )
+	{
+		result.append( arrayToList( *it ) );
+	}
+	return result;
+}
+
 static std::string pathAsString( const SceneInterface &m )
 {
 	SceneInterface::Path p;
@@ -147,7 +167,11 @@ static dict readObjectPrimitiveVariables( const SceneInterface &m, list varNameL
 	SceneInterface::NameList v;
 	listToSceneInterfaceNameList( varNameList, v );
 
-	PrimitiveVariableMap varMap = m.readObjectPrimitiveVariables( v, time );
+	PrimitiveVariableMap varMap;
+	{
+		ScopedGILRelease gilRelease;
+		varMap = m.readObjectPrimitiveVariables( v, time );
+	}
 	dict result;
 	for ( PrimitiveVariableMap::const_iterator it = varMap.begin(); it != varMap.end(); it++ )
 	{
@@ -175,8 +199,21 @@ void writeTags( SceneInterface &m, list tagList )
 	m.writeTags(v);	
 }
 
+static Imath::Box3d readBound( const SceneInterface &m, double time )
+{
+	ScopedGILRelease gilRelease;
+	return m.readBound( time );
+}
+
+static void writeBound( SceneInterface &m, const Imath::Box3d &bound, double time )
+{
+	ScopedGILRelease gilRelease;
+	m.writeBound( bound, time );
+}
+
 DataPtr readTransform( SceneInterface &m, double time )
 {
+	ScopedGILRelease gilRelease;
 	ConstDataPtr t = m.readTransform(time);
 	if ( t )
 	{
@@ -185,8 +222,21 @@ DataPtr readTransform( SceneInterface &m, double time )
 	return 0;
 }
 
+static Imath::M44d readTransformAsMatrix( const SceneInterface &m, double time )
+{
+	ScopedGILRelease gilRelease;
+	return m.readTransformAsMatrix( time );
+}
+
+static void writeTransform( SceneInterface &m, const Data *transform, double time )
+{
+	ScopedGILRelease gilRelease;
+	m.writeTransform( transform, time );
+}
+
 ObjectPtr readAttribute( SceneInterface &m, const SceneInterface::Name &name, double time )
 {
+	ScopedGILRelease gilRelease;
 	ConstObjectPtr o = m.readAttribute(name,time);
 	if ( o )
 	{
@@ -195,8 +245,15 @@ ObjectPtr readAttribute( SceneInterface &m, const SceneInterface::Name &name, do
 	return 0;
 }
 
+static void writeAttribute( SceneInterface &m, const SceneInterface::Name &name, const Object *attribute, double time )
+{
+	ScopedGILRelease gilRelease;
+	m.writeAttribute( name, attribute, time );
+}
+
 ObjectPtr readObject( SceneInterface &m, double time )
 {
+	ScopedGILRelease gilRelease;
 	ConstObjectPtr o = m.readObject(time);
 	if ( o )
 	{
@@ -205,6 +262,20 @@ ObjectPtr readObject( SceneInterface &m, double time )
 	return 0;
 }
 
+static void writeObject( SceneInterface &m, const Object *object, double time )
+{
+	ScopedGILRelease gilRelease;
+	m.writeObject( object, time );
+}
+
+static MurmurHash hash( const SceneInterface &m, SceneInterface::HashType hashType, double time )
+{
+	ScopedGILRelease gilRelease;
+	MurmurHash h;
+	m.hash( hashType, time, h );
+	return h;
+}
+
 void bindSceneInterface()
 {
 	SceneInterfacePtr (SceneInterface::*nonConstChild)(const SceneInterface::Name &, SceneInterface::MissingBehaviour) = &SceneInterface::child;
@@ -222,6 +293,16 @@ void bindSceneInterface()
 			.value("CreateIfMissing", SceneInterface::CreateIfMissing)
 			.export_values()
 		;
+
+		enum_< SceneInterface::HashType > ("HashType")
+			.value("TransformHash", SceneInterface::TransformHash)
+			.value("AttributesHash", SceneInterface::AttributesHash)
+			.value("BoundHash", SceneInterface::BoundHash)
+			.value("ObjectHash", SceneInterface::ObjectHash)
+			.value("ChildNamesHash", SceneInterface::ChildNamesHash)
+			.value("HierarchyHash", SceneInterface::HierarchyHash)
+			.export_values()
+		;
 	}
 
 	// now we've defined the nested types, we're able to define the methods for
@@ -232,27 +313,29 @@ void bindSceneInterface()
 		.def( "fileName", &SceneInterface::fileName )
 		.def( "pathAsString", pathAsString )
 		.def( "name", &SceneInterface::name )
-		.def( "readBound", &SceneInterface::readBound )
-		.def( "writeBound", &SceneInterface::writeBound )
+		.def( "readBound", &readBound )
+		.def( "writeBound", &writeBound )
 		.def( "readTransform", &readTransform )
-		.def( "readTransformAsMatrix", &SceneInterface::readTransformAsMatrix )
-		.def( "writeTransform", &SceneInterface::writeTransform )
+		.def( "readTransformAsMatrix", &readTransformAsMatrix )
+		.def( "writeTransform", &writeTransform )
 		.def( "hasAttribute", &SceneInterface::hasAttribute )
 		.def( "attributeNames", attributeNames )
 		.def( "readAttribute", &readAttribute )
-		.def( "writeAttribute", &SceneInterface::writeAttribute )
+		.def( "writeAttribute", &writeAttribute )
 		.def( "hasTag", &SceneInterface::hasTag, ( arg( "name" ), arg( "includeChildren" ) = true ) )
 		.def( "readTags", readTags, ( arg( "includeChildren" ) = true ) )
 		.def( "writeTags", writeTags )
+		.def( "taggedLocations", taggedLocations )
 		.def( "readObject", &readObject )
 		.def( "readObjectPrimitiveVariables", &readObjectPrimitiveVariables )
-		.def( "writeObject", &SceneInterface::writeObject )
+		.def( "writeObject", &writeObject )
 		.def( "hasObject", &SceneInterface::hasObject )
 		.def( "hasChild", &SceneInterface::hasChild )
 		.def( "childNames", &childNames )
 		.def( "child", nonConstChild, ( arg( "name" ), arg( "missingBehaviour" ) = SceneInterface::ThrowIfMissing ) )
 		.def( "createChild", &SceneInterface::createChild )
 		.def( "scene", &nonConstScene, ( arg( "path" ), arg( "missingBehaviour" ) = SceneInterface::ThrowIfMissing ) )
+		.def( "hash", &hash )
 
 		.def( "pathToString", pathToString ).staticmethod("pathToString")
 		.def( "stringToPath", stringToPath ).staticmethod("stringToPath")
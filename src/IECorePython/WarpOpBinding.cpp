@@ -48,7 +48,14 @@ namespace IECorePython
 void bindWarpOp()
 {
 
-	RunTimeTypedClass<WarpOp>()
+	scope s = RunTimeTypedClass<WarpOp>();
+
+	enum_<WarpOp::FilterType>( "FilterType" )
+		.value( "None", WarpOp::None )
+		.value( "Bilinear", WarpOp::Bilinear )
+		.value( "Bicubic", WarpOp::Bicubic )
+		.value( "Lanczos", WarpOp::Lanczos )
+		.value( "EWA", WarpOp::EWA )
 	;
 
 }
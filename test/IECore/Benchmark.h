@@ -0,0 +1,88 @@
+//////////////////////////////////////////////////////////////////////////
+//
+//  Copyright (c) 2013, Image Engine Design Inc. All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are
+//  met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//
+//     * Neither the name of Image Engine Design nor the names of any
+//       other contributors to this software may be used to endorse or
+//       promote products derived from this software without specific prior
+//       written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+//  IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+//  THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+//  PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+//  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+//  EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+//  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+//  PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+//  LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+//  NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//////////////////////////////////////////////////////////////////////////
+
+#ifndef IECORE_BENCHMARK_H
+#define IECORE_BENCHMARK_H
+
+#include <cstdlib>
+#include <string>
+
+#include "boost/format.hpp"
+#include "boost/test/unit_test.hpp"
+
+#include "tbb/task_scheduler_init.h"
+#include "tbb/tick_count.h"
+
+namespace IECore
+{
+
+/// Benchmarks are timed runs which are too slow and too noisy to be part of the
+/// unit test suite. Test suites should only add them when benchmarksEnabled()
+/// returns true, which is when the IECORE_BENCHMARKS environment variable is set
+/// to a non-zero value. Timings are reported with BOOST_TEST_MESSAGE, so are only
+/// output when running with --log_level=message.
+inline bool benchmarksEnabled()
+{
+	const char *e = getenv( "IECORE_BENCHMARKS" );
+	return e && *e && std::string( e ) != "0";
+}
+
+/// Times a single call to f() and reports it under the given name,
+/// returning the time taken in seconds.
+template<typename F>
+double benchmark( const std::string &name, F f )
+{
+	tbb::tick_count t0 = tbb::tick_count::now();
+	f();
+	const double seconds = ( tbb::tick_count::now() - t0 ).seconds();
+	BOOST_TEST_MESSAGE( boost::format( "%s : %.3fs" ) % name % seconds );
+	return seconds;
+}
+
+/// Times f() with each power of two number of threads up to the default
+/// number for the machine, reporting the time taken for each.
+template<typename F>
+void benchmarkThreads( const std::string &name, F f )
+{
+	const int maxThreads = tbb::task_scheduler_init::default_num_threads();
+	for( int numThreads = 1; numThreads <= maxThreads; numThreads *= 2 )
+	{
+		tbb::task_scheduler_init init( numThreads );
+		benchmark( boost::str( boost::format( "%s with %d thread(s)" ) % name % numThreads ), f );
+	}
+}
+
+} // namespace IECore
+
+#endif // IECORE_BENCHMARK_H
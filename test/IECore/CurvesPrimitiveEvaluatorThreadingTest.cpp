@@ -158,6 +158,36 @@ struct CurvesPrimitiveEvaluatorThreadingTest
 		CurvesPrimitiveEvaluatorPtr evaluator = makeEvaluator();
 		parallel_for( blocked_range<size_t>( 0, 10000 ), CheckClosestPoint( *evaluator ) );
 	}
+
+	void testBatchClosestPoints()
+	{
+		CurvesPrimitiveEvaluatorPtr evaluator = makeEvaluator();
+
+		Rand32 rand;
+		std::vector<V3f> points( 10000 );
+		for( size_t i = 0; i < points.size(); ++i )
+		{
+			points[i] = V3f( rand.nextf(), rand.nextf(), rand.nextf() );
+		}
+
+		std::vector<V3f> positions;
+		std::vector<unsigned> curveIndices;
+		std::vector<float> vs;
+		BOOST_CHECK( evaluator->closestPoints( points, &positions, &curveIndices, &vs ) );
+		BOOST_CHECK_EQUAL( positions.size(), points.size() );
+		BOOST_CHECK_EQUAL( curveIndices.size(), points.size() );
+		BOOST_CHECK_EQUAL( vs.size(), points.size() );
+
+		PrimitiveEvaluator::ResultPtr result = evaluator->createResult();
+		const CurvesPrimitiveEvaluator::Result *curvesResult = static_cast<const CurvesPrimitiveEvaluator::Result *>( result.get() );
+		for( size_t i = 0; i < points.size(); ++i )
+		{
+			evaluator->closestPoint( points[i], result.get() );
+			BOOST_CHECK( positions[i] == curvesResult->point() );
+			BOOST_CHECK_EQUAL( curveIndices[i], curvesResult->curveIndex() );
+			BOOST_CHECK_EQUAL( vs[i], curvesResult->uv()[1] );
+		}
+	}
 	
 };
 
@@ -171,6 +201,7 @@ struct CurvesPrimitiveEvaluatorThreadingTestSuite : public boost::unit_test::tes
 
 		add( BOOST_CLASS_TEST_CASE( &CurvesPrimitiveEvaluatorThreadingTest::testResultCreation, instance ) );
 		add( BOOST_CLASS_TEST_CASE( &CurvesPrimitiveEvaluatorThreadingTest::testClosestPoint, instance ) );
+		add( BOOST_CLASS_TEST_CASE( &CurvesPrimitiveEvaluatorThreadingTest::testBatchClosestPoints, instance ) );
 	}
 };
 
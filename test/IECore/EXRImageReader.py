@@ -153,6 +153,18 @@ class TestEXRReader(unittest.TestCase):
 			cd = r.readChannel( c )
 			self.assertEqual( i[c].data, cd )
 
+	def testReadIndividualChannelsWithDataWindow( self ) :
+
+		r = EXRImageReader( "test/IECore/data/exrFiles/redgreen_gradient_piz_256x256.exr" )
+		r.parameters()["rawChannels"].setTypedValue( True )
+		r.parameters()["dataWindow"].setTypedValue( Box2i( V2i( 10, 5 ), V2i( 100, 250 ) ) )
+		i = r.read()
+
+		for c in i.keys() :
+
+			cd = r.readChannel( c, raw = True )
+			self.assertEqual( i[c].data, cd )
+
 	def testReadWithChangedDisplayWindow( self ) :
 
 		r = EXRImageReader( "test/IECore/data/exrFiles/uvMap.256x256.exr" )
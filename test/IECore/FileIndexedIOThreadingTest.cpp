@@ -0,0 +1,162 @@
+//////////////////////////////////////////////////////////////////////////
+//
+//  Copyright (c) 2013, Image Engine Design Inc. All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are
+//  met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//
+//     * Neither the name of Image Engine Design nor the names of any
+//       other contributors to this software may be used to endorse or
+//       promote products derived from this software without specific prior
+//       written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+//  IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+//  THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+//  PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+//  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+//  EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+//  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+//  PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+//  LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+//  NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//////////////////////////////////////////////////////////////////////////
+
+#include "boost/format.hpp"
+#include "boost/bind.hpp"
+
+#include "tbb/tbb.h"
+
+#include "IECore/FileIndexedIO.h"
+#include "IECore/VectorTypedData.h"
+
+#include "FileIndexedIOThreadingTest.h"
+#include "Benchmark.h"
+
+using namespace boost;
+using namespace boost::unit_test;
+using namespace tbb;
+
+namespace IECore
+{
+
+struct FileIndexedIOThreadingTest
+{
+
+	static const unsigned g_numEntries = 256;
+	static const unsigned g_entryLength = 64 * 1024;
+
+	FileIndexedIOThreadingTest()
+		:	m_fileName( "/tmp/fileIndexedIOThreadingTest.fio" )
+	{
+		IndexedIOPtr io = new FileIndexedIO( m_fileName, IndexedIO::rootPath, IndexedIO::Write );
+		std::vector<float> data( g_entryLength );
+		for( unsigned i = 0; i < g_numEntries; i++ )
+		{
+			// make every entry unique so the data isn't deduplicated
+			std::fill( data.begin(), data.end(), (float)i );
+			io->write( entryName( i ), &data[0], data.size() );
+		}
+	}
+
+	~FileIndexedIOThreadingTest()
+	{
+		remove( m_fileName.c_str() );
+	}
+
+	static IndexedIO::EntryID entryName( unsigned i )
+	{
+		return IndexedIO::EntryID( ( boost::format( "entry%d" ) % i ).str() );
+	}
+
+	struct ReadEntries
+	{
+		public :
+
+			ReadEntries( ConstIndexedIOPtr io )
+				:	m_io( io )
+			{
+			}
+
+			void operator()( const blocked_range<size_t> &r ) const
+			{
+				std::vector<float> data( g_entryLength );
+				for( size_t i=r.begin(); i!=r.end(); ++i )
+				{
+					unsigned entry = i % g_numEntries;
+					float *d = &data[0];
+					m_io->read( entryName( entry ), d, g_entryLength );
+					// can't use boost unit test assertions from threads
+					if( data[0] != (float)entry || data[g_entryLength-1] != (float)entry )
+					{
+						throw Exception( "Unexpected data read." );
+					}
+				}
+			}
+
+		private :
+
+			ConstIndexedIOPtr m_io;
+
+	};
+
+	void testConcurrentReads()
+	{
+		ConstIndexedIOPtr io = new FileIndexedIO( m_fileName, IndexedIO::rootPath, IndexedIO::Read );
+		parallel_for( blocked_range<size_t>( 0, g_numEntries * 10 ), ReadEntries( io ) );
+	}
+
+	static void readEntries( ConstIndexedIOPtr io, size_t numReads )
+	{
+		parallel_for( blocked_range<size_t>( 0, numReads ), ReadEntries( io ) );
+	}
+
+	// Benchmarks reads for increasing numbers of threads, so the scaling
+	// of concurrent reads from a single file can be observed.
+	void testReadScaling()
+	{
+		ConstIndexedIOPtr io = new FileIndexedIO( m_fileName, IndexedIO::rootPath, IndexedIO::Read );
+
+		const size_t numReads = g_numEntries * 40;
+		const size_t megabytes = numReads * g_entryLength * sizeof( float ) / ( 1024 * 1024 );
+		benchmarkThreads(
+			boost::str( boost::format( "FileIndexedIO reading %dMB" ) % megabytes ),
+			boost::bind( &readEntries, io, numReads )
+		);
+	}
+
+	std::string m_fileName;
+
+};
+
+struct FileIndexedIOThreadingTestSuite : public boost::unit_test::test_suite
+{
+
+	FileIndexedIOThreadingTestSuite() : boost::unit_test::test_suite( "FileIndexedIOThreadingTestSuite" )
+	{
+		boost::shared_ptr<FileIndexedIOThreadingTest> instance( new FileIndexedIOThreadingTest() );
+
+		add( BOOST_CLASS_TEST_CASE( &FileIndexedIOThreadingTest::testConcurrentReads, instance ) );
+		if( benchmarksEnabled() )
+		{
+			add( BOOST_CLASS_TEST_CASE( &FileIndexedIOThreadingTest::testReadScaling, instance ) );
+		}
+	}
+};
+
+void addFileIndexedIOThreadingTest(boost::unit_test::test_suite* test)
+{
+	test->add( new FileIndexedIOThreadingTestSuite( ) );
+}
+
+} // namespace IECore
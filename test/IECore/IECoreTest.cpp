@@ -77,6 +77,14 @@
 #include "LRUCacheThreadingTest.h"
 #include "CompoundDataTest.h"
 #include "CompoundObjectTest.h"
+#include "FileIndexedIOThreadingTest.h"
+#include "SceneAlgoTest.h"
+#include "MeshPrimitiveEvaluatorTest.h"
+#include "PointsPrimitiveEvaluatorTest.h"
+#include "MurmurHashTest.h"
+#include "ImageOpThreadingTest.h"
+#include "PointSmoothSkinningOpTest.h"
+#include "MeshAdjacencyTest.h"
 
 using namespace boost::unit_test;
 using boost::test_tools::output_test_stream;
@@ -121,6 +129,14 @@ test_suite* init_unit_test_suite( int argc, char* argv[] )
 		addLRUCacheThreadingTest(test);
 		addCompoundDataTest(test);
 		addCompoundObjectTest(test);
+		addFileIndexedIOThreadingTest(test);
+		addSceneAlgoTest(test);
+		addMeshPrimitiveEvaluatorTest(test);
+		addPointsPrimitiveEvaluatorTest(test);
+		addMurmurHashTest(test);
+		addImageOpThreadingTest(test);
+		addPointSmoothSkinningOpTest(test);
+		addMeshAdjacencyTest(test);
 	}
 	catch (std::exception &ex)
 	{
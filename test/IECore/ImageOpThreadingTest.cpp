@@ -0,0 +1,214 @@
+//////////////////////////////////////////////////////////////////////////
+//
+//  Copyright (c) 2013, Image Engine Design Inc. All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are
+//  met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//
+//     * Neither the name of Image Engine Design nor the names of any
+//       other contributors to this software may be used to endorse or
+//       promote products derived from this software without specific prior
+//       written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+//  IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+//  THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+//  PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+//  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+//  EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+//  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+//  PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+//  LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+//  NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//////////////////////////////////////////////////////////////////////////
+
+#include "boost/bind.hpp"
+
+#include "tbb/tbb.h"
+#include "tbb/task_scheduler_init.h"
+
+#include "OpenEXR/ImathRandom.h"
+
+#include "IECore/ImagePrimitive.h"
+#include "IECore/ImageCompositeOp.h"
+#include "IECore/HdrMergeOp.h"
+#include "IECore/CompositeAlgo.h"
+#include "IECore/Group.h"
+#include "IECore/CompoundParameter.h"
+#include "IECore/ObjectParameter.h"
+
+#include "ImageOpThreadingTest.h"
+#include "Benchmark.h"
+
+using namespace boost;
+using namespace boost::unit_test;
+using namespace tbb;
+using namespace Imath;
+
+namespace IECore
+{
+
+struct ImageOpThreadingTest
+{
+
+	static ImagePrimitivePtr createImage( const Box2i &dataWindow, const Box2i &displayWindow, unsigned long seed, float scale = 1.0f )
+	{
+		ImagePrimitivePtr image = new ImagePrimitive( dataWindow, displayWindow );
+		Rand32 rand( seed );
+		const char *channels[] = { "R", "G", "B", "A" };
+		for( int c = 0; c < 4; ++c )
+		{
+			std::vector<float> &data = image->createChannel<float>( channels[c] )->writable();
+			for( size_t i = 0; i < data.size(); ++i )
+			{
+				data[i] = rand.nextf() * scale;
+			}
+		}
+		return image;
+	}
+
+	static float readPixel( const ImagePrimitive *image, const std::string &channel, const V2i &pixel, float defaultValue )
+	{
+		const Box2i &window = image->getDataWindow();
+		if( !window.intersects( pixel ) )
+		{
+			return defaultValue;
+		}
+		const int width = window.size().x + 1;
+		return image->getChannel<float>( channel )->readable()[( pixel.y - window.min.y ) * width + pixel.x - window.min.x];
+	}
+
+	static ImagePrimitivePtr composite( ImageCompositeOp::Operation operation, ImagePrimitive *imageA, ImagePrimitive *imageB )
+	{
+		ImageCompositeOpPtr op = new ImageCompositeOp;
+		op->inputParameter()->setValue( imageB );
+		op->imageAParameter()->setValue( imageA );
+		op->operationParameter()->setNumericValue( operation );
+		return runTimeCast<ImagePrimitive>( op->operate() );
+	}
+
+	void testComposite()
+	{
+		const Box2i displayWindow( V2i( 0 ), V2i( 299, 199 ) );
+		ImagePrimitivePtr imageA = createImage( Box2i( V2i( 20, 10 ), V2i( 250, 180 ) ), displayWindow, 1 );
+		ImagePrimitivePtr imageB = createImage( Box2i( V2i( 50, 0 ), V2i( 299, 150 ) ), displayWindow, 2 );
+
+		const ImageCompositeOp::Operation operations[] = { ImageCompositeOp::Over, ImageCompositeOp::Max, ImageCompositeOp::Min, ImageCompositeOp::Multiply };
+		float (*functions[])( float, float, float, float ) = { compositeOver<float>, compositeMax<float>, compositeMin<float>, compositeMultiply<float> };
+
+		for( int o = 0; o < 4; ++o )
+		{
+			ImagePrimitivePtr result = composite( operations[o], imageA, imageB );
+
+			const Box2i &window = result->getDataWindow();
+			if( operations[o] == ImageCompositeOp::Over || operations[o] == ImageCompositeOp::Max )
+			{
+				BOOST_CHECK( window == Box2i( V2i( 20, 0 ), V2i( 299, 180 ) ) );
+			}
+			else
+			{
+				BOOST_CHECK( window == Box2i( V2i( 50, 10 ), V2i( 250, 150 ) ) );
+			}
+
+			const char *channels[] = { "R", "G", "B" };
+			for( int c = 0; c < 3; ++c )
+			{
+				for( int y = window.min.y; y <= window.max.y; ++y )
+				{
+					for( int x = window.min.x; x <= window.max.x; ++x )
+					{
+						const V2i p( x, y );
+						float expected = functions[o](
+							readPixel( imageA, channels[c], p, 0.0f ), readPixel( imageA, "A", p, 0.0f ),
+							readPixel( imageB, channels[c], p, 0.0f ), readPixel( imageB, "A", p, 0.0f )
+						);
+						BOOST_CHECK_EQUAL( readPixel( result, channels[c], p, -1.0f ), expected );
+					}
+				}
+			}
+		}
+	}
+
+	static GroupPtr createBrackets( const Box2i &window, int numBrackets )
+	{
+		GroupPtr group = new Group;
+		for( int i = 0; i < numBrackets; ++i )
+		{
+			group->addChild( createImage( window, window, i, 1 << i ) );
+		}
+		return group;
+	}
+
+	static ImagePrimitivePtr hdrMerge( Group *brackets )
+	{
+		HdrMergeOpPtr op = new HdrMergeOp;
+		op->inputGroupParameter()->setValue( brackets );
+		return runTimeCast<ImagePrimitive>( op->operate() );
+	}
+
+	void testHdrMergeThreading()
+	{
+		GroupPtr brackets = createBrackets( Box2i( V2i( 0 ), V2i( 511, 255 ) ), 3 );
+
+		ImagePrimitivePtr expected;
+		{
+			task_scheduler_init init( 1 );
+			expected = hdrMerge( brackets );
+		}
+
+		const int maxThreads = task_scheduler_init::default_num_threads();
+		for( int numThreads = 2; numThreads <= std::max( maxThreads, 2 ); numThreads *= 2 )
+		{
+			task_scheduler_init init( numThreads );
+			ImagePrimitivePtr result = hdrMerge( brackets );
+			BOOST_CHECK( result->isEqualTo( expected ) );
+		}
+	}
+
+	// Benchmarks compositing and merging 4K images for increasing
+	// numbers of threads, so the scaling can be observed.
+	void testPerformance()
+	{
+		const Box2i window( V2i( 0 ), V2i( 4095, 2159 ) );
+		ImagePrimitivePtr imageA = createImage( window, window, 1 );
+		ImagePrimitivePtr imageB = createImage( window, window, 2 );
+		GroupPtr brackets = createBrackets( window, 3 );
+
+		benchmarkThreads( "4K ImageCompositeOp (Over)", boost::bind( &ImageOpThreadingTest::composite, ImageCompositeOp::Over, imageA.get(), imageB.get() ) );
+		benchmarkThreads( "4K HdrMergeOp (3 images)", boost::bind( &ImageOpThreadingTest::hdrMerge, brackets.get() ) );
+	}
+
+};
+
+struct ImageOpThreadingTestSuite : public boost::unit_test::test_suite
+{
+
+	ImageOpThreadingTestSuite() : boost::unit_test::test_suite( "ImageOpThreadingTestSuite" )
+	{
+		boost::shared_ptr<ImageOpThreadingTest> instance( new ImageOpThreadingTest() );
+
+		add( BOOST_CLASS_TEST_CASE( &ImageOpThreadingTest::testComposite, instance ) );
+		add( BOOST_CLASS_TEST_CASE( &ImageOpThreadingTest::testHdrMergeThreading, instance ) );
+		if( benchmarksEnabled() )
+		{
+			add( BOOST_CLASS_TEST_CASE( &ImageOpThreadingTest::testPerformance, instance ) );
+		}
+	}
+};
+
+void addImageOpThreadingTest( boost::unit_test::test_suite *test )
+{
+	test->add( new ImageOpThreadingTestSuite( ) );
+}
+
+} // namespace IECore
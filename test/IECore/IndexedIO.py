@@ -417,6 +417,108 @@ class TestFileIndexedIO(unittest.TestCase):
 		for n in range(0, 1000):
 			self.assertEqual(fv[n], gv[n])
 
+	def testMemoryMappedRead(self):
+		"""Test FileIndexedIO read with MemoryMapped open mode"""
+
+		f = FileIndexedIO("./test/FileIndexedIO.fio", [], IndexedIO.OpenMode.Write)
+		fv = FloatVectorData( [ n * n * math.sin( n ) for n in range( 0, 1000 ) ] )
+		f.subdirectory( "sub1", IndexedIO.MissingBehaviour.CreateIfMissing ).write( "myFloatVector", fv )
+		f.write( "myString", "hello" )
+		del f
+
+		f = FileIndexedIO("./test/FileIndexedIO.fio", [], IndexedIO.OpenMode.Read | IndexedIO.OpenMode.MemoryMapped )
+		self.assertEqual( f.subdirectory( "sub1" ).read( "myFloatVector" ), fv )
+		self.assertEqual( f.read( "myString" ), StringData( "hello" ) )
+
+		self.assertRaises( RuntimeError, FileIndexedIO, "./test/FileIndexedIO.fio", [], IndexedIO.OpenMode.Write | IndexedIO.OpenMode.MemoryMapped )
+
+	def testCompressedData(self):
+		"""Test FileIndexedIO read/write with CompressedData open mode"""
+
+		fv = FloatVectorData( [ n % 100 for n in range( 0, 100000 ) ] )
+		small = FloatVectorData( [ 1, 2, 3 ] )
+
+		f = FileIndexedIO("./test/FileIndexedIO.fio", [], IndexedIO.OpenMode.Write)
+		f.write( "myFloatVector", fv )
+		del f
+		uncompressedSize = os.path.getsize( "./test/FileIndexedIO.fio" )
+
+		f = FileIndexedIO("./test/FileIndexedIO.fio", [], IndexedIO.OpenMode.Write | IndexedIO.OpenMode.CompressedData )
+		f.write( "myFloatVector", fv )
+		f.write( "mySmallFloatVector", small )
+		del f
+		self.failUnless( os.path.getsize( "./test/FileIndexedIO.fio" ) < uncompressedSize / 2 )
+
+		f = FileIndexedIO("./test/FileIndexedIO.fio", [], IndexedIO.OpenMode.Append | IndexedIO.OpenMode.CompressedData )
+		f.write( "myAppendedFloatVector", fv )
+		self.assertEqual( f.read( "myFloatVector" ), fv )
+		del f
+
+		for mode in ( IndexedIO.OpenMode.Read, IndexedIO.OpenMode.Read | IndexedIO.OpenMode.MemoryMapped ) :
+			f = FileIndexedIO("./test/FileIndexedIO.fio", [], mode )
+			self.assertEqual( f.read( "myFloatVector" ), fv )
+			self.assertEqual( f.read( "myAppendedFloatVector" ), fv )
+			self.assertEqual( f.read( "mySmallFloatVector" ), small )
+			self.assertEqual( f.entry( "myFloatVector" ).arrayLength(), len( fv ) )
+			self.assertEqual( f.entry( "myFloatVector" ).dataType(), IndexedIO.DataType.FloatArray )
+
+		# removing entries shortens the index, so the file must be truncated
+		# when it is closed, otherwise stale data would follow the index.
+		f = FileIndexedIO("./test/FileIndexedIO.fio", [], IndexedIO.OpenMode.Append | IndexedIO.OpenMode.CompressedData )
+		f.remove( "myAppendedFloatVector" )
+		f.remove( "mySmallFloatVector" )
+		del f
+
+		f = FileIndexedIO("./test/FileIndexedIO.fio", [], IndexedIO.OpenMode.Append | IndexedIO.OpenMode.CompressedData )
+		self.assertEqual( f.entryIds(), [ "myFloatVector" ] )
+		self.assertEqual( f.read( "myFloatVector" ), fv )
+		f.write( "mySmallFloatVector", small )
+		del f
+
+		for mode in ( IndexedIO.OpenMode.Read, IndexedIO.OpenMode.Read | IndexedIO.OpenMode.CompressedData ) :
+			f = FileIndexedIO("./test/FileIndexedIO.fio", [], mode )
+			self.assertEqual( len( f.entryIds() ), 2 )
+			self.assertEqual( f.read( "myFloatVector" ), fv )
+			self.assertEqual( f.read( "mySmallFloatVector" ), small )
+
+	def testDeduplicationStatistics(self):
+		"""Test FileIndexedIO sharing of identical data"""
+
+		fv = FloatVectorData( [ n % 100 for n in range( 0, 100000 ) ] )
+		other = FloatVectorData( [ n % 50 for n in range( 0, 100000 ) ] )
+
+		for mode in ( IndexedIO.OpenMode.Write, IndexedIO.OpenMode.Write | IndexedIO.OpenMode.CompressedData ) :
+
+			f = FileIndexedIO("./test/FileIndexedIO.fio", [], mode )
+			self.assertEqual( f.deduplicationStatistics().hits, 0 )
+
+			# saving objects passes their hash to the file, so an identical
+			# copy can be shared without being hashed or compressed again.
+			fv.save( f, "a" )
+			before = f.deduplicationStatistics()
+			fv.copy().save( f, "b" )
+			other.save( f, "c" )
+			after = f.deduplicationStatistics()
+
+			self.assertEqual( after.precomputedHashHits - before.precomputedHashHits, 1 )
+			self.failUnless( after.hits > before.hits )
+			self.failUnless( after.bytesSaved > before.bytesSaved )
+			self.failUnless( after.writes > before.writes )
+
+			# writing raw data still shares data by hashing it
+			f.write( "d", fv )
+			f.write( "e", fv )
+			self.assertEqual( f.deduplicationStatistics().hits, after.hits + 1 )
+			self.assertEqual( f.subdirectory( "a" ).deduplicationStatistics().hits, f.deduplicationStatistics().hits )
+			del f
+
+			f = FileIndexedIO("./test/FileIndexedIO.fio", [], IndexedIO.OpenMode.Read )
+			self.assertEqual( Object.load( f, "a" ), fv )
+			self.assertEqual( Object.load( f, "b" ), fv )
+			self.assertEqual( Object.load( f, "c" ), other )
+			self.assertEqual( f.read( "d" ), fv )
+			self.assertEqual( f.read( "e" ), fv )
+
 	def testReadWriteDoubleVector(self):
 		"""Test FileIndexedIO read/write(DoubleVector)"""
 
@@ -271,6 +271,93 @@ class TestInterpolatedCache(unittest.TestCase):
 		
 		cache.setMaxOpenFiles( 10 )
 		self.assertEqual( cache.getMaxOpenFiles(), 10 )
+
+		# the fourth positional argument is still the number of open files
+		cache = InterpolatedCache( self.pathTemplate, InterpolatedCache.Interpolation.None, OversamplesCalculator(), 5 )
+		self.assertEqual( cache.getMaxOpenFiles(), 5 )
+		self.assertEqual( cache.getMaxMemory(), 500 * 1024 * 1024 )
+
+		# small files are limited by number rather than by memory
+		self.__createCache()
+		cache = InterpolatedCache( self.pathTemplate, maxOpenFiles=2, maxMemory=100 * 1024 * 1024 )
+		for frame in range( 0, 6 ) :
+			self.assertEqual( cache.read( frame, "obj2", "i" ), IntData( [ 0, 1, 2, 4, 8, 16 ][frame] ) )
+		self.assertEqual( cache.memoryUsage(), 100 * 1024 * 1024 )
+
+	def testMaxMemory( self ) :
+
+		cache = InterpolatedCache( self.pathTemplate, maxMemory=20 * 1024 * 1024 )
+		self.assertEqual( cache.getMaxMemory(), 20 * 1024 * 1024 )
+		
+		cache.setMaxMemory( 10 * 1024 * 1024 )
+		self.assertEqual( cache.getMaxMemory(), 10 * 1024 * 1024 )
+
+		self.__createCache()
+
+		# large files are limited by memory rather than by number, and are
+		# costed at their size on disk.
+		fileSize = os.path.getsize( FileSequence( self.pathTemplate, EmptyFrameList() ).fileNameForFrame( 250 ) )
+		cache = InterpolatedCache( self.pathTemplate, maxOpenFiles=10, maxMemory=fileSize * 3 )
+		cache.read( 1, "obj2", "i" )
+		self.assertEqual( cache.memoryUsage(), fileSize )
+
+		# files which don't fit in the budget are still readable
+		cache = InterpolatedCache( self.pathTemplate, maxMemory=fileSize - 1 )
+		self.assertEqual( cache.read( 1, "obj2", "i" ), IntData( 1 ) )
+		self.assertEqual( cache.memoryUsage(), 0 )
+
+	def testPrefetch( self ) :
+
+		self.__createCache()
+
+		osc = OversamplesCalculator()
+		cache = InterpolatedCache( self.pathTemplate, InterpolatedCache.Interpolation.Linear, osc )
+		reference = InterpolatedCache( self.pathTemplate, InterpolatedCache.Interpolation.Linear, osc )
+
+		frame = 1.0
+		while frame < 2.0 :
+			cache.prefetch( frame, 0.25, 2 )
+			self.assertEqual( cache.read( frame, "obj1", "v3fVec" ), reference.read( frame, "obj1", "v3fVec" ) )
+			frame += 0.25
+
+		cache.waitForPrefetches()
+		self.failUnless( cache.memoryUsage() > 0 )
+
+		# prefetching missing files doesn't fail, but reading them does
+		cache.prefetch( 100, 1, 2 )
+		cache.waitForPrefetches()
+		self.assertRaises( RuntimeError, cache.read, 101, "obj1", "v3fVec" )
+
+	def testConcurrentReadsFromOneFile( self ) :
+
+		self.__createCache()
+
+		cache = InterpolatedCache( self.pathTemplate, InterpolatedCache.Interpolation.Linear, OversamplesCalculator() )
+		expected = {
+			"obj1" : cache.read( 1.5, "obj1", "v3fVec" ),
+			"obj2" : cache.read( 1.5, "obj2", "i" ),
+		}
+
+		errors = []
+		def t( obj, attr ) :
+			try :
+				for i in range( 0, 100 ) :
+					if cache.read( 1.5, obj, attr ) != expected[obj] :
+						errors.append( "Unexpected value for %s" % obj )
+			except Exception, e :
+				errors.append( str( e ) )
+
+		threads = []
+		for i in range( 0, 10 ) :
+			for obj, attr in ( ( "obj1", "v3fVec" ), ( "obj2", "i" ) ) :
+				thread = threading.Thread( target = t, args = ( obj, attr ) )
+				threads.append( thread )
+				thread.start()
+
+		for thread in threads :
+			thread.join()
+
+		self.assertEqual( errors, [] )
 		
 	def tearDown(self):
 
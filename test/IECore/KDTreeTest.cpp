@@ -32,15 +32,70 @@
 //
 //////////////////////////////////////////////////////////////////////////
 
+#include "boost/bind.hpp"
+
 #include "KDTreeTest.h"
+#include "Benchmark.h"
 
 namespace IECore
 {
 
+typedef std::vector<Imath::V3f> BenchmarkPointVector;
+typedef KDTree<BenchmarkPointVector::const_iterator> BenchmarkTree;
+
+static void scalarNearestNeighbours( const BenchmarkTree &tree, const BenchmarkPointVector &queries, std::vector<BenchmarkTree::Iterator> &results )
+{
+	results.resize( queries.size() );
+	for( size_t i=0; i<queries.size(); i++ )
+	{
+		results[i] = tree.nearestNeighbour( queries[i] );
+	}
+}
+
+static void batchNearestNeighbours( const BenchmarkTree &tree, const BenchmarkPointVector &queries, std::vector<BenchmarkTree::Iterator> &results )
+{
+	tree.nearestNeighbour( queries.begin(), queries.end(), results );
+}
+
+// Benchmarks the batch nearest neighbour query against calling
+// the single query in a loop. The equivalence of the results is
+// tested at smaller scale by KDTreeTest::testBatchQueries().
+static void testBatchQueryPerformance()
+{
+	Imath::Rand32 randGen;
+	BenchmarkPointVector points( 1000000 );
+	for( size_t i=0; i<points.size(); i++ )
+	{
+		points[i] = Imath::V3f( randGen.nextf(), randGen.nextf(), randGen.nextf() );
+	}
+
+	BenchmarkPointVector queries( 10000000 );
+	for( size_t i=0; i<queries.size(); i++ )
+	{
+		queries[i] = Imath::V3f( randGen.nextf(), randGen.nextf(), randGen.nextf() );
+	}
+
+	BenchmarkTree tree( points.begin(), points.end(), 16, true );
+
+	std::vector<BenchmarkTree::Iterator> scalarResults;
+	benchmark( "KDTree scalar nearestNeighbour for 10M queries", boost::bind( &scalarNearestNeighbours, boost::cref( tree ), boost::cref( queries ), boost::ref( scalarResults ) ) );
+
+	std::vector<BenchmarkTree::Iterator> batchResults;
+	benchmark( "KDTree batch nearestNeighbour for 10M queries", boost::bind( &batchNearestNeighbours, boost::cref( tree ), boost::cref( queries ), boost::ref( batchResults ) ) );
+
+	BOOST_CHECK( batchResults == scalarResults );
+}
+
 void addKDTreeTest(boost::unit_test::test_suite* test)
 {
 	test->add( new KDTreeTestSuite<10>() );
 	test->add( new KDTreeTestSuite<1500>() );
+	// large enough to be built in parallel
+	test->add( new KDTreeTestSuite<20000>() );
+	if( benchmarksEnabled() )
+	{
+		test->add( BOOST_TEST_CASE( &testBatchQueryPerformance ) );
+	}
 }
 
 }
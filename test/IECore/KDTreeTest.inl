@@ -192,4 +192,91 @@ void KDTreeTest<T>::testNearestNNeighours()
 
 }
 
+template<typename T>
+void KDTreeTest<T>::testContiguousLeaves()
+{
+	// A tree storing its own copy of the points must give exactly the same answers
+	Tree contiguousTree( m_points.begin(), m_points.end(), 16, true );
+	BOOST_CHECK( contiguousTree.numNodes() == m_tree->numNodes() );
+
+	IteratorVector nearNeighbours;
+	IteratorVector contiguousNearNeighbours;
+	NeighbourVector nearNNeighbours;
+	NeighbourVector contiguousNearNNeighbours;
+	for( typename Tree::Iterator it=m_points.begin(); it!=m_points.end(); it++ )
+	{
+		BOOST_CHECK( contiguousTree.nearestNeighbour( *it ) == it );
+
+		typename T::BaseType radius = 0.05;
+		m_tree->nearestNeighbours( *it, radius, nearNeighbours );
+		contiguousTree.nearestNeighbours( *it, radius, contiguousNearNeighbours );
+		BOOST_CHECK( nearNeighbours == contiguousNearNeighbours );
+
+		m_tree->nearestNNeighbours( *it, 4, nearNNeighbours );
+		contiguousTree.nearestNNeighbours( *it, 4, contiguousNearNNeighbours );
+		BOOST_CHECK( nearNNeighbours.size() == contiguousNearNNeighbours.size() );
+		for( size_t i=0; i<nearNNeighbours.size(); i++ )
+		{
+			BOOST_CHECK( nearNNeighbours[i].point == contiguousNearNNeighbours[i].point );
+		}
+	}
+}
+
+template<typename T>
+void KDTreeTest<T>::testBatchQueries()
+{
+	// The batch queries must give exactly the same answers as the individual
+	// ones, for both the tree and a contiguous copy of it.
+	PointVector queries( m_numPoints * 2 );
+	for( unsigned int i=0; i<queries.size(); i++ )
+	{
+		for ( unsigned int j = 0; j < VectorTraits< T >::dimensions(); j++)
+			queries[i][j] = m_randGen.nextf( -0.1, 1.1 );
+	}
+
+	Tree contiguousTree( m_points.begin(), m_points.end(), 16, true );
+	const Tree *trees[2] = { m_tree, &contiguousTree };
+	for( int t=0; t<2; t++ )
+	{
+		const Tree *tree = trees[t];
+
+		IteratorVector nearest;
+		tree->nearestNeighbour( queries.begin(), queries.end(), nearest );
+		BOOST_CHECK( nearest.size() == queries.size() );
+
+		typename T::BaseType radius = 0.05;
+		std::vector<IteratorVector> nearNeighbours;
+		tree->nearestNeighbours( queries.begin(), queries.end(), radius, nearNeighbours );
+		BOOST_CHECK( nearNeighbours.size() == queries.size() );
+
+		unsigned int neighboursRequested = 4;
+		NeighbourVector nearNNeighbours;
+		unsigned int n = tree->nearestNNeighbours( queries.begin(), queries.end(), neighboursRequested, nearNNeighbours );
+		BOOST_CHECK( n == std::min( neighboursRequested, m_numPoints ) );
+		BOOST_CHECK( nearNNeighbours.size() == queries.size() * n );
+
+		IteratorVector singleNearNeighbours;
+		NeighbourVector singleNearNNeighbours;
+		for( size_t i=0; i<queries.size(); i++ )
+		{
+			BOOST_CHECK( nearest[i] == tree->nearestNeighbour( queries[i] ) );
+
+			tree->nearestNeighbours( queries[i], radius, singleNearNeighbours );
+			BOOST_CHECK( nearNeighbours[i] == singleNearNeighbours );
+
+			tree->nearestNNeighbours( queries[i], neighboursRequested, singleNearNNeighbours );
+			BOOST_CHECK( singleNearNNeighbours.size() == n );
+			for( size_t j=0; j<singleNearNNeighbours.size(); j++ )
+			{
+				BOOST_CHECK( nearNNeighbours[i*n+j].point == singleNearNNeighbours[j].point );
+			}
+		}
+	}
+
+	// An empty query range should give empty results
+	IteratorVector nearest( 1 );
+	m_tree->nearestNeighbour( queries.begin(), queries.begin(), nearest );
+	BOOST_CHECK( nearest.empty() );
+}
+
 }
@@ -36,10 +36,14 @@
 
 #include "tbb/tbb.h"
 
+#include "boost/bind.hpp"
+
 #include "IECore/LRUCache.h"
+#include "IECore/ShardedLRUCache.h"
 #include "IECore/SimpleTypedData.h"
 
 #include "LRUCacheThreadingTest.h"
+#include "Benchmark.h"
 
 using namespace boost;
 using namespace boost::unit_test;
@@ -51,11 +55,12 @@ namespace IECore
 struct LRUCacheThreadingTest
 {
 		
+	template<typename Cache>
 	struct GetFromCache
 	{
 		public :
 		
-			GetFromCache( LRUCache<int, IntDataPtr> &cache )
+			GetFromCache( Cache &cache )
 				:	m_cache( cache )
 			{
 			}
@@ -72,10 +77,37 @@ struct LRUCacheThreadingTest
 			
 		private :
 		
-			LRUCache<int, IntDataPtr> &m_cache;
+			Cache &m_cache;
 			
 	};
 
+	template<typename Cache>
+	struct GetFromCacheModulo
+	{
+		public :
+
+			GetFromCacheModulo( Cache &cache, int numKeys )
+				:	m_cache( cache ), m_numKeys( numKeys )
+			{
+			}
+
+			void operator()( const blocked_range<size_t> &r ) const
+			{
+				for( size_t i=r.begin(); i!=r.end(); ++i )
+				{
+					int key = i % m_numKeys;
+					IntDataPtr k = m_cache.get( key );
+					assert( k->readable() == key );
+				}
+			}
+
+		private :
+
+			Cache &m_cache;
+			int m_numKeys;
+
+	};
+
 	static IntDataPtr get( int key, size_t &cost )
 	{
 		cost = 10;
@@ -86,11 +118,119 @@ struct LRUCacheThreadingTest
 	{
 		LRUCache<int, IntDataPtr> cache( get, 1000 );
 		
-		parallel_for( blocked_range<size_t>( 0, 10000 ), GetFromCache( cache ) );
+		parallel_for( blocked_range<size_t>( 0, 10000 ), GetFromCache<LRUCache<int, IntDataPtr> >( cache ) );
+	}
+
+	void testSharded()
+	{
+		ShardedLRUCache<int, IntDataPtr> cache( get, 1000 );
+
+		parallel_for( blocked_range<size_t>( 0, 10000 ), GetFromCache<ShardedLRUCache<int, IntDataPtr> >( cache ) );
+		BOOST_CHECK( cache.currentCost() <= 1000 );
+
+		// all the gets should be hits once the keys are in the cache
+		cache.clear();
+		cache.setMaxCost( 100000 );
+		parallel_for( blocked_range<size_t>( 0, 1000000 ), GetFromCacheModulo<ShardedLRUCache<int, IntDataPtr> >( cache, 1000 ) );
+		BOOST_CHECK_EQUAL( cache.currentCost(), (size_t)10000 );
+
+		cache.clear();
+		BOOST_CHECK_EQUAL( cache.currentCost(), (size_t)0 );
+	}
+
+	static tbb::atomic<int> g_numSlowGets;
+
+	static IntDataPtr slowGet( int key, size_t &cost )
+	{
+		g_numSlowGets++;
+		tbb::this_tbb_thread::sleep( tbb::tick_count::interval_t( 0.01 ) );
+		cost = 1;
+		return new IntData( key );
+	}
+
+	void testShardedComputesOnce()
+	{
+		// concurrent misses on the same key must only call the getter once
+		g_numSlowGets = 0;
+		ShardedLRUCache<int, IntDataPtr> cache( slowGet, 1000 );
+		parallel_for( blocked_range<size_t>( 0, 1000 ), GetFromCacheModulo<ShardedLRUCache<int, IntDataPtr> >( cache, 10 ) );
+		BOOST_CHECK_EQUAL( (int)g_numSlowGets, 10 );
+	}
+
+	static IntDataPtr getEven( int key, size_t &cost )
+	{
+		if( key % 2 )
+		{
+			throw Exception( "Odd key" );
+		}
+		cost = 1;
+		return new IntData( key );
+	}
+
+	template<typename Cache>
+	static void checkPrefetch()
+	{
+		Cache cache( getEven, 1000 );
+
+		BOOST_CHECK( cache.prefetch( 2 ) );
+		BOOST_CHECK( cache.cached( 2 ) );
+		BOOST_CHECK( cache.prefetch( 2 ) );
+
+		// failed prefetches must not be remembered, so that get()
+		// reports the error from the getter rather than a previous
+		// failure.
+		for( int i = 0; i < 2; ++i )
+		{
+			BOOST_CHECK( !cache.prefetch( 1 ) );
+			BOOST_CHECK( !cache.cached( 1 ) );
+		}
+
+		try
+		{
+			cache.get( 1 );
+			BOOST_ERROR( "Expected exception" );
+		}
+		catch( const std::exception &e )
+		{
+			BOOST_CHECK_EQUAL( std::string( e.what() ), "Odd key" );
+		}
+
+		// but failed gets are still remembered.
+		BOOST_CHECK( !cache.prefetch( 1 ) );
+		BOOST_CHECK_THROW( cache.get( 1 ), Exception );
+	}
+
+	void testPrefetch()
+	{
+		checkPrefetch<LRUCache<int, IntDataPtr> >();
+		checkPrefetch<ShardedLRUCache<int, IntDataPtr> >();
+	}
+
+	template<typename Cache>
+	static void hits( Cache &cache )
+	{
+		parallel_for( blocked_range<size_t>( 0, 10000000 ), GetFromCacheModulo<Cache>( cache, 1000 ) );
+	}
+
+	template<typename Cache>
+	void benchmarkHits( const std::string &name )
+	{
+		Cache cache( get, 100000 );
+		parallel_for( blocked_range<size_t>( 0, 1000 ), GetFromCache<Cache>( cache ) );
+		benchmark( name, boost::bind( &LRUCacheThreadingTest::hits<Cache>, boost::ref( cache ) ) );
+	}
+
+	// Benchmarks concurrent cache hits with both cache implementations.
+	void testContention()
+	{
+		benchmarkHits<LRUCache<int, IntDataPtr> >( "LRUCache contended hits" );
+		benchmarkHits<ShardedLRUCache<int, IntDataPtr> >( "ShardedLRUCache contended hits" );
 	}
 };
 
 
+tbb::atomic<int> LRUCacheThreadingTest::g_numSlowGets;
+
 struct LRUCacheThreadingTestSuite : public boost::unit_test::test_suite
 {
 
@@ -99,6 +239,13 @@ struct LRUCacheThreadingTestSuite : public boost::unit_test::test_suite
 		boost::shared_ptr<LRUCacheThreadingTest> instance( new LRUCacheThreadingTest() );
 
 		add( BOOST_CLASS_TEST_CASE( &LRUCacheThreadingTest::test, instance ) );
+		add( BOOST_CLASS_TEST_CASE( &LRUCacheThreadingTest::testSharded, instance ) );
+		add( BOOST_CLASS_TEST_CASE( &LRUCacheThreadingTest::testShardedComputesOnce, instance ) );
+		add( BOOST_CLASS_TEST_CASE( &LRUCacheThreadingTest::testPrefetch, instance ) );
+		if( benchmarksEnabled() )
+		{
+			add( BOOST_CLASS_TEST_CASE( &LRUCacheThreadingTest::testContention, instance ) );
+		}
 	}
 };
 
@@ -67,3 +67,40 @@ class LensDistortOpTest(unittest.TestCase):
 
 		self.assertEqual( img.displayWindow, img2.displayWindow )
 		
+
+	def testFilters( self ) :
+
+		o = CompoundObject()
+		o["lensModel"] = StringData( "StandardRadialLensModel" )
+		o["distortion"] = DoubleData( 0.2 )
+		o["anamorphicSqueeze"] = DoubleData( 1. )
+		o["curvatureX"] = DoubleData( 0.2 )
+		o["curvatureY"] = DoubleData( 0.5 )
+		o["quarticDistortion"] = DoubleData( .1 )
+
+		img = EXRImageReader( "test/IECore/data/exrFiles/uvMapWithDataWindow.100x100.exr" ).read()
+
+		op = LensDistortOp()
+		op["input"] = img
+		op["mode"] = LensModel.Undistort
+		op["lensModel"].setValue( o )
+
+		op["filter"].setValue( WarpOp.FilterType.Bilinear )
+		bilinear = op()
+
+		for f in ( WarpOp.FilterType.None, WarpOp.FilterType.Bicubic, WarpOp.FilterType.Lanczos, WarpOp.FilterType.EWA ) :
+
+			op["filter"].setValue( f )
+			out = op()
+
+			self.assertEqual( out.dataWindow, bilinear.dataWindow )
+			self.assertEqual( out.displayWindow, bilinear.displayWindow )
+			self.assertEqual( set( out.keys() ), set( bilinear.keys() ) )
+			for k in out.keys() :
+				self.assertEqual( len( out[k].data ), len( bilinear[k].data ) )
+
+			# the uv map is smooth, so all the filters should give similar results
+			self.failIf( ImageDiffOp()( imageA = out, imageB = bilinear, maxError = 0.05 ).value )
+
+if __name__ == "__main__":
+	unittest.main()
@@ -0,0 +1,249 @@
+//////////////////////////////////////////////////////////////////////////
+//
+//  Copyright (c) 2013, Image Engine Design Inc. All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are
+//  met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//
+//     * Neither the name of Image Engine Design nor the names of any
+//       other contributors to this software may be used to endorse or
+//       promote products derived from this software without specific prior
+//       written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+//  IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+//  THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+//  PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+//  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+//  EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+//  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+//  PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+//  LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+//  NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//////////////////////////////////////////////////////////////////////////
+
+#include "boost/bind.hpp"
+
+#include "IECore/MeshPrimitive.h"
+#include "IECore/MeshAdjacency.h"
+#include "IECore/MeshNormalsOp.h"
+#include "IECore/CompoundParameter.h"
+#include "IECore/SimpleTypedParameter.h"
+#include "IECore/Exception.h"
+
+#include "MeshAdjacencyTest.h"
+#include "Benchmark.h"
+
+using namespace boost;
+using namespace boost::unit_test;
+using namespace Imath;
+
+namespace IECore
+{
+
+struct MeshAdjacencyTest
+{
+
+	void testBox()
+	{
+		MeshPrimitivePtr box = MeshPrimitive::createBox( Box3f( V3f( -1 ), V3f( 1 ) ) );
+		ConstMeshAdjacencyPtr adjacency = box->adjacency();
+
+		BOOST_CHECK_EQUAL( adjacency->numFaces(), 6u );
+		BOOST_CHECK_EQUAL( adjacency->numVertices(), 8u );
+
+		const std::vector<int> &faceOffsets = adjacency->faceOffsets();
+		BOOST_CHECK_EQUAL( faceOffsets.size(), 7u );
+		for( size_t f = 0; f < faceOffsets.size(); ++f )
+		{
+			BOOST_CHECK_EQUAL( faceOffsets[f], (int)f * 4 );
+		}
+
+		// every vertex of a box is used by exactly three faces, and
+		// the faces must be listed in increasing order.
+		const std::vector<int> &vertexIds = box->vertexIds()->readable();
+		const std::vector<int> &vertexFaceOffsets = adjacency->vertexFaceOffsets();
+		const std::vector<int> &vertexFaces = adjacency->vertexFaces();
+		const std::vector<int> &vertexFaceVertices = adjacency->vertexFaceVertices();
+		BOOST_CHECK_EQUAL( vertexFaceOffsets.size(), 9u );
+		for( int v = 0; v < 8; ++v )
+		{
+			BOOST_CHECK_EQUAL( vertexFaceOffsets[v+1] - vertexFaceOffsets[v], 3 );
+			for( int i = vertexFaceOffsets[v]; i < vertexFaceOffsets[v+1]; ++i )
+			{
+				BOOST_CHECK_EQUAL( vertexIds[vertexFaceVertices[i]], v );
+				BOOST_CHECK( vertexFaceVertices[i] >= faceOffsets[vertexFaces[i]] );
+				BOOST_CHECK( vertexFaceVertices[i] < faceOffsets[vertexFaces[i]+1] );
+				if( i > vertexFaceOffsets[v] )
+				{
+					BOOST_CHECK( vertexFaces[i] > vertexFaces[i-1] );
+				}
+			}
+		}
+
+		// edges are computed on demand
+		const size_t memoryWithoutEdges = adjacency->memoryUsage();
+		const std::vector<V2i> &edges = adjacency->edges();
+		BOOST_CHECK( adjacency->memoryUsage() > memoryWithoutEdges );
+		BOOST_CHECK( &adjacency->edges() == &edges );
+		BOOST_CHECK_EQUAL( edges.size(), 12u );
+		for( size_t i = 0; i < edges.size(); ++i )
+		{
+			BOOST_CHECK( edges[i].x < edges[i].y );
+			if( i > 0 )
+			{
+				BOOST_CHECK( edges[i-1].x < edges[i].x || ( edges[i-1].x == edges[i].x && edges[i-1].y < edges[i].y ) );
+			}
+		}
+	}
+
+	void testSharing()
+	{
+		MeshPrimitivePtr plane = MeshPrimitive::createPlane( Box2f( V2f( -1 ), V2f( 1 ) ), V2i( 10 ) );
+		ConstMeshAdjacencyPtr adjacency = plane->adjacency();
+		BOOST_CHECK( plane->adjacency() == adjacency );
+
+		// copies and meshes built from scratch with the same topology
+		// should share the same adjacency.
+		MeshPrimitivePtr planeCopy = plane->copy();
+		BOOST_CHECK( planeCopy->adjacency() == adjacency );
+
+		MeshPrimitivePtr otherPlane = MeshPrimitive::createPlane( Box2f( V2f( 0 ), V2f( 5 ) ), V2i( 10 ) );
+		BOOST_CHECK( otherPlane->adjacency() == adjacency );
+
+		MeshPrimitivePtr differentPlane = MeshPrimitive::createPlane( Box2f( V2f( -1 ), V2f( 1 ) ), V2i( 11 ) );
+		BOOST_CHECK( differentPlane->adjacency() != adjacency );
+
+		BOOST_CHECK( MeshAdjacency::cacheMemoryUsage() >= adjacency->memoryUsage() );
+
+		MeshAdjacency::clearCache();
+		BOOST_CHECK_EQUAL( MeshAdjacency::cacheMemoryUsage(), 0u );
+		BOOST_CHECK( plane->adjacency() != adjacency );
+	}
+
+	void testInvalidTopology()
+	{
+		std::vector<int> verticesPerFace( 1, 3 );
+		std::vector<int> vertexIds;
+		vertexIds.push_back( 0 );
+		vertexIds.push_back( 1 );
+		vertexIds.push_back( 3 );
+
+		MurmurHash h;
+		h.append( "testInvalidTopology" );
+
+		// invalid topology should be reported the same way every time,
+		// rather than as a failure recorded by the cache on the first call.
+		BOOST_CHECK_THROW( MeshAdjacency::cached( h, verticesPerFace, vertexIds, 3 ), InvalidArgumentException );
+		BOOST_CHECK_THROW( MeshAdjacency::cached( h, verticesPerFace, vertexIds, 3 ), InvalidArgumentException );
+
+		vertexIds.pop_back();
+		BOOST_CHECK_THROW( MeshAdjacency::cached( h, verticesPerFace, vertexIds, 3 ), InvalidArgumentException );
+		BOOST_CHECK_THROW( MeshAdjacency::cached( h, verticesPerFace, vertexIds, 3 ), InvalidArgumentException );
+	}
+
+	static V3fVectorDataPtr serialNormals( const MeshPrimitive *mesh )
+	{
+		const std::vector<V3f> &points = mesh->variableData<V3fVectorData>( "P" )->readable();
+		const std::vector<int> &vertsPerFace = mesh->verticesPerFace()->readable();
+		const std::vector<int> &vertIds = mesh->vertexIds()->readable();
+
+		V3fVectorDataPtr result = new V3fVectorData;
+		std::vector<V3f> &normals = result->writable();
+		normals.resize( points.size(), V3f( 0 ) );
+
+		const int *vertId = &(vertIds[0]);
+		for( std::vector<int>::const_iterator it = vertsPerFace.begin(); it!=vertsPerFace.end(); it++ )
+		{
+			const V3f &p0 = points[*vertId];
+			const V3f &p1 = points[*(vertId+1)];
+			const V3f &p2 = points[*(vertId+2)];
+
+			V3f normal = (p2-p1).cross(p0-p1);
+			normal.normalize();
+			for( int i=0; i<*it; i++ )
+			{
+				normals[*vertId] += normal;
+				vertId++;
+			}
+		}
+
+		for( std::vector<V3f>::iterator it=normals.begin(); it!=normals.end(); it++ )
+		{
+			it->normalize();
+		}
+
+		return result;
+	}
+
+	static ConstV3fVectorDataPtr parallelNormals( const MeshPrimitive *mesh )
+	{
+		MeshNormalsOpPtr op = new MeshNormalsOp;
+		op->inputParameter()->setValue( const_cast<MeshPrimitive *>( mesh ) );
+		op->copyParameter()->setTypedValue( true );
+		MeshPrimitivePtr result = runTimeCast<MeshPrimitive>( op->operate() );
+		return result->variableData<V3fVectorData>( "N" );
+	}
+
+	void testNormalsMatchSerial()
+	{
+		MeshPrimitivePtr sphere = MeshPrimitive::createSphere( 1.0f, -1.0f, 1.0f, 360.0f, V2i( 100, 200 ) );
+
+		V3fVectorDataPtr expected = serialNormals( sphere );
+		ConstV3fVectorDataPtr normals = parallelNormals( sphere );
+
+		// the adjacency visits faces in the same order as the serial
+		// loop, so the results should be identical, not just close.
+		BOOST_CHECK( normals->readable() == expected->readable() );
+	}
+
+	// Benchmarks building the adjacency and the serial computation of
+	// normals, and MeshNormalsOp for increasing numbers of threads.
+	void testPerformance()
+	{
+		MeshPrimitivePtr sphere = MeshPrimitive::createSphere( 1.0f, -1.0f, 1.0f, 360.0f, V2i( 1000, 2000 ) );
+
+		benchmark( "Serial normals", boost::bind( &MeshAdjacencyTest::serialNormals, sphere.get() ) );
+
+		MeshAdjacency::clearCache();
+		benchmark( "Building adjacency", boost::bind( &MeshPrimitive::adjacency, sphere.get() ) );
+
+		benchmarkThreads( "MeshNormalsOp with cached adjacency", boost::bind( &MeshAdjacencyTest::parallelNormals, sphere.get() ) );
+	}
+
+};
+
+struct MeshAdjacencyTestSuite : public boost::unit_test::test_suite
+{
+
+	MeshAdjacencyTestSuite() : boost::unit_test::test_suite( "MeshAdjacencyTestSuite" )
+	{
+		boost::shared_ptr<MeshAdjacencyTest> instance( new MeshAdjacencyTest() );
+
+		add( BOOST_CLASS_TEST_CASE( &MeshAdjacencyTest::testBox, instance ) );
+		add( BOOST_CLASS_TEST_CASE( &MeshAdjacencyTest::testSharing, instance ) );
+		add( BOOST_CLASS_TEST_CASE( &MeshAdjacencyTest::testInvalidTopology, instance ) );
+		add( BOOST_CLASS_TEST_CASE( &MeshAdjacencyTest::testNormalsMatchSerial, instance ) );
+		if( benchmarksEnabled() )
+		{
+			add( BOOST_CLASS_TEST_CASE( &MeshAdjacencyTest::testPerformance, instance ) );
+		}
+	}
+};
+
+void addMeshAdjacencyTest( boost::unit_test::test_suite *test )
+{
+	test->add( new MeshAdjacencyTestSuite( ) );
+}
+
+} // namespace IECore
@@ -374,6 +374,36 @@ class TestMeshPrimitiveEvaluator( unittest.TestCase ) :
 					hits = mpe.intersectionPoints( origin, direction )
 					self.failIf( hits )
 
+	def testBVHRayAccelerator( self ) :
+
+		m = Reader.create( "test/IECore/data/cobFiles/pSphereShape1.cob" ).read()
+
+		kdEvaluator = MeshPrimitiveEvaluator( m )
+		bvhEvaluator = MeshPrimitiveEvaluator( m, MeshPrimitiveEvaluator.RayAccelerator.BVH )
+
+		kdResult = kdEvaluator.createResult()
+		bvhResult = bvhEvaluator.createResult()
+
+		rand = Rand48( 10 )
+		for i in range( 0, 1000 ) :
+
+			origin = Rand48.solidSpheref( rand ) * 3
+			direction = Rand48.hollowSpheref( rand )
+
+			hit = kdEvaluator.intersectionPoint( origin, direction, kdResult )
+			self.assertEqual( bvhEvaluator.intersectionPoint( origin, direction, bvhResult ), hit )
+			if hit :
+				# compare positions rather than triangle indices, as rays hitting
+				# an edge may legitimately report either triangle
+				self.failUnless( bvhResult.point().equalWithAbsError( kdResult.point(), 0.00001 ) )
+
+			kdHits = kdEvaluator.intersectionPoints( origin, direction )
+			bvhHits = bvhEvaluator.intersectionPoints( origin, direction )
+			self.assertEqual( sorted( [ h.triangleIndex() for h in bvhHits ] ), sorted( [ h.triangleIndex() for h in kdHits ] ) )
+
+			# maximum distance should be respected
+			self.assertEqual( len( bvhEvaluator.intersectionPoints( origin, direction, 0.5 ) ), len( kdEvaluator.intersectionPoints( origin, direction, 0.5 ) ) )
+
 if __name__ == "__main__":
 	unittest.main()
 
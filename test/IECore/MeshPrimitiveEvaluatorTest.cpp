@@ -0,0 +1,227 @@
+//////////////////////////////////////////////////////////////////////////
+//
+//  Copyright (c) 2013, Image Engine Design Inc. All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are
+//  met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//
+//     * Neither the name of Image Engine Design nor the names of any
+//       other contributors to this software may be used to endorse or
+//       promote products derived from this software without specific prior
+//       written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+//  IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+//  THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+//  PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+//  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+//  EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+//  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+//  PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+//  LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+//  NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//////////////////////////////////////////////////////////////////////////
+
+#include "OpenEXR/ImathRandom.h"
+
+#include "IECore/MeshPrimitiveEvaluator.h"
+#include "IECore/MeshPrimitive.h"
+
+#include "MeshPrimitiveEvaluatorTest.h"
+
+using namespace boost;
+using namespace boost::unit_test;
+using namespace Imath;
+
+namespace IECore
+{
+
+struct MeshPrimitiveEvaluatorTest
+{
+
+	MeshPrimitivePtr makeMesh( unsigned numTriangles )
+	{
+		Rand32 rand;
+
+		IntVectorDataPtr verticesPerFaceData = new IntVectorData;
+		IntVectorDataPtr vertexIdsData = new IntVectorData;
+		V3fVectorDataPtr pointsData = new V3fVectorData;
+		std::vector<int> &verticesPerFace = verticesPerFaceData->writable();
+		std::vector<int> &vertexIds = vertexIdsData->writable();
+		std::vector<V3f> &points = pointsData->writable();
+		for( unsigned i = 0; i < numTriangles; ++i )
+		{
+			const V3f center( rand.nextf(), rand.nextf(), rand.nextf() );
+			verticesPerFace.push_back( 3 );
+			for( unsigned j = 0; j < 3; ++j )
+			{
+				vertexIds.push_back( points.size() );
+				points.push_back( center + V3f( rand.nextf( -0.02, 0.02 ), rand.nextf( -0.02, 0.02 ), rand.nextf( -0.02, 0.02 ) ) );
+			}
+		}
+
+		return new MeshPrimitive( verticesPerFaceData, vertexIdsData, "linear", pointsData );
+	}
+
+	void makeRays( unsigned numRays, std::vector<V3f> &origins, std::vector<V3f> &directions )
+	{
+		Rand32 rand;
+		origins.resize( numRays );
+		directions.resize( numRays );
+		for( unsigned i = 0; i < numRays; ++i )
+		{
+			origins[i] = V3f( rand.nextf( -0.5, 1.5 ), rand.nextf( -0.5, 1.5 ), rand.nextf( -0.5, 1.5 ) );
+			directions[i] = V3f( 0.5 ) - origins[i] + V3f( rand.nextf( -0.5, 0.5 ), rand.nextf( -0.5, 0.5 ), rand.nextf( -0.5, 0.5 ) );
+		}
+	}
+
+	void testBVHMatchesKDTree()
+	{
+		MeshPrimitivePtr mesh = makeMesh( 10000 );
+		MeshPrimitiveEvaluatorPtr kdEvaluator = new MeshPrimitiveEvaluator( mesh );
+		MeshPrimitiveEvaluatorPtr bvhEvaluator = new MeshPrimitiveEvaluator( mesh, MeshPrimitiveEvaluator::BVHRayAccelerator );
+		BOOST_CHECK( !kdEvaluator->boundingVolumeHierarchy() );
+		BOOST_CHECK( bvhEvaluator->boundingVolumeHierarchy() );
+
+		std::vector<V3f> origins, directions;
+		makeRays( 1000, origins, directions );
+
+		PrimitiveEvaluator::ResultPtr kdResult = kdEvaluator->createResult();
+		PrimitiveEvaluator::ResultPtr bvhResult = bvhEvaluator->createResult();
+		std::vector<PrimitiveEvaluator::ResultPtr> kdResults, bvhResults;
+		for( size_t i = 0; i < origins.size(); ++i )
+		{
+			bool hit = kdEvaluator->intersectionPoint( origins[i], directions[i], kdResult.get() );
+			BOOST_CHECK_EQUAL( hit, bvhEvaluator->intersectionPoint( origins[i], directions[i], bvhResult.get() ) );
+			if( hit )
+			{
+				BOOST_CHECK( kdResult->point().equalWithAbsError( bvhResult->point(), 0.00001 ) );
+			}
+
+			BOOST_CHECK_EQUAL(
+				kdEvaluator->intersectionPoints( origins[i], directions[i], kdResults ),
+				bvhEvaluator->intersectionPoints( origins[i], directions[i], bvhResults )
+			);
+		}
+	}
+
+	void testBatchIntersectionPoints()
+	{
+		MeshPrimitivePtr mesh = makeMesh( 10000 );
+		std::vector<V3f> origins, directions;
+		makeRays( 10000, origins, directions );
+
+		for( int accelerator = MeshPrimitiveEvaluator::KDTreeRayAccelerator; accelerator <= MeshPrimitiveEvaluator::BVHRayAccelerator; ++accelerator )
+		{
+			MeshPrimitiveEvaluatorPtr evaluator = new MeshPrimitiveEvaluator( mesh, (MeshPrimitiveEvaluator::RayAccelerator)accelerator );
+
+			std::vector<PrimitiveEvaluator::ResultPtr> results;
+			int numHits = evaluator->intersectionPoints( origins, directions, results );
+			BOOST_CHECK_EQUAL( results.size(), origins.size() );
+			BOOST_CHECK( numHits > 0 );
+
+			int expectedNumHits = 0;
+			PrimitiveEvaluator::ResultPtr result = evaluator->createResult();
+			for( size_t i = 0; i < origins.size(); ++i )
+			{
+				bool hit = evaluator->intersectionPoint( origins[i], directions[i], result.get() );
+				BOOST_CHECK_EQUAL( hit, (bool)results[i] );
+				if( hit && results[i] )
+				{
+					expectedNumHits++;
+					BOOST_CHECK( result->point() == results[i]->point() );
+				}
+			}
+			BOOST_CHECK_EQUAL( numHits, expectedNumHits );
+		}
+
+		MeshPrimitiveEvaluatorPtr evaluator = new MeshPrimitiveEvaluator( mesh );
+		std::vector<PrimitiveEvaluator::ResultPtr> results;
+		origins.pop_back();
+		BOOST_CHECK_THROW( evaluator->intersectionPoints( origins, directions, results ), InvalidArgumentException );
+	}
+
+	void testBatchClosestPoints()
+	{
+		MeshPrimitivePtr mesh = makeMesh( 10000 );
+		MeshPrimitiveEvaluatorPtr evaluator = new MeshPrimitiveEvaluator( mesh );
+
+		Rand32 rand;
+		std::vector<V3f> points( 10000 );
+		for( size_t i = 0; i < points.size(); ++i )
+		{
+			points[i] = V3f( rand.nextf( -0.5, 1.5 ), rand.nextf( -0.5, 1.5 ), rand.nextf( -0.5, 1.5 ) );
+		}
+
+		std::vector<V3f> positions, normals, barycentricCoordinates;
+		std::vector<V2f> uvs;
+		std::vector<unsigned> triangleIndices;
+		BOOST_CHECK( evaluator->closestPoints( points, &positions, &normals, &uvs, &triangleIndices, &barycentricCoordinates ) );
+		BOOST_CHECK_EQUAL( positions.size(), points.size() );
+		BOOST_CHECK_EQUAL( normals.size(), points.size() );
+		BOOST_CHECK_EQUAL( uvs.size(), points.size() );
+		BOOST_CHECK_EQUAL( triangleIndices.size(), points.size() );
+		BOOST_CHECK_EQUAL( barycentricCoordinates.size(), points.size() );
+
+		std::vector<float> distances;
+		BOOST_CHECK( evaluator->signedDistances( points, distances ) );
+		BOOST_CHECK_EQUAL( distances.size(), points.size() );
+
+		PrimitiveEvaluator::ResultPtr result = evaluator->createResult();
+		const MeshPrimitiveEvaluator::Result *meshResult = static_cast<const MeshPrimitiveEvaluator::Result *>( result.get() );
+		for( size_t i = 0; i < points.size(); ++i )
+		{
+			evaluator->closestPoint( points[i], result.get() );
+			BOOST_CHECK( positions[i] == meshResult->point() );
+			BOOST_CHECK( normals[i] == meshResult->normal() );
+			BOOST_CHECK( uvs[i] == V2f( 0 ) );
+			BOOST_CHECK_EQUAL( triangleIndices[i], meshResult->triangleIndex() );
+			BOOST_CHECK( barycentricCoordinates[i] == meshResult->barycentricCoordinates() );
+
+			float distance = 0;
+			evaluator->signedDistance( points[i], distance );
+			BOOST_CHECK_EQUAL( distances[i], distance );
+		}
+
+		// outputs which aren't wanted may be omitted
+		std::vector<unsigned> triangleIndicesOnly;
+		BOOST_CHECK( evaluator->closestPoints( points, 0, 0, 0, &triangleIndicesOnly ) );
+		BOOST_CHECK( triangleIndicesOnly == triangleIndices );
+
+		// and empty meshes give no results
+		MeshPrimitivePtr emptyMesh = new MeshPrimitive( new IntVectorData, new IntVectorData, "linear", new V3fVectorData );
+		MeshPrimitiveEvaluatorPtr emptyEvaluator = new MeshPrimitiveEvaluator( emptyMesh );
+		BOOST_CHECK( !emptyEvaluator->closestPoints( points, &positions ) );
+	}
+
+};
+
+struct MeshPrimitiveEvaluatorTestSuite : public boost::unit_test::test_suite
+{
+
+	MeshPrimitiveEvaluatorTestSuite() : boost::unit_test::test_suite( "MeshPrimitiveEvaluatorTestSuite" )
+	{
+		boost::shared_ptr<MeshPrimitiveEvaluatorTest> instance( new MeshPrimitiveEvaluatorTest() );
+
+		add( BOOST_CLASS_TEST_CASE( &MeshPrimitiveEvaluatorTest::testBVHMatchesKDTree, instance ) );
+		add( BOOST_CLASS_TEST_CASE( &MeshPrimitiveEvaluatorTest::testBatchIntersectionPoints, instance ) );
+		add( BOOST_CLASS_TEST_CASE( &MeshPrimitiveEvaluatorTest::testBatchClosestPoints, instance ) );
+	}
+};
+
+void addMeshPrimitiveEvaluatorTest( boost::unit_test::test_suite *test )
+{
+	test->add( new MeshPrimitiveEvaluatorTestSuite( ) );
+}
+
+} // namespace IECore
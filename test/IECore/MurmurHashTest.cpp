@@ -0,0 +1,153 @@
+//////////////////////////////////////////////////////////////////////////
+//
+//  Copyright (c) 2013, Image Engine Design Inc. All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are
+//  met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//
+//     * Neither the name of Image Engine Design nor the names of any
+//       other contributors to this software may be used to endorse or
+//       promote products derived from this software without specific prior
+//       written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+//  IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+//  THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+//  PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+//  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+//  EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+//  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+//  PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+//  LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+//  NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//////////////////////////////////////////////////////////////////////////
+
+#include "boost/bind.hpp"
+
+#include "tbb/tbb.h"
+#include "tbb/task_scheduler_init.h"
+
+#include "IECore/MurmurHash.h"
+#include "IECore/VectorTypedData.h"
+
+#include "MurmurHashTest.h"
+#include "Benchmark.h"
+
+using namespace boost;
+using namespace boost::unit_test;
+using namespace tbb;
+using namespace Imath;
+
+namespace IECore
+{
+
+struct MurmurHashTest
+{
+
+	void testChunkedHashIsDeterministic()
+	{
+		// large enough to be hashed in parallel chunks, and not
+		// a whole number of chunks - a little over 5MB.
+		std::vector<float> data( 5 * 256 * 1024 + 17 );
+		for( size_t i = 0; i < data.size(); ++i )
+		{
+			data[i] = i;
+		}
+
+		MurmurHash expected;
+		{
+			task_scheduler_init init( 1 );
+			expected.append( &data[0], data.size() );
+		}
+
+		const int maxThreads = task_scheduler_init::default_num_threads();
+		for( int numThreads = 2; numThreads <= std::max( maxThreads, 2 ); numThreads *= 2 )
+		{
+			task_scheduler_init init( numThreads );
+			for( int i = 0; i < 10; ++i )
+			{
+				MurmurHash h;
+				h.append( &data[0], data.size() );
+				BOOST_CHECK_EQUAL( h, expected );
+			}
+		}
+
+		// changing a single element must change the hash
+		data[data.size() / 2] += 1.0f;
+		MurmurHash h;
+		h.append( &data[0], data.size() );
+		BOOST_CHECK( h != expected );
+
+		// and so must appending the same data to a different hash
+		MurmurHash h2;
+		h2.append( 1 );
+		h2.append( &data[0], data.size() );
+		BOOST_CHECK( h2 != h );
+	}
+
+	void testVectorDataHash()
+	{
+		V3fVectorDataPtr data = new V3fVectorData;
+		data->writable().resize( 1000000, V3f( 1, 2, 3 ) );
+		MurmurHash h = data->Object::hash();
+
+		V3fVectorDataPtr data2 = data->copy();
+		BOOST_CHECK_EQUAL( data2->Object::hash(), h );
+
+		data2->writable()[999999] = V3f( 3, 2, 1 );
+		BOOST_CHECK( data2->Object::hash() != h );
+	}
+
+	static void hashData( const std::vector<char> &data )
+	{
+		MurmurHash h;
+		h.append( &data[0], data.size() );
+	}
+
+	// Benchmarks hashing a large buffer for increasing
+	// numbers of threads, so the scaling can be observed.
+	void testChunkedHashPerformance()
+	{
+		std::vector<char> data( 1024 * 1024 * 1024 );
+		for( size_t i = 0; i < data.size(); ++i )
+		{
+			data[i] = i % 251;
+		}
+
+		benchmarkThreads( "MurmurHash of 1GB", boost::bind( &MurmurHashTest::hashData, boost::cref( data ) ) );
+	}
+
+};
+
+struct MurmurHashTestSuite : public boost::unit_test::test_suite
+{
+
+	MurmurHashTestSuite() : boost::unit_test::test_suite( "MurmurHashTestSuite" )
+	{
+		boost::shared_ptr<MurmurHashTest> instance( new MurmurHashTest() );
+
+		add( BOOST_CLASS_TEST_CASE( &MurmurHashTest::testChunkedHashIsDeterministic, instance ) );
+		add( BOOST_CLASS_TEST_CASE( &MurmurHashTest::testVectorDataHash, instance ) );
+		if( benchmarksEnabled() )
+		{
+			add( BOOST_CLASS_TEST_CASE( &MurmurHashTest::testChunkedHashPerformance, instance ) );
+		}
+	}
+};
+
+void addMurmurHashTest( boost::unit_test::test_suite *test )
+{
+	test->add( new MurmurHashTestSuite( ) );
+}
+
+} // namespace IECore
@@ -0,0 +1,227 @@
+//////////////////////////////////////////////////////////////////////////
+//
+//  Copyright (c) 2013, Image Engine Design Inc. All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are
+//  met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//
+//     * Neither the name of Image Engine Design nor the names of any
+//       other contributors to this software may be used to endorse or
+//       promote products derived from this software without specific prior
+//       written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+//  IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+//  THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+//  PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+//  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+//  EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+//  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+//  PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+//  LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+//  NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//////////////////////////////////////////////////////////////////////////
+
+#include "boost/format.hpp"
+#include "boost/bind.hpp"
+
+#include "OpenEXR/ImathRandom.h"
+#include "OpenEXR/ImathEuler.h"
+
+#include "IECore/PointSmoothSkinningOp.h"
+#include "IECore/SmoothSkinningData.h"
+#include "IECore/PointsPrimitive.h"
+#include "IECore/CompoundParameter.h"
+
+#include "PointSmoothSkinningOpTest.h"
+#include "Benchmark.h"
+
+using namespace boost;
+using namespace boost::unit_test;
+using namespace Imath;
+
+namespace IECore
+{
+
+struct PointSmoothSkinningOpTest
+{
+
+	PointSmoothSkinningOpTest( int numPoints )
+	{
+		const int numInfluences = 60;
+		const int influencesPerPoint = 4;
+
+		Rand32 rand( 10 );
+
+		StringVectorDataPtr names = new StringVectorData;
+		M44fVectorDataPtr influencePose = new M44fVectorData;
+		m_pose = new M44fVectorData;
+		for( int i = 0; i < numInfluences; ++i )
+		{
+			names->writable().push_back( str( format( "joint%d" ) % i ) );
+			const V3f t( rand.nextf( -1, 1 ), rand.nextf( -1, 1 ), rand.nextf( -1, 1 ) );
+			influencePose->writable().push_back( M44f().setTranslation( t ).inverse() );
+			const Eulerf r( rand.nextf( -1, 1 ), rand.nextf( -1, 1 ), rand.nextf( -1, 1 ) );
+			m_pose->writable().push_back( r.toMatrix44() * M44f().setTranslation( t ) );
+		}
+
+		IntVectorDataPtr offsets = new IntVectorData;
+		IntVectorDataPtr counts = new IntVectorData;
+		IntVectorDataPtr indices = new IntVectorData;
+		FloatVectorDataPtr weights = new FloatVectorData;
+		V3fVectorDataPtr p = new V3fVectorData;
+		V3fVectorDataPtr n = new V3fVectorData;
+		for( int i = 0; i < numPoints; ++i )
+		{
+			offsets->writable().push_back( indices->readable().size() );
+			counts->writable().push_back( influencesPerPoint );
+			float totalWeight = 0;
+			std::vector<float> w;
+			for( int j = 0; j < influencesPerPoint; ++j )
+			{
+				indices->writable().push_back( rand.nexti() % numInfluences );
+				w.push_back( rand.nextf( 0.1, 1 ) );
+				totalWeight += w.back();
+			}
+			for( int j = 0; j < influencesPerPoint; ++j )
+			{
+				weights->writable().push_back( w[j] / totalWeight );
+			}
+			p->writable().push_back( V3f( rand.nextf( -1, 1 ), rand.nextf( -1, 1 ), rand.nextf( -1, 1 ) ) );
+			n->writable().push_back( V3f( rand.nextf( -1, 1 ), rand.nextf( -1, 1 ), rand.nextf( -1, 1 ) ).normalized() );
+		}
+
+		m_ssd = new SmoothSkinningData( names, influencePose, offsets, counts, indices, weights );
+
+		m_points = new PointsPrimitive( p );
+		m_points->variables["N"] = PrimitiveVariable( PrimitiveVariable::Vertex, n );
+	}
+
+	PrimitivePtr skin( PointSmoothSkinningOp::Blend blend )
+	{
+		PointSmoothSkinningOpPtr op = new PointSmoothSkinningOp;
+		op->inputParameter()->setValue( m_points );
+		op->smoothSkinningDataParameter()->setValue( m_ssd );
+		op->deformationPoseParameter()->setValue( m_pose );
+		op->deformNormalsParameter()->setTypedValue( true );
+		op->blendParameter()->setNumericValue( blend );
+		return runTimeCast<Primitive>( op->operate() );
+	}
+
+	// The serial implementation which PointSmoothSkinningOp used before
+	// it was parallelised, for comparison.
+	void referenceSkin( std::vector<V3f> &p, std::vector<V3f> &n )
+	{
+		std::vector<M44f> skin;
+		for( size_t i = 0; i < m_pose->readable().size(); ++i )
+		{
+			skin.push_back( m_ssd->influencePose()->readable()[i] * m_pose->readable()[i] );
+		}
+
+		for( size_t i = 0; i < p.size(); ++i )
+		{
+			V3f pNew( 0 );
+			const int offset = m_ssd->pointIndexOffsets()->readable()[i];
+			const int count = m_ssd->pointInfluenceCounts()->readable()[i];
+			for( int j = offset; j < offset + count; ++j )
+			{
+				pNew += p[i] * skin[m_ssd->pointInfluenceIndices()->readable()[j]] * m_ssd->pointInfluenceWeights()->readable()[j];
+			}
+			p[i] = pNew;
+		}
+
+		for( size_t i = 0; i < n.size(); ++i )
+		{
+			V3f nNew( 0 ), nSkinned;
+			const int offset = m_ssd->pointIndexOffsets()->readable()[i];
+			const int count = m_ssd->pointInfluenceCounts()->readable()[i];
+			for( int j = offset; j < offset + count; ++j )
+			{
+				skin[m_ssd->pointInfluenceIndices()->readable()[j]].multDirMatrix( n[i], nSkinned );
+				nNew += nSkinned * m_ssd->pointInfluenceWeights()->readable()[j];
+			}
+			n[i] = nNew;
+		}
+	}
+
+	void testLinearMatchesReference()
+	{
+		std::vector<V3f> p = m_points->variableData<V3fVectorData>( "P" )->readable();
+		std::vector<V3f> n = m_points->variableData<V3fVectorData>( "N" )->readable();
+		referenceSkin( p, n );
+
+		PrimitivePtr result = skin( PointSmoothSkinningOp::Linear );
+		const std::vector<V3f> &resultP = result->variableData<V3fVectorData>( "P" )->readable();
+		const std::vector<V3f> &resultN = result->variableData<V3fVectorData>( "N" )->readable();
+		BOOST_CHECK_EQUAL( resultP.size(), p.size() );
+		for( size_t i = 0; i < p.size(); ++i )
+		{
+			BOOST_CHECK( resultP[i].equalWithAbsError( p[i], 0.0001f ) );
+			BOOST_CHECK( resultN[i].equalWithAbsError( n[i], 0.0001f ) );
+		}
+	}
+
+	void testDualQuaternionPreservesLength()
+	{
+		// all the skinning transforms are rigid, so normals keep
+		// their length under dual quaternion blending.
+		PrimitivePtr result = skin( PointSmoothSkinningOp::DualQuaternion );
+		const std::vector<V3f> &resultN = result->variableData<V3fVectorData>( "N" )->readable();
+		for( size_t i = 0; i < resultN.size(); ++i )
+		{
+			BOOST_CHECK_CLOSE( resultN[i].length(), 1.0f, 0.01f );
+		}
+	}
+
+	// Benchmarks the reference implementation, and the Linear and
+	// DualQuaternion blending for increasing numbers of threads.
+	void testPerformance()
+	{
+		std::vector<V3f> p = m_points->variableData<V3fVectorData>( "P" )->readable();
+		std::vector<V3f> n = m_points->variableData<V3fVectorData>( "N" )->readable();
+		benchmark( "PointSmoothSkinningOp reference implementation for 1M points", boost::bind( &PointSmoothSkinningOpTest::referenceSkin, this, boost::ref( p ), boost::ref( n ) ) );
+
+		benchmarkThreads( "PointSmoothSkinningOp (Linear) for 1M points", boost::bind( &PointSmoothSkinningOpTest::skin, this, PointSmoothSkinningOp::Linear ) );
+		benchmarkThreads( "PointSmoothSkinningOp (DualQuaternion) for 1M points", boost::bind( &PointSmoothSkinningOpTest::skin, this, PointSmoothSkinningOp::DualQuaternion ) );
+	}
+
+	SmoothSkinningDataPtr m_ssd;
+	M44fVectorDataPtr m_pose;
+	PointsPrimitivePtr m_points;
+
+};
+
+struct PointSmoothSkinningOpTestSuite : public boost::unit_test::test_suite
+{
+
+	PointSmoothSkinningOpTestSuite() : boost::unit_test::test_suite( "PointSmoothSkinningOpTestSuite" )
+	{
+		boost::shared_ptr<PointSmoothSkinningOpTest> instance( new PointSmoothSkinningOpTest( 10000 ) );
+
+		add( BOOST_CLASS_TEST_CASE( &PointSmoothSkinningOpTest::testLinearMatchesReference, instance ) );
+		add( BOOST_CLASS_TEST_CASE( &PointSmoothSkinningOpTest::testDualQuaternionPreservesLength, instance ) );
+
+		if( benchmarksEnabled() )
+		{
+			boost::shared_ptr<PointSmoothSkinningOpTest> benchmarkInstance( new PointSmoothSkinningOpTest( 1000000 ) );
+			add( BOOST_CLASS_TEST_CASE( &PointSmoothSkinningOpTest::testPerformance, benchmarkInstance ) );
+		}
+	}
+};
+
+void addPointSmoothSkinningOpTest( boost::unit_test::test_suite *test )
+{
+	test->add( new PointSmoothSkinningOpTestSuite( ) );
+}
+
+} // namespace IECore
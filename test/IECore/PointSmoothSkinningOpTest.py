@@ -33,6 +33,7 @@
 #
 ##########################################################################
 
+import math
 import unittest
 from IECore import *
 
@@ -215,6 +216,45 @@ class PointSmoothSkinningOpTest( unittest.TestCase ) :
 		o(input=pts, positionVar="bob", copyInput=False, deformationPose = self.myDP(), smoothSkinningData = self.mySSD( ))
 		self.assertNotEqual(pts["bob"].data , self.myP())
 
+	def testDualQuaternionMatchesLinearForRigidBlends( self ) :
+		# the test joints all share the same rotation, in which case dual quaternion
+		# blending is equivalent to linear blending
+		linear = self.myPP()
+		o = PointSmoothSkinningOp()
+		o( input = linear, copyInput = False, deformationPose = self.myDP(), smoothSkinningData = self.mySSD(), deformNormals = True, blend = PointSmoothSkinningOp.Blend.Linear )
+
+		dq = self.myPP()
+		o( input = dq, copyInput = False, deformationPose = self.myDP(), smoothSkinningData = self.mySSD(), deformNormals = True, blend = PointSmoothSkinningOp.Blend.DualQuaternion )
+
+		for i in range( 0, len( linear["P"].data ) ) :
+			self.failUnless( linear["P"].data[i].equalWithAbsError( dq["P"].data[i], 0.0001 ) )
+			self.failUnless( linear["N"].data[i].equalWithAbsError( dq["N"].data[i], 0.0001 ) )
+
+	def testDualQuaternionPreservesVolume( self ) :
+		# a point influenced equally by an unrotated joint and one rotated 90 degrees
+		ssd = SmoothSkinningData(
+			StringVectorData( [ "joint1", "joint2" ] ),
+			M44fVectorData( [ M44f(), M44f() ] ),
+			IntVectorData( [ 0 ] ),
+			IntVectorData( [ 2 ] ),
+			IntVectorData( [ 0, 1 ] ),
+			FloatVectorData( [ 0.5, 0.5 ] ),
+		)
+		pose = M44fVectorData( [ M44f(), M44f().rotate( V3f( math.pi / 2, 0, 0 ) ) ] )
+
+		o = PointSmoothSkinningOp()
+		results = {}
+		for blend in ( PointSmoothSkinningOp.Blend.Linear, PointSmoothSkinningOp.Blend.DualQuaternion ) :
+			pts = PointsPrimitive( V3fVectorData( [ V3f( 0, 1, 0 ) ] ) )
+			o( input = pts, copyInput = False, deformationPose = pose, smoothSkinningData = ssd, blend = blend )
+			results[blend] = pts["P"].data[0]
+
+		# linear blending collapses the point towards the joint, dual quaternion blending
+		# rotates it half way
+		self.assertAlmostEqual( results[PointSmoothSkinningOp.Blend.Linear].length(), math.sqrt( 0.5 ), 5 )
+		self.assertAlmostEqual( results[PointSmoothSkinningOp.Blend.DualQuaternion].length(), 1, 5 )
+		self.assertAlmostEqual( results[PointSmoothSkinningOp.Blend.DualQuaternion].y, math.sqrt( 0.5 ), 5 )
+
 if __name__ == "__main__":
 	unittest.main()
 
@@ -0,0 +1,173 @@
+//////////////////////////////////////////////////////////////////////////
+//
+//  Copyright (c) 2013, Image Engine Design Inc. All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are
+//  met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//
+//     * Neither the name of Image Engine Design nor the names of any
+//       other contributors to this software may be used to endorse or
+//       promote products derived from this software without specific prior
+//       written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+//  IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+//  THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+//  PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+//  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+//  EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+//  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+//  PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+//  LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+//  NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//////////////////////////////////////////////////////////////////////////
+
+#include "tbb/tbb.h"
+
+#include "OpenEXR/ImathRandom.h"
+
+#include "IECore/PointsPrimitiveEvaluator.h"
+#include "IECore/PointsPrimitive.h"
+
+#include "PointsPrimitiveEvaluatorTest.h"
+
+using namespace boost;
+using namespace boost::unit_test;
+using namespace tbb;
+using namespace Imath;
+
+namespace IECore
+{
+
+struct PointsPrimitiveEvaluatorTest
+{
+
+	// enough points that the tree is built using parallel tasks
+	static const size_t g_numPoints = 50000;
+
+	PointsPrimitiveEvaluatorPtr makeEvaluator()
+	{
+		Rand32 rand;
+
+		V3fVectorDataPtr pointsData = new V3fVectorData;
+		std::vector<V3f> &p = pointsData->writable();
+		p.resize( g_numPoints );
+		for( size_t i = 0; i < p.size(); ++i )
+		{
+			p[i] = V3f( rand.nextf(), rand.nextf(), rand.nextf() );
+		}
+
+		return new PointsPrimitiveEvaluator( new PointsPrimitive( pointsData ) );
+	}
+
+	void testBatchClosestPoints()
+	{
+		PointsPrimitiveEvaluatorPtr evaluator = makeEvaluator();
+		const std::vector<V3f> &p = evaluator->primitive()->variableData<V3fVectorData>( "P" )->readable();
+
+		Rand32 rand( 1 );
+
+		std::vector<V3f> queries( 10000 );
+		for( size_t i = 0; i < queries.size(); ++i )
+		{
+			queries[i] = V3f( rand.nextf( -0.5, 1.5 ), rand.nextf( -0.5, 1.5 ), rand.nextf( -0.5, 1.5 ) );
+		}
+
+		std::vector<V3f> positions;
+		std::vector<size_t> pointIndices;
+		BOOST_CHECK( evaluator->closestPoints( queries, &positions, &pointIndices ) );
+		BOOST_CHECK_EQUAL( positions.size(), queries.size() );
+		BOOST_CHECK_EQUAL( pointIndices.size(), queries.size() );
+
+		PrimitiveEvaluator::ResultPtr result = evaluator->createResult();
+		const PointsPrimitiveEvaluator::Result *pointsResult = static_cast<const PointsPrimitiveEvaluator::Result *>( result.get() );
+		for( size_t i = 0; i < queries.size(); ++i )
+		{
+			evaluator->closestPoint( queries[i], result.get() );
+			BOOST_CHECK_EQUAL( pointIndices[i], pointsResult->pointIndex() );
+			BOOST_CHECK( positions[i] == pointsResult->point() );
+			BOOST_CHECK( positions[i] == p[pointIndices[i]] );
+		}
+
+		// outputs which aren't wanted may be omitted
+		std::vector<size_t> pointIndicesOnly;
+		BOOST_CHECK( evaluator->closestPoints( queries, 0, &pointIndicesOnly ) );
+		BOOST_CHECK( pointIndicesOnly == pointIndices );
+
+		// and empty primitives give no results
+		PointsPrimitiveEvaluatorPtr emptyEvaluator = new PointsPrimitiveEvaluator( new PointsPrimitive( new V3fVectorData ) );
+		BOOST_CHECK( !emptyEvaluator->closestPoints( queries, &positions ) );
+	}
+
+	struct CheckClosestPoint
+	{
+		public :
+
+			CheckClosestPoint( const PointsPrimitiveEvaluator &evaluator )
+				:	m_evaluator( evaluator )
+			{
+			}
+
+			void operator()( const blocked_range<size_t> &r ) const
+			{
+				PrimitiveEvaluator::ResultPtr result = m_evaluator.createResult();
+				const std::vector<V3f> &p = m_evaluator.primitive()->variableData<V3fVectorData>( "P" )->readable();
+				for( size_t i=r.begin(); i!=r.end(); ++i )
+				{
+					// BOOST_CHECK isn't threadsafe, so we throw on errors instead
+					if( !m_evaluator.closestPoint( p[i], result.get() ) )
+					{
+						throw Exception( "Not OK." );
+					}
+					if( result->point() != p[i] )
+					{
+						throw Exception( "Closest point not found." );
+					}
+				}
+			}
+
+		private :
+
+			const PointsPrimitiveEvaluator &m_evaluator;
+
+	};
+
+	// the first queries are made from parallel tasks, so the tree is built
+	// from within them - while waiting for its own build tasks, a thread may
+	// pick up another query, which must not deadlock.
+	void testParallelClosestPoint()
+	{
+		PointsPrimitiveEvaluatorPtr evaluator = makeEvaluator();
+		parallel_for( blocked_range<size_t>( 0, g_numPoints ), CheckClosestPoint( *evaluator ) );
+	}
+
+};
+
+struct PointsPrimitiveEvaluatorTestSuite : public boost::unit_test::test_suite
+{
+
+	PointsPrimitiveEvaluatorTestSuite() : boost::unit_test::test_suite( "PointsPrimitiveEvaluatorTestSuite" )
+	{
+		boost::shared_ptr<PointsPrimitiveEvaluatorTest> instance( new PointsPrimitiveEvaluatorTest() );
+
+		add( BOOST_CLASS_TEST_CASE( &PointsPrimitiveEvaluatorTest::testBatchClosestPoints, instance ) );
+		add( BOOST_CLASS_TEST_CASE( &PointsPrimitiveEvaluatorTest::testParallelClosestPoint, instance ) );
+	}
+};
+
+void addPointsPrimitiveEvaluatorTest( boost::unit_test::test_suite *test )
+{
+	test->add( new PointsPrimitiveEvaluatorTestSuite( ) );
+}
+
+} // namespace IECore
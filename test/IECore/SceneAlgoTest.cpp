@@ -0,0 +1,158 @@
+//////////////////////////////////////////////////////////////////////////
+//
+//  Copyright (c) 2013, Image Engine Design Inc. All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are
+//  met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//
+//     * Neither the name of Image Engine Design nor the names of any
+//       other contributors to this software may be used to endorse or
+//       promote products derived from this software without specific prior
+//       written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+//  IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+//  THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+//  PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+//  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+//  EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+//  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+//  PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+//  LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+//  NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//////////////////////////////////////////////////////////////////////////
+
+#include "boost/format.hpp"
+
+#include "tbb/atomic.h"
+
+#include "IECore/SceneAlgo.h"
+#include "IECore/SceneCache.h"
+#include "IECore/SimpleTypedData.h"
+
+#include "SceneAlgoTest.h"
+
+using namespace boost;
+using namespace boost::unit_test;
+
+namespace IECore
+{
+
+struct SceneAlgoTest
+{
+
+	static const unsigned g_depth = 4;
+	static const unsigned g_numChildren = 6;
+
+	SceneAlgoTest()
+		:	m_fileName( "/tmp/sceneAlgoTest.scc" )
+	{
+		SceneInterfacePtr scene = new SceneCache( m_fileName, IndexedIO::Write );
+		writeLocations( scene.get(), 0 );
+	}
+
+	~SceneAlgoTest()
+	{
+		remove( m_fileName.c_str() );
+	}
+
+	static void writeLocations( SceneInterface *scene, unsigned depth )
+	{
+		if( depth == g_depth )
+		{
+			return;
+		}
+		for( unsigned i = 0; i < g_numChildren; i++ )
+		{
+			SceneInterfacePtr child = scene->createChild( SceneInterface::Name( ( boost::format( "child%d" ) % i ).str() ) );
+			child->writeTransform( new M44dData( Imath::M44d().translate( Imath::V3d( i, 0, 0 ) ) ), 0.0 );
+			writeLocations( child.get(), depth + 1 );
+		}
+	}
+
+	struct CountLocations
+	{
+		public :
+
+			CountLocations( tbb::atomic<size_t> &count, size_t maxDepth )
+				:	m_count( count ), m_maxDepth( maxDepth )
+			{
+			}
+
+			bool operator()( const SceneInterface *location, double time )
+			{
+				m_count++;
+				SceneInterface::Path path;
+				location->path( path );
+				return path.size() < m_maxDepth;
+			}
+
+		private :
+
+			tbb::atomic<size_t> &m_count;
+			size_t m_maxDepth;
+
+	};
+
+	static size_t numLocations( size_t depth )
+	{
+		size_t result = 1;
+		size_t level = 1;
+		for( size_t i = 0; i < depth; i++ )
+		{
+			level *= g_numChildren;
+			result += level;
+		}
+		return result;
+	}
+
+	void testVisitsAllLocations()
+	{
+		ConstSceneInterfacePtr scene = new SceneCache( m_fileName, IndexedIO::Read );
+		tbb::atomic<size_t> count;
+		count = 0;
+		parallelProcessLocations( scene.get(), CountLocations( count, g_depth ), 0.0 );
+		BOOST_CHECK_EQUAL( (size_t)count, numLocations( g_depth ) );
+	}
+
+	void testPruning()
+	{
+		ConstSceneInterfacePtr scene = new SceneCache( m_fileName, IndexedIO::Read );
+		tbb::atomic<size_t> count;
+		count = 0;
+		parallelProcessLocations( scene.get(), CountLocations( count, 2 ), 0.0 );
+		BOOST_CHECK_EQUAL( (size_t)count, numLocations( 2 ) );
+	}
+
+	std::string m_fileName;
+
+};
+
+struct SceneAlgoTestSuite : public boost::unit_test::test_suite
+{
+
+	SceneAlgoTestSuite() : boost::unit_test::test_suite( "SceneAlgoTestSuite" )
+	{
+		boost::shared_ptr<SceneAlgoTest> instance( new SceneAlgoTest() );
+
+		add( BOOST_CLASS_TEST_CASE( &SceneAlgoTest::testVisitsAllLocations, instance ) );
+		add( BOOST_CLASS_TEST_CASE( &SceneAlgoTest::testPruning, instance ) );
+	}
+};
+
+void addSceneAlgoTest(boost::unit_test::test_suite* test)
+{
+	test->add( new SceneAlgoTestSuite( ) );
+}
+
+} // namespace IECore
@@ -33,7 +33,9 @@
 ##########################################################################
 
 import gc
+import os
 import sys
+import time
 import math
 import unittest
 
@@ -636,6 +638,251 @@ class SceneCacheTest( unittest.TestCase ) :
 		self.assertTrue( B.hasTag( "ObjectType:SpherePrimitive" ) )
 		self.assertTrue( d.hasTag( "ObjectType:SpherePrimitive" ) )
 
+	def testTaggedLocations( self ) :
+
+		m = IECore.SceneCache( "/tmp/test.scc", IECore.IndexedIO.OpenMode.Write )
+		A = m.createChild( "A" )
+		a = A.createChild( "a" )
+		aa = a.createChild( "aa" )
+		ab = a.createChild( "ab" )
+		B = m.createChild( "B" )
+		b = B.createChild( "b" )
+		aa.writeTags( [ "t1" ] )
+		ab.writeTags( [ "t1", "t2" ] )
+		A.writeTags( [ "t1" ] )
+		b.writeTags( [ "t2" ] )
+		del m, A, a, aa, ab, B, b
+
+		m = IECore.SceneCache( "/tmp/test.scc", IECore.IndexedIO.OpenMode.Read )
+
+		def paths( scene, tag ) :
+			return sorted( [ "/" + "/".join( p ) for p in scene.taggedLocations( tag ) ] )
+
+		self.assertEqual( paths( m, "t1" ), [ "/A", "/A/a/aa", "/A/a/ab" ] )
+		self.assertEqual( paths( m, "t2" ), [ "/A/a/ab", "/B/b" ] )
+		self.assertEqual( paths( m, "t3" ), [] )
+		self.assertEqual( paths( m.scene( [ "A", "a" ] ), "t1" ), [ "/A/a/aa", "/A/a/ab" ] )
+		self.assertEqual( paths( m.scene( [ "A", "a", "aa" ] ), "t2" ), [] )
+		self.assertEqual( paths( m.child( "B" ), "t2" ), [ "/B/b" ] )
+
+	def testHash( self ) :
+
+		box = IECore.MeshPrimitive.createBox( IECore.Box3f( IECore.V3f( 0 ), IECore.V3f( 1 ) ) )
+		box2 = IECore.MeshPrimitive.createBox( IECore.Box3f( IECore.V3f( 0 ), IECore.V3f( 2 ) ) )
+
+		m = IECore.SceneCache( "/tmp/test.scc", IECore.IndexedIO.OpenMode.Write )
+		a = m.createChild( "a" )
+		a.writeObject( box, 0 )
+		a.writeObject( box, 1 )
+		a.writeObject( box2, 2 )
+		a.writeTransform( IECore.M44dData( IECore.M44d.createTranslated( IECore.V3d( 1, 0, 0 ) ) ), 0 )
+		a.writeAttribute( "w", IECore.BoolData( True ), 0 )
+		a.writeAttribute( "w", IECore.BoolData( True ), 1 )
+		a.writeAttribute( "w", IECore.BoolData( False ), 2 )
+		b = m.createChild( "b" )
+		b.writeObject( box, 0 )
+		del m, a, b
+
+		m = IECore.SceneCache( "/tmp/test.scc", IECore.IndexedIO.OpenMode.Read )
+		a = m.child( "a" )
+		b = m.child( "b" )
+
+		# the stored hashes match the hashes of the loaded data
+		self.assertEqual( a.hash( IECore.SceneInterface.HashType.ObjectHash, 0 ), IECore.MurmurHash().append( box.hash() ) )
+		self.assertEqual( a.hash( IECore.SceneInterface.HashType.ObjectHash, 2 ), IECore.MurmurHash().append( box2.hash() ) )
+		self.assertEqual( a.hash( IECore.SceneInterface.HashType.TransformHash, 0 ), IECore.MurmurHash().append( a.readTransform( 0 ).hash() ) )
+
+		# interpolating between equal samples doesn't change the hash
+		self.assertEqual( a.hash( IECore.SceneInterface.HashType.ObjectHash, 0.5 ), a.hash( IECore.SceneInterface.HashType.ObjectHash, 0 ) )
+		self.assertNotEqual( a.hash( IECore.SceneInterface.HashType.ObjectHash, 1.5 ), a.hash( IECore.SceneInterface.HashType.ObjectHash, 1 ) )
+		self.assertNotEqual( a.hash( IECore.SceneInterface.HashType.AttributesHash, 0 ), a.hash( IECore.SceneInterface.HashType.AttributesHash, 2 ) )
+
+		# equal data gives equal hashes in different locations
+		self.assertEqual( a.hash( IECore.SceneInterface.HashType.ObjectHash, 0 ), b.hash( IECore.SceneInterface.HashType.ObjectHash, 0 ) )
+		self.assertNotEqual( a.hash( IECore.SceneInterface.HashType.TransformHash, 0 ), b.hash( IECore.SceneInterface.HashType.TransformHash, 0 ) )
+
+		self.assertEqual( m.hash( IECore.SceneInterface.HashType.HierarchyHash, 0 ), m.hash( IECore.SceneInterface.HashType.HierarchyHash, 0.5 ) )
+		self.assertNotEqual( m.hash( IECore.SceneInterface.HashType.HierarchyHash, 0 ), m.hash( IECore.SceneInterface.HashType.HierarchyHash, 2 ) )
+		self.assertNotEqual( m.hash( IECore.SceneInterface.HashType.ChildNamesHash, 0 ), a.hash( IECore.SceneInterface.HashType.ChildNamesHash, 0 ) )
+
+	def testCacheMemoryLimits( self ) :
+
+		for cacheType in ( IECore.SceneCache.CacheType.Objects, IECore.SceneCache.CacheType.Attributes, IECore.SceneCache.CacheType.Transforms ) :
+			self.assertTrue( IECore.SceneCache.getCacheMemoryLimit( cacheType ) <= IECore.ObjectPool.defaultObjectPool().getMaxMemoryUsage() )
+
+		box = IECore.MeshPrimitive.createBox( IECore.Box3f( IECore.V3f( 0 ), IECore.V3f( 1 ) ) )
+
+		m = IECore.SceneCache( "/tmp/test.scc", IECore.IndexedIO.OpenMode.Write )
+		for i in range( 0, 10 ) :
+			c = m.createChild( str( i ) )
+			c.writeObject( box, 0 )
+		del m, c
+
+		oldLimit = IECore.SceneCache.getCacheMemoryLimit( IECore.SceneCache.CacheType.Objects )
+		IECore.SceneCache.setCacheMemoryLimit( IECore.SceneCache.CacheType.Objects, box.memoryUsage() * 3 )
+		try :
+			m = IECore.SceneCache( "/tmp/test.scc", IECore.IndexedIO.OpenMode.Read )
+			stats = m.cacheStatistics( IECore.SceneCache.CacheType.Objects )
+			self.assertEqual( stats["memoryLimit"].value, box.memoryUsage() * 3 )
+			self.assertEqual( stats["hits"].value, 0 )
+			self.assertEqual( stats["misses"].value, 0 )
+
+			c = m.child( "0" )
+			self.assertEqual( c.readObjectAtSample( 0 ), box )
+			self.assertEqual( c.readObjectAtSample( 0 ), box )
+			stats = m.cacheStatistics( IECore.SceneCache.CacheType.Objects )
+			self.assertEqual( stats["misses"].value, 1 )
+			self.assertEqual( stats["hits"].value, 1 )
+			self.assertEqual( stats["evictions"].value, 0 )
+
+			for i in range( 1, 10 ) :
+				m.child( str( i ) ).readObjectAtSample( 0 )
+
+			stats = m.cacheStatistics( IECore.SceneCache.CacheType.Objects )
+			self.assertTrue( stats["evictions"].value > 0 )
+			self.assertTrue( stats["memoryUsage"].value <= stats["memoryLimit"].value )
+		finally :
+			IECore.SceneCache.setCacheMemoryLimit( IECore.SceneCache.CacheType.Objects, oldLimit )
+
+		w = IECore.SceneCache( "/tmp/test.scc", IECore.IndexedIO.OpenMode.Write )
+		self.assertRaises( RuntimeError, w.cacheStatistics, IECore.SceneCache.CacheType.Objects )
+
+	def testAsynchronousWrites( self ) :
+
+		def write( fileName, asynchronous ) :
+
+			m = IECore.SceneCache( fileName, IECore.IndexedIO.OpenMode.Write )
+			self.assertEqual( m.getAsynchronousWrites(), False )
+			if asynchronous :
+				# a small queue, so that writes have to wait for it
+				m.setAsynchronousWrites( True, 1024 * 10 )
+				self.assertEqual( m.getAsynchronousWrites(), True )
+
+			sphere = IECore.MeshPrimitive.createSphere( 1 )
+			for i in range( 0, 5 ) :
+				c = m.createChild( str( i ) )
+				self.assertEqual( c.getAsynchronousWrites(), asynchronous )
+				c.writeTags( [ "tag%d" % i ] )
+				for t in range( 0, 3 ) :
+					c.writeTransform( IECore.M44dData( IECore.M44d.createTranslated( IECore.V3d( i, t, 0 ) ) ), t )
+					c.writeAttribute( "w", IECore.IntData( i * t ), t )
+					c.writeObject( sphere, t )
+					# modifying the object after writing it must not affect what is written
+					sphere["P"].data[0] += IECore.V3f( 1 )
+					c.writeBound( IECore.Box3d( IECore.V3d( -i - t ), IECore.V3d( i + t ) ), t )
+
+			# queries wait for the queued writes
+			self.assertTrue( c.hasObject() )
+			self.assertTrue( c.hasAttribute( "w" ) )
+			self.assertTrue( c.hasTag( "tag4" ) )
+
+			m.flush()
+			del m, c
+
+		write( "/tmp/test.scc", False )
+		write( "/tmp/testAsync.scc", True )
+
+		a = IECore.SceneCache( "/tmp/test.scc", IECore.IndexedIO.OpenMode.Read )
+		b = IECore.SceneCache( "/tmp/testAsync.scc", IECore.IndexedIO.OpenMode.Read )
+		self.assertEqual( a.childNames(), b.childNames() )
+		self.assertEqual( a.hash( IECore.SceneInterface.HashType.HierarchyHash, 1 ), b.hash( IECore.SceneInterface.HashType.HierarchyHash, 1 ) )
+		for name in a.childNames() :
+			ac = a.child( name )
+			bc = b.child( name )
+			self.assertEqual( ac.readTags(), bc.readTags() )
+			self.assertEqual( ac.numObjectSamples(), 3 )
+			self.assertEqual( bc.numObjectSamples(), 3 )
+			for i in range( 0, 3 ) :
+				self.assertEqual( ac.readObjectAtSample( i ), bc.readObjectAtSample( i ) )
+				self.assertEqual( ac.readTransformAtSample( i ), bc.readTransformAtSample( i ) )
+				self.assertEqual( ac.readAttributeAtSample( "w", i ), bc.readAttributeAtSample( "w", i ) )
+				self.assertEqual( ac.readBoundAtSample( i ), bc.readBoundAtSample( i ) )
+				self.assertEqual( ac.hash( IECore.SceneInterface.HashType.ObjectHash, i ), bc.hash( IECore.SceneInterface.HashType.ObjectHash, i ) )
+
+			# each sample was written before the object was modified
+			self.assertNotEqual( bc.readObjectAtSample( 0 ), bc.readObjectAtSample( 1 ) )
+			self.assertEqual( bc.readObjectAtSample( 1 )["P"].data[0], bc.readObjectAtSample( 0 )["P"].data[0] + IECore.V3f( 1 ) )
+
+		self.assertRaises( RuntimeError, a.flush )
+		self.assertRaises( RuntimeError, a.setAsynchronousWrites, True )
+
+	def testFileFormatConversion( self ) :
+
+		# copies a version 5 file into the current format, with and without compressed
+		# data, and checks that the copies match the original. if the IECORE_BENCHMARKS
+		# environment variable is set, also reports the file sizes and the time taken to
+		# open and traverse them.
+
+		def copy( src, dst ) :
+
+			if src.path() :
+				for i in range( 0, src.numTransformSamples() ) :
+					dst.writeTransform( src.readTransformAtSample( i ), src.transformSampleTime( i ) )
+				if src.hasObject() :
+					for i in range( 0, src.numObjectSamples() ) :
+						dst.writeObject( src.readObjectAtSample( i ), src.objectSampleTime( i ) )
+
+			for name in src.attributeNames() :
+				for i in range( 0, src.numAttributeSamples( name ) ) :
+					dst.writeAttribute( name, src.readAttributeAtSample( name, i ), src.attributeSampleTime( name, i ) )
+
+			for childName in src.childNames() :
+				copy( src.child( childName ), dst.createChild( childName ) )
+
+		def traverse( scene ) :
+
+			if scene.hasObject() :
+				scene.readObjectAtSample( 0 )
+			for childName in scene.childNames() :
+				traverse( scene.child( childName ) )
+
+		def openTime( fileName ) :
+
+			t = time.time()
+			for i in range( 0, 20 ) :
+				traverse( IECore.SceneCache( fileName, IECore.IndexedIO.OpenMode.Read ) )
+			return time.time() - t
+
+		v5FileName = "test/IECore/data/sccFiles/animatedSpheres.scc"
+		v5 = IECore.SceneCache( v5FileName, IECore.IndexedIO.OpenMode.Read )
+
+		files = [
+			( "/tmp/benchmark.scc", IECore.IndexedIO.OpenMode.Write ),
+			( "/tmp/benchmarkCompressed.scc", IECore.IndexedIO.OpenMode.Write | IECore.IndexedIO.OpenMode.CompressedData ),
+		]
+
+		for fileName, mode in files :
+			w = IECore.SceneCache( fileName, mode )
+			copy( v5, w )
+			del w
+
+		if os.environ.get( "IECORE_BENCHMARKS", "0" ) not in ( "", "0" ) :
+			for fileName in [ v5FileName ] + [ f[0] for f in files ] :
+				sys.stderr.write( "\n%s : %d bytes, %.3fs to open and traverse 20 times" % ( fileName, os.path.getsize( fileName ), openTime( fileName ) ) )
+
+		self.assertTrue( os.path.getsize( files[1][0] ) <= os.path.getsize( files[0][0] ) )
+
+		def assertScenesEqual( a, b ) :
+
+			self.assertEqual( a.childNames(), b.childNames() )
+			self.assertEqual( a.numTransformSamples(), b.numTransformSamples() )
+			for i in range( 0, a.numTransformSamples() ) :
+				self.assertEqual( a.readTransformAtSample( i ), b.readTransformAtSample( i ) )
+			self.assertEqual( a.hasObject(), b.hasObject() )
+			if a.hasObject() :
+				self.assertEqual( a.readObjectAtSample( 0 ), b.readObjectAtSample( 0 ) )
+			for childName in a.childNames() :
+				assertScenesEqual( a.child( childName ), b.child( childName ) )
+
+		for fileName, mode in files :
+			assertScenesEqual( IECore.SceneCache( fileName, IECore.IndexedIO.OpenMode.Read ), v5 )
+
+	def tearDown( self ) :
+
+		for f in [ "/tmp/test.scc", "/tmp/testAsync.scc", "/tmp/benchmark.scc", "/tmp/benchmarkCompressed.scc" ] :
+			if os.path.isfile( f ) :
+				os.remove( f )
+
 if __name__ == "__main__":
 	unittest.main()
 
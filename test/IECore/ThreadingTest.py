@@ -310,9 +310,67 @@ class ThreadingTest( unittest.TestCase ) :
 						
 		self.failUnless( threadedTime < nonThreadedTime ) # this could plausibly fail due to varying load on the machine / io but generally shouldn't
 
+	def testSceneCacheReadingGains( self ) :
+
+		## Checks that SceneCache reads from different threads run concurrently.
+
+		m = IECore.SceneCache( "test/IECore/threadingTest.scc", IECore.IndexedIO.OpenMode.Write )
+		for i in range( 0, 8 ) :
+			mesh = IECore.MeshPrimitive.createPlane( IECore.Box2f( IECore.V2f( -1 ), IECore.V2f( 1 ) ), IECore.V2i( 200 + i ) )
+			m.createChild( str( i ) ).writeObject( mesh, 0.0 )
+		del m
+
+		def read( childName ) :
+
+			m = IECore.SceneCache( "test/IECore/threadingTest.scc", IECore.IndexedIO.OpenMode.Read )
+			m.child( childName ).readObject( 0.0 )
+
+		calls = [ read ] * 8
+		args = [ ( str( i ), ) for i in range( 0, 8 ) ]
+
+		tStart = time.time()
+		self.callSomeThings( calls, args, threaded=False )
+		nonThreadedTime = time.time() - tStart
+
+		tStart = time.time()
+		self.callSomeThings( calls, args, threaded=True )
+		threadedTime = time.time() - tStart
+
+		self.failUnless( threadedTime < nonThreadedTime ) # this could plausibly fail due to varying load on the machine / io but generally shouldn't
+
+	def testObjectLoadGains( self ) :
+
+		## Checks that Object.load() calls from different threads run concurrently.
+
+		for i in range( 0, 4 ) :
+			mesh = IECore.MeshPrimitive.createPlane( IECore.Box2f( IECore.V2f( -1 ), IECore.V2f( 1 ) ), IECore.V2i( 200 + i ) )
+			mesh.save( IECore.FileIndexedIO( "test/IECore/threadingTest%d.fio" % i, [], IECore.IndexedIO.OpenMode.Write ), "mesh" )
+
+		def load( fileName ) :
+
+			IECore.Object.load( IECore.FileIndexedIO( fileName, [], IECore.IndexedIO.OpenMode.Read ), "mesh" )
+
+		calls = [ load ] * 8
+		args = [ ( "test/IECore/threadingTest%d.fio" % ( i % 4 ), ) for i in range( 0, 8 ) ]
+
+		tStart = time.time()
+		self.callSomeThings( calls, args, threaded=False )
+		nonThreadedTime = time.time() - tStart
+
+		tStart = time.time()
+		self.callSomeThings( calls, args, threaded=True )
+		threadedTime = time.time() - tStart
+
+		self.failUnless( threadedTime < nonThreadedTime ) # this could plausibly fail due to varying load on the machine / io but generally shouldn't
+
 	def tearDown( self ) :
 		
 		for f in [
+			"test/IECore/threadingTest.scc",
+			"test/IECore/threadingTest0.fio",
+			"test/IECore/threadingTest1.fio",
+			"test/IECore/threadingTest2.fio",
+			"test/IECore/threadingTest3.fio",
 			"test/IECore/test0.jpg",
 			"test/IECore/test1.jpg",
 			"test/IECore/test2.jpg",
@@ -94,7 +94,27 @@ class TestTransformOp( unittest.TestCase ) :
 		self.assertEqual( ms["N"].data, m["N"].data )
 		self.assertEqual( ms["N"].data, m["N"].data )
 		self.assertEqual( ms["notVel"].data, m["notVel"].data )
-		
+
+	def testBytesDuplicated( self ) :
+
+		m = MeshPrimitive.createPlane( Box2f( V2f( -1 ), V2f( 1 ) ), V2i( 100 ) )
+		m["notModified"] = PrimitiveVariable( PrimitiveVariable.Interpolation.Vertex, V3fVectorData( [ V3f( 0.5 ) ] * len( m["P"].data ) ) )
+
+		# copying the input shouldn't duplicate any data, but modifying P must do so
+		o = TransformOp()
+		mt = o( input=m, primVarsToModify = StringVectorData( [ "P" ] ), matrix = M44fData( M44f.createTranslated( V3f( 1 ) ) ) )
+		pBytes = len( m["P"].data ) * 12
+		self.failUnless( o.bytesDuplicated() >= pBytes )
+		self.failUnless( o.bytesDuplicated() < 2 * pBytes )
+
+		# data which isn't shared with anything else doesn't need duplicating
+		o( input=mt, copyInput = False, primVarsToModify = StringVectorData( [ "P" ] ), matrix = M44fData( M44f.createTranslated( V3f( 1 ) ) ) )
+		self.assertEqual( o.bytesDuplicated(), 0 )
+
+		# and when the op is disabled nothing is modified
+		o( input=m, enable = False )
+		self.assertEqual( o.bytesDuplicated(), 0 )
+
 
 if __name__ == "__main__":
 	unittest.main()
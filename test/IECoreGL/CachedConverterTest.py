@@ -170,5 +170,63 @@ class CachedConverterTest( unittest.TestCase ) :
 			# do the deferred removals now we're back on the main thread
 			c.clearUnused()
 		
+	def testPrefetch( self ) :
+
+		c = IECoreGL.CachedConverter( 500 * 1024 * 1024 ) # 500 megs
+
+		meshes = []
+		for i in range( 0, 10 ) :
+			m = IECore.MeshPrimitive.createPlane( IECore.Box2f( IECore.V2f( -1 ), IECore.V2f( 1 ) ), IECore.V2i( 10 + i ) )
+			meshes.append( m )
+
+		# textures need a gl context to convert, so shouldn't be prefetched, but
+		# they shouldn't cause any problems either.
+		dataWindow = IECore.Box2i( IECore.V2i( 0 ), IECore.V2i( 15 ) )
+		image = IECore.ImagePrimitive.createRGBFloat( IECore.Color3f( 1, 0.5, 0.25 ), dataWindow, dataWindow )
+
+		c.prefetch( meshes + [ image ] )
+		c.waitForPrefetches()
+
+		for m in meshes :
+			gm = c.convert( m )
+			self.failUnless( isinstance( gm, IECoreGL.MeshPrimitive ) )
+			self.failUnless( gm.isSame( c.convert( m.copy() ) ) )
+
+		self.failUnless( isinstance( c.convert( image ), IECoreGL.Texture ) )
+
+		# the meshes should not have been modified by the conversion
+		for i, m in enumerate( meshes ) :
+			self.assertEqual( m, IECore.MeshPrimitive.createPlane( IECore.Box2f( IECore.V2f( -1 ), IECore.V2f( 1 ) ), IECore.V2i( 10 + i ) ) )
+
+	def testPrefetchErrors( self ) :
+
+		c = IECoreGL.CachedConverter( 500 * 1024 * 1024 ) # 500 megs
+
+		# a mesh without "P" can't be converted. the error should be
+		# reported by convert() rather than by prefetch().
+		m = IECore.MeshPrimitive( IECore.IntVectorData( [ 3 ] ), IECore.IntVectorData( [ 0, 1, 2 ] ) )
+
+		c.prefetch( [ m ] )
+		c.waitForPrefetches()
+
+		self.assertRaises( RuntimeError, c.convert, m )
+
+	def testPrefetchDuplicates( self ) :
+
+		c = IECoreGL.CachedConverter( 500 * 1024 * 1024 ) # 500 megs
+
+		# a mesh large enough that its conversion uses parallel loops, prefetched
+		# many times over. this must not deadlock.
+		m = IECore.MeshPrimitive.createPlane( IECore.Box2f( IECore.V2f( -1 ), IECore.V2f( 1 ) ), IECore.V2i( 200 ) )
+		c.prefetch( [ m ] * 100 )
+		c.prefetch( [ m.copy() for i in range( 0, 10 ) ] )
+
+		# converting while the prefetches may still be running must not deadlock either
+		gm = c.convert( m )
+		c.waitForPrefetches()
+
+		self.failUnless( isinstance( gm, IECoreGL.MeshPrimitive ) )
+		self.failUnless( gm.isSame( c.convert( m.copy() ) ) )
+
 if __name__ == "__main__":
     unittest.main()
@@ -36,6 +36,7 @@ from __future__ import with_statement
 
 import unittest
 import os
+import sys
 import shutil
 
 import IECore
@@ -104,6 +105,64 @@ class MeshPrimitiveTest( unittest.TestCase ) :
 		
 		self.assertEqual( IECore.ImageDiffOp()( imageA = expectedImage, imageB = actualImage, maxError = 0.05 ).value, False )
 
+	def testIndexedConversion( self ) :
+
+		m = IECore.MeshPrimitive.createPlane( IECore.Box2f( IECore.V2f( -1 ), IECore.V2f( 1 ) ), IECore.V2i( 10 ) )
+		m["Cs"] = IECore.PrimitiveVariable( IECore.PrimitiveVariable.Interpolation.Uniform, IECore.Color3fVectorData( [ IECore.Color3f( 1 ) ] * 100 ) )
+
+		c = IECoreGL.ToGLMeshConverter( m )
+		self.assertEqual( c["indexed"].getTypedValue(), True )
+
+		indexed = c.convert()
+		self.failUnless( isinstance( indexed, IECoreGL.MeshPrimitive ) )
+		self.failUnless( indexed.indexed() )
+		# the s and t values are continuous across faces, so each vertex
+		# of the plane becomes a single unique vertex.
+		self.assertEqual( indexed.numVertices(), 121 )
+		self.assertEqual( len( indexed.vertexIds() ), 200 * 3 )
+		self.assertEqual( max( indexed.vertexIds() ), 120 )
+
+		c["indexed"].setTypedValue( False )
+		expanded = c.convert()
+		self.failIf( expanded.indexed() )
+		self.assertEqual( expanded.numVertices(), 200 * 3 )
+		self.assertEqual( expanded.bound(), indexed.bound() )
+
+		# discontinuous face-varying values split vertices
+		s = m["s"].data.copy()
+		s[1] = 0.5
+		m["s"] = IECore.PrimitiveVariable( IECore.PrimitiveVariable.Interpolation.FaceVarying, s )
+		indexed = IECoreGL.ToGLMeshConverter( m ).convert()
+		self.assertEqual( indexed.numVertices(), 122 )
+
+	def testIndexedConversionMemory( self ) :
+
+		# checks that indexing at least halves the memory used by the vertex
+		# attributes and indices of a typical mesh. if the IECORE_BENCHMARKS environment variable is set, also reports
+		# the time taken for each conversion.
+
+		m = IECore.MeshPrimitive.createPlane( IECore.Box2f( IECore.V2f( -1 ), IECore.V2f( 1 ) ), IECore.V2i( 500 ) )
+		m["N"] = IECore.PrimitiveVariable( IECore.PrimitiveVariable.Interpolation.Vertex, IECore.V3fVectorData( [ IECore.V3f( 0, 0, 1 ) ] * m.variableSize( IECore.PrimitiveVariable.Interpolation.Vertex ) ) )
+
+		c = IECoreGL.ToGLMeshConverter( m )
+		for indexed in ( False, True ) :
+			c["indexed"].setTypedValue( indexed )
+			t = IECore.Timer()
+			glMesh = c.convert()
+			elapsed = t.stop()
+			self.failUnless( glMesh.vertexAttribute( "P" ) is not None )
+			memory = glMesh.vertexIds().memoryUsage() if indexed else 0
+			for name in m.keys() + [ "st" ] :
+				attribute = glMesh.vertexAttribute( name )
+				if attribute is not None :
+					memory += attribute.memoryUsage()
+			if os.environ.get( "IECORE_BENCHMARKS", "0" ) not in ( "", "0" ) :
+				sys.stderr.write( "\nToGLMeshConverter indexed=%d : %.3fs, %.1fMB" % ( indexed, elapsed, memory / ( 1024.0 * 1024.0 ) ) )
+			if indexed :
+				self.failUnless( memory < expandedMemory / 2 )
+			else :
+				expandedMemory = memory
+
 	def setUp( self ) :
 		
 		if not os.path.isdir( "test/IECoreGL/output" ) :